@@ -275,6 +275,9 @@ mesh.add('partition', doc, None, iint('numPart'), ivectorsize('elementTags', 'st
 doc = '''Unpartition the mesh of the current model.'''
 mesh.add('unpartition', doc, None)
 
+doc = '''Write the mesh of the current model split into `numPart' partitions, in one MSH4 file per partition named after `fileName' with the partition number appended (e.g. "mesh_1.msh", "mesh_2.msh", ... for "mesh.msh"), without partitioning the model itself. Optionally, `elementTags' and `partitions' can be provided to specify the partition of each element explicitly; otherwise the partition is computed with the algorithm selected by the `Mesh.PartitionAlgorithm' option. Each file contains the partition entities, the nodes shared with other partitions (classified on interface entities) and, if `Mesh.PartitionCreateGhostCells' is set, the ghost cells.'''
+mesh.add('writePartitioned', doc, None, istring('fileName'), iint('numPart'), ivectorsize('elementTags', 'std::vector<std::size_t>()','[]', '[]'), ivectorint('partitions', 'std::vector<int>()','[]', '[]'))
+
 doc = '''Optimize the mesh of the current model using `method' (empty for default tetrahedral mesh optimizer, "Netgen" for Netgen optimizer, "HighOrder" for direct high-order mesh optimizer, "HighOrderElastic" for high-order elastic smoother, "HighOrderFastCurving" for fast curving algorithm, "Laplace2D" for Laplace smoothing, "Relocate2D" and "Relocate3D" for node relocation, "QuadQuasiStructured" for quad mesh optimization, "UntangleMeshGeometry" for untangling). If `force' is set apply the optimization also to discrete entities. If `dimTags' (given as a vector of (dim, tag) pairs) is given, only apply the optimizer to the given entities.'''
 mesh.add('optimize', doc, None, istring('method', '""'), ibool('force', 'false', 'False'), iint('niter', '1'), ivectorpair('dimTags', 'gmsh::vectorpair()', '[]', '[]'))
 
@@ -533,6 +536,12 @@ mesh.add('renumberNodes', doc, None, ivectorsize('oldTags', 'std::vector<std::si
 doc = '''Renumber the element tags in a continuous sequence. If no explicit renumbering is provided through the `oldTags' and `newTags' vectors, renumber the elements in a continuous sequence, taking into account the subset of elements to be saved later on if the option "Mesh.SaveAll" is not set.'''
 mesh.add('renumberElements', doc, None, ivectorsize('oldTags', 'std::vector<std::size_t>()', '[]', '[]'), ivectorsize('newTags', 'std::vector<std::size_t>()', '[]', '[]'))
 
+doc = '''Sort the nodes and the elements classified on each model entity by increasing tag, so that their order in memory (and in the output of e.g. `getNodes' and `getElements') follows the numbering. This is useful after a renumbering computed with `computeRenumbering' and applied with `renumberNodes' and `renumberElements', to improve memory locality.'''
+mesh.add('sortByTags', doc, None)
+
+doc = '''Sort the nodes and the elements classified on each model entity along a Hilbert curve. If `reallocate' is set, also reallocate them in that order, so that they are contiguous in memory; this improves the memory locality of loops over the mesh (e.g. for quality evaluation, export or assembly through the API). Tags are not modified: use `computeRenumbering' with the "Hilbert" method to renumber the nodes accordingly.'''
+mesh.add('sortAlongHilbertCurve', doc, None, ibool('reallocate', 'true', 'True'))
+
 doc = '''Set the meshes of the entities of dimension `dim' and tag `tags' as periodic copies of the meshes of entities `tagsMaster', using the affine transformation specified in `affineTransformation' (16 entries of a 4x4 matrix, by row). If used after meshing, generate the periodic node correspondence information assuming the meshes of entities `tags' effectively match the meshes of entities `tagsMaster' (useful for structured and extruded meshes). Currently only available for @code{dim} == 1 and @code{dim} == 2.'''
 mesh.add('setPeriodic', doc, None, iint('dim'), ivectorint('tags'), ivectorint('tagsMaster'), ivectordouble('affineTransform'))
 
@@ -1035,6 +1044,9 @@ view.add('combine', doc, None, istring('what'), istring('how'), ibool('remove',
 doc = '''Probe the view `tag' for its `values' at point (`x', `y', `z'). If no match is found, `value' is returned empty. Return only the value at step `step' is `step' is positive. Return only values with `numComp' if `numComp' is positive. Return the gradient of the `values' if `gradient' is set. If `distanceMax' is zero, only return a result if an exact match inside an element in the view is found; if `distanceMax' is positive and an exact match is not found, return the value at the closest node if it is closer than `distanceMax'; if `distanceMax' is negative and an exact match is not found, always return the value at the closest node. The distance to the match is returned in `distance'. Return the result from the element described by its coordinates if `xElementCoord', `yElementCoord' and `zElementCoord' are provided. If `dim' is >= 0, return only matches from elements of the specified dimension.'''
 view.add('probe', doc, None, iint('tag'), idouble('x'), idouble('y'), idouble('z'), ovectordouble('values'), odouble('distance'), iint('step', '-1'), iint('numComp', '-1'), ibool('gradient', 'false', 'False'), idouble('distanceMax', '0.'), ivectordouble('xElemCoord', 'std::vector<double>()', '[]', '[]'), ivectordouble('yElemCoord', 'std::vector<double>()', '[]', '[]'), ivectordouble('zElemCoord', 'std::vector<double>()', '[]', '[]'), iint('dim', '-1'))
 
+doc = '''Probe the view `tag' for its `values' at the points `coord', given as a vector of coordinates (x, y, z) concatenated, processing the points concurrently. `numComp' (1, 3 or 9) gives the number of components of the probed values; if `numComp' is negative, scalar, vector or tensor values are probed (in this order of preference) depending on the data available in the view. The values at each point are stored contiguously in `values' (`numComp' times 3 if `gradient' is set, times the number of time steps if `step' is negative); they are set to zero if no match is found. `distances' contains the distance to the match for each point, or -1 if no match is found. `distanceMax' and `dim' have the same meaning as in `probe'.'''
+view.add('probePoints', doc, None, iint('tag'), ivectordouble('coord'), ovectordouble('values'), ovectordouble('distances'), iint('step', '-1'), iint('numComp', '-1'), ibool('gradient', 'false', 'False'), idouble('distanceMax', '0.'), iint('dim', '-1'))
+
 doc = '''Write the view to a file `fileName'. The export format is determined by the file extension. Append to the file if `append' is set.'''
 view.add('write', doc, None, iint('tag'), istring('fileName'), ibool('append', 'false', 'False'))
 
@@ -241,6 +241,8 @@ module gmsh
         gmshViewCombine
     procedure, nopass :: probe => &
         gmshViewProbe
+    procedure, nopass :: probePoints => &
+        gmshViewProbePoints
     procedure, nopass :: write => &
         gmshViewWrite
     procedure, nopass :: setVisibilityPerWindow => &
@@ -530,6 +532,8 @@ module gmsh
         gmshModelMeshPartition
     procedure, nopass :: unpartition => &
         gmshModelMeshUnpartition
+    procedure, nopass :: writePartitioned => &
+        gmshModelMeshWritePartitioned
     procedure, nopass :: optimize => &
         gmshModelMeshOptimize
     procedure, nopass :: recombine => &
@@ -702,6 +706,10 @@ module gmsh
         gmshModelMeshRenumberNodes
     procedure, nopass :: renumberElements => &
         gmshModelMeshRenumberElements
+    procedure, nopass :: sortByTags => &
+        gmshModelMeshSortByTags
+    procedure, nopass :: sortAlongHilbertCurve => &
+        gmshModelMeshSortAlongHilbertCurve
     procedure, nopass :: setPeriodic => &
         gmshModelMeshSetPeriodic
     procedure, nopass :: getPeriodic => &
@@ -3316,6 +3324,53 @@ module gmsh
     call C_API(ierr_=ierr)
   end subroutine gmshModelMeshUnpartition
 
+  !> Write the mesh of the current model split into `numPart' partitions, in one
+  !! MSH4 file per partition named after `fileName' with the partition number
+  !! appended (e.g. "mesh_1.msh", "mesh_2.msh", ... for "mesh.msh"), without
+  !! partitioning the model itself. Optionally, `elementTags' and `partitions'
+  !! can be provided to specify the partition of each element explicitly;
+  !! otherwise the partition is computed with the algorithm selected by the
+  !! `Mesh.PartitionAlgorithm' option. Each file contains the partition
+  !! entities, the nodes shared with other partitions (classified on interface
+  !! entities) and, if `Mesh.PartitionCreateGhostCells' is set, the ghost cells.
+  subroutine gmshModelMeshWritePartitioned(fileName, &
+                                           numPart, &
+                                           elementTags, &
+                                           partitions, &
+                                           ierr)
+    interface
+    subroutine C_API(fileName, &
+                     numPart, &
+                     api_elementTags_, &
+                     api_elementTags_n_, &
+                     api_partitions_, &
+                     api_partitions_n_, &
+                     ierr_) &
+      bind(C, name="gmshModelMeshWritePartitioned")
+      use, intrinsic :: iso_c_binding
+      character(len=1, kind=c_char), dimension(*), intent(in) :: fileName
+      integer(c_int), value, intent(in) :: numPart
+      integer(c_size_t), dimension(*), optional :: api_elementTags_
+      integer(c_size_t), value, intent(in) :: api_elementTags_n_
+      integer(c_int), dimension(*), optional :: api_partitions_
+      integer(c_size_t), value, intent(in) :: api_partitions_n_
+      integer(c_int), intent(out), optional :: ierr_
+    end subroutine C_API
+    end interface
+    character(len=*), intent(in) :: fileName
+    integer, intent(in) :: numPart
+    integer(c_size_t), dimension(:), intent(in), optional :: elementTags
+    integer(c_int), dimension(:), intent(in), optional :: partitions
+    integer(c_int), intent(out), optional :: ierr
+    call C_API(fileName=istring_(fileName), &
+         numPart=int(numPart, c_int), &
+         api_elementTags_=elementTags, &
+         api_elementTags_n_=size_gmsh_size(elementTags), &
+         api_partitions_=partitions, &
+         api_partitions_n_=size_gmsh_int(partitions), &
+         ierr_=ierr)
+  end subroutine gmshModelMeshWritePartitioned
+
   !> Optimize the mesh of the current model using `method' (empty for default
   !! tetrahedral mesh optimizer, "Netgen" for Netgen optimizer, "HighOrder" for
   !! direct high-order mesh optimizer, "HighOrderElastic" for high-order elastic
@@ -6897,6 +6952,46 @@ module gmsh
          ierr_=ierr)
   end subroutine gmshModelMeshRenumberElements
 
+  !> Sort the nodes and the elements classified on each model entity by
+  !! increasing tag, so that their order in memory (and in the output of e.g.
+  !! `getNodes' and `getElements') follows the numbering. This is useful after a
+  !! renumbering computed with `computeRenumbering' and applied with
+  !! `renumberNodes' and `renumberElements', to improve memory locality.
+  subroutine gmshModelMeshSortByTags(ierr)
+    interface
+    subroutine C_API(ierr_) &
+      bind(C, name="gmshModelMeshSortByTags")
+      use, intrinsic :: iso_c_binding
+      integer(c_int), intent(out), optional :: ierr_
+    end subroutine C_API
+    end interface
+    integer(c_int), intent(out), optional :: ierr
+    call C_API(ierr_=ierr)
+  end subroutine gmshModelMeshSortByTags
+
+  !> Sort the nodes and the elements classified on each model entity along a
+  !! Hilbert curve. If `reallocate' is set, also reallocate them in that order,
+  !! so that they are contiguous in memory; this improves the memory locality of
+  !! loops over the mesh (e.g. for quality evaluation, export or assembly
+  !! through the API). Tags are not modified: use `computeRenumbering' with the
+  !! "Hilbert" method to renumber the nodes accordingly.
+  subroutine gmshModelMeshSortAlongHilbertCurve(reallocate, &
+                                                ierr)
+    interface
+    subroutine C_API(reallocate, &
+                     ierr_) &
+      bind(C, name="gmshModelMeshSortAlongHilbertCurve")
+      use, intrinsic :: iso_c_binding
+      integer(c_int), value, intent(in) :: reallocate
+      integer(c_int), intent(out), optional :: ierr_
+    end subroutine C_API
+    end interface
+    logical, intent(in), optional :: reallocate
+    integer(c_int), intent(out), optional :: ierr
+    call C_API(reallocate=optval_c_bool(.true., reallocate), &
+         ierr_=ierr)
+  end subroutine gmshModelMeshSortAlongHilbertCurve
+
   !> Set the meshes of the entities of dimension `dim' and tag `tags' as
   !! periodic copies of the meshes of entities `tagsMaster', using the affine
   !! transformation specified in `affineTransformation' (16 entries of a 4x4
@@ -14126,6 +14221,90 @@ module gmsh
       api_values_n_)
   end subroutine gmshViewProbe
 
+  !> Probe the view `tag' for its `values' at the points `coord', given as a
+  !! vector of coordinates (x, y, z) concatenated, processing the points
+  !! concurrently. `numComp' (1, 3 or 9) gives the number of components of the
+  !! probed values; if `numComp' is negative, scalar, vector or tensor values
+  !! are probed (in this order of preference) depending on the data available in
+  !! the view. The values at each point are stored contiguously in `values'
+  !! (`numComp' times 3 if `gradient' is set, times the number of time steps if
+  !! `step' is negative); they are set to zero if no match is found. `distances'
+  !! contains the distance to the match for each point, or -1 if no match is
+  !! found. `distanceMax' and `dim' have the same meaning as in `probe'.
+  subroutine gmshViewProbePoints(tag, &
+                                 coord, &
+                                 values, &
+                                 distances, &
+                                 step, &
+                                 numComp, &
+                                 gradient, &
+                                 distanceMax, &
+                                 dim, &
+                                 ierr)
+    interface
+    subroutine C_API(tag, &
+                     api_coord_, &
+                     api_coord_n_, &
+                     api_values_, &
+                     api_values_n_, &
+                     api_distances_, &
+                     api_distances_n_, &
+                     step, &
+                     numComp, &
+                     gradient, &
+                     distanceMax, &
+                     dim, &
+                     ierr_) &
+      bind(C, name="gmshViewProbePoints")
+      use, intrinsic :: iso_c_binding
+      integer(c_int), value, intent(in) :: tag
+      real(c_double), dimension(*) :: api_coord_
+      integer(c_size_t), value, intent(in) :: api_coord_n_
+      type(c_ptr), intent(out) :: api_values_
+      integer(c_size_t) :: api_values_n_
+      type(c_ptr), intent(out) :: api_distances_
+      integer(c_size_t) :: api_distances_n_
+      integer(c_int), value, intent(in) :: step
+      integer(c_int), value, intent(in) :: numComp
+      integer(c_int), value, intent(in) :: gradient
+      real(c_double), value, intent(in) :: distanceMax
+      integer(c_int), value, intent(in) :: dim
+      integer(c_int), intent(out), optional :: ierr_
+    end subroutine C_API
+    end interface
+    integer, intent(in) :: tag
+    real(c_double), dimension(:), intent(in) :: coord
+    real(c_double), dimension(:), allocatable, intent(out) :: values
+    real(c_double), dimension(:), allocatable, intent(out) :: distances
+    integer, intent(in), optional :: step
+    integer, intent(in), optional :: numComp
+    logical, intent(in), optional :: gradient
+    real(c_double), intent(in), optional :: distanceMax
+    integer, intent(in), optional :: dim
+    integer(c_int), intent(out), optional :: ierr
+    type(c_ptr) :: api_values_
+    integer(c_size_t) :: api_values_n_
+    type(c_ptr) :: api_distances_
+    integer(c_size_t) :: api_distances_n_
+    call C_API(tag=int(tag, c_int), &
+         api_coord_=coord, &
+         api_coord_n_=size_gmsh_double(coord), &
+         api_values_=api_values_, &
+         api_values_n_=api_values_n_, &
+         api_distances_=api_distances_, &
+         api_distances_n_=api_distances_n_, &
+         step=optval_c_int(-1, step), &
+         numComp=optval_c_int(-1, numComp), &
+         gradient=optval_c_bool(.false., gradient), &
+         distanceMax=optval_c_double(0., distanceMax), &
+         dim=optval_c_int(-1, dim), &
+         ierr_=ierr)
+    values = ovectordouble_(api_values_, &
+      api_values_n_)
+    distances = ovectordouble_(api_distances_, &
+      api_distances_n_)
+  end subroutine gmshViewProbePoints
+
   !> Write the view to a file `fileName'. The export format is determined by the
   !! file extension. Append to the file if `append' is set.
   subroutine gmshViewWrite(tag, &
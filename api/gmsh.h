@@ -716,6 +716,23 @@ namespace gmsh { // Top-level functions
       // Unpartition the mesh of the current model.
       GMSH_API void unpartition();
 
+      // gmsh::model::mesh::writePartitioned
+      //
+      // Write the mesh of the current model split into `numPart' partitions, in
+      // one MSH4 file per partition named after `fileName' with the partition
+      // number appended (e.g. "mesh_1.msh", "mesh_2.msh", ... for "mesh.msh"),
+      // without partitioning the model itself. Optionally, `elementTags' and
+      // `partitions' can be provided to specify the partition of each element
+      // explicitly; otherwise the partition is computed with the algorithm
+      // selected by the `Mesh.PartitionAlgorithm' option. Each file contains the
+      // partition entities, the nodes shared with other partitions (classified on
+      // interface entities) and, if `Mesh.PartitionCreateGhostCells' is set, the
+      // ghost cells.
+      GMSH_API void writePartitioned(const std::string & fileName,
+                                     const int numPart,
+                                     const std::vector<std::size_t> & elementTags = std::vector<std::size_t>(),
+                                     const std::vector<int> & partitions = std::vector<int>());
+
       // gmsh::model::mesh::optimize
       //
       // Optimize the mesh of the current model using `method' (empty for default
@@ -1700,6 +1717,25 @@ namespace gmsh { // Top-level functions
       GMSH_API void renumberElements(const std::vector<std::size_t> & oldTags = std::vector<std::size_t>(),
                                      const std::vector<std::size_t> & newTags = std::vector<std::size_t>());
 
+      // gmsh::model::mesh::sortByTags
+      //
+      // Sort the nodes and the elements classified on each model entity by
+      // increasing tag, so that their order in memory (and in the output of e.g.
+      // `getNodes' and `getElements') follows the numbering. This is useful after
+      // a renumbering computed with `computeRenumbering' and applied with
+      // `renumberNodes' and `renumberElements', to improve memory locality.
+      GMSH_API void sortByTags();
+
+      // gmsh::model::mesh::sortAlongHilbertCurve
+      //
+      // Sort the nodes and the elements classified on each model entity along a
+      // Hilbert curve. If `reallocate' is set, also reallocate them in that order,
+      // so that they are contiguous in memory; this improves the memory locality
+      // of loops over the mesh (e.g. for quality evaluation, export or assembly
+      // through the API). Tags are not modified: use `computeRenumbering' with the
+      // "Hilbert" method to renumber the nodes accordingly.
+      GMSH_API void sortAlongHilbertCurve(const bool reallocate = true);
+
       // gmsh::model::mesh::setPeriodic
       //
       // Set the meshes of the entities of dimension `dim' and tag `tags' as
@@ -3690,6 +3726,28 @@ namespace gmsh { // Top-level functions
                         const std::vector<double> & zElemCoord = std::vector<double>(),
                         const int dim = -1);
 
+    // gmsh::view::probePoints
+    //
+    // Probe the view `tag' for its `values' at the points `coord', given as a
+    // vector of coordinates (x, y, z) concatenated, processing the points
+    // concurrently. `numComp' (1, 3 or 9) gives the number of components of the
+    // probed values; if `numComp' is negative, scalar, vector or tensor values are
+    // probed (in this order of preference) depending on the data available in the
+    // view. The values at each point are stored contiguously in `values'
+    // (`numComp' times 3 if `gradient' is set, times the number of time steps if
+    // `step' is negative); they are set to zero if no match is found. `distances'
+    // contains the distance to the match for each point, or -1 if no match is
+    // found. `distanceMax' and `dim' have the same meaning as in `probe'.
+    GMSH_API void probePoints(const int tag,
+                              const std::vector<double> & coord,
+                              std::vector<double> & values,
+                              std::vector<double> & distances,
+                              const int step = -1,
+                              const int numComp = -1,
+                              const bool gradient = false,
+                              const double distanceMax = 0.,
+                              const int dim = -1);
+
     // gmsh::view::write
     //
     // Write the view to a file `fileName'. The export format is determined by the
@@ -1856,6 +1856,35 @@ function unpartition()
     return nothing
 end
 
+"""
+    gmsh.model.mesh.writePartitioned(fileName, numPart, elementTags = Csize_t[], partitions = Cint[])
+
+Write the mesh of the current model split into `numPart` partitions, in one MSH4
+file per partition named after `fileName` with the partition number appended
+(e.g. "mesh_1.msh", "mesh_2.msh", ... for "mesh.msh"), without partitioning the
+model itself. Optionally, `elementTags` and `partitions` can be provided to
+specify the partition of each element explicitly; otherwise the partition is
+computed with the algorithm selected by the `Mesh.PartitionAlgorithm` option.
+Each file contains the partition entities, the nodes shared with other
+partitions (classified on interface entities) and, if
+`Mesh.PartitionCreateGhostCells` is set, the ghost cells.
+
+Types:
+ - `fileName`: string
+ - `numPart`: integer
+ - `elementTags`: vector of sizes
+ - `partitions`: vector of integers
+"""
+function writePartitioned(fileName, numPart, elementTags = Csize_t[], partitions = Cint[])
+    ierr = Ref{Cint}()
+    ccall((:gmshModelMeshWritePartitioned, gmsh.lib), Cvoid,
+          (Ptr{Cchar}, Cint, Ptr{Csize_t}, Csize_t, Ptr{Cint}, Csize_t, Ptr{Cint}),
+          fileName, numPart, convert(Vector{Csize_t}, elementTags), length(elementTags), convert(Vector{Cint}, partitions), length(partitions), ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const write_partitioned = writePartitioned
+
 """
     gmsh.model.mesh.optimize(method = "", force = false, niter = 1, dimTags = Tuple{Cint,Cint}[])
 
@@ -4127,6 +4156,48 @@ function renumberElements(oldTags = Csize_t[], newTags = Csize_t[])
 end
 const renumber_elements = renumberElements
 
+"""
+    gmsh.model.mesh.sortByTags()
+
+Sort the nodes and the elements classified on each model entity by increasing
+tag, so that their order in memory (and in the output of e.g. `getNodes` and
+`getElements`) follows the numbering. This is useful after a renumbering
+computed with `computeRenumbering` and applied with `renumberNodes` and
+`renumberElements`, to improve memory locality.
+"""
+function sortByTags()
+    ierr = Ref{Cint}()
+    ccall((:gmshModelMeshSortByTags, gmsh.lib), Cvoid,
+          (Ptr{Cint},),
+          ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const sort_by_tags = sortByTags
+
+"""
+    gmsh.model.mesh.sortAlongHilbertCurve(reallocate = true)
+
+Sort the nodes and the elements classified on each model entity along a Hilbert
+curve. If `reallocate` is set, also reallocate them in that order, so that they
+are contiguous in memory; this improves the memory locality of loops over the
+mesh (e.g. for quality evaluation, export or assembly through the API). Tags are
+not modified: use `computeRenumbering` with the "Hilbert" method to renumber the
+nodes accordingly.
+
+Types:
+ - `reallocate`: boolean
+"""
+function sortAlongHilbertCurve(reallocate = true)
+    ierr = Ref{Cint}()
+    ccall((:gmshModelMeshSortAlongHilbertCurve, gmsh.lib), Cvoid,
+          (Cint, Ptr{Cint}),
+          reallocate, ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const sort_along_hilbert_curve = sortAlongHilbertCurve
+
 """
     gmsh.model.mesh.setPeriodic(dim, tags, tagsMaster, affineTransform)
 
@@ -8718,6 +8789,49 @@ function probe(tag, x, y, z, step = -1, numComp = -1, gradient = false, distance
     return values, api_distance_[]
 end
 
+"""
+    gmsh.view.probePoints(tag, coord, step = -1, numComp = -1, gradient = false, distanceMax = 0., dim = -1)
+
+Probe the view `tag` for its `values` at the points `coord`, given as a vector
+of coordinates (x, y, z) concatenated, processing the points concurrently.
+`numComp` (1, 3 or 9) gives the number of components of the probed values; if
+`numComp` is negative, scalar, vector or tensor values are probed (in this order
+of preference) depending on the data available in the view. The values at each
+point are stored contiguously in `values` (`numComp` times 3 if `gradient` is
+set, times the number of time steps if `step` is negative); they are set to zero
+if no match is found. `distances` contains the distance to the match for each
+point, or -1 if no match is found. `distanceMax` and `dim` have the same meaning
+as in `probe`.
+
+Return `values`, `distances`.
+
+Types:
+ - `tag`: integer
+ - `coord`: vector of doubles
+ - `values`: vector of doubles
+ - `distances`: vector of doubles
+ - `step`: integer
+ - `numComp`: integer
+ - `gradient`: boolean
+ - `distanceMax`: double
+ - `dim`: integer
+"""
+function probePoints(tag, coord, step = -1, numComp = -1, gradient = false, distanceMax = 0., dim = -1)
+    api_values_ = Ref{Ptr{Cdouble}}()
+    api_values_n_ = Ref{Csize_t}()
+    api_distances_ = Ref{Ptr{Cdouble}}()
+    api_distances_n_ = Ref{Csize_t}()
+    ierr = Ref{Cint}()
+    ccall((:gmshViewProbePoints, gmsh.lib), Cvoid,
+          (Cint, Ptr{Cdouble}, Csize_t, Ptr{Ptr{Cdouble}}, Ptr{Csize_t}, Ptr{Ptr{Cdouble}}, Ptr{Csize_t}, Cint, Cint, Cint, Cdouble, Cint, Ptr{Cint}),
+          tag, convert(Vector{Cdouble}, coord), length(coord), api_values_, api_values_n_, api_distances_, api_distances_n_, step, numComp, gradient, distanceMax, dim, ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    values = unsafe_wrap(Array, api_values_[], api_values_n_[], own = true)
+    distances = unsafe_wrap(Array, api_distances_[], api_distances_n_[], own = true)
+    return values, distances
+end
+const probe_points = probePoints
+
 """
     gmsh.view.write(tag, fileName, append = false)
 
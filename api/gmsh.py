@@ -2201,6 +2201,40 @@ class model:
             if ierr.value != 0:
                 raise Exception(logger.getLastError())
 
+        @staticmethod
+        def writePartitioned(fileName, numPart, elementTags=[], partitions=[]):
+            """
+            gmsh.model.mesh.writePartitioned(fileName, numPart, elementTags=[], partitions=[])
+
+            Write the mesh of the current model split into `numPart' partitions, in one
+            MSH4 file per partition named after `fileName' with the partition number
+            appended (e.g. "mesh_1.msh", "mesh_2.msh", ... for "mesh.msh"), without
+            partitioning the model itself. Optionally, `elementTags' and `partitions'
+            can be provided to specify the partition of each element explicitly;
+            otherwise the partition is computed with the algorithm selected by the
+            `Mesh.PartitionAlgorithm' option. Each file contains the partition
+            entities, the nodes shared with other partitions (classified on interface
+            entities) and, if `Mesh.PartitionCreateGhostCells' is set, the ghost cells.
+
+            Types:
+            - `fileName': string
+            - `numPart': integer
+            - `elementTags': vector of sizes
+            - `partitions': vector of integers
+            """
+            api_elementTags_, api_elementTags_n_ = _ivectorsize(elementTags)
+            api_partitions_, api_partitions_n_ = _ivectorint(partitions)
+            ierr = c_int()
+            lib.gmshModelMeshWritePartitioned(
+                c_char_p(fileName.encode()),
+                c_int(numPart),
+                api_elementTags_, api_elementTags_n_,
+                api_partitions_, api_partitions_n_,
+                byref(ierr))
+            if ierr.value != 0:
+                raise Exception(logger.getLastError())
+        write_partitioned = writePartitioned
+
         @staticmethod
         def optimize(method="", force=False, niter=1, dimTags=[]):
             """
@@ -4698,6 +4732,47 @@ class model:
                 raise Exception(logger.getLastError())
         renumber_elements = renumberElements
 
+        @staticmethod
+        def sortByTags():
+            """
+            gmsh.model.mesh.sortByTags()
+
+            Sort the nodes and the elements classified on each model entity by
+            increasing tag, so that their order in memory (and in the output of e.g.
+            `getNodes' and `getElements') follows the numbering. This is useful after a
+            renumbering computed with `computeRenumbering' and applied with
+            `renumberNodes' and `renumberElements', to improve memory locality.
+            """
+            ierr = c_int()
+            lib.gmshModelMeshSortByTags(
+                byref(ierr))
+            if ierr.value != 0:
+                raise Exception(logger.getLastError())
+        sort_by_tags = sortByTags
+
+        @staticmethod
+        def sortAlongHilbertCurve(reallocate=True):
+            """
+            gmsh.model.mesh.sortAlongHilbertCurve(reallocate=True)
+
+            Sort the nodes and the elements classified on each model entity along a
+            Hilbert curve. If `reallocate' is set, also reallocate them in that order,
+            so that they are contiguous in memory; this improves the memory locality of
+            loops over the mesh (e.g. for quality evaluation, export or assembly
+            through the API). Tags are not modified: use `computeRenumbering' with the
+            "Hilbert" method to renumber the nodes accordingly.
+
+            Types:
+            - `reallocate': boolean
+            """
+            ierr = c_int()
+            lib.gmshModelMeshSortAlongHilbertCurve(
+                c_int(bool(reallocate)),
+                byref(ierr))
+            if ierr.value != 0:
+                raise Exception(logger.getLastError())
+        sort_along_hilbert_curve = sortAlongHilbertCurve
+
         @staticmethod
         def setPeriodic(dim, tags, tagsMaster, affineTransform):
             """
@@ -9852,6 +9927,57 @@ class view:
             _ovectordouble(api_values_, api_values_n_.value),
             api_distance_.value)
 
+    @staticmethod
+    def probePoints(tag, coord, step=-1, numComp=-1, gradient=False, distanceMax=0., dim=-1):
+        """
+        gmsh.view.probePoints(tag, coord, step=-1, numComp=-1, gradient=False, distanceMax=0., dim=-1)
+
+        Probe the view `tag' for its `values' at the points `coord', given as a
+        vector of coordinates (x, y, z) concatenated, processing the points
+        concurrently. `numComp' (1, 3 or 9) gives the number of components of the
+        probed values; if `numComp' is negative, scalar, vector or tensor values
+        are probed (in this order of preference) depending on the data available in
+        the view. The values at each point are stored contiguously in `values'
+        (`numComp' times 3 if `gradient' is set, times the number of time steps if
+        `step' is negative); they are set to zero if no match is found. `distances'
+        contains the distance to the match for each point, or -1 if no match is
+        found. `distanceMax' and `dim' have the same meaning as in `probe'.
+
+        Return `values', `distances'.
+
+        Types:
+        - `tag': integer
+        - `coord': vector of doubles
+        - `values': vector of doubles
+        - `distances': vector of doubles
+        - `step': integer
+        - `numComp': integer
+        - `gradient': boolean
+        - `distanceMax': double
+        - `dim': integer
+        """
+        api_coord_, api_coord_n_ = _ivectordouble(coord)
+        api_values_, api_values_n_ = POINTER(c_double)(), c_size_t()
+        api_distances_, api_distances_n_ = POINTER(c_double)(), c_size_t()
+        ierr = c_int()
+        lib.gmshViewProbePoints(
+            c_int(tag),
+            api_coord_, api_coord_n_,
+            byref(api_values_), byref(api_values_n_),
+            byref(api_distances_), byref(api_distances_n_),
+            c_int(step),
+            c_int(numComp),
+            c_int(bool(gradient)),
+            c_double(distanceMax),
+            c_int(dim),
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+        return (
+            _ovectordouble(api_values_, api_values_n_.value),
+            _ovectordouble(api_distances_, api_distances_n_.value))
+    probe_points = probePoints
+
     @staticmethod
     def write(tag, fileName, append=False):
         """
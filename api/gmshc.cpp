@@ -1028,6 +1028,19 @@ GMSH_API void gmshModelMeshUnpartition(int * ierr)
   }
 }
 
+GMSH_API void gmshModelMeshWritePartitioned(const char * fileName, const int numPart, const size_t * elementTags, const size_t elementTags_n, const int * partitions, const size_t partitions_n, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    std::vector<std::size_t> api_elementTags_(elementTags, elementTags + elementTags_n);
+    std::vector<int> api_partitions_(partitions, partitions + partitions_n);
+    gmsh::model::mesh::writePartitioned(fileName, numPart, api_elementTags_, api_partitions_);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
 GMSH_API void gmshModelMeshOptimize(const char * method, const int force, const int niter, const int * dimTags, const size_t dimTags_n, int * ierr)
 {
   if(ierr) *ierr = 0;
@@ -2207,6 +2220,28 @@ GMSH_API void gmshModelMeshRenumberElements(const size_t * oldTags, const size_t
   }
 }
 
+GMSH_API void gmshModelMeshSortByTags(int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    gmsh::model::mesh::sortByTags();
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
+GMSH_API void gmshModelMeshSortAlongHilbertCurve(const int reallocate, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    gmsh::model::mesh::sortAlongHilbertCurve(reallocate);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
 GMSH_API void gmshModelMeshSetPeriodic(const int dim, const int * tags, const size_t tags_n, const int * tagsMaster, const size_t tagsMaster_n, const double * affineTransform, const size_t affineTransform_n, int * ierr)
 {
   if(ierr) *ierr = 0;
@@ -4487,6 +4522,22 @@ GMSH_API void gmshViewProbe(const int tag, const double x, const double y, const
   }
 }
 
+GMSH_API void gmshViewProbePoints(const int tag, const double * coord, const size_t coord_n, double ** values, size_t * values_n, double ** distances, size_t * distances_n, const int step, const int numComp, const int gradient, const double distanceMax, const int dim, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    std::vector<double> api_coord_(coord, coord + coord_n);
+    std::vector<double> api_values_;
+    std::vector<double> api_distances_;
+    gmsh::view::probePoints(tag, api_coord_, api_values_, api_distances_, step, numComp, gradient, distanceMax, dim);
+    vector2ptr(api_values_, values, values_n);
+    vector2ptr(api_distances_, distances, distances_n);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
 GMSH_API void gmshViewWrite(const int tag, const char * fileName, const int append, int * ierr)
 {
   if(ierr) *ierr = 0;
@@ -618,6 +618,21 @@ GMSH_API void gmshModelMeshPartition(const int numPart,
 /* Unpartition the mesh of the current model. */
 GMSH_API void gmshModelMeshUnpartition(int * ierr);
 
+/* Write the mesh of the current model split into `numPart' partitions, in one
+ * MSH4 file per partition named after `fileName' with the partition number
+ * appended (e.g. "mesh_1.msh", "mesh_2.msh", ... for "mesh.msh"), without
+ * partitioning the model itself. Optionally, `elementTags' and `partitions'
+ * can be provided to specify the partition of each element explicitly;
+ * otherwise the partition is computed with the algorithm selected by the
+ * `Mesh.PartitionAlgorithm' option. Each file contains the partition
+ * entities, the nodes shared with other partitions (classified on interface
+ * entities) and, if `Mesh.PartitionCreateGhostCells' is set, the ghost cells. */
+GMSH_API void gmshModelMeshWritePartitioned(const char * fileName,
+                                            const int numPart,
+                                            const size_t * elementTags, const size_t elementTags_n,
+                                            const int * partitions, const size_t partitions_n,
+                                            int * ierr);
+
 /* Optimize the mesh of the current model using `method' (empty for default
  * tetrahedral mesh optimizer, "Netgen" for Netgen optimizer, "HighOrder" for
  * direct high-order mesh optimizer, "HighOrderElastic" for high-order elastic
@@ -1506,6 +1521,22 @@ GMSH_API void gmshModelMeshRenumberElements(const size_t * oldTags, const size_t
                                             const size_t * newTags, const size_t newTags_n,
                                             int * ierr);
 
+/* Sort the nodes and the elements classified on each model entity by
+ * increasing tag, so that their order in memory (and in the output of e.g.
+ * `getNodes' and `getElements') follows the numbering. This is useful after a
+ * renumbering computed with `computeRenumbering' and applied with
+ * `renumberNodes' and `renumberElements', to improve memory locality. */
+GMSH_API void gmshModelMeshSortByTags(int * ierr);
+
+/* Sort the nodes and the elements classified on each model entity along a
+ * Hilbert curve. If `reallocate' is set, also reallocate them in that order,
+ * so that they are contiguous in memory; this improves the memory locality of
+ * loops over the mesh (e.g. for quality evaluation, export or assembly
+ * through the API). Tags are not modified: use `computeRenumbering' with the
+ * "Hilbert" method to renumber the nodes accordingly. */
+GMSH_API void gmshModelMeshSortAlongHilbertCurve(const int reallocate,
+                                                 int * ierr);
+
 /* Set the meshes of the entities of dimension `dim' and tag `tags' as
  * periodic copies of the meshes of entities `tagsMaster', using the affine
  * transformation specified in `affineTransformation' (16 entries of a 4x4
@@ -3295,6 +3326,27 @@ GMSH_API void gmshViewProbe(const int tag,
                             const int dim,
                             int * ierr);
 
+/* Probe the view `tag' for its `values' at the points `coord', given as a
+ * vector of coordinates (x, y, z) concatenated, processing the points
+ * concurrently. `numComp' (1, 3 or 9) gives the number of components of the
+ * probed values; if `numComp' is negative, scalar, vector or tensor values
+ * are probed (in this order of preference) depending on the data available in
+ * the view. The values at each point are stored contiguously in `values'
+ * (`numComp' times 3 if `gradient' is set, times the number of time steps if
+ * `step' is negative); they are set to zero if no match is found. `distances'
+ * contains the distance to the match for each point, or -1 if no match is
+ * found. `distanceMax' and `dim' have the same meaning as in `probe'. */
+GMSH_API void gmshViewProbePoints(const int tag,
+                                  const double * coord, const size_t coord_n,
+                                  double ** values, size_t * values_n,
+                                  double ** distances, size_t * distances_n,
+                                  const int step,
+                                  const int numComp,
+                                  const int gradient,
+                                  const double distanceMax,
+                                  const int dim,
+                                  int * ierr);
+
 /* Write the view to a file `fileName'. The export format is determined by the
  * file extension. Append to the file if `append' is set. */
 GMSH_API void gmshViewWrite(const int tag,
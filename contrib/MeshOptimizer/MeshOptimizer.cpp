@@ -30,9 +30,11 @@
 #include <limits>
 #include <string.h>
 #include <stack>
+#include <algorithm>
 #include "Context.h"
 #include "GmshConfig.h"
 #include "GModel.h"
+#include "GraphColoring.h"
 #include "MTriangle.h"
 #include "MQuadrangle.h"
 #include "MLine.h"
@@ -93,11 +95,13 @@ namespace {
       neighbours = it->second;
   }
 
+  // Get patch around element (only made of elements of 'allowed' if given)
   elSet getSurroundingPatch(MElement *el, const MeshOptPatchDef *patchDef,
                             double limDist, int maxLayers,
                             const vertElVecMap &vertex2elements,
                             elElSetMap &element2elements,
-                            const elEntMap &element2entity)
+                            const elEntMap &element2entity,
+                            const elSet *allowed = nullptr)
   {
     const SPoint3 pnt = el->barycenter(true);
 
@@ -114,6 +118,7 @@ namespace {
                              neighbours);
         for(auto itN = neighbours.begin(); itN != neighbours.end();
             ++itN) { // Loop over neighbours
+          if(allowed && !allowed->count(*itN)) continue;
           if((lastLayer.find(*itN) ==
               lastLayer.end()) && // If neighbour already in last layer...
              (excluded.find(*itN) ==
@@ -425,6 +430,59 @@ namespace {
     mvprintList(9, -8, _patchHistory, 2);
   }
 
+  // Nodes read or moved when optimizing a patch
+  void getPatchVertices(const elSet &elts, const elSet &bndElts, vertSet &verts)
+  {
+    for(auto itEl = elts.begin(); itEl != elts.end(); ++itEl)
+      for(size_t i = 0; i < (*itEl)->getNumVertices(); ++i)
+        verts.insert((*itEl)->getVertex(i));
+    for(auto itEl = bndElts.begin(); itEl != bndElts.end(); ++itEl)
+      for(size_t i = 0; i < (*itEl)->getNumVertices(); ++i)
+        verts.insert((*itEl)->getVertex(i));
+  }
+
+  // Color the patches such that two patches sharing a node get different
+  // colors, so that all the patches of a given color can be optimized
+  // concurrently. Returns the number of colors.
+  int colorPatches(const std::vector<elSetVertSetPair> &patches,
+                   const std::vector<elSet> &bndElts, std::vector<int> &color)
+  {
+    std::vector<vertSet> verts(patches.size());
+    for(size_t iPatch = 0; iPatch < patches.size(); ++iPatch)
+      getPatchVertices(patches[iPatch].first, bndElts[iPatch], verts[iPatch]);
+    return greedyColoring(verts, color);
+  }
+
+  // Outcome of the optimization of a patch, stored by the thread optimizing
+  // the patch and gathered afterwards in patch order
+  struct patchResult {
+    int success;
+    std::vector<std::pair<double, double> > objFunctionRange;
+    std::vector<std::string> objFunctionNames;
+    // Objective function values for each adaptation step (for display)
+    std::vector<std::pair<int, std::string> > history;
+    patchResult() : success(-1) {}
+  };
+
+  void
+  gatherObjFunctionRange(const patchResult &res,
+                         std::vector<std::pair<double, double> > &range,
+                         std::vector<std::string> &names)
+  {
+    if(res.objFunctionRange.empty()) return;
+    if(range.size() == 0) {
+      range = res.objFunctionRange;
+      names = res.objFunctionNames;
+    }
+    else {
+      for(size_t i = 0; i < range.size(); i++) {
+        range[i].first = std::min(range[i].first, res.objFunctionRange[i].first);
+        range[i].second =
+          std::max(range[i].second, res.objFunctionRange[i].second);
+      }
+    }
+  }
+
   void optimizeDisjointPatches(const vertElVecMap &vertex2elements,
                                const elEntMap &element2entity,
                                const elElMap &el2BndEl,
@@ -456,76 +514,82 @@ namespace {
     }
     if(par.nCurses) displayResultTable(nbPatchSuccess, toOptimize.size());
 
-  int nthreads = CTX::instance()->numThreads;
-  if(!nthreads) nthreads = Msg::GetMaxThreads();
+    // Patches may share nodes (e.g. with weak merging, or on their
+    // boundaries): only optimize concurrently patches of the same color
+    std::vector<int> color;
+    const int numColors = colorPatches(toOptimize, bndElts, color);
+    std::vector<std::vector<size_t> > patchesOfColor(numColors);
+    for(size_t iPatch = 0; iPatch < toOptimize.size(); ++iPatch)
+      patchesOfColor[color[iPatch]].push_back(iPatch);
+    if(numColors > 1)
+      Msg::Info("Optimizing %i patches in %i sets of independent patches",
+                toOptimize.size(), numColors);
+
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+    std::vector<patchResult> results(toOptimize.size());
+    for(int c = 0; c < numColors; c++) {
+      const std::vector<size_t> &patches = patchesOfColor[c];
 #pragma omp parallel for schedule(dynamic) num_threads(nthreads)
-    for(size_t iPatch = 0; iPatch < toOptimize.size(); ++iPatch) {
-      // Initialize optimization and output if asked
-      if(par.nCurses) {
-        mvbold(true);
-        mvprintCenter(10, " PATCH %5i ", iPatch);
-        mvbold(false);
-      }
-      if(par.verbose > 1)
-        Msg::Info("Optimizing patch %i/%i composed of %i elements, "
-                  "%i boundary elements",
-                  iPatch, toOptimize.size() - 1,
-                  toOptimize[iPatch].first.size(), bndElts[iPatch].size());
-      MeshOpt opt(e2eOpt, bndEl2Ent, toOptimize[iPatch].first,
-                  toOptimize[iPatch].second, bndElts[iPatch], par);
-      if(par.verbose > 3) {
-        std::ostringstream ossI1;
-        ossI1 << "initial_patch-" << iPatch << ".msh";
-        opt.patch.writeMSH(ossI1.str().c_str());
-      }
-
-      // Optimize patch
-      int success = -1;
-      if(opt.patch.nPC() > 0)
-        success = opt.optimize(par);
-      else if(par.verbose > 1)
-        Msg::Info("Patch %i has no degree of freedom, skipping", iPatch);
-
-      if(par.verbose > 3) {
-        std::ostringstream ossI2;
-        ossI2 << "final_patch-" << iPatch << ".msh";
-        opt.patch.writeMSH(ossI2.str().c_str());
-      }
+      for(size_t i = 0; i < patches.size(); ++i) {
+        const size_t iPatch = patches[i];
+        if(par.verbose > 1)
+          Msg::Info("Optimizing patch %i/%i composed of %i elements, "
+                    "%i boundary elements",
+                    iPatch, toOptimize.size() - 1,
+                    toOptimize[iPatch].first.size(), bndElts[iPatch].size());
+        MeshOpt opt(e2eOpt, bndEl2Ent, toOptimize[iPatch].first,
+                    toOptimize[iPatch].second, bndElts[iPatch], par);
+        if(par.verbose > 3) {
+          std::ostringstream ossI1;
+          ossI1 << "initial_patch-" << iPatch << ".msh";
+          opt.patch.writeMSH(ossI1.str().c_str());
+        }
 
-      // Evaluate mesh and update it if (partial) success
-      opt.updateResults();
+        // Optimize patch
+        int success = -1;
+        if(opt.patch.nPC() > 0)
+          success = opt.optimize(par);
+        else if(par.verbose > 1)
+          Msg::Info("Patch %i has no degree of freedom, skipping", iPatch);
 
-#pragma omp critical(optimizeDisjointPatches1)
-      {
-        if(newObjFunctionRange.size() == 0) {
-          newObjFunctionRange = opt.objFunction()->minMax();
-          objFunctionNames = opt.objFunction()->names();
-        }
-        else {
-          for(size_t i = 0; i < newObjFunctionRange.size(); i++) {
-            newObjFunctionRange[i].first =
-              std::min(newObjFunctionRange[i].first,
-                       opt.objFunction()->minMax()[i].first);
-            newObjFunctionRange[i].second =
-              std::max(newObjFunctionRange[i].second,
-                       opt.objFunction()->minMax()[i].second);
-          }
+        if(par.verbose > 3) {
+          std::ostringstream ossI2;
+          ossI2 << "final_patch-" << iPatch << ".msh";
+          opt.patch.writeMSH(ossI2.str().c_str());
         }
-      }
 
-      if(success >= 0) opt.patch.updateGEntityPositions();
+        // Evaluate mesh and update it if (partial) success
+        opt.updateResults();
+        patchResult &res = results[iPatch];
+        res.success = success;
+        res.objFunctionRange = opt.objFunction()->minMax();
+        res.objFunctionNames = opt.objFunction()->names();
+        if(par.nCurses)
+          res.history.push_back(
+            std::make_pair(-1, opt.objFunction()->minMaxStr()));
 
-#pragma omp critical(optimizeDisjointPatches2)
-      {
-        par.success = std::min(par.success, success);
-        nbPatchSuccess[success + 1]++;
+        if(success >= 0) opt.patch.updateGEntityPositions();
       }
 
-      if(par.nCurses) {
-        displayMinMaxVal(nbPatchSuccess, objFunctionNames, newObjFunctionRange);
-        displayResultTable(nbPatchSuccess, toOptimize.size());
-        updateDisplayPatchHistory(_patchHistory, opt.objFunction()->minMaxStr(),
-                                  iPatch, -1);
+      // Gather results of the patches of this color
+      for(size_t i = 0; i < patches.size(); ++i) {
+        const size_t iPatch = patches[i];
+        const patchResult &res = results[iPatch];
+        gatherObjFunctionRange(res, newObjFunctionRange, objFunctionNames);
+        par.success = std::min(par.success, res.success);
+        nbPatchSuccess[res.success + 1]++;
+        if(par.nCurses) {
+          mvbold(true);
+          mvprintCenter(10, " PATCH %5i ", iPatch);
+          mvbold(false);
+          displayMinMaxVal(nbPatchSuccess, objFunctionNames,
+                           newObjFunctionRange);
+          displayResultTable(nbPatchSuccess, toOptimize.size());
+          updateDisplayPatchHistory(_patchHistory, res.history.back().second,
+                                    iPatch, -1);
+        }
       }
     }
 
@@ -535,26 +599,114 @@ namespace {
     }
   }
 
-  MElement *getWorstElement(elSet &badElts, const elEntMap &element2entity,
-                            const MeshOptParameters &par)
+  double getBadness(MElement *el, const elEntMap &element2entity,
+                    const MeshOptParameters &par)
+  {
+    GEntity *gEnt = nullptr;
+    if(!element2entity.empty()) {
+      auto itEl2Ent = element2entity.find(el);
+      if(itEl2Ent != element2entity.end()) gEnt = itEl2Ent->second;
+    }
+    return par.patchDef->elBadness(el, gEnt);
+  }
+
+  // Number of layers of the patch after the last adaptation step
+  int getMaxAdaptedLayers(const MeshOptParameters &par)
+  {
+    int maxLayers = par.patchDef->maxLayers;
+    for(int iAdapt = 0; iAdapt < par.patchDef->maxPatchAdapt - 1; iAdapt++)
+      maxLayers *= par.patchDef->maxLayersAdaptFact;
+    return maxLayers;
+  }
+
+  // Optimize the patch around a bad element, increasing the size of the patch
+  // until the optimization succeeds. If 'allowed' is given, the patch is
+  // restricted to these elements, whose connectivity must already be stored
+  // in 'element2elements': patches restricted to regions that do not share
+  // any node can then be optimized concurrently.
+  void optimizePatchAround(MElement *worstEl, int iBadEl,
+                           const vertElVecMap &vertex2elements,
+                           elElSetMap &element2elements,
+                           const elEntMap &e2ePatch, const elEntMap &e2eOpt,
+                           const elElMap &el2BndEl, const elEntMap &bndEl2Ent,
+                           const elSet &badElts, MeshOptParameters &par,
+                           patchResult &res, const elSet *allowed = nullptr)
   {
-    double worst = 1.e300;
-    MElement *worstEl = nullptr;
-
-    for(auto it = badElts.begin(); it != badElts.end(); it++) {
-      GEntity *gEnt = nullptr;
-      if(!element2entity.empty()) {
-        auto itEl2Ent = element2entity.find(*it);
-        if(itEl2Ent != element2entity.end()) gEnt = itEl2Ent->second;
+    // Initialize patch size to be adapted
+    int maxLayers = par.patchDef->maxLayers;
+
+    // Patch adaptation loop
+    for(int iAdapt = 0; iAdapt < par.patchDef->maxPatchAdapt; iAdapt++) {
+      // Set up patch
+      const double limDist = par.patchDef->maxDistance(worstEl);
+      elSet toOptimizePrim =
+        getSurroundingPatch(worstEl, par.patchDef, limDist, maxLayers,
+                            vertex2elements, element2elements, e2ePatch,
+                            allowed);
+      vertSet toFix = getAllBndVertices(toOptimizePrim, vertex2elements);
+      elSet toOptimize;
+      std::set_difference(toOptimizePrim.begin(), toOptimizePrim.end(),
+                          badElts.begin(), badElts.end(),
+                          std::inserter(toOptimize, toOptimize.end()));
+
+      // Get boundary elements adjacent to patch if required
+      elSet bndElts;
+      if(!el2BndEl.empty()) {
+        getAdjacentBndElts(el2BndEl, bndEl2Ent, toOptimize, bndElts, par);
       }
-      const double val = par.patchDef->elBadness(*it, gEnt);
-      if(val < worst) {
-        worst = val;
-        worstEl = *it;
+
+      // Initialize optimization and output if asked
+      if(par.verbose > 1)
+        Msg::Info(
+          "Optimizing patch %i (max. %i remaining) composed of %4d elements",
+          iBadEl, badElts.size(), toOptimize.size());
+      MeshOpt opt(e2eOpt, bndEl2Ent, toOptimize, toFix, bndElts, par);
+      if(par.verbose > 3) {
+        std::ostringstream ossI1;
+        ossI1 << "initial_patch-" << iBadEl << ".msh";
+        opt.patch.writeMSH(ossI1.str().c_str());
+      }
+
+      // Optimize patch
+      if(opt.patch.nPC() == 0) {
+        res.success = -1;
+        Msg::Info("Patch %i (adapt #%i) has no degree of freedom, skipping",
+                  iBadEl, iAdapt);
+      }
+      else
+        res.success = opt.optimize(par);
+
+      // Output if asked
+      if(par.verbose > 3) {
+        std::ostringstream ossI2;
+        ossI2 << "final_patch-" << iBadEl << "_adapt-" << iAdapt << ".msh";
+        opt.patch.writeMSH(ossI2.str().c_str());
+      }
+
+      if(par.nCurses)
+        res.history.push_back(
+          std::make_pair(iAdapt, opt.objFunction()->minMaxStr()));
+
+      // If (partial) success, update mesh and break adaptation loop,
+      // otherwise adapt
+      if((res.success > 0) || (iAdapt == par.patchDef->maxPatchAdapt - 1)) {
+        opt.updateResults();
+        res.objFunctionRange = opt.objFunction()->minMax();
+        res.objFunctionNames = opt.objFunction()->names();
+        if(res.success >= 0) {
+          opt.patch.updateGEntityPositions();
+          break;
+        }
+        else {
+          maxLayers *= par.patchDef->maxLayersAdaptFact;
+          if(par.verbose > 1)
+            Msg::Info(
+              "Patch %i failed (adapt #%i), adapting with increased size",
+              iBadEl, iAdapt);
+        }
       }
-    }
 
-    return worstEl;
+    } // End of adaptation loop
   }
 
   void optimizeOneByOne(const vertElVecMap &vertex2elements,
@@ -578,128 +730,127 @@ namespace {
     if(par.verbose > 0)
       Msg::Info("%d bad elements, starting to iterate...", initNumBadElts);
 
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+    const std::size_t maxRoundSize = (nthreads > 1) ? 4 * nthreads : 1;
+    const int maxAdaptedLayers = getMaxAdaptedLayers(par);
+
     elElSetMap
       element2elements; // Element to element connectivity, built progressively
 
-    // Loop over bad elements
-    for(int iBadEl = 0; iBadEl < initNumBadElts; iBadEl++) {
-      int success = -1;
-      if(badElts.empty()) break;
-
-      // Create patch around worst element and remove it from badElts
-      MElement *worstEl = getWorstElement(badElts, e2ePatch, par);
-      badElts.erase(worstEl);
-
-      // Initialize patch size to be adapted
-      int maxLayers = par.patchDef->maxLayers;
-      double distanceFactor = 1.;
-
-      // Patch adaptation loop
-      for(int iAdapt = 0; iAdapt < par.patchDef->maxPatchAdapt; iAdapt++) {
-        // Set up patch
-        const double limDist = par.patchDef->maxDistance(worstEl);
-        elSet toOptimizePrim =
-          getSurroundingPatch(worstEl, par.patchDef, limDist, maxLayers,
-                              vertex2elements, element2elements, e2ePatch);
-        vertSet toFix = getAllBndVertices(toOptimizePrim, vertex2elements);
-        elSet toOptimize;
-        std::set_difference(toOptimizePrim.begin(), toOptimizePrim.end(),
-                            badElts.begin(), badElts.end(),
-                            std::inserter(toOptimize, toOptimize.end()));
-
-        // Get boundary elements adjacent to patch if required
-        elSet bndElts;
-        if(!el2BndEl.empty()) {
-          getAdjacentBndElts(el2BndEl, bndEl2Ent, toOptimize, bndElts, par);
-        }
-
-        // Initialize optimization and output if asked
-        if(par.nCurses) {
-          mvbold(true);
-          mvprintCenter(10, " PATCH %5i - ADAPTATION STEP %i ", iBadEl, iAdapt);
-          mvbold(false);
-        }
-        if(par.verbose > 1)
-          Msg::Info(
-            "Optimizing patch %i (max. %i remaining) composed of %4d elements",
-            iBadEl, badElts.size(), toOptimize.size());
-        MeshOpt opt(e2eOpt, bndEl2Ent, toOptimize, toFix, bndElts, par);
-        if(par.verbose > 3) {
-          std::ostringstream ossI1;
-          ossI1 << "initial_patch-" << iBadEl << ".msh";
-          opt.patch.writeMSH(ossI1.str().c_str());
+    // Loop over bad elements, from the worst to the least bad, by rounds of
+    // bad elements whose patches (at their maximum size) do not share any
+    // node, and can thus be optimized concurrently. With a single thread, each
+    // round only holds the worst element.
+    int iBadEl = 0;
+    while(iBadEl < initNumBadElts && !badElts.empty()) {
+      // The badness of the remaining bad elements is recomputed at each round,
+      // as their nodes can be moved by the optimization of the previous patches
+      std::vector<std::pair<double, MElement *> > candidates;
+      candidates.reserve(badElts.size());
+      for(auto it = badElts.begin(); it != badElts.end(); it++)
+        candidates.push_back(
+          std::make_pair(getBadness(*it, e2ePatch, par), *it));
+      const std::size_t numCandidates =
+        std::min(candidates.size(), 16 * maxRoundSize);
+      std::vector<std::size_t> order(candidates.size());
+      for(std::size_t i = 0; i < order.size(); i++) order[i] = i;
+      std::partial_sort(order.begin(), order.begin() + numCandidates,
+                        order.end(), [&](std::size_t a, std::size_t b) {
+                          if(candidates[a].first != candidates[b].first)
+                            return candidates[a].first < candidates[b].first;
+                          return a < b;
+                        });
+
+      std::vector<MElement *> round;
+      std::vector<elSet> regions;
+      vertSet reserved;
+      for(std::size_t i = 0; i < numCandidates && round.size() < maxRoundSize;
+          i++) {
+        MElement *el = candidates[order[i]].second;
+        if(maxRoundSize > 1) {
+          // Region in which the patch can grow, and nodes read or moved when
+          // optimizing it
+          const double limDist = par.patchDef->maxDistance(el);
+          elSet region =
+            getSurroundingPatch(el, par.patchDef, limDist, maxAdaptedLayers,
+                                vertex2elements, element2elements, e2ePatch);
+          vertSet verts;
+          for(auto itEl = region.begin(); itEl != region.end(); ++itEl) {
+            elSet neighbours;
+            getElementNeighbours(*itEl, vertex2elements, element2elements,
+                                 neighbours);
+            getPatchVertices(neighbours, elSet(), verts);
+          }
+          elSet bndElts;
+          if(!el2BndEl.empty())
+            getAdjacentBndElts(el2BndEl, bndEl2Ent, region, bndElts, par);
+          getPatchVertices(region, bndElts, verts);
+          bool conflict = false;
+          for(auto itV = verts.begin(); itV != verts.end(); ++itV) {
+            if(reserved.count(*itV)) {
+              conflict = true;
+              break;
+            }
+          }
+          if(conflict) continue;
+          reserved.insert(verts.begin(), verts.end());
+          regions.push_back(region);
         }
+        round.push_back(el);
+      }
 
-        // Optimize patch
-        if(opt.patch.nPC() == 0) {
-          success = -1;
-          Msg::Info("Patch %i (adapt #%i) has no degree of freedom, skipping",
-                    iBadEl, iAdapt);
-        }
-        else
-          success = opt.optimize(par);
+      // Remove the elements of the round from the bad elements, so that they
+      // are included in their own patch
+      for(std::size_t k = 0; k < round.size(); k++) badElts.erase(round[k]);
 
-        // Output if asked
-        if(par.verbose > 3) {
-          std::ostringstream ossI2;
-          ossI2 << "final_patch-" << iBadEl << "_adapt-" << iAdapt << ".msh";
-          opt.patch.writeMSH(ossI2.str().c_str());
+      std::vector<patchResult> results(round.size());
+      if(round.size() == 1) {
+        optimizePatchAround(round[0], iBadEl, vertex2elements,
+                            element2elements, e2ePatch, e2eOpt, el2BndEl,
+                            bndEl2Ent, badElts, par, results[0]);
+      }
+      else {
+        // The connectivity of the elements of the regions has been computed
+        // above, so that it is only read concurrently
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+        for(std::size_t k = 0; k < round.size(); k++) {
+          optimizePatchAround(round[k], iBadEl + k, vertex2elements,
+                              element2elements, e2ePatch, e2eOpt, el2BndEl,
+                              bndEl2Ent, badElts, par, results[k],
+                              &regions[k]);
         }
+      }
 
-        if(par.nCurses)
-          updateDisplayPatchHistory(
-            _patchHistory, opt.objFunction()->minMaxStr(), iBadEl, iAdapt);
-
-        // If (partial) success, update mesh and break adaptation loop,
-        // otherwise adapt
-        if((success > 0) || (iAdapt == par.patchDef->maxPatchAdapt - 1)) {
-          opt.updateResults();
-          if(newObjFunctionRange.size() == 0) {
-            newObjFunctionRange = opt.objFunction()->minMax();
-            objFunctionNames = opt.objFunction()->names();
-          }
-          else {
-            for(size_t i = 0; i < newObjFunctionRange.size(); i++) {
-              newObjFunctionRange[i].first =
-                std::min(newObjFunctionRange[i].first,
-                         opt.objFunction()->minMax()[i].first);
-              newObjFunctionRange[i].second =
-                std::max(newObjFunctionRange[i].second,
-                         opt.objFunction()->minMax()[i].second);
-            }
+      for(std::size_t k = 0; k < round.size(); k++, iBadEl++) {
+        const patchResult &res = results[k];
+        gatherObjFunctionRange(res, newObjFunctionRange, objFunctionNames);
+        nbPatchSuccess[res.success + 1]++;
+        if(par.nCurses) {
+          for(std::size_t i = 0; i < res.history.size(); i++) {
+            mvbold(true);
+            mvprintCenter(10, " PATCH %5i - ADAPTATION STEP %i ", iBadEl,
+                          res.history[i].first);
+            mvbold(false);
+            updateDisplayPatchHistory(_patchHistory, res.history[i].second,
+                                      iBadEl, res.history[i].first);
           }
-          if(success >= 0) {
-            opt.patch.updateGEntityPositions();
+          displayMinMaxVal(nbPatchSuccess, objFunctionNames,
+                           newObjFunctionRange);
+          displayResultTable(nbPatchSuccess, initNumBadElts);
+        }
+        if(par.verbose > 1) switch(res.success) {
+          case 1: Msg::Info("Patch %i succeeded", iBadEl); break;
+          case 0:
+            Msg::Info("Patch %i partially failed (measure "
+                      "above critical value but below target)",
+                      iBadEl);
             break;
+          case -1: Msg::Info("Patch %i failed", iBadEl); break;
           }
-          else {
-            distanceFactor *= par.patchDef->distanceAdaptFact;
-            maxLayers *= par.patchDef->maxLayersAdaptFact;
-            if(par.verbose > 1)
-              Msg::Info(
-                "Patch %i failed (adapt #%i), adapting with increased size",
-                iBadEl, iAdapt);
-          }
-        }
 
-      } // End of adaptation loop
-
-      nbPatchSuccess[success + 1]++;
-      if(par.nCurses) {
-        displayMinMaxVal(nbPatchSuccess, objFunctionNames, newObjFunctionRange);
-        displayResultTable(nbPatchSuccess, initNumBadElts);
+        par.success = std::min(par.success, res.success);
       }
-      if(par.verbose > 1) switch(success) {
-        case 1: Msg::Info("Patch %i succeeded", iBadEl); break;
-        case 0:
-          Msg::Info("Patch %i partially failed (measure "
-                    "above critical value but below target)",
-                    iBadEl);
-          break;
-        case -1: Msg::Info("Patch %i failed", iBadEl); break;
-        }
-
-      par.success = std::min(par.success, success);
     }
 
     while(_patchHistory.size() > 0) {
@@ -0,0 +1,68 @@
+import gmsh
+import sys
+
+# test that sorting the mesh along a Hilbert curve keeps the tags and the
+# connectivity of the nodes and elements, and that sorting the mesh by tags
+# after a renumbering makes their order follow the new numbering
+
+gmsh.initialize(sys.argv)
+
+gmsh.model.occ.addBox(0, 0, 0, 1, 1, 1)
+gmsh.model.occ.addSphere(2, 0.5, 0.5, 0.5)
+gmsh.model.occ.synchronize()
+
+gmsh.option.setNumber("Mesh.MeshSizeMax", 0.1)
+gmsh.model.mesh.generate(3)
+
+
+def get_mesh():
+    nodes = {}
+    tags, coord, _ = gmsh.model.mesh.getNodes()
+    for i in range(len(tags)):
+        nodes[tags[i]] = tuple(coord[3 * i:3 * i + 3])
+    elements = {}
+    types, tags, nodeTags = gmsh.model.mesh.getElements()
+    for t in range(len(types)):
+        n = len(nodeTags[t]) // len(tags[t])
+        for i in range(len(tags[t])):
+            elements[tags[t][i]] = tuple(nodeTags[t][n * i:n * i + n])
+    return nodes, elements
+
+
+def is_sorted(tags):
+    return all(tags[i] < tags[i + 1] for i in range(len(tags) - 1))
+
+
+def check_sorted_by_tags():
+    for dim, tag in gmsh.model.getEntities():
+        nodeTags, _, _ = gmsh.model.mesh.getNodes(dim, tag)
+        if not is_sorted(nodeTags):
+            raise Exception("Nodes of entity ({}, {}) are not sorted".format(
+                dim, tag))
+        _, elementTags, _ = gmsh.model.mesh.getElements(dim, tag)
+        for tags in elementTags:
+            if not is_sorted(tags):
+                raise Exception(
+                    "Elements of entity ({}, {}) are not sorted".format(
+                        dim, tag))
+
+
+# sort the nodes and elements along a Hilbert curve and reallocate them in that
+# order: only their order in memory changes
+before = get_mesh()
+gmsh.model.mesh.sortAlongHilbertCurve(reallocate=True)
+if get_mesh() != before:
+    raise Exception("Mesh changed when sorting along a Hilbert curve")
+
+# renumber the nodes (here with the reverse Cuthill-McKee algorithm) and the
+# elements, then sort the nodes and elements by tags
+oldTags, newTags = gmsh.model.mesh.computeRenumbering("RCMK")
+gmsh.model.mesh.renumberNodes(oldTags, newTags)
+gmsh.model.mesh.renumberElements()
+gmsh.model.mesh.sortByTags()
+check_sorted_by_tags()
+
+if '-nopopup' not in sys.argv:
+    gmsh.fltk.run()
+
+gmsh.finalize()
@@ -70,7 +70,8 @@ struct contextMeshOptions {
   int cgnsConstructTopology, cgnsExportCPEX0045, cgnsExportStructured;
   int preserveNumberingMsh2, createTopologyMsh2;
   // partitioning
-  int numPartitions, partitionCreateTopology, partitionCreateGhostCells;
+  int numPartitions, partitionAlgorithm, partitionCreateTopology;
+  int partitionCreateGhostCells;
   int partitionCreatePhysicals, partitionSplitMeshFiles;
   int partitionSaveTopologyFile, partitionTriWeight, partitionQuaWeight;
   int partitionTetWeight, partitionHexWeight, partitionLinWeight;
@@ -340,8 +341,8 @@ public:
     int smooth, animCycle, animStep;
     int combineTime, combineRemoveOrig, combineCopyOptions;
     int fileFormat, plugins, forceNodeData, forceElementData;
-    int saveMesh, saveInterpolationMatrices;
-    double animDelay;
+    int saveMesh, saveInterpolationMatrices, incrementalStepUpdate;
+    double animDelay, outOfCoreMemoryLimit;
     std::string doubleClickedGraphPointCommand;
     double doubleClickedGraphPointX, doubleClickedGraphPointY;
     int doubleClickedView;
@@ -1441,6 +1441,10 @@ StringXNumber MeshOptions_Number[] = {
   { F|O, "OptimizePyramids" , opt_mesh_optimize_pyramids , 0 ,
     "Optimize pyramids in hybrid 3D meshes (0: smoother; 1: untangler)" },
 
+  { F|O, "PartitionAlgorithm" , opt_mesh_partition_algorithm , 0 ,
+    "Mesh partitioning algorithm (0: METIS, 1: Hilbert curve, i.e. geometric "
+    "partitioning by splitting the elements sorted along a Hilbert curve into "
+    "chunks of equal weight)" },
   { F|O, "PartitionHexWeight" , opt_mesh_partition_hex_weight , -1 ,
     "Weight of hexahedral element for METIS load balancing (-1: automatic)" },
   { F|O, "PartitionLineWeight" , opt_mesh_partition_line_weight , -1 ,
@@ -1765,6 +1769,11 @@ StringXNumber PostProcessingOptions_Number[] = {
   { F|O, "HorizontalScales" , opt_post_horizontal_scales , 1. ,
     "Display value scales horizontally" },
 
+  { F|O, "IncrementalStepUpdate" , opt_post_incremental_step_update , 0. ,
+    "Only update the colors of the vertex arrays of views when their time step "
+    "changes, if their geometry does not depend on the values (continuous iso "
+    "values with point and line type 0, no raise, no skin-only drawing)" },
+
   { F|O, "Link" , opt_post_link , 0. ,
     "Post-processing view links (0: apply next option changes to selected views, "
     "1: force same options for all selected views)" },
@@ -1772,6 +1781,11 @@ StringXNumber PostProcessingOptions_Number[] = {
   { F,   "NbViews" , opt_post_nb_views , 0. ,
     "Current number of views merged (read-only)" },
 
+  { F|O, "OutOfCoreMemoryLimit" , opt_post_out_of_core_memory_limit , 0. ,
+    "Maximum memory (in Mb) used by the values of the time steps of model-based "
+    "views read from MSH files; when exceeded, the least recently used steps are "
+    "released from memory and read again from disk when needed (0: no limit)" },
+
   { F|O, "Plugins" , opt_post_plugins , 1. ,
     "Enable default post-processing plugins?" },
 
@@ -1665,9 +1665,15 @@ MsgProgressStatus::~MsgProgressStatus()
 
 void MsgProgressStatus::next()
 {
-  if(Msg::GetCommRank() || Msg::GetNumThreads() > 1) return;
+  if(Msg::GetNumThreads() > 1) return;
+  setProgress(_currentI + 1);
+}
+
+void MsgProgressStatus::setProgress(int num)
+{
+  if(Msg::GetCommRank()) return;
 
-  ++_currentI;
+  _currentI = num;
   if (_currentI < _nextIToCheck) return;
 
   int currentPercentage = _currentI * 100 / _totalElementToTreat;
@@ -193,6 +193,9 @@ public:
   ~MsgProgressStatus();
   void setInitialTime(double time) { _initialTime = time; }
   void next();
+  // set the number of treated elements (can be called from the master thread
+  // of a parallel region)
+  void setProgress(int num);
 };
 
 #endif
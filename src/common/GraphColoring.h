@@ -0,0 +1,46 @@
+// Gmsh - Copyright (C) 1997-2025 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef GRAPH_COLORING_H
+#define GRAPH_COLORING_H
+
+#include <cstddef>
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+
+// Greedy coloring of a list of items, in their order, such that two items
+// sharing a resource (e.g. a mesh node or a model entity) never have the same
+// color: all the items of a given color can then be processed concurrently.
+// Returns the number of colors.
+template <class Resource>
+int greedyColoring(const std::vector<std::set<Resource> > &resources,
+                   std::vector<int> &color)
+{
+  std::map<Resource, std::vector<std::size_t> > items;
+  for(std::size_t i = 0; i < resources.size(); i++)
+    for(auto it = resources[i].begin(); it != resources[i].end(); ++it)
+      items[*it].push_back(i);
+
+  int numColors = 0;
+  color.assign(resources.size(), -1);
+  std::vector<char> used;
+  for(std::size_t i = 0; i < resources.size(); i++) {
+    used.assign(numColors + 1, 0);
+    for(auto it = resources[i].begin(); it != resources[i].end(); ++it) {
+      const std::vector<std::size_t> &neighbors = items[*it];
+      for(std::size_t k = 0; k < neighbors.size(); k++)
+        if(color[neighbors[k]] >= 0) used[color[neighbors[k]]] = 1;
+    }
+    int c = 0;
+    while(used[c]) c++;
+    color[i] = c;
+    numColors = std::max(numColors, c + 1);
+  }
+  return numColors;
+}
+
+#endif
@@ -6731,6 +6731,12 @@ double opt_mesh_partition_num(OPT_ARGS_NUM)
   return CTX::instance()->mesh.numPartitions;
 }
 
+double opt_mesh_partition_algorithm(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) CTX::instance()->mesh.partitionAlgorithm = (int)val;
+  return CTX::instance()->mesh.partitionAlgorithm;
+}
+
 double opt_mesh_partition_metis_algorithm(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) CTX::instance()->mesh.metisAlgorithm = (int)val;
@@ -7108,6 +7114,19 @@ double opt_post_force_element_data(OPT_ARGS_NUM)
   return CTX::instance()->post.forceElementData;
 }
 
+double opt_post_incremental_step_update(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) CTX::instance()->post.incrementalStepUpdate = (int)val;
+  return CTX::instance()->post.incrementalStepUpdate;
+}
+
+double opt_post_out_of_core_memory_limit(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET)
+    CTX::instance()->post.outOfCoreMemoryLimit = std::max(0., val);
+  return CTX::instance()->post.outOfCoreMemoryLimit;
+}
+
 double opt_post_save_mesh(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) CTX::instance()->post.saveMesh = (int)val;
@@ -7188,7 +7207,7 @@ double opt_view_timestep(OPT_ARGS_NUM)
           opt->timeStep, opt->maxRecursionLevel, opt->targetError);
       opt->currentTime = data->getTime(opt->timeStep);
     }
-    if(view) view->setChanged(true);
+    if(view) view->setStepChanged();
   }
 #if defined(HAVE_FLTK)
   if(_gui_action_valid(action, num))
@@ -523,6 +523,7 @@ double opt_mesh_med_single_model(OPT_ARGS_NUM);
 double opt_mesh_partition_split_mesh_files(OPT_ARGS_NUM);
 double opt_mesh_partition_save_topology_file(OPT_ARGS_NUM);
 double opt_mesh_partition_num(OPT_ARGS_NUM);
+double opt_mesh_partition_algorithm(OPT_ARGS_NUM);
 double opt_mesh_partition_metis_algorithm(OPT_ARGS_NUM);
 double opt_mesh_partition_metis_edge_matching(OPT_ARGS_NUM);
 double opt_mesh_partition_metis_refinement_algorithm(OPT_ARGS_NUM);
@@ -676,6 +677,8 @@ double opt_post_nb_views(OPT_ARGS_NUM);
 double opt_post_file_format(OPT_ARGS_NUM);
 double opt_post_force_node_data(OPT_ARGS_NUM);
 double opt_post_force_element_data(OPT_ARGS_NUM);
+double opt_post_incremental_step_update(OPT_ARGS_NUM);
+double opt_post_out_of_core_memory_limit(OPT_ARGS_NUM);
 double opt_post_save_mesh(OPT_ARGS_NUM);
 double opt_post_save_interpolation_matrices(OPT_ARGS_NUM);
 double opt_post_double_clicked_graph_point_x(OPT_ARGS_NUM);
@@ -33,10 +33,11 @@ VertexArray::VertexArray(int numVerticesPerElement, int numElements)
 
 double VertexArray::getMemoryInMb()
 {
-  int bytes = _vertices.size() * sizeof(float) +
-              _normals.size() * sizeof(normal_type) +
-              _colors.size() * sizeof(unsigned char);
-  return (double)bytes / 1024. / 1024.;
+  double bytes = (double)_vertices.size() * sizeof(float) +
+                 (double)_normals.size() * sizeof(normal_type) +
+                 (double)_colors.size() * sizeof(unsigned char) +
+                 (double)_tags.size() * sizeof(uint64_t);
+  return bytes / 1024. / 1024.;
 }
 
 void VertexArray::_addVertex(float x, float y, float z)
@@ -78,6 +79,14 @@ void VertexArray::_addElement(MElement *ele)
   if(ele && CTX::instance()->pickElements) _elements.push_back(ele);
 }
 
+void VertexArray::setColor(int i, unsigned int col)
+{
+  _colors[4 * i] = CTX::instance()->unpackRed(col);
+  _colors[4 * i + 1] = CTX::instance()->unpackGreen(col);
+  _colors[4 * i + 2] = CTX::instance()->unpackBlue(col);
+  _colors[4 * i + 3] = CTX::instance()->unpackAlpha(col);
+}
+
 void VertexArray::add(double *x, double *y, double *z, SVector3 *n,
                       unsigned int *col, MElement *ele, bool unique, bool boundary)
 {
@@ -104,7 +113,6 @@ void VertexArray::add(double *x, double *y, double *z, SVector3 *n, unsigned cha
 
   if(boundary && npe == 3){
     ElementData<3> e(x, y, z, n, r, g, b, a, ele);
-    ElementDataLessThan<3>::tolerance = (float)(CTX::instance()->lc * 1.e-12);
     auto it = _data3.find(e);
     if(it == _data3.end())
       _data3.insert(e);
@@ -154,10 +162,12 @@ void VertexArray::finalize()
 
 class AlphaElement {
  public:
-  AlphaElement(float *vp, normal_type *np, unsigned char *cp) : v(vp), n(np), c(cp) {}
+  AlphaElement(float *vp, normal_type *np, unsigned char *cp, uint64_t *tp)
+    : v(vp), n(np), c(cp), t(tp) {}
   float *v;
   normal_type *n;
   unsigned char *c;
+  uint64_t *t;
 };
 
 class AlphaElementLessThan {
@@ -202,16 +212,20 @@ void VertexArray::sort(double x, double y, double z)
     float *vp = &_vertices[3 * npe * i];
     normal_type *np = _normals.empty() ? nullptr : &_normals[3 * npe * i];
     unsigned char *cp = _colors.empty() ? nullptr : &_colors[4 * npe * i];
-    elements.push_back(AlphaElement(vp, np, cp));
+    uint64_t *tp = (_tags.size() != _vertices.size() / 3) ? nullptr :
+      &_tags[npe * i];
+    elements.push_back(AlphaElement(vp, np, cp, tp));
   }
   std::sort(elements.begin(), elements.end(), AlphaElementLessThan());
 
   std::vector<float> sortedVertices;
   std::vector<normal_type> sortedNormals;
   std::vector<unsigned char> sortedColors;
+  std::vector<uint64_t> sortedTags;
   sortedVertices.reserve(_vertices.size());
   sortedNormals.reserve(_normals.size());
   sortedColors.reserve(_colors.size());
+  sortedTags.reserve(_tags.size());
 
   for(int i = 0; i < n; i++){
     for(int j = 0; j < npe; j++){
@@ -223,12 +237,15 @@ void VertexArray::sort(double x, double y, double z)
       if(elements[i].c)
         for(int k = 0; k < 4; k++)
           sortedColors.push_back(elements[i].c[4 * j + k]);
+      if(elements[i].t)
+        sortedTags.push_back(elements[i].t[j]);
     }
   }
 
   _vertices = sortedVertices;
   _normals = sortedNormals;
   _colors = sortedColors;
+  _tags = sortedTags;
 }
 
 char *VertexArray::toChar(int num, const std::string &name, int type,
@@ -348,5 +365,20 @@ void VertexArray::merge(VertexArray* va)
     _colors.insert(_colors.end(), va->firstColor(), va->lastColor());
     _elements.insert(_elements.end(), va->firstElementPointer(),
                      va->lastElementPointer());
+    _tags.insert(_tags.end(), va->_tags.begin(), va->_tags.end());
+  }
+  // boundary elements that are not finalized yet: an element present in both
+  // arrays is interior, and is thus removed
+  for(auto it = va->_data3.begin(); it != va->_data3.end(); it++){
+    auto it2 = _data3.find(*it);
+    if(it2 == _data3.end())
+      _data3.insert(*it);
+    else
+      _data3.erase(it2);
   }
 }
+
+void VertexArray::setBoundaryTolerance()
+{
+  ElementDataLessThan<3>::tolerance = (float)(CTX::instance()->lc * 1.e-12);
+}
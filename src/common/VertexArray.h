@@ -8,6 +8,7 @@
 
 #include <vector>
 #include <set>
+#include <cstdint>
 #include "SVector3.h"
 #include "SBoundingBox3d.h"
 
@@ -155,6 +156,9 @@ private:
   std::vector<normal_type> _normals;
   std::vector<unsigned char> _colors;
   std::vector<MElement *> _elements;
+  // optional tags associated with the vertices (e.g. to identify the data the
+  // vertices were created from)
+  std::vector<uint64_t> _tags;
   std::set<ElementData<3>, ElementDataLessThan<3> > _data3;
   std::set<Barycenter, BarycenterLessThan> _barycenters;
   // std::tr1::unordered_set<Barycenter, BarycenterHash, BarycenterEqual>
@@ -204,6 +208,12 @@ public:
     return _elements.end();
   }
 
+  // tags of the vertices (only meaningful if all the vertices are tagged)
+  std::vector<uint64_t> &getTags() { return _tags; }
+
+  // change the color of the i-th vertex
+  void setColor(int i, unsigned int col);
+
   // add element data in the arrays (if unique is set, only add the
   // element if another one with the same barycenter is not already
   // present)
@@ -229,8 +239,14 @@ public:
                           double &max, int &numSteps, double &time,
                           double &xmin, double &ymin, double &zmin,
                           double &xmax, double &ymax, double &zmax);
-  // merge another vertex array into this one
+  // merge another vertex array into this one (if the arrays are not
+  // finalized, their boundary elements are merged as well, which allows to
+  // fill separate arrays in parallel and to merge them before finalizing)
   void merge(VertexArray *va);
+  // set the tolerance used to identify duplicate boundary elements from the
+  // current characteristic length; the tolerance is shared by all the arrays,
+  // and must thus be set before (not while) filling arrays in parallel
+  static void setBoundaryTolerance();
 };
 
 #endif
@@ -1383,6 +1383,40 @@ GMSH_API void gmsh::model::mesh::unpartition()
   CTX::instance()->mesh.changed = ENT_ALL;
 }
 
+GMSH_API void
+gmsh::model::mesh::writePartitioned(const std::string &fileName,
+                                    const int numPart,
+                                    const std::vector<std::size_t> &elementTags,
+                                    const std::vector<int> &partitions)
+{
+  if(!_checkInit()) return;
+  std::vector<std::pair<MElement *, int>> epart;
+  if(elementTags.size()) {
+    if(elementTags.size() != partitions.size()) {
+      Msg::Error("Number of element tags (%d) does not match number of "
+                 "partitions (%d)",
+                 elementTags.size(), partitions.size());
+      return;
+    }
+    epart.reserve(elementTags.size());
+    for(std::size_t i = 0; i < elementTags.size(); i++) {
+      MElement *el = GModel::current()->getMeshElementByTag(elementTags[i]);
+      if(el)
+        epart.push_back(std::make_pair(el, partitions[i]));
+      else
+        Msg::Error("Unknown element %d", elementTags[i]);
+    }
+  }
+  std::vector<std::string> split = SplitFileName(fileName);
+  double version = CTX::instance()->mesh.mshFileVersion;
+  if(version < 4.0) version = 4.1;
+  GModel::current()->writeSplitMSH(
+    split[0] + split[1],
+    numPart >= 0 ? numPart : CTX::instance()->mesh.numPartitions, epart,
+    version, CTX::instance()->mesh.binary, CTX::instance()->mesh.saveAll,
+    CTX::instance()->mesh.saveParametric, CTX::instance()->mesh.scalingFactor);
+}
+
 GMSH_API void gmsh::model::mesh::refine()
 {
   if(!_checkInit()) return;
@@ -2402,6 +2436,51 @@ GMSH_API void gmsh::model::mesh::getElementQualities(
 
   const std::size_t begin = (task * numElements) / numTasks;
   const std::size_t end = ((task + 1) * numElements) / numTasks;
+
+#if defined(HAVE_MESH)
+  if(qualityName == "minDetJac" || qualityName == "maxDetJac" ||
+     qualityName == "minSICN" || qualityName == "minSIGE" ||
+     qualityName == "minSJ") {
+    // Jacobian-based qualities are computed for all the elements at once, by
+    // batches of elements of the same type
+    std::vector<MElement *> elements;
+    std::vector<std::size_t> indices;
+    elements.reserve(end - begin);
+    indices.reserve(end - begin);
+    for(size_t k = begin; k < end; k++) {
+      MElement *e = GModel::current()->getMeshElementByTag(elementTags[k]);
+      if(!e) {
+        Msg::Error("Unknown element %d", elementTags[k]);
+        elementQualities[k] = 0.;
+        continue;
+      }
+      elements.push_back(e);
+      indices.push_back(k);
+    }
+    // if the caller already splits the work into several tasks, don't spawn
+    // additional threads
+    int nthreads = 1;
+    if(numTasks == 1) {
+      nthreads = CTX::instance()->numThreads;
+      if(!nthreads) nthreads = Msg::GetMaxThreads();
+    }
+    std::vector<double> min, max;
+    if(qualityName == "minSICN")
+      jacobianBasedQuality::minSICNShapeMeasure(elements, min, nthreads);
+    else if(qualityName == "minSIGE")
+      jacobianBasedQuality::minSIGEShapeMeasure(elements, min, nthreads);
+    else if(qualityName == "minSJ")
+      jacobianBasedQuality::distoShapeMeasure(elements, min, nthreads);
+    else
+      jacobianBasedQuality::minMaxJacobianDeterminant(elements, min, max,
+                                                      nullptr, nthreads);
+    const bool isMax = (qualityName == "maxDetJac");
+    for(std::size_t i = 0; i < elements.size(); i++)
+      elementQualities[indices[i]] = isMax ? max[i] : min[i];
+    return;
+  }
+#endif
+
   for(size_t k = begin; k < end; k++) {
     MElement *e = GModel::current()->getMeshElementByTag(elementTags[k]);
     if(!e) {
@@ -2445,18 +2524,6 @@ GMSH_API void gmsh::model::mesh::getElementQualities(
     else if(qualityName == "innerRadius") {
       elementQualities[k] = e->getInnerRadius();
     }
-#if defined(HAVE_MESH)
-    else if(qualityName == "minDetJac") {
-      double min, max;
-      jacobianBasedQuality::minMaxJacobianDeterminant(e, min, max);
-      elementQualities[k] = min;
-    }
-    else if(qualityName == "maxDetJac") {
-      double min, max;
-      jacobianBasedQuality::minMaxJacobianDeterminant(e, min, max);
-      elementQualities[k] = max;
-    }
-#endif
     else {
       if(k == begin) {
         Msg::Error("Unknown quality name '%s'", qualityName.c_str());
@@ -5330,25 +5397,20 @@ GMSH_API void gmsh::model::mesh::computeRenumbering(
   std::vector<std::size_t> &oldTags, std::vector<std::size_t> &newTags,
   const std::string &method, const std::vector<std::size_t> &elementTags)
 {
-  std::map<std::size_t, std::size_t> remap;
+  oldTags.clear();
+  newTags.clear();
 #if defined(HAVE_MESH)
   if(method == "RCMK")
-    meshRenumber_Vertices_RCMK(elementTags, remap);
+    meshRenumber_Vertices_RCMK(elementTags, oldTags, newTags);
   else if(method == "Hilbert")
-    meshRenumber_Vertices_Hilbert(elementTags, remap);
+    meshRenumber_Vertices_Hilbert(elementTags, oldTags, newTags);
   else if(method == "Metis")
-    meshRenumber_Vertices_Metis(elementTags, remap);
+    meshRenumber_Vertices_Metis(elementTags, oldTags, newTags);
   else
     Msg::Error("Unknown renumbering method %s", method.c_str());
 #else
   Msg::Error("Computing renumbering requires the mesh module");
 #endif
-  oldTags.reserve(remap.size());
-  newTags.reserve(remap.size());
-  for(auto r : remap) {
-    oldTags.push_back(r.first);
-    newTags.push_back(r.second);
-  }
 }
 
 GMSH_API void
@@ -5361,10 +5423,7 @@ gmsh::model::mesh::renumberNodes(const std::vector<std::size_t> &oldTags,
                oldTags.size(), newTags.size());
     return;
   }
-  std::map<std::size_t, std::size_t> remap;
-  for(std::size_t i = 0; i < oldTags.size(); i++)
-    remap[oldTags[i]] = newTags[i];
-  GModel::current()->renumberMeshVertices(remap);
+  GModel::current()->renumberMeshVertices(oldTags, newTags);
 }
 
 GMSH_API void
@@ -5377,10 +5436,20 @@ gmsh::model::mesh::renumberElements(const std::vector<std::size_t> &oldTags,
                oldTags.size(), newTags.size());
     return;
   }
-  std::map<std::size_t, std::size_t> remap;
-  for(std::size_t i = 0; i < oldTags.size(); i++)
-    remap[oldTags[i]] = newTags[i];
-  GModel::current()->renumberMeshElements(remap);
+  GModel::current()->renumberMeshElements(oldTags, newTags);
+}
+
+GMSH_API void gmsh::model::mesh::sortByTags()
+{
+  if(!_checkInit()) return;
+  GModel::current()->sortMeshByTags();
+}
+
+GMSH_API void gmsh::model::mesh::sortAlongHilbertCurve(const bool reallocate)
+{
+  if(!_checkInit()) return;
+  GModel::current()->sortMeshAlongHilbertCurve(reallocate);
+  CTX::instance()->mesh.changed = ENT_ALL;
 }
 
 GMSH_API void
@@ -8027,6 +8096,47 @@ GMSH_API void gmsh::view::probe(
 #endif
 }
 
+GMSH_API void gmsh::view::probePoints(
+  const int tag, const std::vector<double> &coord, std::vector<double> &values,
+  std::vector<double> &distances, const int step, const int numComp,
+  const bool gradient, const double distanceMax, const int dim)
+{
+  if(!_checkInit()) return;
+  values.clear();
+  distances.clear();
+#if defined(HAVE_POST)
+  PView *view = PView::getViewByTag(tag);
+  if(!view) {
+    Msg::Error("Unknown view with tag %d", tag);
+    return;
+  }
+  PViewData *data = view->getData();
+  if(!data) {
+    Msg::Error("No data in view %d", tag);
+    return;
+  }
+  if(coord.size() % 3) {
+    Msg::Error("Number of coordinates should be a multiple of 3");
+    return;
+  }
+  int nc = numComp;
+  if(nc < 0) {
+    // same order of preference as in probe()
+    if(data->getNumScalars()) nc = 1;
+    else if(data->getNumVectors()) nc = 3;
+    else if(data->getNumTensors()) nc = 9;
+  }
+  if(nc != 1 && nc != 3 && nc != 9) {
+    Msg::Error("Number of components should be 1, 3 or 9");
+    return;
+  }
+  data->searchClosest(coord, nc, values, distances, step, gradient,
+                      distanceMax, dim);
+#else
+  Msg::Error("Views require the post-processing module");
+#endif
+}
+
 GMSH_API void gmsh::view::write(const int tag, const std::string &fileName,
                                 const bool append)
 {
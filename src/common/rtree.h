@@ -47,6 +47,7 @@ o Minor updates for MSVC 2005/08 compilers
 #ifndef RTREE_H
 #define RTREE_H
 #include <algorithm>
+#include <vector>
 
 // NOTE This file compiles under MSVC 6 SP5 and MSVC .Net 2003 it may not work on other compilers without modification.
 
@@ -138,6 +139,15 @@ public:
   /// \return Returns the number of entries found
   int Search(const ELEMTYPE a_min[NUMDIMS], const ELEMTYPE a_max[NUMDIMS], bool a_resultCallback(DATATYPE a_data, void* a_context), void* a_context);
 
+  /// Remove all entries from tree, and load the given entries using Sort-Tile-Recursive
+  /// packing. Nodes are completely filled, which gives a smaller tree with less overlap
+  /// (and thus faster searches) than inserting the entries one at a time.
+  /// \param a_count Number of entries
+  /// \param a_min Min of bounding rects (NUMDIMS values per entry)
+  /// \param a_max Max of bounding rects (NUMDIMS values per entry)
+  /// \param a_dataIds Data Ids of the entries
+  void BulkLoad(int a_count, const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE* a_dataIds);
+
   /// Remove all entries from tree
   void RemoveAll();
 
@@ -456,6 +466,7 @@ protected:
   void ReInsert(Node* a_node, ListNode** a_listNode);
   bool Search(Node* a_node, Rect* a_rect, int& a_foundCount, bool a_resultCallback(DATATYPE a_data, void* a_context), void* a_context);
   void RemoveAllRec(Node* a_node);
+  void SortTileRecursive(Branch* a_branch, int a_count, int a_axis);
   void Reset();
   void CountRec(Node* a_node, int& a_count);
 
@@ -873,6 +884,92 @@ void RTREE_QUAL::RemoveAll()
 }
 
 
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkLoad(int a_count, const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE* a_dataIds)
+{
+  RemoveAll();
+
+  if(a_count <= 0)
+  {
+    return;
+  }
+
+  // Leaf level branches
+  std::vector<Branch> branches(a_count);
+  for(int index=0; index < a_count; ++index)
+  {
+    for(int axis=0; axis<NUMDIMS; ++axis)
+    {
+      branches[index].m_rect.m_min[axis] = a_min[index * NUMDIMS + axis];
+      branches[index].m_rect.m_max[axis] = a_max[index * NUMDIMS + axis];
+    }
+    branches[index].m_data = a_dataIds[index];
+  }
+
+  // Pack the branches of each level into full nodes, until they fit in the root
+  int level = 0;
+  while((int)branches.size() > MAXNODES)
+  {
+    SortTileRecursive(&branches[0], (int)branches.size(), 0);
+    std::vector<Branch> parents;
+    parents.reserve((branches.size() + MAXNODES - 1) / MAXNODES);
+    for(std::size_t first=0; first < branches.size(); first += MAXNODES)
+    {
+      Node* node = AllocNode();
+      node->m_level = level;
+      std::size_t last = std::min(first + MAXNODES, branches.size());
+      for(std::size_t index=first; index < last; ++index)
+      {
+        node->m_branch[node->m_count++] = branches[index];
+      }
+      Branch parent;
+      parent.m_rect = NodeCover(node);
+      parent.m_child = node;
+      parents.push_back(parent);
+    }
+    branches.swap(parents);
+    ++level;
+  }
+
+  m_root->m_level = level;
+  for(std::size_t index=0; index < branches.size(); ++index)
+  {
+    m_root->m_branch[m_root->m_count++] = branches[index];
+  }
+}
+
+
+// Order the branches so that consecutive groups of MAXNODES branches are
+// spatially close: sort along the axis, cut into slabs of whole nodes, and
+// recursively tile each slab along the next axes.
+RTREE_TEMPLATE
+void RTREE_QUAL::SortTileRecursive(Branch* a_branch, int a_count, int a_axis)
+{
+  if(a_count <= MAXNODES || a_axis >= NUMDIMS)
+  {
+    return;
+  }
+
+  std::sort(a_branch, a_branch + a_count, [a_axis](const Branch& a_a, const Branch& a_b) {
+    return a_a.m_rect.m_min[a_axis] + a_a.m_rect.m_max[a_axis] <
+           a_b.m_rect.m_min[a_axis] + a_b.m_rect.m_max[a_axis];
+  });
+
+  if(a_axis == NUMDIMS - 1)
+  {
+    return;
+  }
+
+  int numNodes = (a_count + MAXNODES - 1) / MAXNODES;
+  int numSlabs = (int)ceil(pow((double)numNodes, 1. / (NUMDIMS - a_axis)));
+  int slabSize = MAXNODES * ((numNodes + numSlabs - 1) / numSlabs);
+  for(int first=0; first < a_count; first += slabSize)
+  {
+    SortTileRecursive(a_branch + first, std::min(slabSize, a_count - first), a_axis + 1);
+  }
+}
+
+
 RTREE_TEMPLATE
 void RTREE_QUAL::Reset()
 {
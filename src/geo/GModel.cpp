@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <sstream>
 #include <stack>
+#include <typeinfo>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "GModel.h"
@@ -37,7 +38,9 @@
 #include "OS.h"
 #include "StringUtils.h"
 #include "GEdgeLoop.h"
+#include "HilbertCurve.h"
 #include "MVertexRTree.h"
+#include "weldPoints.h"
 #include "OpenFile.h"
 #include "CreateFile.h"
 #include "Options.h"
@@ -227,7 +230,7 @@ void GModel::destroyMeshCaches()
     _elementIndexCache.clear();
     std::map<int, int>().swap(_elementIndexCache);
     if(_elementOctree) {
-      delete _elementOctree;
+      delete _elementOctree.load();
       _elementOctree = nullptr;
     }
   }
@@ -1450,14 +1453,14 @@ int GModel::adaptMesh(std::vector<int> technique,
             meshGFaceBamg(*fit);
             laplaceSmoothing(*fit, CTX::instance()->mesh.nbSmoothing);
           }
-          if(_elementOctree) delete _elementOctree;
+          if(_elementOctree) delete _elementOctree.load();
           _elementOctree = nullptr;
         }
       }
       else if(getDim() == 3) {
         for(auto rit = firstRegion(); rit != lastRegion(); ++rit) {
           refineMeshMMG(*rit);
-          if(_elementOctree) delete _elementOctree;
+          if(_elementOctree) delete _elementOctree.load();
           _elementOctree = nullptr;
         }
       }
@@ -1714,14 +1717,89 @@ static void getDependentViewData(GModel *m, PViewDataGModel::DataType type,
 }
 #endif
 
+// Sort the (old tag, new tag) pairs by old tag; if an old tag appears several
+// times, only its last pair is kept (as when inserting the pairs in a map)
+static void sortTagMapping(const std::vector<std::size_t> &oldTags,
+                           const std::vector<std::size_t> &newTags,
+                           std::vector<std::pair<std::size_t, std::size_t> > &m)
+{
+  std::size_t n = std::min(oldTags.size(), newTags.size());
+  m.resize(n);
+  for(std::size_t i = 0; i < n; i++)
+    m[i] = std::make_pair(oldTags[i], newTags[i]);
+  std::stable_sort(m.begin(), m.end(),
+                   [](const std::pair<std::size_t, std::size_t> &a,
+                      const std::pair<std::size_t, std::size_t> &b) {
+                     return a.first < b.first;
+                   });
+  std::size_t k = 0;
+  for(std::size_t i = 0; i < n; i++) {
+    if(k && m[k - 1].first == m[i].first)
+      m[k - 1] = m[i];
+    else
+      m[k++] = m[i];
+  }
+  m.resize(k);
+}
+
+// Look up the new tag of each tag in the sorted mapping (0 if not found, as 0
+// is never a valid tag); tags that are not found are numbered after the
+// largest new tag
+static void applyTagMapping(
+  const std::vector<std::pair<std::size_t, std::size_t> > &m,
+  const std::vector<std::size_t> &tags, std::size_t maxmap, const char *what,
+  std::vector<std::size_t> &remap)
+{
+  remap.resize(tags.size());
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < tags.size(); i++) {
+    auto it = std::lower_bound(
+      m.begin(), m.end(), std::make_pair(tags[i], (std::size_t)0));
+    remap[i] = (it != m.end() && it->first == tags[i]) ? it->second : 0;
+  }
+
+  for(auto &mm : m) maxmap = std::max(maxmap, mm.second);
+  bool info = true;
+  for(std::size_t i = 0; i < tags.size(); i++) {
+    if(remap[i]) continue;
+    if(info) {
+      Msg::Info("Mapping does not contain %s tag (%zu) - "
+                "incrementing after last provided tag (%zu)",
+                what, tags[i], maxmap);
+      info = false;
+    }
+    remap[i] = ++maxmap;
+  }
+}
+
 void GModel::renumberMeshVertices(const std::map<std::size_t, std::size_t> &mapping)
+{
+  std::vector<std::size_t> oldTags, newTags;
+  oldTags.reserve(mapping.size());
+  newTags.reserve(mapping.size());
+  for(auto &m : mapping) {
+    oldTags.push_back(m.first);
+    newTags.push_back(m.second);
+  }
+  renumberMeshVertices(oldTags, newTags);
+}
+
+void GModel::renumberMeshVertices(const std::vector<std::size_t> &oldTags,
+                                  const std::vector<std::size_t> &newTags)
 {
   destroyMeshCaches();
   setMaxVertexNumber(CTX::instance()->mesh.firstNodeTag - 1);
   std::vector<GEntity *> entities;
   getEntities(entities);
 
-  std::map<MVertex *, std::size_t> old, remap;
+  // the nodes are always visited in the same (entity) order below, so that
+  // their old and new tags can be stored in flat arrays
+  std::size_t nv = 0;
+  for(auto ge : entities) nv += ge->getNumMeshVertices();
+
+  std::vector<std::size_t> old, remap;
   std::size_t npost = 0;
 #if defined(HAVE_POST)
   // check if any nodal post-processing datasets depend on the model
@@ -1730,29 +1808,17 @@ void GModel::renumberMeshVertices(const std::map<std::size_t, std::size_t> &mapp
   npost = data.size();
 #endif
 
-  std::size_t maxmap = CTX::instance()->mesh.firstNodeTag - 1;
-  for(auto m : mapping) maxmap = std::max(maxmap, m.second);
-  bool info = true;
-  if(mapping.size() || npost) {
+  if(oldTags.size() || npost) {
+    old.reserve(nv);
     for(auto ge : entities) {
-      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++) {
-        MVertex *v = ge->getMeshVertex(j);
-        old[v] = v->getNum();
-        if(mapping.size()) {
-          auto it = mapping.find(v->getNum());
-          if(it != mapping.end())
-            remap[v] = it->second;
-          else {
-            if(info) {
-              Msg::Info("Mapping does not contain a node tag (%zu) - "
-                        "incrementing after last provided tag (%zu)",
-                        v->getNum(), maxmap);
-              info = false;
-            }
-            remap[v] = ++maxmap;
-          }
-        }
-      }
+      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++)
+        old.push_back(ge->getMeshVertex(j)->getNum());
+    }
+    if(oldTags.size()) {
+      std::vector<std::pair<std::size_t, std::size_t> > mapping;
+      sortTagMapping(oldTags, newTags, mapping);
+      applyTagMapping(mapping, old, CTX::instance()->mesh.firstNodeTag - 1,
+                      "a node", remap);
     }
   }
 
@@ -1775,15 +1841,11 @@ void GModel::renumberMeshVertices(const std::map<std::size_t, std::size_t> &mapp
     // if we potentially only save a subset of elements, make sure to first
     // renumber the nodes that belong to those elements (so that we end up
     // with a dense node numbering in the output file)
-    std::size_t nv = CTX::instance()->mesh.firstNodeTag - 1;
-    for(std::size_t i = 0; i < entities.size(); i++) {
-      GEntity *ge = entities[i];
-      nv += ge->getNumMeshVertices();
-    }
+    std::size_t nv1 = CTX::instance()->mesh.firstNodeTag - 1 + nv;
     for(std::size_t i = 0; i < entities.size(); i++) {
       GEntity *ge = entities[i];
       for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++) {
-        ge->getMeshVertex(j)->forceNum(nv + 1);
+        ge->getMeshVertex(j)->forceNum(nv1 + 1);
       }
     }
     for(std::size_t i = 0; i < entities.size(); i++) {
@@ -1798,28 +1860,32 @@ void GModel::renumberMeshVertices(const std::map<std::size_t, std::size_t> &mapp
         }
       }
     }
+    std::size_t k = 0;
     for(std::size_t i = 0; i < entities.size(); i++) {
       GEntity *ge = entities[i];
-      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++) {
+      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++, k++) {
         MVertex *v = ge->getMeshVertex(j);
-        if(v->getNum() == 0) v->forceNum(remap.empty() ? ++n : remap[v]);
+        if(v->getNum() == 0) v->forceNum(remap.empty() ? ++n : remap[k]);
       }
     }
+    k = 0;
     for(std::size_t i = 0; i < entities.size(); i++) {
       GEntity *ge = entities[i];
-      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++) {
+      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++, k++) {
         MVertex *v = ge->getMeshVertex(j);
-        if(v->getNum() == nv + 1) v->forceNum(remap.empty() ? ++n : remap[v]);
+        if(v->getNum() == nv1 + 1)
+          v->forceNum(remap.empty() ? ++n : remap[k]);
       }
     }
   }
   else {
     // full save
+    std::size_t k = 0;
     for(std::size_t i = 0; i < entities.size(); i++) {
       GEntity *ge = entities[i];
-      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++) {
+      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++, k++) {
         MVertex *v = ge->getMeshVertex(j);
-        v->forceNum(remap.empty() ? ++n : remap[v]);
+        v->forceNum(remap.empty() ? ++n : remap[k]);
       }
     }
   }
@@ -1830,10 +1896,11 @@ void GModel::renumberMeshVertices(const std::map<std::size_t, std::size_t> &mapp
     Msg::Info("Renumbering nodal model data (%d step%s)", npost,
               npost > 1 ? "s" : "");
     std::map<std::size_t, std::size_t> remap2;
+    std::size_t k = 0;
     for(auto ge : entities) {
-      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++) {
+      for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++, k++) {
         MVertex *v = ge->getMeshVertex(j);
-        remap2[old[v]] = v->getNum();
+        remap2[old[k]] = v->getNum();
       }
     }
     for(auto d : data) { d->renumberData(remap2); }
@@ -1842,13 +1909,35 @@ void GModel::renumberMeshVertices(const std::map<std::size_t, std::size_t> &mapp
 }
 
 void GModel::renumberMeshElements(const std::map<std::size_t, std::size_t> &mapping)
+{
+  std::vector<std::size_t> oldTags, newTags;
+  oldTags.reserve(mapping.size());
+  newTags.reserve(mapping.size());
+  for(auto &m : mapping) {
+    oldTags.push_back(m.first);
+    newTags.push_back(m.second);
+  }
+  renumberMeshElements(oldTags, newTags);
+}
+
+void GModel::renumberMeshElements(const std::vector<std::size_t> &oldTags,
+                                  const std::vector<std::size_t> &newTags)
 {
   destroyMeshCaches();
   setMaxElementNumber(CTX::instance()->mesh.firstElementTag - 1);
   std::vector<GEntity *> entities;
   getEntities(entities);
 
-  std::map<MElement *, int> old, remap;
+  // the elements are always visited in the same (entity) order below, so that
+  // their old and new tags can be stored in flat arrays
+  std::size_t ne = 0;
+  std::vector<std::size_t> offset(entities.size() + 1, 0);
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    ne += entities[i]->getNumMeshElements();
+    offset[i + 1] = ne;
+  }
+
+  std::vector<std::size_t> old, remap;
   std::size_t npost = 0;
 #if defined(HAVE_POST)
   // check if any element-based post-processing datasets depend on the model
@@ -1858,29 +1947,18 @@ void GModel::renumberMeshElements(const std::map<std::size_t, std::size_t> &mapp
   npost = data[0].size() + data[1].size();
 #endif
 
-  std::size_t maxmap = CTX::instance()->mesh.firstElementTag - 1;
-  for(auto m : mapping) maxmap = std::max(maxmap, m.second);
-  bool info = true;
-  if(mapping.size() || npost) {
+  if(oldTags.size() || npost) {
+    old.reserve(ne);
     for(auto ge : entities) {
-      for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
-        MElement *e = ge->getMeshElement(j);
-        old[e] = e->getNum();
-        if(mapping.size()) {
-          auto it = mapping.find(e->getNum());
-          if(it != mapping.end())
-            remap[e] = it->second;
-          else {
-            if(info) {
-              Msg::Info("Mapping does not contain an element tag (%zu) - "
-                        "incrementing after last provided tag (%zu)",
-                        e->getNum(), maxmap);
-              info = false;
-            }
-            remap[e] = ++maxmap;
-          }
-        }
-      }
+      for(std::size_t j = 0; j < ge->getNumMeshElements(); j++)
+        old.push_back(ge->getMeshElement(j)->getNum());
+    }
+    if(oldTags.size()) {
+      std::vector<std::pair<std::size_t, std::size_t> > mapping;
+      sortTagMapping(oldTags, newTags, mapping);
+      applyTagMapping(mapping, old,
+                      CTX::instance()->mesh.firstElementTag - 1,
+                      "an element", remap);
     }
   }
 
@@ -1905,7 +1983,7 @@ void GModel::renumberMeshElements(const std::map<std::size_t, std::size_t> &mapp
            (saveOnlyPhysicals && ge->physicals.empty()))) {
         for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
           MElement *e = ge->getMeshElement(j);
-          e->forceNum(remap.empty() ? ++n : remap[e]);
+          e->forceNum(remap.empty() ? ++n : remap[offset[i] + j]);
         }
       }
     }
@@ -1915,7 +1993,7 @@ void GModel::renumberMeshElements(const std::map<std::size_t, std::size_t> &mapp
           (saveOnlyPhysicals && ge->physicals.empty()))) {
         for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
           MElement *e = ge->getMeshElement(j);
-          e->forceNum(remap.empty() ? ++n : remap[e]);
+          e->forceNum(remap.empty() ? ++n : remap[offset[i] + j]);
         }
       }
     }
@@ -1926,7 +2004,7 @@ void GModel::renumberMeshElements(const std::map<std::size_t, std::size_t> &mapp
       GEntity *ge = entities[i];
       for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
         MElement *e = ge->getMeshElement(j);
-        e->forceNum(remap.empty() ? ++n : remap[e]);
+        e->forceNum(remap.empty() ? ++n : remap[offset[i] + j]);
       }
     }
   }
@@ -1937,10 +2015,11 @@ void GModel::renumberMeshElements(const std::map<std::size_t, std::size_t> &mapp
     Msg::Info("Renumbering element model data (%d step%s)", npost,
               npost > 1 ? "s" : "");
     std::map<std::size_t, std::size_t> remap2;
-    for(auto ge : entities) {
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      GEntity *ge = entities[i];
       for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
         MElement *e = ge->getMeshElement(j);
-        remap2[old[e]] = e->getNum();
+        remap2[old[offset[i] + j]] = e->getNum();
       }
     }
     for(int i = 0; i < 2; i++) {
@@ -1950,6 +2029,278 @@ void GModel::renumberMeshElements(const std::map<std::size_t, std::size_t> &mapp
 #endif
 }
 
+void GModel::sortMeshByTags()
+{
+  std::vector<GEntity *> entities;
+  getEntities(entities);
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // the entities store disjoint sets of nodes and elements: sort them
+  // concurrently
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    GEntity *ge = entities[i];
+    std::sort(ge->mesh_vertices.begin(), ge->mesh_vertices.end(),
+              [](const MVertex *v1, const MVertex *v2) {
+                return v1->getNum() < v2->getNum();
+              });
+    std::vector<int> types;
+    ge->getElementTypes(types);
+    for(auto t : types) {
+      std::size_t ne = ge->getNumMeshElementsByType(t);
+      if(!ne) continue;
+      std::vector<std::pair<std::size_t, std::size_t> > num(ne);
+      for(std::size_t j = 0; j < ne; j++)
+        num[j] = std::make_pair(ge->getMeshElementByType(t, j)->getNum(), j);
+      std::sort(num.begin(), num.end());
+      std::vector<std::size_t> ordering(ne);
+      for(std::size_t j = 0; j < ne; j++) ordering[j] = num[j].second;
+      int type = ge->getMeshElementByType(t, 0)->getTypeForMSH();
+      ge->reorder(type, ordering);
+    }
+  }
+  destroyMeshCaches();
+}
+
+// Check if the mesh nodes and elements can be reallocated, i.e. if all the
+// references to them can be updated
+static bool canReallocateMesh(std::vector<GEntity *> &entities)
+{
+  for(auto ge : entities) {
+    if(ge->geomType() == GEntity::GhostCurve ||
+       ge->geomType() == GEntity::GhostSurface ||
+       ge->geomType() == GEntity::GhostVolume)
+      return false;
+    BoundaryLayerColumns *c = nullptr;
+    if(ge->dim() == 2) c = static_cast<GFace *>(ge)->getColumns();
+    if(ge->dim() == 3) c = static_cast<GRegion *>(ge)->getColumns();
+    if(c && (c->size() || c->_elemColumns.size() || c->_toFirst.size()))
+      return false;
+    for(auto v : ge->mesh_vertices) {
+      if(typeid(*v) != typeid(MVertex) && typeid(*v) != typeid(MEdgeVertex) &&
+         typeid(*v) != typeid(MFaceVertex))
+        return false;
+    }
+    for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
+      MElement *e = ge->getMeshElement(j);
+      if(e->getType() == TYPE_POLYG || e->getType() == TYPE_POLYH ||
+         e->getParent())
+        return false;
+    }
+  }
+  return true;
+}
+
+static MVertex *copyVertex(MVertex *v)
+{
+  // the boundary layer data is moved to the copy
+  if(typeid(*v) == typeid(MFaceVertex)) {
+    MFaceVertex *fv = static_cast<MFaceVertex *>(v);
+    MFaceVertex *n = new MFaceVertex(*fv);
+    fv->bl_data = nullptr;
+    return n;
+  }
+  if(typeid(*v) == typeid(MEdgeVertex)) {
+    MEdgeVertex *ev = static_cast<MEdgeVertex *>(v);
+    MEdgeVertex *n = new MEdgeVertex(*ev);
+    ev->bl_data = nullptr;
+    return n;
+  }
+  return new MVertex(*v);
+}
+
+void GModel::sortMeshAlongHilbertCurve(bool reallocate)
+{
+  destroyMeshCaches();
+  std::vector<GEntity *> entities;
+  getEntities(entities);
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  double min[3] = {std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max()};
+  double max[3] = {-std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max()};
+  for(auto ge : entities) {
+    std::vector<MVertex *> &v = ge->mesh_vertices;
+#pragma omp parallel num_threads(nthreads)
+    {
+      double tmin[3] = {min[0], min[1], min[2]};
+      double tmax[3] = {max[0], max[1], max[2]};
+#pragma omp for
+      for(std::size_t i = 0; i < v.size(); i++) {
+        for(int j = 0; j < 3; j++) {
+          tmin[j] = std::min(tmin[j], v[i]->point()[j]);
+          tmax[j] = std::max(tmax[j], v[i]->point()[j]);
+        }
+      }
+#pragma omp critical
+      for(int j = 0; j < 3; j++) {
+        min[j] = std::min(min[j], tmin[j]);
+        max[j] = std::max(max[j], tmax[j]);
+      }
+    }
+  }
+
+  // sort the nodes, and the elements of each type (using their barycenter),
+  // by Hilbert index in each entity; ties keep their initial order
+  for(auto ge : entities) {
+    std::vector<MVertex *> &v = ge->mesh_vertices;
+    std::vector<std::pair<uint64_t, std::size_t> > keys(v.size());
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t i = 0; i < v.size(); i++)
+      keys[i] = std::make_pair(
+        HilbertIndex(v[i]->x(), v[i]->y(), v[i]->z(), min, max), i);
+    std::sort(keys.begin(), keys.end());
+    std::vector<MVertex *> sorted(v.size());
+    for(std::size_t i = 0; i < keys.size(); i++) sorted[i] = v[keys[i].second];
+    v.swap(sorted);
+
+    std::vector<int> types;
+    ge->getElementTypes(types);
+    for(auto t : types) {
+      std::size_t ne = ge->getNumMeshElementsByType(t);
+      if(!ne) continue;
+      keys.resize(ne);
+#pragma omp parallel for num_threads(nthreads)
+      for(std::size_t i = 0; i < ne; i++) {
+        SPoint3 b = ge->getMeshElementByType(t, i)->barycenter();
+        keys[i] =
+          std::make_pair(HilbertIndex(b.x(), b.y(), b.z(), min, max), i);
+      }
+      std::sort(keys.begin(), keys.end());
+      std::vector<std::size_t> ordering(ne);
+      for(std::size_t i = 0; i < ne; i++) ordering[i] = keys[i].second;
+      int type = ge->getMeshElementByType(t, 0)->getTypeForMSH();
+      ge->reorder(type, ordering);
+    }
+  }
+
+  if(!reallocate) return;
+
+  if(!canReallocateMesh(entities)) {
+    Msg::Info("Mesh with boundary layer, ghost or cut elements: sorting "
+              "without reallocation");
+    return;
+  }
+
+  // allocate new nodes in the sorted order, so that they end up (mostly)
+  // contiguous in memory; the old nodes store their position in the index
+  // (copied to the new nodes beforehand), which allows to find the new node
+  // from the old one without a map
+  std::vector<MVertex *> oldv, newv;
+  for(auto ge : entities) {
+    for(auto v : ge->mesh_vertices) {
+      oldv.push_back(v);
+      newv.push_back(copyVertex(v));
+    }
+  }
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < oldv.size(); i++) oldv[i]->setIndex((long int)i);
+  auto newVertex = [&oldv, &newv](MVertex *v) {
+    long int i = v->getIndex();
+    if(i >= 0 && i < (long int)oldv.size() && oldv[i] == v) return newv[i];
+    return v; // not stored in any entity
+  };
+
+  // update all the references to the nodes
+  std::vector<MElement *> elements;
+  for(auto ge : entities) {
+    for(std::size_t j = 0; j < ge->getNumMeshElements(); j++)
+      elements.push_back(ge->getMeshElement(j));
+  }
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    MElement *e = elements[i];
+    for(std::size_t j = 0; j < e->getNumVertices(); j++)
+      e->setVertex(j, newVertex(e->getVertex(j)));
+  }
+  std::size_t k = 0;
+  for(auto ge : entities) {
+    for(auto &v : ge->mesh_vertices) v = newv[k++];
+    std::map<MVertex *, MVertex *> corr;
+    for(auto &c : ge->correspondingVertices)
+      corr[newVertex(c.first)] = newVertex(c.second);
+    ge->correspondingVertices.swap(corr);
+    corr.clear();
+    for(auto &c : ge->correspondingHighOrderVertices)
+      corr[newVertex(c.first)] = newVertex(c.second);
+    ge->correspondingHighOrderVertices.swap(corr);
+    if(ge->dim() == 2) {
+      GFace *gf = static_cast<GFace *>(ge);
+      for(auto &tv : gf->transfinite_vertices)
+        for(auto &v : tv) v = newVertex(v);
+      std::set<MVertex *> cv;
+      for(auto v : gf->constr_vertices) cv.insert(newVertex(v));
+      gf->constr_vertices.swap(cv);
+    }
+    else if(ge->dim() == 3) {
+      GRegion *gr = static_cast<GRegion *>(ge);
+      for(auto &tv : gr->transfinite_vertices)
+        for(auto &tvv : tv)
+          for(auto &v : tvv) v = newVertex(v);
+    }
+  }
+  if(_curvatures.size()) {
+    std::map<MVertex *, std::pair<SVector3, SVector3> > curv;
+    for(auto &c : _curvatures) curv[newVertex(c.first)] = c.second;
+    _curvatures.swap(curv);
+  }
+  for(auto &v : _lastMeshVertexError) v = newVertex(v);
+  if(_mapEdgeNum.size()) {
+    hashmapMEdge edges;
+    for(auto &e : _mapEdgeNum)
+      edges[MEdge(newVertex(e.first.getVertex(0)),
+                  newVertex(e.first.getVertex(1)))] = e.second;
+    _mapEdgeNum.swap(edges);
+  }
+  if(_mapFaceNum.size()) {
+    hashmapMFace faces;
+    for(auto &f : _mapFaceNum) {
+      std::vector<MVertex *> fv(f.first.getNumVertices());
+      for(std::size_t j = 0; j < fv.size(); j++)
+        fv[j] = newVertex(f.first.getVertex(j));
+      faces[MFace(fv)] = f.second;
+    }
+    _mapFaceNum.swap(faces);
+  }
+  for(auto v : oldv) delete v;
+
+  // allocate new elements in the sorted order (the visibility flag is copied
+  // as is, even if unselected elements are currently hidden)
+  int hideUnselected = CTX::instance()->hideUnselected;
+  CTX::instance()->hideUnselected = 0;
+  MElementFactory factory;
+  for(auto ge : entities) {
+    std::vector<MElement *> olde, newe;
+    for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
+      MElement *e = ge->getMeshElement(j);
+      std::vector<MVertex *> verts;
+      e->getVertices(verts);
+      MElement *n = factory.create(e->getTypeForMSH(), verts, e->getNum(),
+                                   e->getPartition());
+      if(n) {
+        n->setVisibility(e->getVisibility());
+        olde.push_back(e);
+      }
+      else
+        n = e;
+      newe.push_back(n);
+    }
+    ge->removeElements(false);
+    for(auto e : newe) ge->addElement(e);
+    for(auto e : olde) delete e;
+  }
+  CTX::instance()->hideUnselected = hideUnselected;
+
+  destroyMeshCaches();
+}
+
 std::size_t GModel::getNumMeshElements(unsigned c[6])
 {
   c[0] = 0;
@@ -1970,18 +2321,26 @@ std::size_t GModel::getNumMeshElements(unsigned c[6])
   return 0;
 }
 
-MElement *GModel::getMeshElementByCoord(SPoint3 &p, SPoint3 &param, int dim,
-                                        bool strict)
+MElementOctree *GModel::_getElementOctree()
 {
-  if(!_elementOctree) {
-#pragma omp barrier
-#pragma omp single
-    {
+  MElementOctree *octree = _elementOctree.load(std::memory_order_acquire);
+  if(octree) return octree;
+#pragma omp critical(GModelElementOctree)
+  {
+    octree = _elementOctree.load(std::memory_order_relaxed);
+    if(!octree) {
       Msg::Debug("Rebuilding mesh element octree");
-      _elementOctree = new MElementOctree(this);
+      octree = new MElementOctree(this);
+      _elementOctree.store(octree, std::memory_order_release);
     }
   }
-  MElement *e = _elementOctree->find(p.x(), p.y(), p.z(), dim, strict);
+  return octree;
+}
+
+MElement *GModel::getMeshElementByCoord(SPoint3 &p, SPoint3 &param, int dim,
+                                        bool strict)
+{
+  MElement *e = _getElementOctree()->find(p.x(), p.y(), p.z(), dim, strict);
   if(e) {
     double xyz[3] = {p.x(), p.y(), p.z()}, uvw[3];
     e->xyz2uvw(xyz, uvw);
@@ -1996,15 +2355,7 @@ MElement *GModel::getMeshElementByCoord(SPoint3 &p, SPoint3 &param, int dim,
 std::vector<MElement *> GModel::getMeshElementsByCoord(SPoint3 &p, int dim,
                                                        bool strict)
 {
-  if(!_elementOctree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding mesh element octree");
-      _elementOctree = new MElementOctree(this);
-    }
-  }
-  return _elementOctree->findAll(p.x(), p.y(), p.z(), dim, strict);
+  return _getElementOctree()->findAll(p.x(), p.y(), p.z(), dim, strict);
 }
 
 void GModel::rebuildMeshVertexCache(bool onlyIfNecessary)
@@ -2337,7 +2688,7 @@ void GModel::setCurrentMeshEntity(GEntity *e)
 int GModel::partitionMesh(
   int numPart, std::vector<std::pair<MElement *, int> > elementPartition)
 {
-#if defined(HAVE_MESH) && (defined(HAVE_METIS))
+#if defined(HAVE_MESH)
   if(numPart > 0) {
     if(_numPartitions > 0) UnpartitionMesh(this);
     if(elementPartition.empty())
@@ -2347,11 +2698,43 @@ int GModel::partitionMesh(
   }
   return 1;
 #else
-  Msg::Error("Mesh or Metis module not compiled");
+  Msg::Error("Mesh module not compiled");
   return 1;
 #endif
 }
 
+int GModel::writeSplitMSH(
+  const std::string &baseName, int numPart,
+  const std::vector<std::pair<MElement *, int> > &elementPartition,
+  double version, bool binary, bool saveAll, bool saveParametric,
+  double scalingFactor)
+{
+  if(numPart <= 0) {
+    Msg::Error("Number of partitions should be > 0");
+    return 0;
+  }
+  if(getNumPartitions() > 0) {
+    Msg::Error("Mesh is already partitioned: use writePartitionedMSH instead");
+    return 0;
+  }
+  if(version < 4.0) {
+    Msg::Error("Streaming partitioned export requires MSH 4 format");
+    return 0;
+  }
+  if(!elementPartition.empty())
+    return _writeSplitMSH4(baseName, numPart, elementPartition, version, binary,
+                           saveAll, saveParametric, scalingFactor);
+#if defined(HAVE_MESH)
+  std::vector<std::pair<MElement *, int> > computedPartition;
+  if(ComputeMeshPartition(this, numPart, computedPartition)) return 0;
+  return _writeSplitMSH4(baseName, numPart, computedPartition, version, binary,
+                         saveAll, saveParametric, scalingFactor);
+#else
+  Msg::Error("Mesh module not compiled");
+  return 0;
+#endif
+}
+
 int GModel::unpartitionMesh()
 {
 #if defined(HAVE_MESH)
@@ -2364,11 +2747,11 @@ int GModel::unpartitionMesh()
 
 int GModel::convertOldPartitioningToNewOne()
 {
-#if defined(HAVE_MESH) && (defined(HAVE_METIS))
+#if defined(HAVE_MESH)
   int ier = ConvertOldPartitioningToNewOne(this);
   return ier;
 #else
-  Msg::Error("Mesh or Metis module not compiled");
+  Msg::Error("Mesh module not compiled");
   return 1;
 #endif
 }
@@ -2824,34 +3207,34 @@ int GModel::removeDuplicateMeshVertices(double tolerance,
   std::vector<GEntity*> entities(ents);
   if(entities.empty()) getEntities(entities);
 
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
   // re-index all vertices (don't use MVertex::getNum(), as we want to be able
   // to remove duplicate vertices from "incorrect" meshes, where vertices with
   // the same number are duplicated)
-  int n = 0;
+  std::vector<MVertex *> all;
   for(std::size_t i = 0; i < entities.size(); i++) {
     GEntity *ge = entities[i];
-    for(std::size_t j = 0; j < ge->mesh_vertices.size(); j++) {
-      MVertex *v = ge->mesh_vertices[j];
-      v->setIndex(++n);
-    }
+    all.insert(all.end(), ge->mesh_vertices.begin(), ge->mesh_vertices.end());
   }
+  std::size_t nv = all.size();
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < nv; i++) all[i]->setIndex((long int)i);
 
-  MVertexRTree pos(eps);
-  std::map<std::size_t, MVertex *> vertices;
-  std::map<MVertex *, MVertex *> duplicates;
-  for(std::size_t i = 0; i < entities.size(); i++) {
-    GEntity *ge = entities[i];
-    for(std::size_t j = 0; j < ge->mesh_vertices.size(); j++) {
-      MVertex *v = ge->mesh_vertices[j];
-      MVertex *v2 = pos.insert(v);
-      if(v2)
-        duplicates[v] = v2; // v should be removed
-      else
-        vertices[v->getIndex()] = v;
-    }
+  // find duplicates: each node is replaced by the first node before it (in
+  // entity order) that it duplicates and that is not itself a duplicate
+  std::vector<double> xyz(3 * nv);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < nv; i++) {
+    xyz[3 * i] = all[i]->x();
+    xyz[3 * i + 1] = all[i]->y();
+    xyz[3 * i + 2] = all[i]->z();
   }
+  std::vector<std::size_t> rep;
+  int num = (int)weldPoints(xyz, eps, rep, nthreads);
+  std::vector<double>().swap(xyz);
 
-  int num = (int)duplicates.size();
   Msg::Info("Found %d duplicate nodes ", num);
 
   if(!num) {
@@ -2859,53 +3242,51 @@ int GModel::removeDuplicateMeshVertices(double tolerance,
     return 0;
   }
 
+  // the replacement of a node, found through its index (nodes that are not
+  // in the entities are kept)
+  auto replacement = [&all, &rep](MVertex *v) {
+    long int i = v->getIndex();
+    if(i >= 0 && i < (long int)all.size() && all[i] == v) return all[rep[i]];
+    return v;
+  };
+
+  std::vector<MElement *> elements;
   for(std::size_t i = 0; i < entities.size(); i++) {
     GEntity *ge = entities[i];
     // clear list of vertices owned by entity
     ge->mesh_vertices.clear();
-    // replace vertices in element
-    for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
-      MElement *e = ge->getMeshElement(j);
-      for(std::size_t k = 0; k < e->getNumVertices(); k++) {
-        auto it = duplicates.find(e->getVertex(k));
-        if(it != duplicates.end()) e->setVertex(k, it->second);
-      }
-    }
-    // replace vertices in periodic copies
-    std::map<MVertex *, MVertex *> &corrVtcs = ge->correspondingVertices;
-    if(corrVtcs.size()) {
-      std::map<MVertex *, MVertex *>::iterator cIter;
-      for(cIter = duplicates.begin(); cIter != duplicates.end(); ++cIter) {
-        MVertex *oldTgt = cIter->first;
-        MVertex *newTgt = cIter->second;
-        auto cvIter = corrVtcs.find(oldTgt);
-        if(cvIter != corrVtcs.end()) {
-          MVertex *src = cvIter->second;
-          corrVtcs.erase(cvIter);
-          corrVtcs[newTgt] = src;
-        }
-      }
-      for(cIter = corrVtcs.begin(); cIter != corrVtcs.end(); ++cIter) {
-        MVertex *oldSrc = cIter->second;
-        auto nIter = duplicates.find(oldSrc);
-        if(nIter != duplicates.end()) {
-          MVertex *tgt = cIter->first;
-          MVertex *newSrc = nIter->second;
-          corrVtcs[tgt] = newSrc;
-        }
-      }
-    }
+    for(std::size_t j = 0; j < ge->getNumMeshElements(); j++)
+      elements.push_back(ge->getMeshElement(j));
+  }
+
+  // replace vertices in elements
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    MElement *e = elements[i];
+    for(std::size_t k = 0; k < e->getNumVertices(); k++)
+      e->setVertex(k, replacement(e->getVertex(k)));
+  }
+
+  // replace vertices in periodic copies
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    std::map<MVertex *, MVertex *> &corrVtcs = entities[i]->correspondingVertices;
+    if(corrVtcs.empty()) continue;
+    std::map<MVertex *, MVertex *> corr;
+    for(auto &c : corrVtcs) corr[replacement(c.first)] = replacement(c.second);
+    corrVtcs.swap(corr);
   }
 
   destroyMeshCaches();
   _associateEntityWithMeshVertices();
+  std::vector<MVertex *> vertices(nv, nullptr);
+  for(std::size_t i = 0; i < nv; i++)
+    if(rep[i] == i) vertices[i] = all[i];
   _storeVerticesInEntities(vertices);
 
   // delete duplicates
-  std::vector<MVertex *> to_delete;
-  for(auto it = duplicates.begin(); it != duplicates.end(); it++)
-    to_delete.push_back(it->first);
-  for(std::size_t i = 0; i < to_delete.size(); i++) delete to_delete[i];
+  for(std::size_t i = 0; i < nv; i++)
+    if(rep[i] != i) delete all[i];
 
   if(CTX::instance()->mesh.renumber) {
     renumberMeshVertices();
@@ -13,6 +13,7 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <atomic>
 #include "GVertex.h"
 #include "GEdge.h"
 #include "GFace.h"
@@ -80,6 +81,10 @@ private:
   int _writePartitionedMSH4(const std::string &baseName, double version,
                             bool binary, bool saveAll, bool saveParametric,
                             double scalingFactor);
+  int _writeSplitMSH4(const std::string &baseName, int numPart,
+                      const std::vector<std::pair<MElement *, int> > &elmToPart,
+                      double version, bool binary, bool saveAll,
+                      bool saveParametric, double scalingFactor);
   int _writeX3dFile(FILE* fp, bool saveAll,
                     double scalingFactor, int x3dsurfaces, int x3dedges,
                     int x3dvertices, int x3dcolorize,
@@ -109,8 +114,10 @@ protected:
   // /!\ Use only for compatibility with mesh format msh2 and msh3
   std::multimap<MElement *, short> _ghostCells;
 
-  // an octree for fast mesh element lookup
-  MElementOctree *_elementOctree;
+  // an octree for fast mesh element lookup, created on demand (possibly
+  // concurrently) by _getElementOctree()
+  std::atomic<MElementOctree *> _elementOctree;
+  MElementOctree *_getElementOctree();
 
   // global cache storage of discrete curvatures
   std::map<MVertex *, std::pair<SVector3, SVector3> > _curvatures;
@@ -298,6 +305,23 @@ public:
                             std::map<std::size_t, std::size_t>());
   void renumberMeshElements(const std::map<std::size_t, std::size_t> &mapping =
                             std::map<std::size_t, std::size_t>());
+  // same as above, with the mapping given as two vectors (the node or element
+  // with tag oldTags[i] is renumbered newTags[i])
+  void renumberMeshVertices(const std::vector<std::size_t> &oldTags,
+                            const std::vector<std::size_t> &newTags);
+  void renumberMeshElements(const std::vector<std::size_t> &oldTags,
+                            const std::vector<std::size_t> &newTags);
+
+  // sort the nodes and the elements stored in each entity by increasing tag,
+  // so that their order in memory follows the numbering (e.g. after a
+  // renumbering for locality)
+  void sortMeshByTags();
+
+  // sort the nodes and the elements stored in each entity along a Hilbert
+  // curve; if reallocate is set, also reallocate them in that order so that
+  // they are contiguous in memory (this invalidates all the pointers to the
+  // nodes and elements, but not their tags)
+  void sortMeshAlongHilbertCurve(bool reallocate = true);
 
   // delete all the mesh-related caches (this must be called when the
   // mesh is changed)
@@ -793,6 +817,14 @@ public:
                           bool binary = false, bool saveAll = false,
                           bool saveParametric = false,
                           double scalingFactor = 1.0);
+  // write the mesh split into numPart partitions (given by elementPartition,
+  // or computed with the current partitioner if elementPartition is empty) in
+  // one MSH4 file per partition, without partitioning the model itself
+  int
+  writeSplitMSH(const std::string &baseName, int numPart,
+                const std::vector<std::pair<MElement *, int> > &elementPartition,
+                double version = 4.1, bool binary = false, bool saveAll = false,
+                bool saveParametric = false, double scalingFactor = 1.0);
 
   // Iridium file format
   int writeIR3(const std::string &name, int elementTagType, bool saveAll,
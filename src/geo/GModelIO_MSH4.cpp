@@ -16,6 +16,7 @@
 #include <cstdlib>
 #include <limits>
 #include <stdexcept>
+#include <unordered_map>
 
 #include "GmshDefines.h"
 #include "OS.h"
@@ -2038,28 +2039,26 @@ static void writeMSH4Entities(GModel *const model, FILE *fp, bool partition,
     fprintf(fp, "$EndEntities\n");
 }
 
-static void writeMSH4EntityNodes(GEntity *ge, FILE *fp, bool binary,
-                                 int saveParametric, double scalingFactor,
-                                 double version)
+static void writeMSH4NodeBlock(int entityDim, int entityTag,
+                               const std::vector<MVertex *> &verts, FILE *fp,
+                               bool binary, int saveParametric,
+                               double scalingFactor, double version)
 {
   int parametric = saveParametric;
-  if(ge->dim() != 1 && ge->dim() != 2)
+  if(entityDim != 1 && entityDim != 2)
     parametric = 0; // Gmsh only stores parametric coordinates for dim 1 and 2
 
-  std::size_t numVerts = ge->getNumMeshVertices();
+  std::size_t numVerts = verts.size();
 
   if(binary) {
-    int entityDim = ge->dim();
-    int entityTag = ge->tag();
     fwrite(&entityDim, sizeof(int), 1, fp);
     fwrite(&entityTag, sizeof(int), 1, fp);
     fwrite(&parametric, sizeof(int), 1, fp);
     fwrite(&numVerts, sizeof(std::size_t), 1, fp);
   }
   else {
-    fprintf(fp, "%d %d %d %zu\n", (version >= 4.1) ? ge->dim() : ge->tag(),
-            (version >= 4.1) ? ge->tag() : ge->dim(), parametric,
-            ge->getNumMeshVertices());
+    fprintf(fp, "%d %d %d %zu\n", (version >= 4.1) ? entityDim : entityTag,
+            (version >= 4.1) ? entityTag : entityDim, parametric, numVerts);
   }
 
   if(!numVerts) {
@@ -2067,17 +2066,17 @@ static void writeMSH4EntityNodes(GEntity *ge, FILE *fp, bool binary,
   }
 
   std::size_t n = 3;
-  if(parametric) n += ge->dim();
+  if(parametric) n += entityDim;
 
   if(binary) {
     std::vector<size_t> tags(numVerts);
     for(std::size_t i = 0; i < numVerts; i++)
-      tags[i] = ge->getMeshVertex(i)->getNum();
+      tags[i] = verts[i]->getNum();
     fwrite(&tags[0], sizeof(std::size_t), numVerts, fp);
     std::vector<double> coord(n * numVerts);
     std::size_t j = 0;
     for(std::size_t i = 0; i < numVerts; i++) {
-      MVertex *mv = ge->getMeshVertex(i);
+      MVertex *mv = verts[i];
       coord[j++] = mv->x() * scalingFactor;
       coord[j++] = mv->y() * scalingFactor;
       coord[j++] = mv->z() * scalingFactor;
@@ -2089,10 +2088,10 @@ static void writeMSH4EntityNodes(GEntity *ge, FILE *fp, bool binary,
   else {
     if(version >= 4.1) {
       for(std::size_t i = 0; i < numVerts; i++)
-        fprintf(fp, "%zu\n", ge->getMeshVertex(i)->getNum());
+        fprintf(fp, "%zu\n", verts[i]->getNum());
     }
     for(std::size_t i = 0; i < numVerts; i++) {
-      MVertex *mv = ge->getMeshVertex(i);
+      MVertex *mv = verts[i];
       double x = mv->x() * scalingFactor;
       double y = mv->y() * scalingFactor;
       double z = mv->z() * scalingFactor;
@@ -2115,6 +2114,14 @@ static void writeMSH4EntityNodes(GEntity *ge, FILE *fp, bool binary,
   }
 }
 
+static void writeMSH4EntityNodes(GEntity *ge, FILE *fp, bool binary,
+                                 int saveParametric, double scalingFactor,
+                                 double version)
+{
+  writeMSH4NodeBlock(ge->dim(), ge->tag(), ge->mesh_vertices, fp, binary,
+                     saveParametric, scalingFactor, version);
+}
+
 static std::size_t
 getAdditionalEntities(std::set<GRegion *, GEntityPtrLessThan> &regions,
                       std::set<GFace *, GEntityPtrLessThan> &faces,
@@ -2439,6 +2446,11 @@ static void writeMSH4Nodes(GModel *const model, FILE *fp, bool partitioned,
   fprintf(fp, "$EndNodes\n");
 }
 
+static void writeMSH4ElementBlocks(
+  FILE *fp,
+  std::map<std::pair<int, int>, std::vector<MElement *> > elementsByType[4],
+  std::size_t numElements, bool binary, double version);
+
 static void writeMSH4Elements(GModel *const model, FILE *fp, bool partitioned,
                               int partitionToSave, bool binary, bool saveAll,
                               double version)
@@ -2526,6 +2538,14 @@ static void writeMSH4Elements(GModel *const model, FILE *fp, bool partitioned,
     }
   }
 
+  writeMSH4ElementBlocks(fp, elementsByType, numElements, binary, version);
+}
+
+static void writeMSH4ElementBlocks(
+  FILE *fp,
+  std::map<std::pair<int, int>, std::vector<MElement *> > elementsByType[4],
+  std::size_t numElements, bool binary, double version)
+{
   if(!numElements) return;
 
   fprintf(fp, "$Elements\n");
@@ -2836,6 +2856,32 @@ static void writeMSH4Parametrizations(GModel *const model, FILE *fp,
   fprintf(fp, "$EndParametrizations\n");
 }
 
+static void writeMSH4Header(GModel *const model, FILE *fp, double version,
+                            bool binary)
+{
+  fprintf(fp, "$MeshFormat\n");
+  fprintf(fp, "%g %d %zu\n", version, (binary ? 1 : 0), sizeof(std::size_t));
+  if(binary) {
+    int one = 1;
+    fwrite(&one, sizeof(int), 1, fp); // swapping byte
+    fprintf(fp, "\n");
+  }
+  fprintf(fp, "$EndMeshFormat\n");
+
+  if(model->numPhysicalNames() > 0) {
+    fprintf(fp, "$PhysicalNames\n");
+    fprintf(fp, "%d\n", model->numPhysicalNames());
+    for(auto it = model->firstPhysicalName(); it != model->lastPhysicalName();
+        ++it) {
+      std::string name = it->second;
+      if(name.size() > 128) name.resize(128);
+      fprintf(fp, "%d %d \"%s\"\n", it->first.first, it->first.second,
+              name.c_str());
+    }
+    fprintf(fp, "$EndPhysicalNames\n");
+  }
+}
+
 int GModel::_writeMSH4(const std::string &name, double version, bool binary,
                        bool saveAll, bool saveParametric, double scalingFactor,
                        bool append, int partitionToSave,
@@ -2860,28 +2906,8 @@ int GModel::_writeMSH4(const std::string &name, double version, bool binary,
   // if there are no physicals we save all the elements
   if(noPhysicalGroups()) saveAll = true;
 
-  // header
-  fprintf(fp, "$MeshFormat\n");
-  fprintf(fp, "%g %d %zu\n", version, (binary ? 1 : 0), sizeof(std::size_t));
-  if(binary) {
-    int one = 1;
-    fwrite(&one, sizeof(int), 1, fp); // swapping byte
-    fprintf(fp, "\n");
-  }
-  fprintf(fp, "$EndMeshFormat\n");
-
-  // physicals
-  if(numPhysicalNames() > 0) {
-    fprintf(fp, "$PhysicalNames\n");
-    fprintf(fp, "%d\n", numPhysicalNames());
-    for(auto it = firstPhysicalName(); it != lastPhysicalName(); ++it) {
-      std::string name = it->second;
-      if(name.size() > 128) name.resize(128);
-      fprintf(fp, "%d %d \"%s\"\n", it->first.first, it->first.second,
-              name.c_str());
-    }
-    fprintf(fp, "$EndPhysicalNames\n");
-  }
+  // header and physicals
+  writeMSH4Header(this, fp, version, binary);
 
   // entities
   writeMSH4Entities(this, fp, false, binary, scalingFactor, version,
@@ -2946,6 +2972,22 @@ int GModel::_writeMSH4(const std::string &name, double version, bool binary,
   return 1;
 }
 
+static void getMSH4EntityBounds(GModel *const model,
+                                std::map<GEntity*, SBoundingBox3d> &entityBounds,
+                                int nthreads)
+{
+  std::vector<GEntity*> entities;
+  model->getEntities(entities);
+  std::vector<SBoundingBox3d> bounds(entities.size());
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    bounds[i] = entities[i]->bounds();
+  }
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    entityBounds[entities[i]] = bounds[i];
+  }
+}
+
 int GModel::_writePartitionedMSH4(const std::string &baseName, double version,
                                   bool binary, bool saveAll,
                                   bool saveParametric, double scalingFactor)
@@ -2956,17 +2998,8 @@ int GModel::_writePartitionedMSH4(const std::string &baseName, double version,
   // precompute entity bounding boxes (we write the full brep in each file, so
   // otherwise we would compute the bounding boxes as many times as we have
   // partitions)
-  std::vector<GEntity*> entities;
-  getEntities(entities);
-  std::vector<SBoundingBox3d> bounds(entities.size());
-#pragma omp parallel for num_threads(nthreads)
-  for(std::size_t i = 0; i < entities.size(); i++) {
-    bounds[i] = entities[i]->bounds();
-  }
   std::map<GEntity*, SBoundingBox3d> entityBounds;
-  for(std::size_t i = 0; i < entities.size(); i++) {
-    entityBounds[entities[i]] = bounds[i];
-  }
+  getMSH4EntityBounds(this, entityBounds, nthreads);
 
   bool exceptions = false;
 #pragma omp parallel for num_threads(nthreads)
@@ -2997,6 +3030,490 @@ int GModel::_writePartitionedMSH4(const std::string &baseName, double version,
   return 1;
 }
 
+// A partition, interface or ghost entity of a mesh split that is saved without
+// being created in the model (see GModel::_writeSplitMSH4)
+struct splitEntity {
+  GEntity *parent;
+  int dim, tag;
+  std::vector<int> partitions;
+  std::vector<MVertex *> vertices;
+  SBoundingBox3d bounds;
+  splitEntity(GEntity *p, int d, int t) : parent(p), dim(d), tag(t) {}
+};
+
+static bool splitEntityLessThan(const splitEntity *e1, const splitEntity *e2)
+{
+  if(e1->dim != e2->dim) return e1->dim < e2->dim;
+  return e1->tag < e2->tag;
+}
+
+static void writeMSH4SplitEntities(FILE *fp, std::size_t numPart,
+                                   std::vector<splitEntity *> &entities,
+                                   splitEntity *ghost, bool binary,
+                                   double scalingFactor, double version)
+{
+  std::size_t num[4] = {0, 0, 0, 0};
+  for(auto e : entities) num[e->dim]++;
+
+  fprintf(fp, "$PartitionedEntities\n");
+  if(binary) {
+    fwrite(&numPart, sizeof(std::size_t), 1, fp);
+    std::size_t ghostSize = ghost ? 1 : 0;
+    fwrite(&ghostSize, sizeof(std::size_t), 1, fp);
+    if(ghost) {
+      int tags[2] = {ghost->tag, ghost->partitions[0]};
+      fwrite(tags, sizeof(int), 2, fp);
+    }
+    fwrite(num, sizeof(std::size_t), 4, fp);
+  }
+  else {
+    fprintf(fp, "%zu\n", numPart);
+    fprintf(fp, "%d\n", ghost ? 1 : 0);
+    if(ghost) fprintf(fp, "%d %d\n", ghost->tag, ghost->partitions[0]);
+    fprintf(fp, "%zu %zu %zu %zu\n", num[0], num[1], num[2], num[3]);
+  }
+
+  for(auto e : entities) {
+    // the physical groups of the parent are only inherited by the entities
+    // with the same dimension
+    std::vector<int> phys;
+    if(e->parent && e->parent->dim() == e->dim)
+      phys = e->parent->getPhysicalEntities();
+    int parentDim = e->parent ? e->parent->dim() : 0;
+    int parentTag = e->parent ? e->parent->tag() : 0;
+    if(binary) {
+      fwrite(&e->tag, sizeof(int), 1, fp);
+      fwrite(&parentDim, sizeof(int), 1, fp);
+      fwrite(&parentTag, sizeof(int), 1, fp);
+      std::size_t numPartitions = e->partitions.size();
+      fwrite(&numPartitions, sizeof(std::size_t), 1, fp);
+      fwrite(&e->partitions[0], sizeof(int), numPartitions, fp);
+      writeMSH4BoundingBox(e->bounds, fp, scalingFactor, binary, e->dim,
+                           version);
+      std::size_t phySize = phys.size();
+      fwrite(&phySize, sizeof(std::size_t), 1, fp);
+      if(phySize) fwrite(&phys[0], sizeof(int), phySize, fp);
+      if(e->dim) {
+        std::size_t numBrep = 0;
+        fwrite(&numBrep, sizeof(std::size_t), 1, fp);
+      }
+    }
+    else {
+      fprintf(fp, "%d %d %d %zu ", e->tag, parentDim, parentTag,
+              e->partitions.size());
+      for(auto p : e->partitions) fprintf(fp, "%d ", p);
+      writeMSH4BoundingBox(e->bounds, fp, scalingFactor, binary, e->dim,
+                           version);
+      fprintf(fp, "%zu", phys.size());
+      for(auto p : phys) fprintf(fp, " %d", p);
+      fprintf(fp, " ");
+      if(e->dim) fprintf(fp, "0 ");
+      fprintf(fp, "\n");
+    }
+  }
+
+  if(binary) fprintf(fp, "\n");
+  fprintf(fp, "$EndPartitionedEntities\n");
+}
+
+// Save the mesh split according to elmToPart in one file per partition,
+// directly from the unpartitioned model. The entities follow the conventions
+// of a partitioned model: the elements of each partition and the nodes only
+// used by this partition are stored in partition entities (one per parent
+// entity), the nodes shared by several partitions in interface entities (one
+// per parent entity and set of partitions), and the ghost cells in a ghost
+// entity. Only the split, the list of shared nodes and the ghost cells are
+// stored in memory; the partition entities are built one partition at a time.
+int GModel::_writeSplitMSH4(
+  const std::string &baseName, int numPart,
+  const std::vector<std::pair<MElement *, int> > &elmToPart, double version,
+  bool binary, bool saveAll, bool saveParametric, double scalingFactor)
+{
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  if(version < 4.1 && binary) {
+    Msg::Error("Can only write MSH 4.0 format in ASCII mode");
+    return 0;
+  }
+
+  if(noPhysicalGroups()) saveAll = true;
+
+  Msg::StatusBar(true, "Writing %d partitions...", numPart);
+  double t1 = Cpu(), w1 = TimeOfDay();
+
+  std::vector<GEntity *> entities;
+  getEntities(entities);
+  std::map<GEntity *, std::size_t> entityIndex;
+  std::vector<int> entityTag(entities.size());
+  int nextTag[4];
+  {
+    std::size_t rank[4] = {0, 0, 0, 0};
+    for(int dim = 0; dim < 4; dim++)
+      nextTag[dim] = getMaxElementaryNumber(dim) + 1;
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      int dim = entities[i]->dim();
+      entityIndex[entities[i]] = i;
+      // tag of the partition entity of this entity in partition p is
+      // entityTag[i] + p - 1
+      entityTag[i] = nextTag[dim] + rank[dim]++ * numPart;
+    }
+    for(int dim = 0; dim < 4; dim++) nextTag[dim] += rank[dim] * numPart;
+  }
+
+  // bucket the elements by partition, and find the partition of each node: 0
+  // if unused, -1 if shared by several partitions
+  std::vector<std::vector<std::pair<std::size_t, MElement *> > > partElements(
+    numPart);
+  std::vector<int> nodePart(getMaxVertexNumber() + 1, 0);
+  std::unordered_map<MVertex *, std::vector<int> > nodeParts;
+  {
+    std::unordered_map<MElement *, int> part;
+    part.reserve(elmToPart.size());
+    for(auto &ep : elmToPart) {
+      if(ep.second <= 0 || ep.second > numPart) {
+        Msg::Error("Invalid partition %d for element %zu", ep.second,
+                   ep.first->getNum());
+        return 0;
+      }
+      part[ep.first] = ep.second;
+    }
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
+        MElement *e = entities[i]->getMeshElement(j);
+        auto it = part.find(e);
+        if(it == part.end()) {
+          Msg::Error("Element %zu is not partitioned", e->getNum());
+          return 0;
+        }
+        int p = it->second;
+        partElements[p - 1].push_back(std::make_pair(i, e));
+        for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+          MVertex *v = e->getVertex(k);
+          if(v->getNum() >= nodePart.size()) {
+            Msg::Error("Node %zu is not numbered", v->getNum());
+            return 0;
+          }
+          int &np = nodePart[v->getNum()];
+          if(!np) { np = p; }
+          else if(np != p) {
+            std::vector<int> &parts = nodeParts[v];
+            if(np > 0) {
+              parts.push_back(np);
+              np = -1;
+            }
+            if(std::find(parts.begin(), parts.end(), p) == parts.end())
+              parts.push_back(p);
+          }
+        }
+      }
+    }
+  }
+
+  // create the interface entities: the dimension decreases with the number of
+  // partitions sharing the nodes, as with the partition topology
+  int meshDim = getMeshDim();
+  std::map<std::pair<std::pair<int, int>, std::vector<int> >, std::size_t>
+    interfaceIndex;
+  std::vector<splitEntity> interfaces;
+  std::unordered_map<MVertex *, std::size_t> nodeInterface;
+  nodeInterface.reserve(nodeParts.size());
+  {
+    std::vector<std::pair<MVertex *, std::vector<int> > > shared(
+      nodeParts.begin(), nodeParts.end());
+    nodeParts.clear();
+    std::sort(shared.begin(), shared.end(),
+              [](const std::pair<MVertex *, std::vector<int> > &a,
+                 const std::pair<MVertex *, std::vector<int> > &b) {
+                return a.first->getNum() < b.first->getNum();
+              });
+    for(auto &sv : shared) std::sort(sv.second.begin(), sv.second.end());
+    // number the interfaces in (parent, partitions) order, so that the tags
+    // do not depend on the node numbering
+    std::map<std::pair<std::pair<int, int>, std::vector<int> >, GEntity *>
+      keys;
+    for(auto &sv : shared) {
+      GEntity *parent = sv.first->onWhat();
+      std::pair<int, int> dt = parent ? std::make_pair(parent->dim(),
+                                                       parent->tag()) :
+                                        std::make_pair(-1, 0);
+      keys[std::make_pair(dt, sv.second)] = parent;
+    }
+    for(auto &k : keys) {
+      int dim = (k.second ? k.second->dim() : meshDim) -
+                (int)k.first.second.size() + 1;
+      dim = std::max(dim, 0);
+      interfaceIndex[k.first] = interfaces.size();
+      interfaces.push_back(splitEntity(k.second, dim, 0));
+      interfaces.back().partitions = k.first.second;
+    }
+    for(auto &i : interfaces) i.tag = nextTag[i.dim]++;
+    for(auto &sv : shared) {
+      GEntity *parent = sv.first->onWhat();
+      std::pair<int, int> dt = parent ? std::make_pair(parent->dim(),
+                                                       parent->tag()) :
+                                        std::make_pair(-1, 0);
+      std::size_t idx = interfaceIndex[std::make_pair(dt, sv.second)];
+      interfaces[idx].vertices.push_back(sv.first);
+      interfaces[idx].bounds += sv.first->point();
+      nodeInterface[sv.first] = idx;
+    }
+  }
+  std::vector<std::vector<std::size_t> > partInterfaces(numPart);
+  for(std::size_t i = 0; i < interfaces.size(); i++) {
+    for(auto p : interfaces[i].partitions) partInterfaces[p - 1].push_back(i);
+  }
+
+  // the ghost cells of partition p are the elements of highest dimension of
+  // the other partitions that share a node with it
+  std::vector<std::vector<std::pair<MElement *, int> > > ghostElements(
+    numPart);
+  if(CTX::instance()->mesh.partitionCreateGhostCells) {
+    for(int p = 1; p <= numPart; p++) {
+      for(auto &ie : partElements[p - 1]) {
+        MElement *e = ie.second;
+        if(e->getDim() != meshDim) continue;
+        for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+          MVertex *v = e->getVertex(k);
+          if(nodePart[v->getNum()] >= 0) continue;
+          for(auto q : interfaces[nodeInterface[v]].partitions) {
+            if(q != p) ghostElements[q - 1].push_back(std::make_pair(e, p));
+          }
+        }
+      }
+    }
+  }
+  int ghostTag = nextTag[meshDim];
+
+  std::map<GEntity *, SBoundingBox3d> entityBounds;
+  getMSH4EntityBounds(this, entityBounds, nthreads);
+
+  bool exceptions = false, failed = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(int p = 1; p <= numPart; p++) {
+    if(exceptions) continue;
+    std::ostringstream sstream;
+    sstream << baseName << "_" << p << ".msh";
+    if(numPart > 100) {
+      if(p % 100 == 1) {
+        Msg::Info("Writing partition %d/%d in file '%s'", p, numPart,
+                  sstream.str().c_str());
+      }
+    }
+    else {
+      Msg::Info("Writing partition %d in file '%s'", p, sstream.str().c_str());
+    }
+
+    try { // OpenMP forbids leaving block via exception
+      std::map<std::size_t, splitEntity> partEntities;
+      std::map<std::pair<int, int>, std::vector<MElement *> >
+        elementsByType[4];
+      std::size_t numElements = 0;
+      std::vector<MVertex *> nodes;
+      for(auto &ie : partElements[p - 1]) {
+        GEntity *ge = entities[ie.first];
+        auto it = partEntities.find(ie.first);
+        if(it == partEntities.end())
+          it = partEntities
+                 .insert(std::make_pair(
+                   ie.first,
+                   splitEntity(ge, ge->dim(), entityTag[ie.first] + p - 1)))
+                 .first;
+        MElement *e = ie.second;
+        for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+          MVertex *v = e->getVertex(k);
+          it->second.bounds += v->point();
+          if(nodePart[v->getNum()] == p) nodes.push_back(v);
+        }
+        if(!saveAll && ge->physicals.empty()) continue;
+        elementsByType[ge->dim()][std::make_pair(it->second.tag,
+                                                 e->getTypeForMSH())]
+          .push_back(e);
+        numElements++;
+      }
+
+      // nodes only used by this partition go to the partition entity of the
+      // entity they are classified on
+      std::sort(nodes.begin(), nodes.end(), MVertexPtrLessThan());
+      nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+      for(auto v : nodes) {
+        auto ei = entityIndex.find(v->onWhat());
+        if(ei == entityIndex.end()) {
+          Msg::Error("Node %zu is not classified on a model entity",
+                     v->getNum());
+          continue;
+        }
+        auto it = partEntities.find(ei->second);
+        if(it == partEntities.end()) {
+          GEntity *ge = entities[ei->second];
+          it = partEntities
+                 .insert(std::make_pair(
+                   ei->second,
+                   splitEntity(ge, ge->dim(), entityTag[ei->second] + p - 1)))
+                 .first;
+        }
+        it->second.vertices.push_back(v);
+        it->second.bounds += v->point();
+      }
+      nodes.clear();
+
+      std::vector<splitEntity *> fileEntities;
+      for(auto &pe : partEntities) {
+        pe.second.partitions.push_back(p);
+        fileEntities.push_back(&pe.second);
+      }
+      for(auto i : partInterfaces[p - 1]) fileEntities.push_back(&interfaces[i]);
+      std::sort(fileEntities.begin(), fileEntities.end(), splitEntityLessThan);
+
+      // ghost cells, with the nodes that are not already in the partition
+      std::vector<std::pair<MElement *, int> > &ghosts = ghostElements[p - 1];
+      std::sort(ghosts.begin(), ghosts.end(),
+                [](const std::pair<MElement *, int> &a,
+                   const std::pair<MElement *, int> &b) {
+                  return a.first->getNum() < b.first->getNum();
+                });
+      ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+      splitEntity ghost(nullptr, meshDim, ghostTag + p - 1);
+      ghost.partitions.push_back(p);
+      for(auto &g : ghosts) {
+        MElement *e = g.first;
+        for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+          MVertex *v = e->getVertex(k);
+          int np = nodePart[v->getNum()];
+          if(np == p) continue;
+          if(np < 0) {
+            const std::vector<int> &parts =
+              interfaces[nodeInterface.find(v)->second].partitions;
+            if(std::binary_search(parts.begin(), parts.end(), p)) continue;
+          }
+          ghost.vertices.push_back(v);
+        }
+        elementsByType[meshDim][std::make_pair(ghost.tag, e->getTypeForMSH())]
+          .push_back(e);
+        numElements++;
+      }
+      std::sort(ghost.vertices.begin(), ghost.vertices.end(),
+                MVertexPtrLessThan());
+      ghost.vertices.erase(
+        std::unique(ghost.vertices.begin(), ghost.vertices.end()),
+        ghost.vertices.end());
+
+      FILE *fp = Fopen(sstream.str().c_str(), binary ? "wb" : "w");
+      if(!fp) {
+        // skip this partition, but still release its memory below
+        Msg::Error("Unable to open file '%s'", sstream.str().c_str());
+#pragma omp atomic write
+        failed = true;
+      }
+      else {
+        writeMSH4Header(this, fp, version, binary);
+        writeMSH4Entities(this, fp, false, binary, scalingFactor, version,
+                          &entityBounds);
+        writeMSH4SplitEntities(fp, numPart, fileEntities,
+                               ghosts.empty() ? nullptr : &ghost, binary,
+                               scalingFactor, version);
+
+        // nodes
+        std::size_t numBlocks = 0, numNodes = 0;
+        std::size_t minTag = std::numeric_limits<std::size_t>::max();
+        std::size_t maxTag = 0;
+        if(!ghost.vertices.empty()) fileEntities.push_back(&ghost);
+        for(auto e : fileEntities) {
+          if(e->vertices.empty()) continue;
+          numBlocks++;
+          numNodes += e->vertices.size();
+          for(auto v : e->vertices) {
+            minTag = std::min(minTag, v->getNum());
+            maxTag = std::max(maxTag, v->getNum());
+          }
+        }
+        if(numNodes) {
+          fprintf(fp, "$Nodes\n");
+          if(binary) {
+            fwrite(&numBlocks, sizeof(std::size_t), 1, fp);
+            fwrite(&numNodes, sizeof(std::size_t), 1, fp);
+            fwrite(&minTag, sizeof(std::size_t), 1, fp);
+            fwrite(&maxTag, sizeof(std::size_t), 1, fp);
+          }
+          else if(version >= 4.1) {
+            fprintf(fp, "%zu %zu %zu %zu\n", numBlocks, numNodes, minTag,
+                    maxTag);
+          }
+          else {
+            fprintf(fp, "%zu %zu\n", numBlocks, numNodes);
+          }
+          for(auto e : fileEntities) {
+            if(e->vertices.empty()) continue;
+            // parametric coordinates are only valid on entities with the same
+            // dimension as their parent
+            bool parametric =
+              saveParametric && e->parent && e->parent->dim() == e->dim;
+            writeMSH4NodeBlock(e->dim, e->tag, e->vertices, fp, binary,
+                               parametric ? 1 : 0, scalingFactor, version);
+          }
+          if(binary) fprintf(fp, "\n");
+          fprintf(fp, "$EndNodes\n");
+        }
+
+        // elements
+        writeMSH4ElementBlocks(fp, elementsByType, numElements, binary,
+                               version);
+
+        writeMSH4PeriodicNodes(this, fp, binary, version);
+
+        // ghost cells
+        if(!ghosts.empty()) {
+          fprintf(fp, "$GhostElements\n");
+          if(binary) {
+            std::size_t ghostSize = ghosts.size(), one = 1;
+            fwrite(&ghostSize, sizeof(std::size_t), 1, fp);
+            for(auto &g : ghosts) {
+              std::size_t elmTag = g.first->getNum();
+              fwrite(&elmTag, sizeof(std::size_t), 1, fp);
+              fwrite(&g.second, sizeof(int), 1, fp);
+              fwrite(&one, sizeof(std::size_t), 1, fp);
+              fwrite(&p, sizeof(int), 1, fp);
+            }
+            fprintf(fp, "\n");
+          }
+          else {
+            fprintf(fp, "%zu\n", ghosts.size());
+            for(auto &g : ghosts)
+              fprintf(fp, "%zu %d 1 %d\n", g.first->getNum(), g.second, p);
+          }
+          fprintf(fp, "$EndGhostElements\n");
+        }
+
+        writeMSH4Parametrizations(this, fp, binary);
+
+        for(auto &a : _attributes) {
+          fprintf(fp, "$%s\n", a.first.c_str());
+          for(auto &s : a.second) fprintf(fp, "%s\n", s.c_str());
+          fprintf(fp, "$End%s\n", a.first.c_str());
+        }
+
+        fclose(fp);
+      }
+    }
+    catch(...) {
+      exceptions = true;
+    }
+
+    // release the memory used by this partition as soon as it is written
+    std::vector<std::pair<std::size_t, MElement *> >().swap(
+      partElements[p - 1]);
+    std::vector<std::pair<MElement *, int> >().swap(ghostElements[p - 1]);
+  }
+
+  if(exceptions) throw std::runtime_error(Msg::GetLastError());
+  if(failed) return 0;
+
+  double t2 = Cpu(), w2 = TimeOfDay();
+  Msg::StatusBar(true, "Done writing %d partitions (Wall %gs, CPU %gs)",
+                 numPart, w2 - w1, t2 - t1);
+  return 1;
+}
+
 static bool getPhyscialNameInfo(const std::string &name, int &parentPhysicalTag,
                                 std::vector<int> &partitions)
 {
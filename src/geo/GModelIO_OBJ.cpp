@@ -5,17 +5,20 @@
 //
 // Contributed by Giannis Nikiteas
 
+#include "Context.h"
 #include "GModel.h"
 #include "MElementCut.h"
 #include "MQuadrangle.h"
 #include "MTriangle.h"
 #include "OS.h"
 #include "discreteFace.h"
+#include "weldPoints.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #define TINYOBJLOADER_USE_DOUBLE
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
@@ -85,11 +88,24 @@ int GModel::readOBJ(const std::string &name)
   GFace *gf = new discreteFace(this, getMaxElementaryNumber(2) + 1);
   add(gf);
 
-  std::vector<MVertex *> vertices;
-  for(size_t i = 0; i < attrib.vertices.size(); i += 3) {
-    vertices.push_back(new MVertex(attrib.vertices[i], attrib.vertices[i + 1],
-                                   attrib.vertices[i + 2], gf));
+  // weld duplicate vertices (e.g. when each face has its own vertices), with
+  // the same tolerance as for STL files
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  const std::vector<double> &xyz = attrib.vertices;
+  SBoundingBox3d bbox = pointsBoundingBox(xyz, nthreads);
+  double eps =
+    norm(SVector3(bbox.max(), bbox.min())) * CTX::instance()->geom.tolerance;
+  std::vector<std::size_t> rep;
+  std::size_t nbWeld = weldPoints(xyz, eps, rep, nthreads);
+  if(nbWeld) Msg::Info("Welded %d duplicate nodes", (int)nbWeld);
+
+  std::vector<MVertex *> vertices(xyz.size() / 3, nullptr);
+  for(size_t i = 0; i < vertices.size(); i++) {
+    if(rep[i] == i)
+      vertices[i] = new MVertex(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2], gf);
   }
+  int nbDegen = 0;
 
   for(const auto &shape : shapes) {
     size_t index_offset = 0;
@@ -100,18 +116,31 @@ int GModel::readOBJ(const std::string &name)
         index_offset += fv;
         continue;
       }
+      // consecutive nodes of the face can be identical after welding: remove
+      // them, and skip the face if it has less than 3 nodes left or if some
+      // of its nodes are still repeated
       std::vector<MVertex *> faceVerts;
       faceVerts.reserve(fv);
       for(int k = 0; k < fv; k++) {
         int idx = shape.mesh.indices[index_offset + k].vertex_index;
-        faceVerts.push_back(vertices[idx]);
+        MVertex *v = vertices[rep[idx]];
+        if(faceVerts.empty() || faceVerts.back() != v) faceVerts.push_back(v);
       }
-      addFaceToGFace(gf, faceVerts);
+      while(faceVerts.size() > 1 && faceVerts.back() == faceVerts.front())
+        faceVerts.pop_back();
+      std::vector<MVertex *> sorted(faceVerts);
+      std::sort(sorted.begin(), sorted.end());
+      if(faceVerts.size() < 3 ||
+         std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+        nbDegen++;
+      else
+        addFaceToGFace(gf, faceVerts);
       index_offset += fv;
     }
   }
+  if(nbDegen) Msg::Warning("%d degenerate faces in OBJ file", nbDegen);
   _associateEntityWithMeshVertices();
-  _storeVerticesInEntities(vertices);
+  _storeVerticesInEntities(vertices); // will delete unused vertices
   return 1;
 }
 
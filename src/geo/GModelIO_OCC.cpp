@@ -116,7 +116,10 @@
 #include <TopTools_DataMapIteratorOfDataMapOfIntegerShape.hxx>
 #include <TopTools_DataMapIteratorOfDataMapOfShapeInteger.hxx>
 #include <TopTools_ListIteratorOfListOfShape.hxx>
+#include <TopTools_MapIteratorOfMapOfShape.hxx>
+#include <TopTools_MapOfShape.hxx>
 #include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
 #include <gce_MakeCirc.hxx>
 #include <gce_MakeElips.hxx>
 #include <gce_MakePln.hxx>
@@ -172,6 +175,9 @@ OCC_Internals::OCC_Internals()
   for(int i = 0; i < 6; i++)
     _maxTag[i] = CTX::instance()->geom.firstEntityTag - 1;
   _changed = true;
+  _syncAll = true;
+  _syncModel = nullptr;
+  for(int i = 0; i < 4; i++) _syncNumEntities[i] = 0;
   _attributes = new OCCAttributesRTree(CTX::instance()->geom.tolerance);
 }
 
@@ -187,6 +193,7 @@ void OCC_Internals::reset()
   _emap.Clear();
   _vmap.Clear();
   _unbind();
+  _syncAll = true;
 }
 
 void OCC_Internals::setMaxTag(int dim, int val)
@@ -236,6 +243,7 @@ void OCC_Internals::_bind(const TopoDS_Vertex &vertex, int tag, bool recursive)
     _tagVertex.Bind(tag, vertex);
     setMaxTag(0, tag);
     _changed = true;
+    _toSync.insert(std::make_pair(0, tag));
     _attributes->insert(new OCCAttributes(0, vertex));
   }
 }
@@ -258,6 +266,7 @@ void OCC_Internals::_bind(const TopoDS_Edge &edge, int tag, bool recursive)
     _tagEdge.Bind(tag, edge);
     setMaxTag(1, tag);
     _changed = true;
+    _toSync.insert(std::make_pair(1, tag));
     _attributes->insert(new OCCAttributes(1, edge));
   }
   if(recursive) {
@@ -321,6 +330,7 @@ void OCC_Internals::_bind(const TopoDS_Face &face, int tag, bool recursive)
     _tagFace.Bind(tag, face);
     setMaxTag(2, tag);
     _changed = true;
+    _toSync.insert(std::make_pair(2, tag));
     _attributes->insert(new OCCAttributes(2, face));
   }
   if(recursive) {
@@ -391,6 +401,7 @@ void OCC_Internals::_bind(const TopoDS_Solid &solid, int tag, bool recursive)
     _tagSolid.Bind(tag, solid);
     setMaxTag(3, tag);
     _changed = true;
+    _toSync.insert(std::make_pair(3, tag));
     _attributes->insert(new OCCAttributes(3, solid));
   }
   if(recursive) {
@@ -674,6 +685,10 @@ void OCC_Internals::_unbindWithoutChecks(TopoDS_Shape shape)
     }
   }
   for(int d = -2; d <= 3; d++) _recomputeMaxTag(d);
+  // sub-shapes of shapes that are still bound might have been unbound: they
+  // will be re-bound at the next synchronization, which should thus explore all
+  // the bound shapes
+  _syncAll = true;
 }
 
 void OCC_Internals::_unbind()
@@ -4636,7 +4651,7 @@ static void getColorRGB(const Quantity_Color &col, double &r, double &g,
 #endif
 }
 
-static void setShapeAttributes(OCCAttributesRTree *attributes,
+static void setShapeAttributes(std::vector<OCCAttributes *> &attributes,
                                const Handle_XCAFDoc_ShapeTool &shapeTool,
                                const Handle_XCAFDoc_ColorTool &colorTool,
                                const Handle_XCAFDoc_MaterialTool &materialTool,
@@ -4694,26 +4709,28 @@ static void setShapeAttributes(OCCAttributesRTree *attributes,
     else if(phys.size()) {
       Msg::Info(" - Label '%s' (%dD)", phys.c_str(), dim);
     }
-    if(phys.size()) { attributes->insert(new OCCAttributes(dim, shape, phys)); }
+    if(phys.size()) {
+      attributes.push_back(new OCCAttributes(dim, shape, phys));
+    }
 
     Quantity_Color col;
     if(colorTool->GetColor(label, XCAFDoc_ColorGen, col)) {
       double r, g, b;
       getColorRGB(col, r, g, b);
       Msg::Info(" - Color (%g, %g, %g) (%dD)", r, g, b, dim);
-      attributes->insert(new OCCAttributes(dim, shape, r, g, b, 1.));
+      attributes.push_back(new OCCAttributes(dim, shape, r, g, b, 1.));
     }
     else if(colorTool->GetColor(label, XCAFDoc_ColorSurf, col)) {
       double r, g, b;
       getColorRGB(col, r, g, b);
       Msg::Info(" - Color (%g, %g, %g) (%dD & Surfaces)", r, g, b, dim);
-      attributes->insert(new OCCAttributes(dim, shape, r, g, b, 1., 1));
+      attributes.push_back(new OCCAttributes(dim, shape, r, g, b, 1., 1));
     }
     else if(colorTool->GetColor(label, XCAFDoc_ColorCurv, col)) {
       double r, g, b;
       getColorRGB(col, r, g, b);
       Msg::Info(" - Color (%g, %g, %g) (%dD & Curves)", r, g, b, dim);
-      attributes->insert(new OCCAttributes(dim, shape, r, g, b, 1., 2));
+      attributes.push_back(new OCCAttributes(dim, shape, r, g, b, 1., 2));
     }
     // check explicit coloring of boundary entities
     if(dim == 3) {
@@ -4726,7 +4743,7 @@ static void setShapeAttributes(OCCAttributesRTree *attributes,
           getColorRGB(col, r, g, b);
           Msg::Info(" - Color (%g, %g, %g) (Surface)", r, g, b);
           TopoDS_Face face = TopoDS::Face(xp2.Current());
-          attributes->insert(new OCCAttributes(2, face, r, g, b, 1.));
+          attributes.push_back(new OCCAttributes(2, face, r, g, b, 1.));
         }
         xp2.Next();
       }
@@ -4741,7 +4758,7 @@ static void setShapeAttributes(OCCAttributesRTree *attributes,
           getColorRGB(col, r, g, b);
           Msg::Info(" - Color (%g, %g, %g) (Curve)", r, g, b);
           TopoDS_Edge edge = TopoDS::Edge(xp1.Current());
-          attributes->insert(new OCCAttributes(1, edge, r, g, b, 1.));
+          attributes.push_back(new OCCAttributes(1, edge, r, g, b, 1.));
         }
         xp1.Next();
       }
@@ -4780,9 +4797,12 @@ void readAttributes(OCCAttributesRTree *attributes, T &reader,
     XCAFDoc_DocumentTool::ColorTool(mainLabel);
   Handle_XCAFDoc_MaterialTool materialTool =
     XCAFDoc_DocumentTool::MaterialTool(mainLabel);
-  // traverse the labels recursively to set attributes on shapes
-  setShapeAttributes(attributes, shapeTool, colorTool, materialTool, mainLabel,
+  // traverse the labels recursively to collect the attributes on shapes, and
+  // insert them all at once
+  std::vector<OCCAttributes *> attr;
+  setShapeAttributes(attr, shapeTool, colorTool, materialTool, mainLabel,
                      TopLoc_Location(), "", false);
+  attributes->insert(attr);
 }
 
 #endif
@@ -4799,11 +4819,15 @@ bool OCC_Internals::importShapes(const std::string &fileName,
 
   std::vector<std::string> split = SplitFileName(fileName);
 
+  // wall time of each import phase (reading, transfer with attributes, healing
+  // and binding)
+  double t1 = TimeOfDay(), t2 = t1, t3 = t1;
   TopoDS_Shape result;
   try {
     if(format == "brep" || split[2] == ".brep" || split[2] == ".BREP") {
       BRep_Builder aBuilder;
       BRepTools::Read(result, fileName.c_str(), aBuilder);
+      t2 = TimeOfDay();
     }
     else if(format == "step" || split[2] == ".step" || split[2] == ".stp" ||
             split[2] == ".STEP" || split[2] == ".STP") {
@@ -4818,6 +4842,7 @@ bool OCC_Internals::importShapes(const std::string &fileName,
         Msg::Error("Could not read file '%s'", fileName.c_str());
         return false;
       }
+      t2 = TimeOfDay();
       if(CTX::instance()->geom.occImportLabels)
         readAttributes(_attributes, cafreader, "STEP-XCAF");
       reader = cafreader.ChangeReader();
@@ -4826,6 +4851,7 @@ bool OCC_Internals::importShapes(const std::string &fileName,
         Msg::Error("Could not read file '%s'", fileName.c_str());
         return false;
       }
+      t2 = TimeOfDay();
 #endif
       reader.NbRootsForTransfer();
       reader.TransferRoots();
@@ -4840,6 +4866,7 @@ bool OCC_Internals::importShapes(const std::string &fileName,
         Msg::Error("Could not read file '%s'", fileName.c_str());
         return false;
       }
+      t2 = TimeOfDay();
       if(CTX::instance()->geom.occImportLabels)
         readAttributes(_attributes, reader, "IGES-XCAF");
 #else
@@ -4848,6 +4875,7 @@ bool OCC_Internals::importShapes(const std::string &fileName,
         Msg::Error("Could not read file '%s'", fileName.c_str());
         return false;
       }
+      t2 = TimeOfDay();
 #endif
       reader.NbRootsForTransfer();
       reader.TransferRoots();
@@ -4861,6 +4889,7 @@ bool OCC_Internals::importShapes(const std::string &fileName,
     Msg::Error("OpenCASCADE exception %s", err.GetMessageString());
     return false;
   }
+  t3 = TimeOfDay();
 
   BRepTools::Clean(result);
 
@@ -4870,9 +4899,13 @@ bool OCC_Internals::importShapes(const std::string &fileName,
     CTX::instance()->geom.occFixSmallEdges,
     CTX::instance()->geom.occFixSmallFaces, CTX::instance()->geom.occSewFaces,
     CTX::instance()->geom.occMakeSolids, CTX::instance()->geom.occScaling);
+  double t4 = TimeOfDay();
 
   _multiBind(result, -1, outDimTags, highestDimOnly, true);
+  double t5 = TimeOfDay();
 
+  Msg::Info("Imported '%s' (read %gs, transfer %gs, healing %gs, binding %gs)",
+            fileName.c_str(), t2 - t1, t3 - t2, t4 - t3, t5 - t4);
   return true;
 }
 
@@ -5180,6 +5213,7 @@ void OCC_Internals::setMeshSize(int dim, int tag, double size)
     // first remove any other constraint
     _attributes->remove(a);
     _attributes->insert(a);
+    _toSync.insert(std::make_pair(0, tag));
   }
 }
 
@@ -5498,7 +5532,25 @@ void OCC_Internals::synchronize(GModel *model)
   for(std::size_t i = 0; i < removed.size(); i++) delete removed[i];
   _toRemove.clear();
 
-  // iterate over all shapes with tags, and import them into the (sub)shape
+  // only import the shapes that have been bound or modified since the last
+  // synchronization, unless some entities have been removed from the model
+  // behind our back (in which case they should be recreated) or some bound
+  // shapes might have unbound sub-shapes
+  bool syncAll = _syncAll || model != _syncModel;
+  if(!syncAll) {
+    std::size_t numRemoved[4] = {0, 0, 0, 0};
+    for(std::size_t i = 0; i < removed.size(); i++) {
+      int dim = removed[i]->dim();
+      if(dim >= 0 && dim < 4) numRemoved[dim]++;
+    }
+    std::size_t num[4] = {model->getNumVertices(), model->getNumEdges(),
+                          model->getNumFaces(), model->getNumRegions()};
+    for(int dim = 0; dim < 4; dim++) {
+      if(num[dim] + numRemoved[dim] < _syncNumEntities[dim]) syncAll = true;
+    }
+  }
+
+  // iterate over the shapes with tags, and import them into the (sub)shape
   // _maps
   _somap.Clear();
   _shmap.Clear();
@@ -5506,14 +5558,25 @@ void OCC_Internals::synchronize(GModel *model)
   _wmap.Clear();
   _emap.Clear();
   _vmap.Clear();
-  TopTools_DataMapIteratorOfDataMapOfIntegerShape exp0(_tagVertex);
-  for(; exp0.More(); exp0.Next()) _addShapeToMaps(exp0.Value());
-  TopTools_DataMapIteratorOfDataMapOfIntegerShape exp1(_tagEdge);
-  for(; exp1.More(); exp1.Next()) _addShapeToMaps(exp1.Value());
-  TopTools_DataMapIteratorOfDataMapOfIntegerShape exp2(_tagFace);
-  for(; exp2.More(); exp2.Next()) _addShapeToMaps(exp2.Value());
-  TopTools_DataMapIteratorOfDataMapOfIntegerShape exp3(_tagSolid);
-  for(; exp3.More(); exp3.Next()) _addShapeToMaps(exp3.Value());
+  if(syncAll) {
+    TopTools_DataMapIteratorOfDataMapOfIntegerShape exp0(_tagVertex);
+    for(; exp0.More(); exp0.Next()) _addShapeToMaps(exp0.Value());
+    TopTools_DataMapIteratorOfDataMapOfIntegerShape exp1(_tagEdge);
+    for(; exp1.More(); exp1.Next()) _addShapeToMaps(exp1.Value());
+    TopTools_DataMapIteratorOfDataMapOfIntegerShape exp2(_tagFace);
+    for(; exp2.More(); exp2.Next()) _addShapeToMaps(exp2.Value());
+    TopTools_DataMapIteratorOfDataMapOfIntegerShape exp3(_tagSolid);
+    for(; exp3.More(); exp3.Next()) _addShapeToMaps(exp3.Value());
+  }
+  else {
+    // _toSync is sorted by dimension, so that lower dimensional shapes are
+    // added first, as in a complete synchronization
+    for(auto it = _toSync.begin(); it != _toSync.end(); ++it) {
+      if(_isBound(it->first, it->second))
+        _addShapeToMaps(_find(it->first, it->second));
+    }
+    Msg::Debug("Sync is importing %zu new or modified shapes", _toSync.size());
+  }
 
   // import all shapes in _maps into the GModel, preserving all explicit tags
   int vTagMax = std::max(model->getMaxElementaryNumber(0), getMaxTag(0));
@@ -5650,6 +5713,14 @@ void OCC_Internals::synchronize(GModel *model)
   Msg::Debug("%d curves", model->getNumEdges());
   Msg::Debug("%d surfaces", model->getNumFaces());
   Msg::Debug("%d volumes", model->getNumRegions());
+
+  _toSync.clear();
+  _syncAll = false;
+  _syncModel = model;
+  _syncNumEntities[0] = model->getNumVertices();
+  _syncNumEntities[1] = model->getNumEdges();
+  _syncNumEntities[2] = model->getNumFaces();
+  _syncNumEntities[3] = model->getNumRegions();
   _changed = false;
 }
 
@@ -5833,51 +5904,83 @@ void OCC_Internals::_addShapeToMaps(const TopoDS_Shape &shape)
   }
 }
 
-void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
-                               bool fixDegenerated, bool fixSmallEdges,
-                               bool fixSmallFaces, bool sewFaces,
-                               bool makeSolids, double scaling)
+static double getSurfaceArea(const TopoDS_Shape &shape, int nthreads)
 {
-  if(scaling != 1.0) {
-    Msg::Info("Scaling geometry (factor: %g)", scaling);
-    gp_Trsf t;
-    t.SetScaleFactor(scaling);
-    BRepBuilderAPI_Transform trsf(myshape, t);
-    myshape = trsf.Shape();
+  std::vector<TopoDS_Face> faces;
+  TopExp_Explorer exp0;
+  for(exp0.Init(shape, TopAbs_FACE); exp0.More(); exp0.Next())
+    faces.push_back(TopoDS::Face(exp0.Current()));
+  double area = 0;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+  reduction(+ : area)
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    GProp_GProps system;
+    BRepGProp::SurfaceProperties(faces[i], system);
+    area += system.Mass();
   }
+  return area;
+}
 
-  if(!fixDegenerated && !fixSmallEdges && !fixSmallFaces && !sewFaces &&
-     !makeSolids)
-    return;
+static bool getIndependentSolids(const TopoDS_Shape &shape,
+                                 std::vector<TopoDS_Shape> &solids)
+{
+  // only consider flat compounds of solids, so that the compound can be
+  // rebuilt from the healed solids without changing its hierarchy
+  if(shape.ShapeType() != TopAbs_COMPOUND) return false;
+  for(TopoDS_Iterator it(shape); it.More(); it.Next()) {
+    if(it.Value().ShapeType() != TopAbs_SOLID) {
+      solids.clear();
+      return false;
+    }
+    solids.push_back(it.Value());
+  }
+  // solids are independent if they share no vertex: the locations are ignored
+  // so that instances of the same underlying solid are also detected
+  TopTools_MapOfShape seen;
+  TopExp_Explorer exp1;
+  for(std::size_t i = 0; i < solids.size(); i++) {
+    TopTools_MapOfShape vertices;
+    for(exp1.Init(solids[i], TopAbs_VERTEX); exp1.More(); exp1.Next())
+      vertices.Add(exp1.Current().Located(TopLoc_Location()));
+    TopTools_MapIteratorOfMapOfShape it(vertices);
+    for(; it.More(); it.Next()) {
+      if(!seen.Add(it.Key())) {
+        solids.clear();
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-  Msg::Info("Healing shapes (tolerance: %g)", tolerance);
-  double t1 = Cpu(), w1 = TimeOfDay();
+// messages of healShapeLocally(): printed directly, or stored in log (with a
+// flag for warnings) when several shapes are healed concurrently
+typedef std::vector<std::pair<bool, std::string> > healLog;
 
-  _somap.Clear();
-  _shmap.Clear();
-  _fmap.Clear();
-  _wmap.Clear();
-  _emap.Clear();
-  _vmap.Clear();
-  _addShapeToMaps(myshape);
+static void healInfo(healLog *log, const std::string &msg)
+{
+  if(log)
+    log->push_back(std::make_pair(false, msg));
+  else
+    Msg::Info("%s", msg.c_str());
+}
 
-  TopExp_Explorer exp0, exp1;
-  int nrc = 0, nrcs = 0;
-  int nrso = _somap.Extent(), nrsh = _shmap.Extent(), nrf = _fmap.Extent();
-  int nrw = _wmap.Extent(), nre = _emap.Extent(), nrv = _vmap.Extent();
-  for(exp0.Init(myshape, TopAbs_COMPOUND); exp0.More(); exp0.Next()) nrc++;
-  for(exp0.Init(myshape, TopAbs_COMPSOLID); exp0.More(); exp0.Next()) nrcs++;
+static void healWarning(healLog *log, const std::string &msg)
+{
+  if(log)
+    log->push_back(std::make_pair(true, msg));
+  else
+    Msg::Warning("%s", msg.c_str());
+}
 
-  double surfacecont = 0;
-  for(exp0.Init(myshape, TopAbs_FACE); exp0.More(); exp0.Next()) {
-    TopoDS_Face face = TopoDS::Face(exp0.Current());
-    GProp_GProps system;
-    BRepGProp::SurfaceProperties(face, system);
-    surfacecont += system.Mass();
-  }
+static void healShapeLocally(TopoDS_Shape &myshape, double tolerance,
+                             bool fixDegenerated, bool fixSmallEdges,
+                             bool fixSmallFaces, healLog *log = nullptr)
+{
+  TopExp_Explorer exp0, exp1;
 
   if(fixDegenerated) {
-    Msg::Info(" - Fixing degenerated edges and faces");
+    healInfo(log, " - Fixing degenerated edges and faces");
 
     {
       ShapeBuild_ReShape rebuild;
@@ -5901,17 +6004,17 @@ void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
         if(sff.Status(ShapeExtend_DONE1) || sff.Status(ShapeExtend_DONE2) ||
            sff.Status(ShapeExtend_DONE3) || sff.Status(ShapeExtend_DONE4) ||
            sff.Status(ShapeExtend_DONE5)) {
-          Msg::Info(" . Repaired face");
+          healInfo(log, " . Repaired face");
           if(sff.Status(ShapeExtend_DONE1))
-            Msg::Info(" . Some wires are fixed");
+            healInfo(log, " . Some wires are fixed");
           else if(sff.Status(ShapeExtend_DONE2))
-            Msg::Info(" . Orientation of wires fixed");
+            healInfo(log, " . Orientation of wires fixed");
           else if(sff.Status(ShapeExtend_DONE3))
-            Msg::Info(" . Missing seam added");
+            healInfo(log, " . Missing seam added");
           else if(sff.Status(ShapeExtend_DONE4))
-            Msg::Info(" . Small area wire removed");
+            healInfo(log, " . Small area wire removed");
           else if(sff.Status(ShapeExtend_DONE5))
-            Msg::Info(" . Natural bounds added");
+            healInfo(log, " . Natural bounds added");
 
           TopoDS_Face newface = sff.Face();
           rebuild.Replace(face, newface);
@@ -5931,7 +6034,7 @@ void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
   }
 
   if(fixSmallEdges) {
-    Msg::Info(" - Fixing small edges");
+    healInfo(log, " - Fixing small edges");
 
     {
       ShapeBuild_ReShape rebuild;
@@ -5952,19 +6055,20 @@ void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
              !(sfw.StatusSmall(ShapeExtend_FAIL1) ||
                sfw.StatusSmall(ShapeExtend_FAIL2) ||
                sfw.StatusSmall(ShapeExtend_FAIL3))) {
-            Msg::Info(" . Fixed small edge in wire");
+            healInfo(log, " . Fixed small edge in wire");
             replace = true;
           }
           else if(sfw.StatusSmall(ShapeExtend_FAIL1))
-            Msg::Warning("Failed to fix small edge in wire, edge cannot be "
-                         "checked (no 3d curve and no pcurve)");
+            healWarning(log, "Failed to fix small edge in wire, edge cannot "
+                             "be checked (no 3d curve and no pcurve)");
           else if(sfw.StatusSmall(ShapeExtend_FAIL2))
-            Msg::Warning("Failed to fix small edge in wire, edge is null-"
-                         "length and has different vertives at begin and end, "
-                         "and lockvtx is True or ModifiyTopologyMode is False");
+            healWarning(log, "Failed to fix small edge in wire, edge is "
+                             "null-length and has different vertives at begin "
+                             "and end, and lockvtx is True or "
+                             "ModifiyTopologyMode is False");
           else if(sfw.StatusSmall(ShapeExtend_FAIL3))
-            Msg::Warning("Failed to fix small edge in wire, CheckConnected has "
-                         "failed");
+            healWarning(log, "Failed to fix small edge in wire, "
+                             "CheckConnected has failed");
 
           replace = sfw.FixEdgeCurves() || replace;
           replace = sfw.FixDegenerated() || replace;
@@ -5987,7 +6091,7 @@ void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
         GProp_GProps system;
         BRepGProp::LinearProperties(edge, system);
         if(system.Mass() < tolerance) {
-          Msg::Info("  - Removing degenerated edge");
+          healInfo(log, "  - Removing degenerated edge");
           rebuild.Remove(edge);
         }
       }
@@ -6009,41 +6113,151 @@ void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
     sfwf.ModeDropSmallEdges() = Standard_True;
 
     if(sfwf.FixWireGaps()) {
-      Msg::Info(" - Fixing wire gaps");
-      if(sfwf.StatusWireGaps(ShapeExtend_OK)) Msg::Info("  no gaps found");
+      healInfo(log, " - Fixing wire gaps");
+      if(sfwf.StatusWireGaps(ShapeExtend_OK)) healInfo(log, "  no gaps found");
       if(sfwf.StatusWireGaps(ShapeExtend_DONE1))
-        Msg::Info(" . Some 2D gaps fixed");
+        healInfo(log, " . Some 2D gaps fixed");
       if(sfwf.StatusWireGaps(ShapeExtend_DONE2))
-        Msg::Info(" . Some 3D gaps fixed");
+        healInfo(log, " . Some 3D gaps fixed");
       if(sfwf.StatusWireGaps(ShapeExtend_FAIL1))
-        Msg::Info(" . Failed to fix some 2D gaps");
+        healInfo(log, " . Failed to fix some 2D gaps");
       if(sfwf.StatusWireGaps(ShapeExtend_FAIL2))
-        Msg::Info(" . Failed to fix some 3D gaps");
+        healInfo(log, " . Failed to fix some 3D gaps");
     }
 
     sfwf.SetPrecision(tolerance);
 
     if(sfwf.FixSmallEdges()) {
-      Msg::Info(" - Fixing wire frames");
+      healInfo(log, " - Fixing wire frames");
       if(sfwf.StatusSmallEdges(ShapeExtend_OK))
-        Msg::Info(" . No small edges found");
+        healInfo(log, " . No small edges found");
       if(sfwf.StatusSmallEdges(ShapeExtend_DONE1))
-        Msg::Info(" . Some small edges fixed");
+        healInfo(log, " . Some small edges fixed");
       if(sfwf.StatusSmallEdges(ShapeExtend_FAIL1))
-        Msg::Info(" . Failed to fix some small edges");
+        healInfo(log, " . Failed to fix some small edges");
     }
 
     myshape = sfwf.Shape();
   }
 
   if(fixSmallFaces) {
-    Msg::Info(" - Fixing spot and strip faces");
+    healInfo(log, " - Fixing spot and strip faces");
     ShapeFix_FixSmallFace sffsm;
     sffsm.Init(myshape);
     sffsm.SetPrecision(tolerance);
     sffsm.Perform();
     myshape = sffsm.FixShape();
   }
+}
+
+void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
+                               bool fixDegenerated, bool fixSmallEdges,
+                               bool fixSmallFaces, bool sewFaces,
+                               bool makeSolids, double scaling)
+{
+  if(scaling != 1.0) {
+    Msg::Info("Scaling geometry (factor: %g)", scaling);
+    gp_Trsf t;
+    t.SetScaleFactor(scaling);
+    BRepBuilderAPI_Transform trsf(myshape, t);
+    myshape = trsf.Shape();
+  }
+
+  if(!fixDegenerated && !fixSmallEdges && !fixSmallFaces && !sewFaces &&
+     !makeSolids)
+    return;
+
+  Msg::Info("Healing shapes (tolerance: %g)", tolerance);
+  double t1 = Cpu(), w1 = TimeOfDay();
+
+  _somap.Clear();
+  _shmap.Clear();
+  _fmap.Clear();
+  _wmap.Clear();
+  _emap.Clear();
+  _vmap.Clear();
+  _addShapeToMaps(myshape);
+
+  TopExp_Explorer exp0, exp1;
+  int nrc = 0, nrcs = 0;
+  int nrso = _somap.Extent(), nrsh = _shmap.Extent(), nrf = _fmap.Extent();
+  int nrw = _wmap.Extent(), nre = _emap.Extent(), nrv = _vmap.Extent();
+  for(exp0.Init(myshape, TopAbs_COMPOUND); exp0.More(); exp0.Next()) nrc++;
+  for(exp0.Init(myshape, TopAbs_COMPSOLID); exp0.More(); exp0.Next()) nrcs++;
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  double surfacecont = getSurfaceArea(myshape, nthreads);
+
+  if(fixDegenerated || fixSmallEdges || fixSmallFaces) {
+    // these fixes only modify the faces, wires and edges locally: if the shape
+    // is made of solids that share no sub-shape, heal each solid concurrently
+    std::vector<TopoDS_Shape> parts;
+    if(nthreads > 1 && getIndependentSolids(myshape, parts) &&
+       parts.size() > 1) {
+      Msg::Info(" - Healing %d independent solids concurrently",
+                (int)parts.size());
+      std::vector<healLog> logs(parts.size());
+      std::vector<std::string> errors(parts.size());
+      bool ok = true;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+      for(std::size_t i = 0; i < parts.size(); i++) {
+        try {
+          healShapeLocally(parts[i], tolerance, fixDegenerated, fixSmallEdges,
+                           fixSmallFaces, &logs[i]);
+        } catch(Standard_Failure &err) {
+          errors[i] = err.GetMessageString();
+#pragma omp atomic write
+          ok = false;
+        } catch(...) {
+          errors[i] = "unknown";
+#pragma omp atomic write
+          ok = false;
+        }
+      }
+      if(ok) {
+        // print each distinct message once, in the order of the solids
+        std::vector<std::pair<bool, std::string> > messages;
+        std::map<std::pair<bool, std::string>, int> count;
+        for(std::size_t i = 0; i < logs.size(); i++) {
+          for(std::size_t j = 0; j < logs[i].size(); j++) {
+            if(!count[logs[i][j]]++) messages.push_back(logs[i][j]);
+          }
+        }
+        for(std::size_t i = 0; i < messages.size(); i++) {
+          std::string msg = messages[i].second;
+          int n = count[messages[i]];
+          if(n > 1) msg += " (" + std::to_string(n) + " times)";
+          if(messages[i].first)
+            Msg::Warning("%s", msg.c_str());
+          else
+            Msg::Info("%s", msg.c_str());
+        }
+        BRep_Builder b;
+        TopoDS_Compound c;
+        b.MakeCompound(c);
+        for(std::size_t i = 0; i < parts.size(); i++) b.Add(c, parts[i]);
+        myshape = c;
+      }
+      else {
+        // the solids are copies: heal the original shape serially instead
+        for(std::size_t i = 0; i < errors.size(); i++) {
+          if(errors[i].size())
+            Msg::Warning("OpenCASCADE exception %s while healing solid %d",
+                         errors[i].c_str(), (int)i + 1);
+        }
+        Msg::Warning("Could not heal solids concurrently, healing the whole "
+                     "shape serially");
+        healShapeLocally(myshape, tolerance, fixDegenerated, fixSmallEdges,
+                         fixSmallFaces);
+      }
+    }
+    else {
+      healShapeLocally(myshape, tolerance, fixDegenerated, fixSmallEdges,
+                       fixSmallFaces);
+    }
+  }
 
   if(sewFaces) {
     Msg::Info(" - Sewing faces");
@@ -6106,13 +6320,7 @@ void OCC_Internals::_healShape(TopoDS_Shape &myshape, double tolerance,
     }
   }
 
-  double newsurfacecont = 0;
-  for(exp0.Init(myshape, TopAbs_FACE); exp0.More(); exp0.Next()) {
-    TopoDS_Face face = TopoDS::Face(exp0.Current());
-    GProp_GProps system;
-    BRepGProp::SurfaceProperties(face, system);
-    newsurfacecont += system.Mass();
-  }
+  double newsurfacecont = getSurfaceArea(myshape, nthreads);
 
   _somap.Clear();
   _shmap.Clear();
@@ -62,6 +62,19 @@ private:
   // removed from the model at the next synchronization
   std::set<std::pair<int, int> > _toRemove;
 
+  // cache of <dim,tag> pairs corresponding to entities that have been bound,
+  // or whose attributes have changed, since the last synchronization: only
+  // these (and their sub-shapes) are imported at the next synchronization
+  std::set<std::pair<int, int> > _toSync;
+
+  // force the next synchronization to import all the bound shapes (e.g. when
+  // sub-shapes of bound shapes have been unbound); the model and its number of
+  // entities after the last synchronization are used to detect entities that
+  // have been removed from the model directly
+  bool _syncAll;
+  GModel *_syncModel;
+  std::size_t _syncNumEntities[4];
+
   // cache of <dim,tag> pairs corresponding to entities that should not be
   // unbound during boolean operations
   std::set<std::pair<int, int> > _toPreserve;
@@ -7,9 +7,11 @@
 #include <string.h>
 #include "GmshConfig.h"
 #include "GModel.h"
+#include "Context.h"
 #include "MTriangle.h"
 #include "OS.h"
 #include "StringUtils.h"
+#include "weldPoints.h"
 
 #if defined(HAVE_POST)
 #include "PView.h"
@@ -46,6 +48,44 @@ static bool getProperties(int num, int *indices, std::vector<double> &vec,
 }
 #endif
 
+static void weldMeshVertices(std::vector<MVertex *> &vertexVector,
+                             std::vector<MElement *> &tris)
+{
+  // weld duplicate vertices, with the same tolerance as for STL files, and
+  // remove the triangles that become degenerate
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  std::vector<double> xyz(3 * vertexVector.size());
+  for(std::size_t i = 0; i < vertexVector.size(); i++) {
+    if(!vertexVector[i]) return; // incomplete file
+    vertexVector[i]->setIndex(i);
+    xyz[3 * i] = vertexVector[i]->x();
+    xyz[3 * i + 1] = vertexVector[i]->y();
+    xyz[3 * i + 2] = vertexVector[i]->z();
+  }
+  SBoundingBox3d bbox = pointsBoundingBox(xyz, nthreads);
+  double eps =
+    norm(SVector3(bbox.max(), bbox.min())) * CTX::instance()->geom.tolerance;
+  std::vector<std::size_t> rep;
+  std::size_t nbWeld = weldPoints(xyz, eps, rep, nthreads);
+  if(!nbWeld) return;
+  Msg::Info("Welded %d duplicate nodes", (int)nbWeld);
+  std::size_t n = 0;
+  for(std::size_t i = 0; i < tris.size(); i++) {
+    MElement *e = tris[i];
+    for(int k = 0; k < 3; k++)
+      e->setVertex(k, vertexVector[rep[e->getVertex(k)->getIndex()]]);
+    if(e->getVertex(0) == e->getVertex(1) ||
+       e->getVertex(0) == e->getVertex(2) || e->getVertex(1) == e->getVertex(2))
+      delete e;
+    else
+      tris[n++] = e;
+  }
+  if(n < tris.size())
+    Msg::Warning("%d degenerate triangles in PLY file", (int)(tris.size() - n));
+  tris.resize(n);
+}
+
 int GModel::readPLY(const std::string &name)
 {
   FILE *fp = Fopen(name.c_str(), "rb");
@@ -165,10 +205,15 @@ int GModel::readPLY(const std::string &name)
     }
   }
 
+  // weld duplicate vertices (not when there are properties, which are
+  // associated with the vertex numbers)
+  if(!nbView && elements[0].count(elementary))
+    weldMeshVertices(vertexVector, elements[0][elementary]);
+
   for(int i = 0; i < (int)(sizeof(elements) / sizeof(elements[0])); i++)
     _storeElementsInEntities(elements[i]);
   _associateEntityWithMeshVertices();
-  _storeVerticesInEntities(vertexVector);
+  _storeVerticesInEntities(vertexVector); // will delete unused vertices
 
 #if defined(HAVE_POST)
   // create PViews here
@@ -270,10 +315,13 @@ int GModel::readPLY2(const std::string &name)
     }
   }
 
+  if(elements[0].count(elementary))
+    weldMeshVertices(vertexVector, elements[0][elementary]);
+
   for(int i = 0; i < (int)(sizeof(elements) / sizeof(elements[0])); i++)
     _storeElementsInEntities(elements[i]);
   _associateEntityWithMeshVertices();
-  _storeVerticesInEntities(vertexVector);
+  _storeVerticesInEntities(vertexVector); // will delete unused vertices
 
   fclose(fp);
   return 1;
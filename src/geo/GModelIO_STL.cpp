@@ -4,6 +4,8 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include <string>
 #include <algorithm>
@@ -13,23 +15,158 @@
 #include "MLine.h"
 #include "MTriangle.h"
 #include "MQuadrangle.h"
-#include "MVertexRTree.h"
+#include "SVector3.h"
+#include "weldPoints.h"
 #include "discreteFace.h"
 #include "StringUtils.h"
 #include "Context.h"
 
 static bool invalidChar(char c) { return !(c >= 32 && c <= 126); }
 
-static char *fgets0(char *buffer, int size, FILE *fp)
+static bool startsWith(const char *p, const char *end, const char *lower,
+                       const char *upper)
 {
-  // same as fgets but ignores empty lines
-  while(1) {
-    char *ret = fgets(buffer, size, fp);
-    if(!ret) return nullptr;
-    for(std::size_t i = 0; i < strlen(ret); i++) {
-      if(!isspace(ret[i])) return ret;
+  // check if [p, end) starts with a keyword, in lower or upper case
+  std::size_t n = strlen(lower);
+  if((std::size_t)(end - p) < n) return false;
+  return !strncmp(p, lower, n) || !strncmp(p, upper, n);
+}
+
+// vertices and solids found in a chunk of an ASCII STL file
+struct STLChunk {
+  std::vector<double> xyz;
+  std::vector<std::pair<std::size_t, std::string> > solids;
+  STLChunk() {}
+};
+
+static void parseSTLChunk(const char *p, const char *end, STLChunk &chunk)
+{
+  while(p < end) {
+    while(p < end && isspace(*p)) p++;
+    if(p >= end) break;
+    const char *eol = p;
+    while(eol < end && *eol != '\n') eol++;
+    if(startsWith(p, eol, "vertex", "VERTEX")) {
+      // "vertex x y z"
+      char *q0 = (char *)p + 6, *q1, *q2, *q3;
+      double x = strtod(q0, &q1);
+      double y = strtod(q1, &q2);
+      double z = strtod(q2, &q3);
+      if(q1 != q0 && q2 != q1 && q3 != q2 && q3 <= eol) {
+        chunk.xyz.push_back(x);
+        chunk.xyz.push_back(y);
+        chunk.xyz.push_back(z);
+      }
+    }
+    else if(startsWith(p, eol, "solid", "SOLID")) {
+      // "solid name"
+      std::string name;
+      if(eol - p > 6) name = std::string(p + 6, eol);
+      chunk.solids.push_back(std::make_pair(chunk.xyz.size() / 3, name));
+    }
+    // "facet normal", "outer loop", "endloop", "endfacet" and "endsolid" lines
+    // carry no information
+    p = eol;
+  }
+}
+
+static void readSTLASCII(const std::vector<char> &data, int nthreads,
+                         std::vector<double> &xyz,
+                         std::vector<std::size_t> &solids,
+                         std::vector<std::string> &names)
+{
+  // split the file in chunks starting at the beginning of a line, and parse
+  // them concurrently
+  const char *begin = &data[0], *end = &data[0] + data.size() - 1;
+  std::size_t size = end - begin;
+  std::size_t nchunks = std::max<std::size_t>(
+    1, std::min<std::size_t>(size / (1 << 20) + 1, 16 * nthreads));
+  std::vector<const char *> starts(nchunks + 1, end);
+  starts[0] = begin;
+  for(std::size_t i = 1; i < nchunks; i++) {
+    const char *p = std::max(begin + i * (size / nchunks), starts[i - 1]);
+    while(p < end && *p != '\n') p++;
+    starts[i] = p;
+  }
+  std::vector<STLChunk> chunks(nchunks);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < nchunks; i++)
+    parseSTLChunk(starts[i], starts[i + 1], chunks[i]);
+
+  // gather the vertices and the solids
+  std::vector<std::size_t> offset(nchunks + 1, 0);
+  for(std::size_t i = 0; i < nchunks; i++) {
+    offset[i + 1] = offset[i] + chunks[i].xyz.size() / 3;
+    for(auto &s : chunks[i].solids) {
+      solids.push_back(offset[i] + s.first);
+      names.push_back(s.second);
     }
   }
+  if(solids.empty() || solids[0]) {
+    solids.insert(solids.begin(), 0);
+    names.insert(names.begin(), "");
+  }
+  xyz.resize(3 * offset[nchunks]);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < nchunks; i++) {
+    std::copy(chunks[i].xyz.begin(), chunks[i].xyz.end(),
+              xyz.begin() + 3 * offset[i]);
+    std::vector<double>().swap(chunks[i].xyz);
+  }
+}
+
+static void readSTLBinary(const std::vector<char> &data, int nthreads,
+                          std::vector<double> &xyz,
+                          std::vector<std::size_t> &solids,
+                          std::vector<std::string> &names)
+{
+  // the file can contain several solids, each with an 80 byte header, the
+  // number of facets and 50 bytes per facet
+  std::size_t size = data.size() - 1, pos = 0;
+  while(pos + 84 <= size) {
+    char header[80];
+    memcpy(header, &data[pos], 80);
+    header[79] = '\0';
+    unsigned int nfacets = 0;
+    memcpy(&nfacets, &data[pos + 80], sizeof(unsigned int));
+    pos += 84;
+    bool swap = false;
+    if(nfacets > 100000000) {
+      Msg::Info("Swapping bytes from binary file");
+      swap = true;
+      SwapBytes((char *)&nfacets, sizeof(unsigned int), 1);
+    }
+    if(!nfacets) continue;
+    names.push_back(header);
+    solids.push_back(xyz.size() / 3);
+    if(pos + 50 * (std::size_t)nfacets > size) break;
+    std::size_t n = xyz.size();
+    xyz.resize(n + 9 * (std::size_t)nfacets);
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t i = 0; i < nfacets; i++) {
+      float f[12];
+      memcpy(f, &data[pos + 50 * i], 12 * sizeof(float));
+      if(swap) SwapBytes((char *)f, sizeof(float), 12);
+      for(int j = 0; j < 9; j++) xyz[n + 9 * i + j] = f[3 + j];
+    }
+    pos += 50 * (std::size_t)nfacets;
+  }
+}
+
+// size of the file, or -1 if the stream is not seekable; the position is reset
+// to the beginning of the file
+static long long fileSize(FILE *fp)
+{
+#if defined(_MSC_VER)
+  if(_fseeki64(fp, 0, SEEK_END)) return -1;
+  long long size = _ftelli64(fp);
+  if(_fseeki64(fp, 0, SEEK_SET)) return -1;
+#else
+  if(fseeko(fp, 0, SEEK_END)) return -1;
+  long long size = ftello(fp);
+  if(fseeko(fp, 0, SEEK_SET)) return -1;
+#endif
+  return size;
 }
 
 int GModel::readSTL(const std::string &name, double tolerance)
@@ -40,143 +177,85 @@ int GModel::readSTL(const std::string &name, double tolerance)
     return 0;
   }
 
-  // store triplets of points for each solid found in the file
-  std::vector<std::vector<SPoint3> > points;
-  SBoundingBox3d bbox;
-  std::vector<std::string> names;
-
-  // "solid", or binary data header
-  char buffer[256];
-  if(!fgets0(buffer, sizeof(buffer), fp)) {
-    fclose(fp);
-    return 0;
+  // read the whole file in memory, and parse it concurrently (if the stream is
+  // not seekable, its size is unknown: grow the buffer by blocks)
+  std::vector<char> data;
+  long long size = fileSize(fp);
+  if(size >= 0) {
+    data.resize(size);
+    if(size) data.resize(fread(&data[0], sizeof(char), size, fp));
+  }
+  else {
+    while(1) {
+      std::size_t n = data.size(), block = std::max<std::size_t>(n, 1 << 24);
+      data.resize(n + block);
+      std::size_t ret = fread(&data[n], sizeof(char), block, fp);
+      data.resize(n + ret);
+      if(ret < block) break;
+    }
   }
+  fclose(fp);
+  data.push_back('\0');
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
 
-  // SPoint3 p0(1.9e6, 4e6, 0);
+  // coordinates of the triplets of points, index of the first point of each
+  // solid, and names of the solids
+  std::vector<double> xyz;
+  std::vector<std::size_t> solids;
+  std::vector<std::string> names;
 
-  bool binary = strncmp(buffer, "solid", 5) && strncmp(buffer, "SOLID", 5);
+  // "solid", or binary data header (the first non-empty line)
+  std::size_t first = 0;
+  while(first < data.size() - 1 && isspace(data[first])) first++;
+  const char *end = &data[0] + data.size() - 1;
+  bool binary = !startsWith(&data[first], end, "solid", "SOLID");
 
   // ASCII STL
-  if(!binary) {
-    if(strlen(buffer) > 6)
-      names.push_back(&buffer[6]);
-    else
-      names.push_back("");
-    points.resize(1);
-    while(!feof(fp)) {
-      // "facet normal x y z" or "endsolid"
-      if(!fgets0(buffer, sizeof(buffer), fp)) break;
-      if(!strncmp(buffer, "endsolid", 8) || !strncmp(buffer, "ENDSOLID", 8)) {
-        // "solid"
-        if(!fgets0(buffer, sizeof(buffer), fp)) break;
-        if(!strncmp(buffer, "solid", 5) || !strncmp(buffer, "SOLID", 5)) {
-          if(strlen(buffer) > 6)
-            names.push_back(&buffer[6]);
-          else
-            names.push_back("");
-          points.resize(points.size() + 1);
-          // "facet normal x y z"
-          if(!fgets0(buffer, sizeof(buffer), fp)) break;
-        }
-      }
-      // "outer loop"
-      if(!fgets0(buffer, sizeof(buffer), fp)) break;
-      // "vertex x y z"
-      for(int i = 0; i < 3; i++) {
-        if(!fgets0(buffer, sizeof(buffer), fp)) break;
-        char s1[256];
-        double x, y, z;
-        if(sscanf(buffer, "%s %lf %lf %lf", s1, &x, &y, &z) != 4) break;
-        SPoint3 p(x, y, z);
-        // p -= p0;
-        points.back().push_back(p);
-        bbox += p;
-      }
-      // "endloop"
-      if(!fgets0(buffer, sizeof(buffer), fp)) break;
-      // "endfacet"
-      if(!fgets0(buffer, sizeof(buffer), fp)) break;
-    }
-  }
-
-  // check if we could parse something
-  bool empty = true;
-  for(std::size_t i = 0; i < points.size(); i++) {
-    if(points[i].size()) {
-      empty = false;
-      break;
-    }
-  }
-  if(empty) points.clear();
+  if(!binary) readSTLASCII(data, nthreads, xyz, solids, names);
 
   // binary STL (we also try to read in binary mode if the header told
   // us the format was ASCII but we could not read any vertices)
+  bool empty = xyz.empty();
   if(binary || empty) {
     if(binary)
       Msg::Info("Mesh is in binary format");
     else
       Msg::Info("Wrong ASCII header or empty file: trying binary read");
-    rewind(fp);
-    while(!feof(fp)) {
-      char header[80];
-      if(!fread(header, sizeof(char), 80, fp)) break;
-      header[79] = '\0';
-      unsigned int nfacets = 0;
-      size_t ret = fread(&nfacets, sizeof(unsigned int), 1, fp);
-      bool swap = false;
-      if(nfacets > 100000000) {
-        Msg::Info("Swapping bytes from binary file");
-        swap = true;
-        SwapBytes((char *)&nfacets, sizeof(unsigned int), 1);
-      }
-      if(ret && nfacets) {
-        names.push_back(header);
-        points.resize(points.size() + 1);
-        char *data = new char[nfacets * 50 * sizeof(char)];
-        ret = fread(data, sizeof(char), nfacets * 50, fp);
-        if(ret == nfacets * 50) {
-          for(std::size_t i = 0; i < nfacets; i++) {
-            float *xyz = (float *)&data[i * 50 * sizeof(char)];
-            if(swap) SwapBytes((char *)xyz, sizeof(float), 12);
-            for(int j = 0; j < 3; j++) {
-              SPoint3 p(xyz[3 + 3 * j], xyz[3 + 3 * j + 1], xyz[3 + 3 * j + 2]);
-              // p -= p0;
-              points.back().push_back(p);
-              bbox += p;
-            }
-          }
-        }
-        delete[] data;
-      }
-    }
+    xyz.clear();
+    solids.clear();
+    names.clear();
+    readSTLBinary(data, nthreads, xyz, solids, names);
   }
+  std::vector<char>().swap(data);
 
   // cleanup names
-  if(names.size() != points.size()) {
+  if(names.size() != solids.size()) {
     Msg::Debug("Invalid number of names in STL file - should never happen");
-    names.resize(points.size());
+    names.resize(solids.size());
   }
   for(std::size_t i = 0; i < names.size(); i++) {
     names[i].erase(remove_if(names[i].begin(), names[i].end(), invalidChar),
                    names[i].end());
   }
 
+  std::size_t npts = xyz.size() / 3;
+  solids.push_back(npts);
   std::vector<GFace *> faces;
-  for(std::size_t i = 0; i < points.size(); i++) {
-    if(points[i].empty()) {
+  for(std::size_t i = 0; i < names.size(); i++) {
+    std::size_t n = solids[i + 1] - solids[i];
+    if(!n) {
       Msg::Error("No facets found in STL file for solid %d %s", i,
                  names[i].c_str());
-      fclose(fp);
       return 0;
     }
-    if(points[i].size() % 3) {
-      Msg::Error("Wrong number of points (%d) in STL file for solid %d %s",
-                 points[i].size(), i, names[i].c_str());
-      fclose(fp);
+    if(n % 3) {
+      Msg::Error("Wrong number of points (%d) in STL file for solid %d %s", n,
+                 i, names[i].c_str());
       return 0;
     }
-    Msg::Info("%d facets in solid %d %s", points[i].size() / 3, i,
-              names[i].c_str());
+    Msg::Info("%d facets in solid %d %s", n / 3, i, names[i].c_str());
     // create face
     GFace *face = new discreteFace(this, getMaxElementaryNumber(2) + 1);
     faces.push_back(face);
@@ -184,63 +263,69 @@ int GModel::readSTL(const std::string &name, double tolerance)
     if(!names[i].empty()) setElementaryName(2, face->tag(), names[i]);
   }
 
-  // create triangles using unique vertices
+  // weld the points, and create the unique vertices
+  SBoundingBox3d bbox = pointsBoundingBox(xyz, nthreads);
   double eps = norm(SVector3(bbox.max(), bbox.min())) * tolerance;
-  std::vector<MVertex *> vertices;
-  for(std::size_t i = 0; i < points.size(); i++)
-    for(std::size_t j = 0; j < points[i].size(); j++)
-      vertices.push_back(
-        new MVertex(points[i][j].x(), points[i][j].y(), points[i][j].z()));
-  MVertexRTree pos(eps);
-  pos.insert(vertices);
-
-  std::set<MFace, MFaceLessThan> unique;
-  int nbDuplic = 0, nbDegen = 0;
-  for(std::size_t i = 0; i < points.size(); i++) {
-    for(std::size_t j = 0; j < points[i].size(); j += 3) {
-      MVertex *v[3];
-      for(int k = 0; k < 3; k++) {
-        double x = points[i][j + k].x();
-        double y = points[i][j + k].y();
-        double z = points[i][j + k].z();
-        v[k] = pos.find(x, y, z);
-        if(!v[k])
-          Msg::Error("Could not find node at position (%.16g, %.16g, %.16g) "
-                     "with tol=%.16g", x, y, z, eps);
-      }
-      if(!v[0] || !v[1] || !v[2]) {
-        // error
-      }
-      else if(v[0] == v[1] || v[0] == v[2] || v[1] == v[2]) {
-        Msg::Debug("Skipping degenerated triangle %zu %zu %zu", v[0]->getNum(),
-                   v[1]->getNum(), v[2]->getNum());
-        nbDegen++;
-      }
-      else if(CTX::instance()->mesh.stlRemoveBadTriangles) {
-        MFace mf(v[0], v[1], v[2]);
-        if(unique.find(mf) == unique.end()) {
-          if(CTX::instance()->mesh.stlRemoveBadTriangles > 1) {
-            double a = mf.approximateArea();
-            if(a < tolerance * tolerance) {
-              Msg::Warning("Skipping degenerated triangle with area %g", a);
-              nbDegen++;
-            }
-            else
-              faces[i]->triangles.push_back(new MTriangle(v[0], v[1], v[2]));
-          }
-          else
-            faces[i]->triangles.push_back(new MTriangle(v[0], v[1], v[2]));
-          unique.insert(mf);
-        }
-        else {
-          nbDuplic++;
-        }
-      }
-      else {
-        faces[i]->triangles.push_back(new MTriangle(v[0], v[1], v[2]));
+  std::vector<std::size_t> rep;
+  weldPoints(xyz, eps, rep, nthreads);
+  std::vector<MVertex *> vertices(npts, nullptr);
+  for(std::size_t i = 0; i < npts; i++) {
+    if(rep[i] == i)
+      vertices[i] = new MVertex(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+  }
+
+  // flag degenerate triangles, and duplicate or tiny triangles if requested
+  // (the welded points of triangle i are rep[3 * i], rep[3 * i + 1] and
+  // rep[3 * i + 2])
+  int removeBad = CTX::instance()->mesh.stlRemoveBadTriangles;
+  std::size_t ntri = npts / 3;
+  std::vector<char> dup;
+  if(removeBad) findDuplicateTriangles(rep, dup, nthreads);
+  std::vector<char> skip(ntri, 0);
+  int nbDuplic = 0, nbDegen = 0, nbSmall = 0;
+#pragma omp parallel for num_threads(nthreads) \
+  reduction(+ : nbDuplic, nbDegen, nbSmall)
+  for(std::size_t i = 0; i < ntri; i++) {
+    const std::size_t *t = &rep[3 * i];
+    if(t[0] == t[1] || t[0] == t[2] || t[1] == t[2]) {
+      skip[i] = 1;
+      nbDegen++;
+    }
+    else if(removeBad && dup[i]) {
+      skip[i] = 1;
+      nbDuplic++;
+    }
+    else if(removeBad > 1) {
+      SVector3 a(xyz[3 * t[1]] - xyz[3 * t[0]],
+                 xyz[3 * t[1] + 1] - xyz[3 * t[0] + 1],
+                 xyz[3 * t[1] + 2] - xyz[3 * t[0] + 2]);
+      SVector3 b(xyz[3 * t[2]] - xyz[3 * t[0]],
+                 xyz[3 * t[2] + 1] - xyz[3 * t[0] + 1],
+                 xyz[3 * t[2] + 2] - xyz[3 * t[0] + 2]);
+      if(0.5 * norm(crossprod(a, b)) < tolerance * tolerance) {
+        skip[i] = 1;
+        nbSmall++;
       }
     }
   }
+  if(nbSmall)
+    Msg::Warning("Skipping %d degenerated triangle%s with small area", nbSmall,
+                 nbSmall > 1 ? "s" : "");
+  nbDegen += nbSmall;
+
+  // create triangles using unique vertices
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    std::size_t n = 0;
+    for(std::size_t j = solids[i] / 3; j < solids[i + 1] / 3; j++)
+      if(!skip[j]) n++;
+    faces[i]->triangles.reserve(n);
+    for(std::size_t j = solids[i] / 3; j < solids[i + 1] / 3; j++) {
+      if(skip[j]) continue;
+      const std::size_t *t = &rep[3 * j];
+      faces[i]->triangles.push_back(
+        new MTriangle(vertices[t[0]], vertices[t[1]], vertices[t[2]]));
+    }
+  }
   if(nbDuplic || nbDegen)
     Msg::Warning("%d duplicate/%d degenerate triangles in STL file", nbDuplic,
                  nbDegen);
@@ -249,7 +334,6 @@ int GModel::readSTL(const std::string &name, double tolerance)
 
   _storeVerticesInEntities(vertices); // will delete unused vertices
 
-  fclose(fp);
   return 1;
 }
 
@@ -192,12 +192,10 @@ static void addSmoothNormals(GEntity *e, std::vector<T *> &elements)
 
 template <class T>
 static void addElementsInArrays(GEntity *e, std::vector<T *> &elements,
-                                bool edges, bool faces)
+                                std::size_t begin, std::size_t end,
+                                VertexArray *lines, VertexArray *triangles)
 {
-  int nthreads = CTX::instance()->numThreads;
-  if(!nthreads) nthreads = Msg::GetMaxThreads();
-#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
-  for(std::size_t i = 0; i < elements.size(); i++) {
+  for(std::size_t i = begin; i < end; i++) {
     MElement *ele = elements[i];
 
     if(!isElementVisible(ele) || ele->getDim() < 1) continue;
@@ -212,7 +210,7 @@ static void addElementsInArrays(GEntity *e, std::vector<T *> &elements,
     SPoint3 pc(0., 0., 0.);
     if(CTX::instance()->mesh.explode != 1.) pc = ele->barycenter();
 
-    if(edges) {
+    if(lines) {
       bool unique = e->dim() > 1 && !CTX::instance()->pickElements;
       for(int j = 0; j < ele->getNumEdgesRep(curved); j++) {
         double x[2], y[2], z[2];
@@ -229,14 +227,11 @@ static void addElementsInArrays(GEntity *e, std::vector<T *> &elements,
           for(int k = 0; k < 2; k++)
             e->model()->normals->get(x[k], y[k], z[k], n[k][0], n[k][1],
                                      n[k][2]);
-#pragma omp critical(addElementsInArrays1)
-        {
-          e->va_lines->add(x, y, z, n, col, ele, unique);
-        }
+        lines->add(x, y, z, n, col, ele, unique);
       }
     }
 
-    if(faces) {
+    if(triangles) {
       bool unique = e->dim() > 2 && !CTX::instance()->pickElements;
       bool skin = e->dim() > 2 && CTX::instance()->mesh.drawSkinOnly;
       for(int j = 0; j < ele->getNumFacesRep(curved); j++) {
@@ -254,15 +249,59 @@ static void addElementsInArrays(GEntity *e, std::vector<T *> &elements,
           for(int k = 0; k < 3; k++)
             e->model()->normals->get(x[k], y[k], z[k], n[k][0], n[k][1],
                                      n[k][2]);
-#pragma omp critical(addElementsInArrays2)
-        {
-          e->va_triangles->add(x, y, z, n, col, ele, unique, skin);
-        }
+        triangles->add(x, y, z, n, col, ele, unique, skin);
       }
     }
   }
 }
 
+template <class T>
+static void addElementsInArrays(GEntity *e, std::vector<T *> &elements,
+                                bool edges, bool faces)
+{
+  VertexArray::setBoundaryTolerance();
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  std::size_t chunkSize =
+    std::max((std::size_t)1000, elements.size() / (8 * nthreads));
+  std::size_t numChunks = (elements.size() + chunkSize - 1) / chunkSize;
+
+  if(nthreads == 1 || numChunks < 2) {
+    addElementsInArrays(e, elements, 0, elements.size(),
+                        edges ? e->va_lines : nullptr,
+                        faces ? e->va_triangles : nullptr);
+    return;
+  }
+
+  // each chunk of elements is added in its own vertex arrays, which are then
+  // merged in order: this avoids synchronizing the threads, and leads to the
+  // same arrays as the sequential algorithm
+  std::vector<VertexArray *> lines(numChunks, nullptr);
+  std::vector<VertexArray *> triangles(numChunks, nullptr);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t c = 0; c < numChunks; c++) {
+    std::size_t begin = c * chunkSize;
+    std::size_t end = std::min(elements.size(), begin + chunkSize);
+    if(edges) lines[c] = new VertexArray(2, end - begin);
+    if(faces)
+      triangles[c] = new VertexArray(e->va_triangles->getNumVerticesPerElement(),
+                                     end - begin);
+    addElementsInArrays(e, elements, begin, end, lines[c], triangles[c]);
+  }
+
+  for(std::size_t c = 0; c < numChunks; c++) {
+    if(lines[c]) {
+      e->va_lines->merge(lines[c]);
+      delete lines[c];
+    }
+    if(triangles[c]) {
+      e->va_triangles->merge(triangles[c]);
+      delete triangles[c];
+    }
+  }
+}
+
 class initMeshGEdge {
 private:
   int _estimateNumLines(GEdge *e)
@@ -20,6 +20,8 @@
 #include <BRepBndLib.hxx>
 #include <TopoDS_Shape.hxx>
 #include <BRepTools.hxx>
+#include <NCollection_DataMap.hxx>
+#include <TopTools_ShapeMapHasher.hxx>
 
 class OCCAttributes {
 private:
@@ -78,10 +80,16 @@ public:
 // attributes are stored according to the center of their associated shape
 // bounding box; this allows to efficiently search for potential matches, even
 // if the actual underlying shape has been modified (typically through boolean
-// fragments)
+// fragments). Attributes are also indexed by shape, so that exact matches are
+// found without any geometrical search. Lookups only read the trees and the
+// index: they can be performed concurrently, as long as no attribute is
+// inserted or removed at the same time.
 class OCCAttributesRTree {
 private:
   RTree<OCCAttributes *, double, 3, double> *_rtree[4];
+  NCollection_DataMap<TopoDS_Shape, std::vector<OCCAttributes *>,
+                      TopTools_ShapeMapHasher>
+    _index[4];
   std::vector<OCCAttributes *> _all;
   double _tol;
   static bool rtree_callback(OCCAttributes *v, void *ctx)
@@ -98,6 +106,18 @@ private:
   {
     attr.clear();
     if(dim < 0 || dim > 3) return;
+    if(!excludeSame && _index[dim].IsBound(shape)) {
+      const std::vector<OCCAttributes *> &same = _index[dim].Find(shape);
+      for(std::size_t i = 0; i < same.size(); i++) {
+        if(requireMeshSize && same[i]->getMeshSize() == MAX_LC) continue;
+        if(requireExtrudeParams && !same[i]->getExtrudeParams()) continue;
+        if(requireLabel && same[i]->getLabel().empty()) continue;
+        if(requireColor && same[i]->getColor().empty()) continue;
+        attr.push_back(same[i]); // exact match: same shape
+        Msg::Debug("OCCRTree exact match");
+        return;
+      }
+    }
     Bnd_Box box;
     try {
       BRepBndLib::Add(shape, box, Standard_False);
@@ -124,19 +144,6 @@ private:
     if(tmp.empty()) { // no match
       return;
     }
-    if(!excludeSame) {
-      for(std::size_t i = 0; i < tmp.size(); i++) {
-        if(requireMeshSize && tmp[i]->getMeshSize() == MAX_LC) continue;
-        if(requireExtrudeParams && !tmp[i]->getExtrudeParams()) continue;
-        if(requireLabel && tmp[i]->getLabel().empty()) continue;
-        if(requireColor && tmp[i]->getColor().empty()) continue;
-        if(shape.IsSame(tmp[i]->getShape())) { // exact match: same shape
-          attr.push_back(tmp[i]);
-          Msg::Debug("OCCRTree exact match");
-          return;
-        }
-      }
-    }
     // potential matches based on bounding box
     for(std::size_t i = 0; i < tmp.size(); i++) {
       if(requireMeshSize && tmp[i]->getMeshSize() == MAX_LC) continue;
@@ -156,6 +163,22 @@ private:
     Msg::Debug("OCCRtree %d matches after bounding box filtering",
                (int)attr.size());
   }
+  void _addToIndex(OCCAttributes *v)
+  {
+    int dim = v->getDim();
+    if(_index[dim].IsBound(v->getShape()))
+      _index[dim].ChangeFind(v->getShape()).push_back(v);
+    else
+      _index[dim].Bind(v->getShape(), std::vector<OCCAttributes *>(1, v));
+  }
+  void _removeFromIndex(OCCAttributes *v)
+  {
+    int dim = v->getDim();
+    if(!_index[dim].IsBound(v->getShape())) return;
+    std::vector<OCCAttributes *> &same = _index[dim].ChangeFind(v->getShape());
+    same.erase(std::remove(same.begin(), same.end(), v), same.end());
+    if(same.empty()) _index[dim].UnBind(v->getShape());
+  }
 
 public:
   OCCAttributesRTree(double tolerance = 1.e-8)
@@ -171,7 +194,10 @@ public:
   }
   void clear()
   {
-    for(int dim = 0; dim < 4; dim++) _rtree[dim]->RemoveAll();
+    for(int dim = 0; dim < 4; dim++) {
+      _rtree[dim]->RemoveAll();
+      _index[dim].Clear();
+    }
     for(std::size_t i = 0; i < _all.size(); i++) delete _all[i];
     _all.clear();
   }
@@ -221,6 +247,72 @@ public:
     double bmin[3] = {x - _tol, y - _tol, z - _tol};
     double bmax[3] = {x + _tol, y + _tol, z + _tol};
     _rtree[v->getDim()]->Insert(bmin, bmax, v);
+    _addToIndex(v);
+  }
+  void insert(const std::vector<OCCAttributes *> &v)
+  {
+    // computing the bounding boxes dominates the cost of inserting attributes
+    // (e.g. when importing large STEP assemblies): compute them concurrently,
+    // then fill the trees and the index serially
+    std::vector<double> center(3 * v.size());
+    std::vector<char> valid(v.size(), 0);
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t i = 0; i < v.size(); i++) {
+      if(v[i]->getDim() < 0 || v[i]->getDim() > 3) continue;
+      Bnd_Box box;
+      try {
+        BRepBndLib::Add(v[i]->getShape(), box, Standard_False);
+        if(box.IsVoid()) {
+          Msg::Debug(
+            "Inserting (null or degenerate) shape with void bounding box");
+          continue;
+        }
+      } catch(Standard_Failure &err) {
+        Msg::Error("OpenCASCADE exception %s", err.GetMessageString());
+        continue;
+      }
+      double xmin, ymin, zmin, xmax, ymax, zmax;
+      box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+      center[3 * i] = 0.5 * (xmin + xmax);
+      center[3 * i + 1] = 0.5 * (ymin + ymax);
+      center[3 * i + 2] = 0.5 * (zmin + zmax);
+      valid[i] = 1;
+    }
+    _all.insert(_all.end(), v.begin(), v.end());
+    for(int dim = 0; dim < 4; dim++) {
+      std::vector<double> bmin, bmax;
+      std::vector<OCCAttributes *> data;
+      for(std::size_t i = 0; i < v.size(); i++) {
+        if(!valid[i] || v[i]->getDim() != dim) continue;
+        for(int j = 0; j < 3; j++) {
+          bmin.push_back(center[3 * i + j] - _tol);
+          bmax.push_back(center[3 * i + j] + _tol);
+        }
+        data.push_back(v[i]);
+        _addToIndex(v[i]);
+      }
+      if(data.empty()) continue;
+      // when the new attributes outnumber the ones already in the tree (e.g.
+      // right after importing a large assembly), pack all of them into a new
+      // tree; otherwise insert them one at a time
+      std::size_t numNew = data.size();
+      if(numNew < (std::size_t)_rtree[dim]->Count()) {
+        for(std::size_t i = 0; i < numNew; i++)
+          _rtree[dim]->Insert(&bmin[3 * i], &bmax[3 * i], data[i]);
+        continue;
+      }
+      RTree<OCCAttributes *, double, 3, double>::Iterator it;
+      for(_rtree[dim]->GetFirst(it); !it.IsNull(); ++it) {
+        double min[3], max[3];
+        it.GetBounds(min, max);
+        bmin.insert(bmin.end(), min, min + 3);
+        bmax.insert(bmax.end(), max, max + 3);
+        data.push_back(*it);
+      }
+      _rtree[dim]->BulkLoad((int)data.size(), &bmin[0], &bmax[0], &data[0]);
+    }
   }
   void remove(OCCAttributes *v)
   {
@@ -247,8 +339,10 @@ public:
     double bmax[3] = {x + _tol, y + _tol, z + _tol};
     std::vector<OCCAttributes *> tmp;
     _rtree[v->getDim()]->Search(bmin, bmax, rtree_callback, &tmp);
-    for(std::size_t i = 0; i < tmp.size(); i++)
+    for(std::size_t i = 0; i < tmp.size(); i++) {
       _rtree[v->getDim()]->Remove(bmin, bmax, tmp[i]);
+      _removeFromIndex(tmp[i]);
+    }
   }
   double getMeshSize(int dim, TopoDS_Shape shape)
   {
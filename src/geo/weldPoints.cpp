@@ -0,0 +1,185 @@
+// Gmsh - Copyright (C) 1997-2025 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "weldPoints.h"
+
+// key of the cell (i, j, k) of a uniform grid, used to hash the cells
+static uint64_t gridCellKey(int64_t i, int64_t j, int64_t k)
+{
+  uint64_t h = (uint64_t)i;
+  h = h * 0x9E3779B97F4A7C15ULL + (uint64_t)j;
+  h = h * 0x9E3779B97F4A7C15ULL + (uint64_t)k;
+  h ^= h >> 31;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 29;
+  return h;
+}
+
+SBoundingBox3d pointsBoundingBox(const std::vector<double> &xyz, int nthreads)
+{
+  double min[3] = {std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max()};
+  double max[3] = {-std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max()};
+  std::size_t n = xyz.size() / 3;
+#pragma omp parallel num_threads(nthreads)
+  {
+    double tmin[3] = {min[0], min[1], min[2]};
+    double tmax[3] = {max[0], max[1], max[2]};
+#pragma omp for
+    for(std::size_t i = 0; i < n; i++) {
+      for(int j = 0; j < 3; j++) {
+        tmin[j] = std::min(tmin[j], xyz[3 * i + j]);
+        tmax[j] = std::max(tmax[j], xyz[3 * i + j]);
+      }
+    }
+#pragma omp critical
+    for(int j = 0; j < 3; j++) {
+      min[j] = std::min(min[j], tmin[j]);
+      max[j] = std::max(max[j], tmax[j]);
+    }
+  }
+  SBoundingBox3d bbox;
+  if(n) {
+    bbox += SPoint3(min[0], min[1], min[2]);
+    bbox += SPoint3(max[0], max[1], max[2]);
+  }
+  return bbox;
+}
+
+std::size_t weldPoints(const std::vector<double> &xyz, double tol,
+                       std::vector<std::size_t> &rep, int nthreads)
+{
+  std::size_t n = xyz.size() / 3;
+  rep.resize(n);
+  if(!n) return 0;
+
+  // hash the points in a grid with cells of the size of the matching distance,
+  // so that duplicates are in neighboring cells (the cell size is bounded from
+  // below relative to the coordinates, so that cell indices do not overflow)
+  double eps = 2 * tol;
+  SBoundingBox3d bbox = pointsBoundingBox(xyz, nthreads);
+  double m = 0.;
+  for(int j = 0; j < 3; j++)
+    m = std::max(m, std::max(std::abs(bbox.min()[j]),
+                             std::abs(bbox.max()[j])));
+  double h = std::max(eps, m * 1e-15);
+  if(h <= 0.) h = 1.;
+  std::vector<std::pair<uint64_t, std::size_t> > keys(n);
+  std::vector<int64_t> cells(3 * n);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < n; i++) {
+    for(int j = 0; j < 3; j++)
+      cells[3 * i + j] = (int64_t)std::floor(xyz[3 * i + j] / h);
+    keys[i] = std::make_pair(
+      gridCellKey(cells[3 * i], cells[3 * i + 1], cells[3 * i + 2]), i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  // for each point, find the points before it that it duplicates: count them
+  // in a first pass, store them in a second pass
+  std::vector<std::size_t> cptr(n + 1, 0), cand;
+  for(int pass = 0; pass < 2; pass++) {
+#pragma omp parallel num_threads(nthreads)
+    {
+      std::vector<std::size_t> c;
+#pragma omp for schedule(dynamic, 1024)
+      for(std::size_t i = 0; i < n; i++) {
+        c.clear();
+        const double *p = &xyz[3 * i];
+        for(int di = -1; di <= 1; di++) {
+          for(int dj = -1; dj <= 1; dj++) {
+            for(int dk = -1; dk <= 1; dk++) {
+              uint64_t key =
+                gridCellKey(cells[3 * i] + di, cells[3 * i + 1] + dj,
+                            cells[3 * i + 2] + dk);
+              auto it = std::lower_bound(keys.begin(), keys.end(),
+                                         std::make_pair(key, (std::size_t)0));
+              for(; it != keys.end() && it->first == key; ++it) {
+                std::size_t j = it->second;
+                if(j >= i) break; // sorted by index within a cell
+                const double *q = &xyz[3 * j];
+                if(std::abs(p[0] - q[0]) <= eps &&
+                   std::abs(p[1] - q[1]) <= eps && std::abs(p[2] - q[2]) <= eps)
+                  c.push_back(j);
+              }
+            }
+          }
+        }
+        if(!pass)
+          cptr[i + 1] = c.size();
+        else {
+          std::sort(c.begin(), c.end());
+          std::copy(c.begin(), c.end(), cand.begin() + cptr[i]);
+        }
+      }
+    }
+    if(!pass) {
+      for(std::size_t i = 0; i < n; i++) cptr[i + 1] += cptr[i];
+      cand.resize(cptr[n]);
+    }
+  }
+
+  // a point is replaced by the first point before it that is not itself a
+  // duplicate
+  std::size_t num = 0;
+  for(std::size_t i = 0; i < n; i++) {
+    rep[i] = i;
+    for(std::size_t k = cptr[i]; k < cptr[i + 1]; k++) {
+      if(rep[cand[k]] == cand[k]) {
+        rep[i] = cand[k];
+        num++;
+        break;
+      }
+    }
+  }
+  return num;
+}
+
+std::size_t findDuplicateTriangles(const std::vector<std::size_t> &tri,
+                                   std::vector<char> &dup, int nthreads)
+{
+  std::size_t n = tri.size() / 3;
+  dup.assign(n, 0);
+  if(!n) return 0;
+
+  std::vector<std::size_t> sorted(3 * n);
+  std::vector<std::pair<uint64_t, std::size_t> > keys(n);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < n; i++) {
+    std::size_t *s = &sorted[3 * i];
+    for(int j = 0; j < 3; j++) s[j] = tri[3 * i + j];
+    std::sort(s, s + 3);
+    keys[i] = std::make_pair(gridCellKey(s[0], s[1], s[2]), i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  // triangles with the same key are sorted by index: compare each one with
+  // the ones before it
+  std::size_t num = 0;
+#pragma omp parallel for num_threads(nthreads) reduction(+ : num)
+  for(std::size_t i = 0; i < n; i++) {
+    if(i && keys[i - 1].first == keys[i].first) continue;
+    for(std::size_t j = i + 1; j < n && keys[j].first == keys[i].first; j++) {
+      const std::size_t *s = &sorted[3 * keys[j].second];
+      for(std::size_t k = i; k < j; k++) {
+        const std::size_t *t = &sorted[3 * keys[k].second];
+        if(!dup[keys[k].second] && s[0] == t[0] && s[1] == t[1] &&
+           s[2] == t[2]) {
+          dup[keys[j].second] = 1;
+          num++;
+          break;
+        }
+      }
+    }
+  }
+  return num;
+}
@@ -0,0 +1,34 @@
+// Gmsh - Copyright (C) 1997-2025 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef WELD_POINTS_H
+#define WELD_POINTS_H
+
+#include <cstddef>
+#include <vector>
+#include "SBoundingBox3d.h"
+
+// Welding of point clouds and triangle soups (e.g. from STL, OBJ or PLY
+// files), based on a uniform hash grid. All functions are multi-threaded, and
+// their result does not depend on the number of threads.
+
+// bounding box of the points, given by their 3 coordinates in xyz
+SBoundingBox3d pointsBoundingBox(const std::vector<double> &xyz, int nthreads);
+
+// find the duplicate points: two points are duplicates if their coordinates
+// differ by at most 2 * tol in each direction (i.e. if their boxes of size tol
+// intersect, as in MVertexRTree). On output, rep[i] is the first point before
+// i (in the input order) that is not a duplicate and that i duplicates, or i
+// itself if i is not a duplicate. Returns the number of duplicates.
+std::size_t weldPoints(const std::vector<double> &xyz, double tol,
+                       std::vector<std::size_t> &rep, int nthreads);
+
+// find the triangles (given by 3 node indices in tri) that have the same nodes
+// as a triangle before them, regardless of orientation: on output, dup[i] is
+// set to 1 for these triangles. Returns the number of duplicates.
+std::size_t findDuplicateTriangles(const std::vector<std::size_t> &tri,
+                                   std::vector<char> &dup, int nthreads);
+
+#endif
@@ -773,16 +773,22 @@ static void Mesh3D(GModel *m)
     Msg::ProgressMeter(0, false, "Meshing 3D...");
   }
 
+  int nthreads = CTX::instance()->mesh.maxNumThreads3D;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
   // mesh the extruded volumes first
-  std::for_each(m->firstRegion(), m->lastRegion(), meshGRegionExtruded());
+  MeshExtrudedVolumes(m, nthreads);
 
   // then subdivide if necessary (unfortunately the subdivision is a
   // global operation, which can require changing the surface mesh!)
   SubdivideExtrudedMesh(m);
 
-  // then mesh all the non-delaunay regions (front3D with netgen)
-  std::vector<GRegion *> delaunay;
-  std::for_each(m->firstRegion(), m->lastRegion(), meshGRegion(delaunay));
+  // then mesh all the non-delaunay regions (front3D with netgen), the
+  // transfinite ones concurrently
+  std::vector<GRegion *> delaunay, transfinite;
+  std::for_each(m->firstRegion(), m->lastRegion(),
+                meshGRegion(delaunay, &transfinite));
+  MeshTransfiniteVolumes(transfinite, nthreads, delaunay);
 
   // and finally mesh the delaunay regions (again, this is global; but
   // we mesh each connected part separately for performance and mesh
@@ -803,15 +809,10 @@ static void Mesh3D(GModel *m)
     }
   }
 
-  for(std::size_t i = 0; i < connected.size(); i++) {
-    if(CTX::instance()->abortOnError && Msg::GetErrorCount()) {
-      Msg::Warning("Aborted 3D meshing");
-      break;
-    }
-
-    MeshDelaunayVolume(connected[i]);
+  MeshDelaunayVolumes(connected, nthreads);
 
 #if defined(HAVE_DOMHEX) and defined(HAVE_HXT)
+  for(std::size_t i = 0; i < connected.size(); i++) {
     // additional code for experimental hex mesh - will eventually be replaced
     // by new HXT-based code
     for(std::size_t j = 0; j < connected[i].size(); j++) {
@@ -835,8 +836,8 @@ static void Mesh3D(GModel *m)
         RelocateVertices(gr, CTX::instance()->mesh.nbSmoothing);
       }
     }
-#endif
   }
+#endif
 
   MakeHybridHexTetMeshConformalThroughTriHedron(m);
   // ensure that all volume Jacobians are positive
@@ -9,6 +9,7 @@
 
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include "GmshConfig.h"
 #include "GModel.h"
 #include "HighOrder.h"
@@ -398,24 +399,30 @@ inline static bool getMinMaxVert(MVertex *v0, MVertex *v1, MVertex *&vMin,
 
 // Get new interior vertices for a 1D element
 static void getEdgeVertices(GEdge *ge, MElement *ele,
-                            std::vector<MVertex *> &ve,
-                            edgeContainer &edgeVertices, bool linear,
+                            std::vector<MVertex *> &veEdge, bool linear,
                             int nPts = 1)
 {
   if(!ge->haveParametrization()) linear = true;
 
-  std::vector<MVertex *> veOld;
-  ele->getVertices(veOld);
-  MVertex *vMin, *vMax;
-  const bool increasing = getMinMaxVert(veOld[0], veOld[1], vMin, vMax);
-  std::pair<MVertex *, MVertex *> p(vMin, vMax);
-
-  std::vector<MVertex *> veEdge;
   // Get vertices on geometry if asked
   bool gotVertOnGeo =
-    linear ? false : getEdgeVerticesOnGeo(ge, veOld[0], veOld[1], veEdge, nPts);
+    linear ? false :
+             getEdgeVerticesOnGeo(ge, ele->getVertex(0), ele->getVertex(1),
+                                  veEdge, nPts);
   // If not on geometry, create from mesh interpolation
   if(!gotVertOnGeo) interpVerticesInExistingEdge(ge, ele, veEdge, nPts);
+}
+
+// Store the new interior vertices of a 1D element
+static void addEdgeVertices(GEdge *ge, MElement *ele,
+                            const std::vector<MVertex *> &veEdge,
+                            edgeContainer &edgeVertices)
+{
+  MVertex *vMin, *vMax;
+  const bool increasing =
+    getMinMaxVert(ele->getVertex(0), ele->getVertex(1), vMin, vMax);
+  std::pair<MVertex *, MVertex *> p(vMin, vMax);
+
   if(edgeVertices.count(p) == 0) {
     if(increasing) // Add newly created vertices to list
       edgeVertices[p].insert(edgeVertices[p].end(), veEdge.begin(),
@@ -431,7 +438,6 @@ static void getEdgeVertices(GEdge *ge, MElement *ele,
       "(curve involved: %d)",
       ge->tag());
   }
-  ve.insert(ve.end(), veEdge.begin(), veEdge.end());
 }
 
 // Get new interior vertices for an edge in a 2D element
@@ -493,11 +499,13 @@ static void getEdgeVertices(GRegion *gr, MElement *ele,
     const bool increasing = getMinMaxVert(veOld[0], veOld[1], vMin, vMax);
     std::pair<MVertex *, MVertex *> p(vMin, vMax);
     std::vector<MVertex *> veEdge;
-    if(edgeVertices.count(p)) { // Vertices already exist
+    auto eIter = edgeVertices.find(p);
+    if(eIter != edgeVertices.end()) { // Vertices already exist
+      std::vector<MVertex *> &eVtcs = eIter->second;
       if(increasing)
-        veEdge.assign(edgeVertices[p].begin(), edgeVertices[p].end());
+        veEdge.assign(eVtcs.begin(), eVtcs.end());
       else
-        veEdge.assign(edgeVertices[p].rbegin(), edgeVertices[p].rend());
+        veEdge.assign(eVtcs.rbegin(), eVtcs.rend());
     }
     else { // Vertices do not exist, create them
       const MLineN edgeEl(veOld, ele->getPolynomialOrder());
@@ -513,6 +521,27 @@ static void getEdgeVertices(GRegion *gr, MElement *ele,
   }
 }
 
+// Create the new interior vertices of the local edge num of a 2D or 3D
+// element, ordered according to the orientation of the edge in the element
+static void createEdgeVertices(GEntity *ge, MElement *ele, int num,
+                               std::vector<MVertex *> &ve, bool linear,
+                               int nPts)
+{
+  GFace *gf = (ge->dim() == 2) ? static_cast<GFace *>(ge) : nullptr;
+  if(!gf || !gf->haveParametrization()) linear = true;
+
+  std::vector<MVertex *> veOld;
+  ele->getEdgeVertices(num, veOld);
+  // Get vertices on geometry if asked
+  bool gotVertOnGeo =
+    linear ? false : getEdgeVerticesOnGeo(gf, veOld[0], veOld[1], ve, nPts);
+  if(!gotVertOnGeo) {
+    // If not on geometry, create from mesh interpolation
+    const MLineN edgeEl(veOld, ele->getPolynomialOrder());
+    interpVerticesInExistingEdge(ge, &edgeEl, ve, nPts);
+  }
+}
+
 // Creation of high-order face vertices
 
 static void reorientTrianglePoints(std::vector<MVertex *> &vtcs,
@@ -753,8 +782,7 @@ static void getFaceVerticesOnGeo(GFace *gf,
 
 // Get new interior vertices for a 2D element
 static void getFaceVertices(GFace *gf, MElement *ele,
-                            std::vector<MVertex *> &newVertices,
-                            faceContainer &faceVertices, bool linear,
+                            std::vector<MVertex *> &newVertices, bool linear,
                             int nPts = 1)
 {
   if(!gf->haveParametrization()) linear = true;
@@ -784,9 +812,6 @@ static void getFaceVertices(GFace *gf, MElement *ele,
     interpVerticesInExistingFace(gf, *coefficients, boundaryVertices, vFace);
   }
 
-  MFace face = ele->getFace(0);
-  faceVertices[face].insert(faceVertices[face].end(), vFace.begin(),
-                            vFace.end());
   newVertices.insert(newVertices.end(), vFace.begin(), vFace.end());
 }
 
@@ -899,6 +924,21 @@ static void getFaceVertices(GRegion *gr, MElement *ele,
   }
 }
 
+// Create the new interior vertices of the local face num of a 3D element, whose
+// edge vertices already exist
+static void createFaceVertices(GRegion *gr, MElement *ele, int num,
+                               std::vector<MVertex *> &vFace,
+                               edgeContainer &edgeVertices, int nPts)
+{
+  std::vector<MVertex *> vCorner, vEdges, faceBoundaryVertices;
+  ele->getVertices(vCorner);
+  getEdgeVertices(gr, ele, vEdges, edgeVertices, nPts);
+  int type = retrieveFaceBoundaryVertices(num, ele->getType(), nPts, vCorner,
+                                          vEdges, faceBoundaryVertices);
+  fullMatrix<double> *coefficients = getInnerVertexPlacement(type, nPts + 1);
+  interpVerticesInExistingFace(gr, *coefficients, faceBoundaryVertices, vFace);
+}
+
 // Get new interior vertices for a 3D element
 static void getVolumeVertices(GRegion *gr, MElement *ele,
                               std::vector<MVertex *> &newVertices, int nPts = 1)
@@ -928,117 +968,296 @@ static void getVolumeVertices(GRegion *gr, MElement *ele,
   }
 }
 
+static int getOrder(GEntity *ge)
+{
+  for(std::size_t i = 0; i < ge->getNumMeshElements(); i++)
+    return ge->getMeshElement(i)->getPolynomialOrder();
+  return 0;
+}
+
+static void setHighOrderFromExistingMesh(GEdge *ge, edgeContainer &edgeVertices)
+{
+  for(std::size_t i = 0; i < ge->getNumMeshElements(); i++) {
+    MElement *e = ge->getMeshElement(i);
+    std::vector<MVertex *> v;
+    e->getVertices(v);
+    MVertex *vMin, *vMax;
+    const bool increasing = getMinMaxVert(v[0], v[1], vMin, vMax);
+    std::pair<MVertex *, MVertex *> p(vMin, vMax);
+    if(edgeVertices.count(p) == 0) {
+      if(increasing)
+        edgeVertices[p].insert(edgeVertices[p].end(), v.begin() + e->getNumPrimaryVertices(), v.end());
+      else
+        edgeVertices[p].insert(edgeVertices[p].end(), v.rbegin(), v.rend() - e->getNumPrimaryVertices());
+    }
+  }
+}
+
+static void setHighOrderFromExistingMesh(GFace *gf, edgeContainer &edgeVertices,
+                                         faceContainer &faceVertices)
+{
+  for(std::size_t i = 0; i < gf->getNumMeshElements(); i++) {
+    MElement *e = gf->getMeshElement(i);
+    for(int j = 0; j < e->getNumEdges(); j++) {
+      MEdge edg = e->getEdge(j);
+      MVertex *vMin, *vMax;
+      const bool increasing = getMinMaxVert(edg.getVertex(0), edg.getVertex(1), vMin, vMax);
+      std::pair<MVertex *, MVertex *> p(vMin, vMax);
+      if(edgeVertices.count(p) == 0) {
+        std::vector<MVertex *> edgv;
+        e->getEdgeVertices(j, edgv);
+        if(increasing)
+          edgeVertices[p].insert(edgeVertices[p].end(), edgv.begin() + 2, edgv.end());
+        else
+          edgeVertices[p].insert(edgeVertices[p].end(), edgv.rbegin(), edgv.rend() - 2);
+      }
+    }
+    MFace f = e->getFace(0);
+    std::vector<MVertex *> facev;
+    if(faceVertices.count(f) == 0) {
+      e->getFaceVertices(0, facev);
+      for(std::size_t j = e->getNumPrimaryVertices() + e->getNumEdgeVertices();
+          j < facev.size(); j++) {
+        faceVertices[f].push_back(facev[j]);
+      }
+    }
+  }
+}
+
 // Creation of high-order elements
+//
+// The elements of each entity are converted in parallel: the unique mesh edges
+// (and faces) that require new vertices are first identified sequentially,
+// their vertices (which can involve projections on the CAD) are then created
+// in parallel, and the elements are finally assembled in parallel. The new
+// vertices and elements are numbered in a deterministic order, so that the
+// resulting mesh does not depend on the number of threads.
+
+namespace {
+  // a mesh edge (or face) whose high-order vertices must be created, defined
+  // as the local edge (or face) num of the element ele in the entity ge; the
+  // new vertices are stored in v, which points to the entry of the edge (or
+  // face) container
+  struct highOrderTask {
+    GEntity *ge;
+    MElement *ele;
+    int num;
+    std::vector<MVertex *> *v;
+  };
+} // namespace
 
-static void setHighOrder(GEdge *ge, edgeContainer &edgeVertices, bool linear,
-                         int nbPts = 1)
+template <class T>
+static void addEdgeTasks(GEntity *ge, std::vector<T *> &elements,
+                         edgeContainer &edgeVertices,
+                         std::vector<highOrderTask> &tasks)
 {
-  std::vector<MLine *> lines2;
-  for(std::size_t i = 0; i < ge->lines.size(); i++) {
-    MLine *l = ge->lines[i];
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    T *ele = elements[i];
+    for(int j = 0; j < ele->getNumEdges(); j++) {
+      MEdge edge = ele->getEdge(j);
+      MVertex *vMin, *vMax;
+      getMinMaxVert(edge.getVertex(0), edge.getVertex(1), vMin, vMax);
+      auto it = edgeVertices.insert(
+        std::make_pair(std::make_pair(vMin, vMax), std::vector<MVertex *>()));
+      if(it.second) tasks.push_back({ge, ele, j, &it.first->second});
+    }
+  }
+}
+
+template <class T>
+static void addFaceTasks(GEntity *ge, std::vector<T *> &elements,
+                         faceContainer &faceVertices,
+                         std::vector<highOrderTask> &tasks)
+{
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    T *ele = elements[i];
+    for(int j = 0; j < ele->getNumFaces(); j++) {
+      auto it = faceVertices.insert(
+        std::make_pair(ele->getFace(j), std::vector<MVertex *>()));
+      if(it.second) tasks.push_back({ge, ele, j, &it.first->second});
+    }
+  }
+}
+
+static void createEdgeVertices(std::vector<highOrderTask> &tasks, bool linear,
+                               int nPts, int nthreads)
+{
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < tasks.size(); i++) {
+    highOrderTask &t = tasks[i];
     std::vector<MVertex *> ve;
-    getEdgeVertices(ge, l, ve, edgeVertices, linear, nbPts);
-    if(nbPts == 1)
-      lines2.push_back(
-        new MLine3(l->getVertex(0), l->getVertex(1), ve[0], l->getPartition()));
+    createEdgeVertices(t.ge, t.ele, t.num, ve, linear, nPts);
+    MEdge edge = t.ele->getEdge(t.num);
+    MVertex *vMin, *vMax;
+    if(getMinMaxVert(edge.getVertex(0), edge.getVertex(1), vMin, vMax))
+      t.v->assign(ve.begin(), ve.end());
     else
-      lines2.push_back(
-        new MLineN(l->getVertex(0), l->getVertex(1), ve, l->getPartition()));
-    delete l;
+      t.v->assign(ve.rbegin(), ve.rend());
+  }
+}
+
+static void createFaceVertices(std::vector<highOrderTask> &tasks,
+                               edgeContainer &edgeVertices, int nPts,
+                               int nthreads)
+{
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < tasks.size(); i++) {
+    highOrderTask &t = tasks[i];
+    createFaceVertices(static_cast<GRegion *>(t.ge), t.ele, t.num, *t.v,
+                       edgeVertices, nPts);
+  }
+}
+
+static void renumberVertices(std::vector<highOrderTask> &tasks,
+                             std::size_t &vertexNum)
+{
+  for(std::size_t i = 0; i < tasks.size(); i++) {
+    std::vector<MVertex *> &v = *tasks[i].v;
+    for(std::size_t j = 0; j < v.size(); j++) v[j]->forceNum(++vertexNum);
+  }
+}
+
+// Renumber the interior vertices of new elements (which are the last
+// numInterior vertices of each element), and store them in the face container
+// for 2D elements
+template <class T>
+static void renumberVertices(std::vector<T *> &elements, int numInterior,
+                             std::size_t &vertexNum,
+                             faceContainer *faceVertices = nullptr)
+{
+  if(numInterior <= 0) return;
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    T *ele = elements[i];
+    std::size_t n = ele->getNumVertices();
+    std::vector<MVertex *> *vf = nullptr;
+    if(faceVertices) vf = &(*faceVertices)[ele->getFace(0)];
+    for(std::size_t j = n - numInterior; j < n; j++) {
+      MVertex *v = ele->getVertex(j);
+      v->forceNum(++vertexNum);
+      if(vf) vf->push_back(v);
+    }
+  }
+}
+
+static int getNumInteriorVertices(int type, int nPts, bool complete)
+{
+  if(!complete) return 0;
+  return getInnerVertexPlacement(type, nPts + 1)->size1();
+}
+
+static void setHighOrder(std::vector<GEdge *> &edges,
+                         edgeContainer &edgeVertices, bool linear, int order,
+                         int nthreads)
+{
+  const int nPts = order - 1;
+
+  std::vector<std::pair<GEdge *, MLine *> > lines;
+  std::vector<bool> existing(edges.size());
+  for(std::size_t i = 0; i < edges.size(); i++) {
+    GEdge *ge = edges[i];
+    existing[i] = (getOrder(ge) == order);
+    if(existing[i]) continue;
+    for(std::size_t j = 0; j < ge->lines.size(); j++)
+      lines.push_back(std::make_pair(ge, ge->lines[j]));
+  }
+
+  std::vector<std::vector<MVertex *> > ve(lines.size());
+  std::size_t vertexNum = GModel::current()->getMaxVertexNumber();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < lines.size(); i++)
+    getEdgeVertices(lines[i].first, lines[i].second, ve[i], linear, nPts);
+  for(std::size_t i = 0; i < ve.size(); i++)
+    for(std::size_t j = 0; j < ve[i].size(); j++)
+      ve[i][j]->forceNum(++vertexNum);
+
+  std::size_t k = 0;
+  for(std::size_t i = 0; i < edges.size(); i++) {
+    GEdge *ge = edges[i];
+    if(existing[i]) {
+      setHighOrderFromExistingMesh(ge, edgeVertices);
+      continue;
+    }
+    std::vector<MLine *> lines2;
+    for(std::size_t j = 0; j < ge->lines.size(); j++, k++) {
+      MLine *l = ge->lines[j];
+      addEdgeVertices(ge, l, ve[k], edgeVertices);
+      if(nPts == 1)
+        lines2.push_back(new MLine3(l->getVertex(0), l->getVertex(1), ve[k][0],
+                                    l->getPartition()));
+      else
+        lines2.push_back(
+          new MLineN(l->getVertex(0), l->getVertex(1), ve[k], l->getPartition()));
+      delete l;
+    }
+    ge->lines = lines2;
+    ge->deleteVertexArrays();
   }
-  ge->lines = lines2;
-  ge->deleteVertexArrays();
 }
 
 static MTriangle *setHighOrder(MTriangle *t, GFace *gf,
                                edgeContainer &edgeVertices,
                                faceContainer &faceVertices, bool linear,
-                               bool incomplete, int nPts)
+                               bool incomplete, int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
   getEdgeVertices(gf, t, v, edgeVertices, linear, nPts);
   if(nPts == 1) {
     return new MTriangle6(t->getVertex(0), t->getVertex(1), t->getVertex(2),
-                          v[0], v[1], v[2], 0, t->getPartition());
+                          v[0], v[1], v[2], num, t->getPartition());
   }
   else {
-    if(!incomplete) getFaceVertices(gf, t, v, faceVertices, linear, nPts);
+    if(!incomplete) getFaceVertices(gf, t, v, linear, nPts);
     return new MTriangleN(t->getVertex(0), t->getVertex(1), t->getVertex(2), v,
-                          nPts + 1, 0, t->getPartition());
+                          nPts + 1, num, t->getPartition());
   }
 }
 
 static MQuadrangle *setHighOrder(MQuadrangle *q, GFace *gf,
                                  edgeContainer &edgeVertices,
                                  faceContainer &faceVertices, bool linear,
-                                 bool incomplete, int nPts)
+                                 bool incomplete, int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
   getEdgeVertices(gf, q, v, edgeVertices, linear, nPts);
   if(incomplete) {
     if(nPts == 1) {
       return new MQuadrangle8(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v[0], v[1], v[2], v[3], 0,
+                              q->getVertex(3), v[0], v[1], v[2], v[3], num,
                               q->getPartition());
     }
     else {
       return new MQuadrangleN(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v, nPts + 1, 0,
+                              q->getVertex(3), v, nPts + 1, num,
                               q->getPartition());
     }
   }
   else {
-    getFaceVertices(gf, q, v, faceVertices, linear, nPts);
+    getFaceVertices(gf, q, v, linear, nPts);
     if(nPts == 1) {
       return new MQuadrangle9(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v[0], v[1], v[2], v[3], v[4], 0,
-                              q->getPartition());
+                              q->getVertex(3), v[0], v[1], v[2], v[3], v[4],
+                              num, q->getPartition());
     }
     else {
       return new MQuadrangleN(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v, nPts + 1, 0,
+                              q->getVertex(3), v, nPts + 1, num,
                               q->getPartition());
     }
   }
 }
 
-static void setHighOrder(GFace *gf, edgeContainer &edgeVertices,
-                         faceContainer &faceVertices, bool linear,
-                         bool incomplete, int nPts = 1)
-{
-  std::vector<MTriangle *> triangles2;
-  for(std::size_t i = 0; i < gf->triangles.size(); i++) {
-    MTriangle *t = gf->triangles[i];
-    MTriangle *tNew =
-      setHighOrder(t, gf, edgeVertices, faceVertices, linear, incomplete, nPts);
-    triangles2.push_back(tNew);
-    delete t;
-  }
-  gf->triangles = triangles2;
-
-  std::vector<MQuadrangle *> quadrangles2;
-  for(std::size_t i = 0; i < gf->quadrangles.size(); i++) {
-    MQuadrangle *q = gf->quadrangles[i];
-    MQuadrangle *qNew =
-      setHighOrder(q, gf, edgeVertices, faceVertices, linear, incomplete, nPts);
-    quadrangles2.push_back(qNew);
-    delete q;
-  }
-  gf->quadrangles = quadrangles2;
-  gf->deleteVertexArrays();
-}
-
+// The new vertices of 3D elements are always created by interpolation
 static MTetrahedron *setHighOrder(MTetrahedron *t, GRegion *gr,
                                   edgeContainer &edgeVertices,
                                   faceContainer &faceVertices, bool incomplete,
-                                  int nPts)
+                                  int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
   getEdgeVertices(gr, t, v, edgeVertices, nPts);
   if(nPts == 1) {
     return new MTetrahedron10(t->getVertex(0), t->getVertex(1), t->getVertex(2),
                               t->getVertex(3), v[0], v[1], v[2], v[3], v[4],
-                              v[5], 0, t->getPartition());
+                              v[5], num, t->getPartition());
   }
   else {
     if(!incomplete) {
@@ -1046,7 +1265,7 @@ static MTetrahedron *setHighOrder(MTetrahedron *t, GRegion *gr,
       getVolumeVertices(gr, t, v, nPts);
     }
     return new MTetrahedronN(t->getVertex(0), t->getVertex(1), t->getVertex(2),
-                             t->getVertex(3), v, nPts + 1, 0,
+                             t->getVertex(3), v, nPts + 1, num,
                              t->getPartition());
   }
 }
@@ -1054,7 +1273,7 @@ static MTetrahedron *setHighOrder(MTetrahedron *t, GRegion *gr,
 static MHexahedron *setHighOrder(MHexahedron *h, GRegion *gr,
                                  edgeContainer &edgeVertices,
                                  faceContainer &faceVertices, bool incomplete,
-                                 int nPts)
+                                 int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
   getEdgeVertices(gr, h, v, edgeVertices, nPts);
@@ -1064,13 +1283,13 @@ static MHexahedron *setHighOrder(MHexahedron *h, GRegion *gr,
         h->getVertex(0), h->getVertex(1), h->getVertex(2), h->getVertex(3),
         h->getVertex(4), h->getVertex(5), h->getVertex(6), h->getVertex(7),
         v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
-        v[11], 0, h->getPartition());
+        v[11], num, h->getPartition());
     }
     else {
       return new MHexahedronN(h->getVertex(0), h->getVertex(1), h->getVertex(2),
                               h->getVertex(3), h->getVertex(4), h->getVertex(5),
-                              h->getVertex(6), h->getVertex(7), v, nPts + 1, 0,
-                              h->getPartition());
+                              h->getVertex(6), h->getVertex(7), v, nPts + 1,
+                              num, h->getPartition());
     }
   }
   else {
@@ -1081,21 +1300,21 @@ static MHexahedron *setHighOrder(MHexahedron *h, GRegion *gr,
         h->getVertex(0), h->getVertex(1), h->getVertex(2), h->getVertex(3),
         h->getVertex(4), h->getVertex(5), h->getVertex(6), h->getVertex(7),
         v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
-        v[11], v[12], v[13], v[14], v[15], v[16], v[17], v[18], 0,
+        v[11], v[12], v[13], v[14], v[15], v[16], v[17], v[18], num,
         h->getPartition());
     }
     else {
       return new MHexahedronN(h->getVertex(0), h->getVertex(1), h->getVertex(2),
                               h->getVertex(3), h->getVertex(4), h->getVertex(5),
-                              h->getVertex(6), h->getVertex(7), v, nPts + 1, 0,
-                              h->getPartition());
+                              h->getVertex(6), h->getVertex(7), v, nPts + 1,
+                              num, h->getPartition());
     }
   }
 }
 
 static MPrism *setHighOrder(MPrism *p, GRegion *gr, edgeContainer &edgeVertices,
                             faceContainer &faceVertices, bool incomplete,
-                            int nPts)
+                            int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
   getEdgeVertices(gr, p, v, edgeVertices, nPts);
@@ -1104,12 +1323,12 @@ static MPrism *setHighOrder(MPrism *p, GRegion *gr, edgeContainer &edgeVertices,
       return new MPrism15(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                           p->getVertex(3), p->getVertex(4), p->getVertex(5),
                           v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
-                          0, p->getPartition());
+                          num, p->getPartition());
     }
     else {
       return new MPrismN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                          p->getVertex(3), p->getVertex(4), p->getVertex(5), v,
-                         nPts + 1, 0, p->getPartition());
+                         nPts + 1, num, p->getPartition());
     }
   }
   else {
@@ -1118,13 +1337,13 @@ static MPrism *setHighOrder(MPrism *p, GRegion *gr, edgeContainer &edgeVertices,
       return new MPrism18(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                           p->getVertex(3), p->getVertex(4), p->getVertex(5),
                           v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
-                          v[9], v[10], v[11], 0, p->getPartition());
+                          v[9], v[10], v[11], num, p->getPartition());
     }
     else {
       getVolumeVertices(gr, p, v, nPts);
       return new MPrismN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                          p->getVertex(3), p->getVertex(4), p->getVertex(5), v,
-                         nPts + 1, 0, p->getPartition());
+                         nPts + 1, num, p->getPartition());
     }
   }
 }
@@ -1132,7 +1351,7 @@ static MPrism *setHighOrder(MPrism *p, GRegion *gr, edgeContainer &edgeVertices,
 static MPyramid *setHighOrder(MPyramid *p, GRegion *gr,
                               edgeContainer &edgeVertices,
                               faceContainer &faceVertices, bool incomplete,
-                              int nPts)
+                              int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
   getEdgeVertices(gr, p, v, edgeVertices, nPts);
@@ -1141,55 +1360,146 @@ static MPyramid *setHighOrder(MPyramid *p, GRegion *gr,
     if(nPts > 1) { getVolumeVertices(gr, p, v, nPts); }
   }
   return new MPyramidN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
-                       p->getVertex(3), p->getVertex(4), v, nPts + 1, 0,
+                       p->getVertex(3), p->getVertex(4), v, nPts + 1, num,
                        p->getPartition());
 }
 
-static void setHighOrder(GRegion *gr, edgeContainer &edgeVertices,
+// Assemble in parallel the high-order elements of a given type, once all the
+// vertices on their edges (and faces for 3D elements) have been created; 'args'
+// are the arguments of the element-wise setHighOrder(), before the element
+// number
+template <class T, class E, class... Args>
+static void setHighOrder(E *ge, std::vector<T *> &elements, int nthreads,
+                         Args &...args)
+{
+  GModel *m = GModel::current();
+  std::size_t elementNum = m->getMaxElementNumber();
+  std::vector<T *> elements2(elements.size());
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    T *ele = elements[i];
+    elements2[i] = setHighOrder(ele, ge, args..., elementNum + i + 1);
+    delete ele;
+  }
+  // the new elements are numbered after the previous maximum number, which is
+  // raised once for all of them
+  m->setMaxElementNumber(elementNum + elements.size());
+  elements = elements2;
+}
+
+static void setHighOrder(std::vector<GFace *> &faces,
+                         edgeContainer &edgeVertices,
+                         faceContainer &faceVertices, bool linear,
+                         bool incomplete, int order, int nthreads)
+{
+  const int nPts = order - 1;
+
+  // the unique mesh edges that require new vertices
+  std::vector<highOrderTask> edgeTasks;
+  std::vector<bool> existing(faces.size());
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    GFace *gf = faces[i];
+    existing[i] = (getOrder(gf) == order);
+    if(existing[i]) {
+      setHighOrderFromExistingMesh(gf, edgeVertices, faceVertices);
+      continue;
+    }
+    addEdgeTasks(gf, gf->triangles, edgeVertices, edgeTasks);
+    addEdgeTasks(gf, gf->quadrangles, edgeVertices, edgeTasks);
+  }
+
+  std::size_t vertexNum = GModel::current()->getMaxVertexNumber();
+  createEdgeVertices(edgeTasks, linear, nPts, nthreads);
+  renumberVertices(edgeTasks, vertexNum);
+
+  const int numTri =
+    getNumInteriorVertices(TYPE_TRI, nPts, !incomplete && nPts > 1);
+  const int numQua = getNumInteriorVertices(TYPE_QUA, nPts, !incomplete);
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    if(existing[i]) continue;
+    GFace *gf = faces[i];
+    setHighOrder(gf, gf->triangles, nthreads, edgeVertices, faceVertices,
+                 linear, incomplete, nPts);
+    renumberVertices(gf->triangles, numTri, vertexNum, &faceVertices);
+    setHighOrder(gf, gf->quadrangles, nthreads, edgeVertices, faceVertices,
+                 linear, incomplete, nPts);
+    renumberVertices(gf->quadrangles, numQua, vertexNum, &faceVertices);
+    gf->deleteVertexArrays();
+  }
+}
+
+static void setHighOrder(std::vector<GRegion *> &regions,
+                         edgeContainer &edgeVertices,
                          faceContainer &faceVertices, bool incomplete,
-                         int nPts = 1)
+                         int order, int nthreads)
 {
-  std::vector<MTetrahedron *> tetrahedra2;
-  for(std::size_t i = 0; i < gr->tetrahedra.size(); i++) {
-    MTetrahedron *t = gr->tetrahedra[i];
-    MTetrahedron *tNew =
-      setHighOrder(t, gr, edgeVertices, faceVertices, incomplete, nPts);
-    tetrahedra2.push_back(tNew);
-    delete t;
-  }
-  gr->tetrahedra = tetrahedra2;
-
-  std::vector<MHexahedron *> hexahedra2;
-  for(std::size_t i = 0; i < gr->hexahedra.size(); i++) {
-    MHexahedron *h = gr->hexahedra[i];
-    MHexahedron *hNew =
-      setHighOrder(h, gr, edgeVertices, faceVertices, incomplete, nPts);
-    hexahedra2.push_back(hNew);
-    delete h;
-  }
-  gr->hexahedra = hexahedra2;
-
-  std::vector<MPrism *> prisms2;
-  for(std::size_t i = 0; i < gr->prisms.size(); i++) {
-    MPrism *p = gr->prisms[i];
-    MPrism *pNew =
-      setHighOrder(p, gr, edgeVertices, faceVertices, incomplete, nPts);
-    prisms2.push_back(pNew);
-    delete p;
-  }
-  gr->prisms = prisms2;
-
-  std::vector<MPyramid *> pyramids2;
-  for(std::size_t i = 0; i < gr->pyramids.size(); i++) {
-    MPyramid *p = gr->pyramids[i];
-    MPyramid *pNew =
-      setHighOrder(p, gr, edgeVertices, faceVertices, incomplete, nPts);
-    pyramids2.push_back(pNew);
-    delete p;
-  }
-  gr->pyramids = pyramids2;
-
-  gr->deleteVertexArrays();
+  const int nPts = order - 1;
+
+  std::vector<GRegion *> todo;
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    if(getOrder(regions[i]) != order) todo.push_back(regions[i]);
+  }
+
+  // the unique mesh edges that require new vertices
+  std::vector<highOrderTask> edgeTasks;
+  for(std::size_t i = 0; i < todo.size(); i++) {
+    GRegion *gr = todo[i];
+    addEdgeTasks(gr, gr->tetrahedra, edgeVertices, edgeTasks);
+    addEdgeTasks(gr, gr->hexahedra, edgeVertices, edgeTasks);
+    addEdgeTasks(gr, gr->prisms, edgeVertices, edgeTasks);
+    addEdgeTasks(gr, gr->pyramids, edgeVertices, edgeTasks);
+  }
+
+  std::size_t vertexNum = GModel::current()->getMaxVertexNumber();
+  createEdgeVertices(edgeTasks, true, nPts, nthreads);
+  renumberVertices(edgeTasks, vertexNum);
+
+  // the unique mesh faces that require new vertices
+  std::vector<highOrderTask> faceTasks;
+  if(!incomplete) {
+    for(std::size_t i = 0; i < todo.size(); i++) {
+      GRegion *gr = todo[i];
+      if(nPts > 1) addFaceTasks(gr, gr->tetrahedra, faceVertices, faceTasks);
+      addFaceTasks(gr, gr->hexahedra, faceVertices, faceTasks);
+      addFaceTasks(gr, gr->prisms, faceVertices, faceTasks);
+      addFaceTasks(gr, gr->pyramids, faceVertices, faceTasks);
+    }
+  }
+
+  createFaceVertices(faceTasks, edgeVertices, nPts, nthreads);
+  renumberVertices(faceTasks, vertexNum);
+
+  const bool complete = !incomplete && nPts > 1;
+  const int numTet = getNumInteriorVertices(TYPE_TET, nPts, complete);
+  const int numHex = getNumInteriorVertices(TYPE_HEX, nPts, !incomplete);
+  const int numPri = getNumInteriorVertices(TYPE_PRI, nPts, complete);
+  const int numPyr = getNumInteriorVertices(TYPE_PYR, nPts, complete);
+  for(std::size_t i = 0; i < todo.size(); i++) {
+    GRegion *gr = todo[i];
+    setHighOrder(gr, gr->tetrahedra, nthreads, edgeVertices, faceVertices,
+                 incomplete, nPts);
+    renumberVertices(gr->tetrahedra, numTet, vertexNum);
+    setHighOrder(gr, gr->hexahedra, nthreads, edgeVertices, faceVertices,
+                 incomplete, nPts);
+    renumberVertices(gr->hexahedra, numHex, vertexNum);
+    setHighOrder(gr, gr->prisms, nthreads, edgeVertices, faceVertices,
+                 incomplete, nPts);
+    renumberVertices(gr->prisms, numPri, vertexNum);
+    setHighOrder(gr, gr->pyramids, nthreads, edgeVertices, faceVertices,
+                 incomplete, nPts);
+    renumberVertices(gr->pyramids, numPyr, vertexNum);
+    gr->deleteVertexArrays();
+  }
+}
+
+// Make sure that the interpolation data that is built on demand is available
+// before creating the high-order vertices in parallel
+static void initializeInterpolationData(int order, int maxOrder)
+{
+  for(int o = 1; o <= std::max(order, maxOrder); o++)
+    BasisFactory::getNodalBasis(ElementType::getType(TYPE_LIN, o));
+  for(int type = TYPE_TRI; type <= TYPE_HEX; type++)
+    getInnerVertexPlacement(type, order);
 }
 
 // High-level functions
@@ -1338,62 +1648,6 @@ void checkHighOrderTetrahedron(const char *cc, GModel *m,
       minJGlob, avg / (count ? count : 1), bad.size());
 }
 
-static int getOrder(GEntity *ge)
-{
-  for(std::size_t i = 0; i < ge->getNumMeshElements(); i++)
-    return ge->getMeshElement(i)->getPolynomialOrder();
-  return 0;
-}
-
-static void setHighOrderFromExistingMesh(GEdge *ge, edgeContainer &edgeVertices)
-{
-  for(std::size_t i = 0; i < ge->getNumMeshElements(); i++) {
-    MElement *e = ge->getMeshElement(i);
-    std::vector<MVertex *> v;
-    e->getVertices(v);
-    MVertex *vMin, *vMax;
-    const bool increasing = getMinMaxVert(v[0], v[1], vMin, vMax);
-    std::pair<MVertex *, MVertex *> p(vMin, vMax);
-    if(edgeVertices.count(p) == 0) {
-      if(increasing)
-        edgeVertices[p].insert(edgeVertices[p].end(), v.begin() + e->getNumPrimaryVertices(), v.end());
-      else
-        edgeVertices[p].insert(edgeVertices[p].end(), v.rbegin(), v.rend() - e->getNumPrimaryVertices());
-    }
-  }
-}
-
-static void setHighOrderFromExistingMesh(GFace *gf, edgeContainer &edgeVertices,
-                                         faceContainer &faceVertices)
-{
-  for(std::size_t i = 0; i < gf->getNumMeshElements(); i++) {
-    MElement *e = gf->getMeshElement(i);
-    for(int j = 0; j < e->getNumEdges(); j++) {
-      MEdge edg = e->getEdge(j);
-      MVertex *vMin, *vMax;
-      const bool increasing = getMinMaxVert(edg.getVertex(0), edg.getVertex(1), vMin, vMax);
-      std::pair<MVertex *, MVertex *> p(vMin, vMax);
-      if(edgeVertices.count(p) == 0) {
-        std::vector<MVertex *> edgv;
-        e->getEdgeVertices(j, edgv);
-        if(increasing)
-          edgeVertices[p].insert(edgeVertices[p].end(), edgv.begin() + 2, edgv.end());
-        else
-          edgeVertices[p].insert(edgeVertices[p].end(), edgv.rbegin(), edgv.rend() - 2);
-      }
-    }
-    MFace f = e->getFace(0);
-    std::vector<MVertex *> facev;
-    if(faceVertices.count(f) == 0) {
-      e->getFaceVertices(0, facev);
-      for(std::size_t j = e->getNumPrimaryVertices() + e->getNumEdgeVertices();
-          j < facev.size(); j++) {
-        faceVertices[f].push_back(facev[j]);
-      }
-    }
-  }
-}
-
 void SetOrderN(GModel *m, int order, bool linear, bool incomplete,
                bool onlyVisible)
 {
@@ -1416,8 +1670,6 @@ void SetOrderN(GModel *m, int order, bool linear, bool incomplete,
 
   // - if onlyVisible is true, then only the visible entities will be curved.
 
-  int nPts = order - 1;
-
   char msg[256];
   sprintf(msg, "Meshing order %d (curvilinear %s)...", order,
           linear ? "off" : "on");
@@ -1439,35 +1691,54 @@ void SetOrderN(GModel *m, int order, bool linear, bool incomplete,
   // TODO: we can leak nodes of discrete entities with existing high-order
   // nodes, if we ask a mesh with a different order
 
+  std::vector<GEdge *> edges;
+  std::vector<GFace *> faces;
+  std::vector<GRegion *> regions;
+  int maxOrder = 1;
   for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
-    Msg::Info("Meshing curve %d order %d", (*it)->tag(), order);
-    Msg::ProgressMeter(++counter, false, msg);
     if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, linear, nPts);
-    else
-      setHighOrderFromExistingMesh(*it, edgeVertices);
+    edges.push_back(*it);
+    maxOrder = std::max(maxOrder, getOrder(*it));
   }
-
   for(auto it = m->firstFace(); it != m->lastFace(); ++it) {
-    Msg::Info("Meshing surface %d order %d", (*it)->tag(), order);
-    Msg::ProgressMeter(++counter, false, msg);
     if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, faceVertices, linear, incomplete, nPts);
-    else
-      setHighOrderFromExistingMesh(*it, edgeVertices, faceVertices);
-    if((*it)->getColumns() != nullptr) (*it)->getColumns()->clearElementData();
+    faces.push_back(*it);
+    maxOrder = std::max(maxOrder, getOrder(*it));
   }
-
   for(auto it = m->firstRegion(); it != m->lastRegion(); ++it) {
-    Msg::Info("Meshing volume %d order %d", (*it)->tag(), order);
-    Msg::ProgressMeter(++counter, false, msg);
     if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, faceVertices, incomplete, nPts);
-    if((*it)->getColumns() != nullptr) (*it)->getColumns()->clearElementData();
+    regions.push_back(*it);
+    maxOrder = std::max(maxOrder, getOrder(*it));
+  }
+
+  int nthreads = Msg::GetMaxThreads();
+  initializeInterpolationData(order, maxOrder);
+
+  Msg::Info("Meshing %d curve%s order %d", (int)edges.size(),
+            edges.size() > 1 ? "s" : "", order);
+  setHighOrder(edges, edgeVertices, linear, order, nthreads);
+  counter += m->getNumEdges();
+  Msg::ProgressMeter(counter, false, msg);
+
+  Msg::Info("Meshing %d surface%s order %d", (int)faces.size(),
+            faces.size() > 1 ? "s" : "", order);
+  setHighOrder(faces, edgeVertices, faceVertices, linear, incomplete, order,
+               nthreads);
+  for(auto gf : faces) {
+    if(gf->getColumns() != nullptr) gf->getColumns()->clearElementData();
+  }
+  counter += m->getNumFaces();
+  Msg::ProgressMeter(counter, false, msg);
+
+  Msg::Info("Meshing %d volume%s order %d", (int)regions.size(),
+            regions.size() > 1 ? "s" : "", order);
+  setHighOrder(regions, edgeVertices, faceVertices, incomplete, order,
+               nthreads);
+  for(auto gr : regions) {
+    if(gr->getColumns() != nullptr) gr->getColumns()->clearElementData();
   }
+  counter += m->getNumRegions();
+  Msg::ProgressMeter(counter, false, msg);
 
   // store nodes in entities
   m->pruneMeshVertexAssociations();
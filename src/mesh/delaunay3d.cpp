@@ -25,6 +25,7 @@
 #include "Context.h"
 #include "robustPredicates.h"
 #include "OS.h"
+#include "GmshMessage.h"
 
 #ifndef MAX_NUM_THREADS_
 #define MAX_NUM_THREADS_ 8
@@ -1262,7 +1263,9 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
     _temp[v->getNum()] = mv;
   }
 
-  robustPredicates::exactinit(maxx, maxy, maxz);
+  // in a parallel region the static filters are shared by all the threads and
+  // have been initialized by the caller for the whole model
+  if(Msg::GetNumThreads() == 1) robustPredicates::exactinit(maxx, maxy, maxz);
 
   Vert *box[8];
   delaunayTriangulation(numThreads, nptsatonce, _vertices, box, allocator);
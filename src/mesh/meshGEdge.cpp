@@ -204,13 +204,43 @@ struct F_LcB {
   }
 };
 
+// norm of the derivative of the curve at the parameters sampled when computing
+// its length: the size integration samples (mostly) the same parameters, which
+// then do not require evaluating the derivative again
+class DerivativeCache {
+private:
+  std::vector<std::pair<double, double> > _samples;
+
+public:
+  void set(const std::vector<IntPoint> &Points)
+  {
+    _samples.resize(Points.size());
+    for(std::size_t i = 0; i < Points.size(); i++)
+      _samples[i] = std::make_pair(Points[i].t, Points[i].lc);
+    std::sort(_samples.begin(), _samples.end());
+  }
+  double operator()(GEdge *ge, double t) const
+  {
+    auto it = std::lower_bound(
+      _samples.begin(), _samples.end(), t,
+      [](const std::pair<double, double> &s, double t) { return s.first < t; });
+    if(it != _samples.end() && it->first == t) return it->second;
+    return norm(ge->firstDer(t));
+  }
+};
+
 struct F_Lc {
-  double operator()(GEdge *ge, double t)
+  const DerivativeCache &der;
+  double t_begin, t_end;
+  F_Lc(GEdge *ge, const DerivativeCache &d) : der(d)
   {
-    GPoint p = ge->point(t);
     Range<double> bounds = ge->parBounds(0);
-    double t_begin = bounds.low();
-    double t_end = bounds.high();
+    t_begin = bounds.low();
+    t_end = bounds.high();
+  }
+  double operator()(GEdge *ge, double t, double &xp)
+  {
+    GPoint p = ge->point(t);
     double lc_here = 1.e22;
     if(t == t_begin && ge->getBeginVertex())
       lc_here = BGM_MeshSize(ge->getBeginVertex(), t, 0, p.x(), p.y(), p.z());
@@ -218,21 +248,24 @@ struct F_Lc {
       lc_here = BGM_MeshSize(ge->getEndVertex(), t, 0, p.x(), p.y(), p.z());
 
     lc_here = std::min(lc_here, BGM_MeshSize(ge, t, 0, p.x(), p.y(), p.z()));
-    SVector3 der = ge->firstDer(t);
-    return norm(der) / lc_here;
+    xp = der(ge, t);
+    return xp / lc_here;
   }
 };
 
 struct F_Lc_aniso {
-  double operator()(GEdge *ge, double t)
+  double t_begin, t_end;
+  F_Lc_aniso(GEdge *ge)
+  {
+    Range<double> bounds = ge->parBounds(0);
+    t_begin = bounds.low();
+    t_end = bounds.high();
+  }
+  double operator()(GEdge *ge, double t, double &xp)
   {
     GPoint p = ge->point(t);
     SMetric3 lc_here;
 
-    Range<double> bounds = ge->parBounds(0);
-    double t_begin = bounds.low();
-    double t_end = bounds.high();
-
     if(t == t_begin && ge->getBeginVertex())
       lc_here = BGM_MeshMetric(ge->getBeginVertex(), t, 0, p.x(), p.y(), p.z());
     else if(t == t_end && ge->getEndVertex())
@@ -252,8 +285,9 @@ struct F_Lc_aniso {
       lc_here = intersection_conserveM1(lc_here, lc_bgm);
     }
 
-    SVector3 der = ge->firstDer(t);
-    return std::sqrt(dot(der, lc_here, der));
+    SVector3 d = ge->firstDer(t);
+    xp = norm(d);
+    return std::sqrt(dot(d, lc_here, d));
   }
 };
 
@@ -272,21 +306,19 @@ static double dfbeta(double t, double beta)
 }
 
 struct F_Transfinite {
-  double operator()(GEdge *ge, double t_)
+  double length, coef, t_begin, t_end;
+  int type, atype, nbpt;
+  F_Transfinite(GEdge *ge)
   {
-    double length = ge->length();
+    length = ge->length();
     if(length == 0.0) {
       Msg::Error("Zero-length curve %d in transfinite mesh", ge->tag());
-      return 1.;
+      return;
     }
 
-    SVector3 der = ge->firstDer(t_);
-    double d = norm(der);
-    double coef = ge->meshAttributes.coeffTransfinite;
-    int type = ge->meshAttributes.typeTransfinite;
-    int nbpt = ge->meshAttributes.nbPointsTransfinite;
-
-    //    printf("type = %d coef %g\n",type, coef);
+    coef = ge->meshAttributes.coeffTransfinite;
+    type = ge->meshAttributes.typeTransfinite;
+    nbpt = ge->meshAttributes.nbPointsTransfinite;
 
     // transform type = 5 onto type = 1
     if (type == 5){
@@ -311,16 +343,23 @@ struct F_Transfinite {
       type = 3*(sgn ? 1 : -1);
     }
 
-    
-    int atype = std::abs(type);
-    
+    atype = std::abs(type);
+
     if(CTX::instance()->mesh.flexibleTransfinite &&
        CTX::instance()->mesh.lcFactor)
       nbpt /= CTX::instance()->mesh.lcFactor;
 
     Range<double> bounds = ge->parBounds(0);
-    double t_begin = bounds.low();
-    double t_end = bounds.high();
+    t_begin = bounds.low();
+    t_end = bounds.high();
+  }
+  double operator()(GEdge *ge, double t_, double &xp)
+  {
+    SVector3 der = ge->firstDer(t_);
+    double d = norm(der);
+    xp = d;
+    if(length == 0.0) return 1.;
+
     double t = (t_ - t_begin) / (t_end - t_begin);
 
     double val;
@@ -380,10 +419,11 @@ struct F_Transfinite {
 };
 
 struct F_One {
-  double operator()(GEdge *ge, double t)
+  double operator()(GEdge *ge, double t, double &xp)
   {
     SVector3 der = ge->firstDer(t);
-    return norm(der);
+    xp = norm(der);
+    return xp;
   }
 };
 
@@ -394,7 +434,7 @@ static double trapezoidal(IntPoint *const P1, IntPoint *const P2)
 
 template <typename function>
 static void RecursiveIntegration(GEdge *ge, IntPoint *from, IntPoint *to,
-                                 function f, std::vector<IntPoint> &Points,
+                                 function &f, std::vector<IntPoint> &Points,
                                  double Prec, int *depth)
 {
   IntPoint P, p1;
@@ -402,7 +442,7 @@ static void RecursiveIntegration(GEdge *ge, IntPoint *from, IntPoint *to,
   (*depth)++;
 
   P.t = 0.5 * (from->t + to->t);
-  P.lc = f(ge, P.t);
+  P.lc = f(ge, P.t, P.xp);
 
   double const val1 = trapezoidal(from, to);
   double const val2 = trapezoidal(from, &P);
@@ -435,12 +475,12 @@ static double Integration(GEdge *ge, double t1, double t2, function f,
   int depth = 0;
 
   from.t = t1;
-  from.lc = f(ge, from.t);
+  from.lc = f(ge, from.t, from.xp);
   from.p = 0.0;
   Points.push_back(from);
 
   to.t = t2;
-  to.lc = f(ge, to.t);
+  to.lc = f(ge, to.t, to.xp);
 
   RecursiveIntegration(ge, &from, &to, f, Points, Prec, &depth);
 
@@ -783,6 +823,8 @@ int meshGEdgeProcessing(GEdge *ge, const double t_begin, double t_end, int &N,
                          CTX::instance()->mesh.lcIntegrationPrecision *
                            CTX::instance()->lc);
   ge->setLength(length);
+  DerivativeCache der;
+  der.set(Points);
   Points.clear();
 
   if(length < CTX::instance()->mesh.toleranceEdgeLength) {
@@ -805,12 +847,12 @@ int meshGEdgeProcessing(GEdge *ge, const double t_begin, double t_end, int &N,
           ge->meshAttributes.typeTransfinite == 4) {
     // Transfinite (prescribed number of edges) but the points are positioned
     // according to the standard size constraints (size map, etc)
-    a = Integration(ge, t_begin, t_end, F_Lc(), Points,
+    a = Integration(ge, t_begin, t_end, F_Lc(ge, der), Points,
                     CTX::instance()->mesh.lcIntegrationPrecision);
     N = ge->meshAttributes.nbPointsTransfinite;
   }
   else if(ge->meshAttributes.method == MESH_TRANSFINITE) {
-    a = Integration(ge, t_begin, t_end, F_Transfinite(), Points,
+    a = Integration(ge, t_begin, t_end, F_Transfinite(ge), Points,
                     CTX::instance()->mesh.lcIntegrationPrecision);
     N = ge->meshAttributes.nbPointsTransfinite;
     if(CTX::instance()->mesh.flexibleTransfinite &&
@@ -819,20 +861,16 @@ int meshGEdgeProcessing(GEdge *ge, const double t_begin, double t_end, int &N,
   }
   else {
     if(CTX::instance()->mesh.algo2d == ALGO_2D_BAMG /* || blf*/) {
-      a = Integration(ge, t_begin, t_end, F_Lc_aniso(), Points,
+      a = Integration(ge, t_begin, t_end, F_Lc_aniso(ge), Points,
                       CTX::instance()->mesh.lcIntegrationPrecision);
     }
     else {
-      a = Integration(ge, t_begin, t_end, F_Lc(), Points,
+      a = Integration(ge, t_begin, t_end, F_Lc(ge, der), Points,
                       CTX::instance()->mesh.lcIntegrationPrecision);
     }
 
-    // we should maybe provide an option to disable the smoothing
-    for(std::size_t i = 0; i < Points.size(); i++) {
-      IntPoint &pt = Points[i];
-      SVector3 der = ge->firstDer(pt.t);
-      pt.xp = der.norm();
-    }
+    // we should maybe provide an option to disable the smoothing (the norm of
+    // the derivative at each point has been stored during the integration)
     if(CTX::instance()->mesh.algo2d != ALGO_2D_BAMG)
       a = smoothPrimitive(ge, std::sqrt(CTX::instance()->mesh.smoothRatio),
                           Points);
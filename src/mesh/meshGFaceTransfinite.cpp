@@ -547,6 +547,7 @@ int MeshTransfiniteSurface(GFace *gf)
   if(corners.size() == 4) {
     double UC4 = U[N4];
     double VC4 = V[N4];
+    gf->mesh_vertices.reserve(gf->mesh_vertices.size() + (L - 1) * (H - 1));
     for(int i = 1; i < L; i++) {
       double u = lengths_i[i] / L_i;
       for(int j = 1; j < H; j++) {
@@ -897,13 +898,19 @@ int MeshTransfiniteSurface(GFace *gf)
 
   // create elements
   if(corners.size() == 4) {
+    const bool recombine =
+      CTX::instance()->mesh.recombineAll || gf->meshAttributes.recombine;
+    if(recombine)
+      gf->quadrangles.reserve(gf->quadrangles.size() + L * H);
+    else
+      gf->triangles.reserve(gf->triangles.size() + 2 * L * H);
     for(int i = 0; i < L; i++) {
       for(int j = 0; j < H; j++) {
         MVertex *v1 = tab[i][j];
         MVertex *v2 = tab[i + 1][j];
         MVertex *v3 = tab[i + 1][j + 1];
         MVertex *v4 = tab[i][j + 1];
-        if(CTX::instance()->mesh.recombineAll || gf->meshAttributes.recombine)
+        if(recombine)
           _addQuadrangle(gf, v1, v2, v3, v4);
         else if(gf->meshAttributes.transfiniteArrangement == 1 ||
                 (gf->meshAttributes.transfiniteArrangement == 2 &&
@@ -4,7 +4,12 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <stdlib.h>
+#include <cmath>
+#include <algorithm>
 #include <vector>
+#include <set>
+#include <map>
+#include <stdexcept>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "meshGRegion.h"
@@ -14,13 +19,16 @@
 #include "meshGFace.h"
 #include "meshGFaceOptimize.h"
 #include "meshGRegionBoundaryRecovery.h"
+#include "GraphColoring.h"
 #include "meshGRegionDelaunayInsertion.h"
 #include "meshRelocateVertex.h"
 #include "meshUntangle.h"
+#include "robustPredicates.h"
 #include "GModel.h"
 #include "GRegion.h"
 #include "GFace.h"
 #include "GEdge.h"
+#include "GVertex.h"
 #include "discreteFace.h"
 #include "discreteEdge.h"
 #include "MLine.h"
@@ -87,21 +95,19 @@ int splitQuadRecovery::buildPyramids(GModel *gm)
   return npyram;
 }
 
-void MeshDelaunayVolume(std::vector<GRegion *> &regions)
+static bool isBoundaryRecoveryAlgo()
 {
-  if(regions.empty()) return;
-
-  if(CTX::instance()->mesh.algo3d == ALGO_3D_HXT) {
-    if(meshGRegionHxt(regions) != 0) { Msg::Error("HXT 3D mesh failed"); }
-    return;
-  }
-
-  if(CTX::instance()->mesh.algo3d != ALGO_3D_RTREE &&
-     CTX::instance()->mesh.algo3d != ALGO_3D_DELAUNAY &&
-     CTX::instance()->mesh.algo3d != ALGO_3D_INITIAL_ONLY &&
-     CTX::instance()->mesh.algo3d != ALGO_3D_MMG3D)
-    return;
+  return CTX::instance()->mesh.algo3d == ALGO_3D_RTREE ||
+         CTX::instance()->mesh.algo3d == ALGO_3D_DELAUNAY ||
+         CTX::instance()->mesh.algo3d == ALGO_3D_INITIAL_ONLY ||
+         CTX::instance()->mesh.algo3d == ALGO_3D_MMG3D;
+}
 
+// build the initial (boundary conforming) tetrahedralization of a group of
+// connected volumes; the mesh is stored in the first region of the group
+static bool recoverBoundaryOfVolumes(std::vector<GRegion *> &regions,
+                                     splitQuadRecovery &sqr)
+{
   GRegion *gr = regions[0];
   std::vector<GFace *> faces = gr->faces();
 
@@ -150,7 +156,6 @@ void MeshDelaunayVolume(std::vector<GRegion *> &regions)
   std::vector<GVertex *> oldEmbVertices = gr->embeddedVertices();
   gr->embeddedVertices() = allEmbVertices;
 
-  splitQuadRecovery sqr;
   bool success = meshGRegionBoundaryRecovery(gr, &sqr);
 
   // sort triangles in all model faces in order to be able to search in vectors
@@ -180,9 +185,16 @@ void MeshDelaunayVolume(std::vector<GRegion *> &regions)
   gr->embeddedEdges() = oldEmbEdges;
   gr->embeddedVertices() = oldEmbVertices;
 
-  if(!success) return;
+  return success;
+}
+
+// insert points in the initial tetrahedralization of a group of connected
+// volumes
+static void refineVolumes(std::vector<GRegion *> &regions,
+                          splitQuadRecovery &sqr)
+{
+  GRegion *gr = regions[0];
 
-  // now do insertion of points
   if(CTX::instance()->mesh.algo3d == ALGO_3D_MMG3D) {
     for(std::size_t i = 0; i < regions.size(); i++) {
       refineMeshMMG(regions[i]);
@@ -207,6 +219,118 @@ void MeshDelaunayVolume(std::vector<GRegion *> &regions)
   }
 }
 
+void MeshDelaunayVolume(std::vector<GRegion *> &regions)
+{
+  if(regions.empty()) return;
+
+  if(CTX::instance()->mesh.algo3d == ALGO_3D_HXT) {
+    if(meshGRegionHxt(regions) != 0) { Msg::Error("HXT 3D mesh failed"); }
+    return;
+  }
+
+  if(!isBoundaryRecoveryAlgo()) return;
+
+  splitQuadRecovery sqr;
+  if(!recoverBoundaryOfVolumes(regions, sqr)) return;
+  refineVolumes(regions, sqr);
+}
+
+// assign a color to each group of volumes, such that groups sharing a curve or
+// a point (and thus mesh nodes that can be modified during boundary recovery,
+// e.g. by the insertion of Steiner points) never have the same color
+static int colorVolumeGroups(std::vector<std::vector<GRegion *> > &connected,
+                             std::vector<int> &color)
+{
+  std::vector<std::set<GEntity *> > closures(connected.size());
+  for(std::size_t i = 0; i < connected.size(); i++) {
+    std::set<GEntity *> &closure = closures[i];
+    for(auto gr : connected[i]) {
+      std::vector<GEdge *> edges = gr->edges();
+      std::vector<GEdge *> const &ee = gr->embeddedEdges();
+      edges.insert(edges.end(), ee.begin(), ee.end());
+      for(auto ge : edges) {
+        closure.insert(ge);
+        if(ge->getBeginVertex()) closure.insert(ge->getBeginVertex());
+        if(ge->getEndVertex()) closure.insert(ge->getEndVertex());
+      }
+      std::vector<GVertex *> const &ev = gr->embeddedVertices();
+      closure.insert(ev.begin(), ev.end());
+    }
+  }
+  return greedyColoring(closures, color);
+}
+
+void MeshDelaunayVolumes(std::vector<std::vector<GRegion *> > &connected,
+                         int nthreads)
+{
+  if(CTX::instance()->mesh.algo3d == ALGO_3D_HXT || nthreads < 2 ||
+     connected.size() < 2) {
+    for(std::size_t i = 0; i < connected.size(); i++) {
+      if(CTX::instance()->abortOnError && Msg::GetErrorCount()) {
+        Msg::Warning("Aborted 3D meshing");
+        break;
+      }
+      MeshDelaunayVolume(connected[i]);
+    }
+    return;
+  }
+
+  if(!isBoundaryRecoveryAlgo()) return;
+
+  std::vector<int> color;
+  int numColors = colorVolumeGroups(connected, color);
+  Msg::Info("Recovering boundary of %d groups of volumes in %d pass%s",
+            (int)connected.size(), numColors, numColors > 1 ? "es" : "");
+
+  // the static filters of the robust predicates depend on the size of the
+  // domain: initialize them once for the whole model, as they are shared by
+  // all the threads
+  SBoundingBox3d bb = connected[0][0]->model()->bounds();
+  double maxx = 1.1 * std::max(std::abs(bb.min().x()), std::abs(bb.max().x()));
+  double maxy = 1.1 * std::max(std::abs(bb.min().y()), std::abs(bb.max().y()));
+  double maxz = 1.1 * std::max(std::abs(bb.min().z()), std::abs(bb.max().z()));
+  robustPredicates::exactinit(maxx, maxy, maxz);
+  // same for the look-up tables of the boundary recovery
+  initMeshGRegionBoundaryRecovery();
+
+  std::vector<splitQuadRecovery> sqr(connected.size());
+  std::vector<char> success(connected.size(), 0);
+  for(int c = 0; c < numColors; c++) {
+    if(CTX::instance()->abortOnError && Msg::GetErrorCount()) {
+      Msg::Warning("Aborted 3D meshing");
+      return;
+    }
+    std::vector<std::size_t> batch;
+    for(std::size_t i = 0; i < connected.size(); i++) {
+      if(color[i] == c) batch.push_back(i);
+    }
+    bool exceptions = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t k = 0; k < batch.size(); k++) {
+      if(exceptions) continue;
+      std::size_t i = batch[k];
+      try { // OpenMP forbids leaving block via exception
+        success[i] = recoverBoundaryOfVolumes(connected[i], sqr[i]);
+      }
+      catch(...) {
+        exceptions = true;
+      }
+    }
+    if(exceptions) {
+      CTX::instance()->lock = 0;
+      throw std::runtime_error(Msg::GetLastError());
+    }
+  }
+
+  for(std::size_t i = 0; i < connected.size(); i++) {
+    if(CTX::instance()->abortOnError && Msg::GetErrorCount()) {
+      Msg::Warning("Aborted 3D meshing");
+      break;
+    }
+    if(success[i]) refineVolumes(connected[i], sqr[i]);
+  }
+}
+
 void deMeshGRegion::operator()(GRegion *gr)
 {
   if(gr->isFullyDiscrete()) return;
@@ -229,6 +353,13 @@ void meshGRegion::operator()(GRegion *gr)
   deMeshGRegion dem;
   dem(gr);
 
+  // defer the transfinite volumes if requested, so that they can be meshed
+  // concurrently
+  if(transfinite && gr->meshAttributes.method == MESH_TRANSFINITE) {
+    transfinite->push_back(gr);
+    return;
+  }
+
   if(MeshTransfiniteVolume(gr)) return;
 
   if(CTX::instance()->mesh.algo3d != ALGO_3D_FRONTAL) {
@@ -239,6 +370,52 @@ void meshGRegion::operator()(GRegion *gr)
   }
 }
 
+void MeshTransfiniteVolumes(std::vector<GRegion *> &regions, int nthreads,
+                            std::vector<GRegion *> &delaunay)
+{
+  std::vector<char> success(regions.size(), 0);
+
+  // QuadTri subdivision is not thread-safe
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    if(regions[i]->meshAttributes.QuadTri) nthreads = 1;
+  }
+
+  if(regions.size() < 2 || nthreads < 2) {
+    // use the threads to compute the nodes inside each volume
+    for(std::size_t i = 0; i < regions.size(); i++)
+      success[i] = MeshTransfiniteVolume(regions[i], nthreads) ? 1 : 0;
+  }
+  else {
+    // each volume only reads the mesh of its bounding surfaces: mesh the
+    // volumes concurrently
+    bool exceptions = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t i = 0; i < regions.size(); i++) {
+      bool skip;
+#pragma omp atomic read
+      skip = exceptions;
+      if(skip) continue;
+      try { // OpenMP forbids leaving block via exception
+        success[i] = MeshTransfiniteVolume(regions[i]) ? 1 : 0;
+      }
+      catch(...) {
+#pragma omp atomic write
+        exceptions = true;
+      }
+    }
+    if(exceptions) throw std::runtime_error(Msg::GetLastError());
+  }
+
+  // fall back to the unstructured algorithms, as meshGRegion does
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    if(success[i]) continue;
+    if(CTX::instance()->mesh.algo3d != ALGO_3D_FRONTAL)
+      delaunay.push_back(regions[i]);
+    else
+      meshGRegionNetgen(regions[i]);
+  }
+}
+
 void untangleMeshGRegion::operator()(GRegion *gr, bool always)
 {
   gr->model()->setCurrentMeshEntity(gr);
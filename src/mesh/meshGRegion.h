@@ -23,7 +23,14 @@ class MTriangle;
 class meshGRegion {
 public:
   std::vector<GRegion *> &delaunay;
-  meshGRegion(std::vector<GRegion *> &d) : delaunay(d) {}
+  // if not null, transfinite volumes are collected here instead of being
+  // meshed
+  std::vector<GRegion *> *transfinite;
+  meshGRegion(std::vector<GRegion *> &d,
+              std::vector<GRegion *> *t = nullptr)
+    : delaunay(d), transfinite(t)
+  {
+  }
   void operator()(GRegion *);
 };
 
@@ -58,8 +65,22 @@ public:
 };
 
 void MeshDelaunayVolume(std::vector<GRegion *> &delaunay);
+// Mesh groups of connected volumes; the boundary of groups that share no curve
+// or point is recovered concurrently with up to nthreads threads
+void MeshDelaunayVolumes(std::vector<std::vector<GRegion *> > &connected,
+                         int nthreads);
 bool CreateAnEmptyVolumeMesh(GRegion *gr);
-int MeshTransfiniteVolume(GRegion *gr);
+// Mesh a transfinite volume; the interior nodes are computed with up to
+// nthreads threads
+int MeshTransfiniteVolume(GRegion *gr, int nthreads = 1);
+// Mesh transfinite volumes concurrently with up to nthreads threads; volumes
+// that cannot be meshed with the transfinite algorithm are added to delaunay
+// (or meshed with the frontal algorithm)
+void MeshTransfiniteVolumes(std::vector<GRegion *> &regions, int nthreads,
+                            std::vector<GRegion *> &delaunay);
+// Mesh the extruded volumes; volumes with their own extrusion parameters are
+// meshed concurrently with up to nthreads threads
+void MeshExtrudedVolumes(GModel *m, int nthreads);
 int SubdivideExtrudedMesh(GModel *m);
 void carveHole(GRegion *gr, int num, double distance,
                std::vector<int> &surfaces);
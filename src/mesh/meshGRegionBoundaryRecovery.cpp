@@ -7,6 +7,9 @@
 #include <string.h>
 #include <assert.h>
 #include <sstream>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 #include "GmshConfig.h"
 #include "meshGRegionBoundaryRecovery.h"
 
@@ -1297,6 +1300,8 @@ namespace tetgenBR {
         int etags[2] = {tetgenBR::sevent.s_marker1, tetgenBR::sevent.s_marker2};
         std::ostringstream pb;
         std::vector<double> x, y, z, val;
+        // the boundary of several volumes can be recovered concurrently
+#pragma omp critical(meshGRegionBoundaryRecoveryError)
         for(int f = 0; f < 2; f++) {
           if(ftags[f] > 0) {
             GFace *gf = gr->model()->getFaceByTag(ftags[f]);
@@ -1336,10 +1341,13 @@ namespace tetgenBR {
         Msg::Error("Invalid boundary mesh (%s) on%s", what.c_str(),
                    pb.str().c_str());
 #if defined(HAVE_POST)
+#pragma omp critical(meshGRegionBoundaryRecoveryError)
         new PView("Boundary mesh issue", x, y, z, val);
 #if defined(HAVE_FLTK)
-        if(FlGui::available()) FlGui::instance()->updateViews(true, true);
-        drawContext::global()->draw();
+        if(Msg::GetNumThreads() == 1) {
+          if(FlGui::available()) FlGui::instance()->updateViews(true, true);
+          drawContext::global()->draw();
+        }
 #endif
 #endif
         ret = false;
@@ -1352,6 +1360,8 @@ namespace tetgenBR {
     return ret;
   }
 
+  void initMeshGRegionBoundaryRecovery() { tetgenBR::tetgenmesh::inittables(); }
+
 #else
 
 bool meshGRegionBoundaryRecovery(GRegion *gr, splitQuadRecovery *sqr)
@@ -1359,4 +1369,6 @@ bool meshGRegionBoundaryRecovery(GRegion *gr, splitQuadRecovery *sqr)
   return false;
 }
 
+void initMeshGRegionBoundaryRecovery() {}
+
 #endif
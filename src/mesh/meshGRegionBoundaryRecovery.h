@@ -11,4 +11,8 @@ class splitQuadRecovery;
 
 bool meshGRegionBoundaryRecovery(GRegion *gr, splitQuadRecovery *sqr = nullptr);
 
+// initialize the static data shared by all the boundary recoveries (must be
+// called before recovering boundaries concurrently)
+void initMeshGRegionBoundaryRecovery();
+
 #endif
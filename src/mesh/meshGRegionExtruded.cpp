@@ -3,7 +3,11 @@
 // See the LICENSE.txt file in the Gmsh root directory for license information.
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
+#include <algorithm>
+#include <map>
 #include <set>
+#include <stdexcept>
+#include <unordered_map>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "GModel.h"
@@ -125,31 +129,74 @@ static void createTet(MVertex *v1, MVertex *v2, MVertex *v3, MVertex *v4,
     addTetrahedron(v1, v2, v3, v4, to);
 }
 
-static int getExtrudedVertices(MElement *ele, ExtrudeParams *ep, int j, int k,
-                               MVertexRTree &pos, std::vector<MVertex *> &verts)
-{
-  double x[8], y[8], z[8];
-  int n = ele->getNumVertices();
-  for(int p = 0; p < n; p++) {
-    MVertex *v = ele->getVertex(p);
-    x[p] = x[p + n] = v->x();
-    y[p] = y[p + n] = v->y();
-    z[p] = z[p + n] = v->z();
-  }
-  for(int p = 0; p < n; p++) {
-    ep->Extrude(j, k, x[p], y[p], z[p]);
-    ep->Extrude(j, k + 1, x[p + n], y[p + n], z[p + n]);
-  }
-  for(int p = 0; p < 2 * n; p++) {
-    MVertex *tmp = pos.find(x[p], y[p], z[p]);
-    if(!tmp)
-      Msg::Error("Could not find extruded vertex (%.16g, %.16g, %.16g)", x[p],
-                 y[p], z[p]);
-    else
-      verts.push_back(tmp);
+// extruded nodes of the nodes of the source surface mesh, indexed by source node
+// and by position in the layers: each extruded node is searched for only once
+// by position, instead of once for each extruded element it belongs to
+class extrudedVertices {
+private:
+  ExtrudeParams *_ep;
+  // position (j, k) in the layers is stored at _offset[j] + k, with k in [0,
+  // NbElmLayer[j]]
+  std::vector<int> _offset;
+  int _numPositions;
+  std::unordered_map<MVertex *, std::size_t> _row;
+  std::vector<MVertex *> _vertices;
+
+public:
+  extrudedVertices() : _ep(nullptr), _numPositions(0) {}
+  void build(GFace *from, ExtrudeParams *ep, MVertexRTree &pos)
+  {
+    _ep = ep;
+    _offset.resize(ep->mesh.NbLayer);
+    _numPositions = 0;
+    for(int j = 0; j < ep->mesh.NbLayer; j++) {
+      _offset[j] = _numPositions;
+      _numPositions += ep->mesh.NbElmLayer[j] + 1;
+    }
+    std::vector<MVertex *> source;
+    for(std::size_t i = 0; i < from->getNumMeshElements(); i++) {
+      MElement *e = from->getMeshElement(i);
+      for(std::size_t p = 0; p < e->getNumVertices(); p++) {
+        if(_row.insert(std::make_pair(e->getVertex(p), source.size())).second)
+          source.push_back(e->getVertex(p));
+      }
+    }
+    _vertices.resize(source.size() * _numPositions);
+    for(std::size_t i = 0; i < source.size(); i++) {
+      MVertex **row = &_vertices[i * _numPositions];
+      for(int j = 0; j < ep->mesh.NbLayer; j++) {
+        for(int k = 0; k <= ep->mesh.NbElmLayer[j]; k++) {
+          double x = source[i]->x(), y = source[i]->y(), z = source[i]->z();
+          ep->Extrude(j, k, x, y, z);
+          row[_offset[j] + k] = pos.find(x, y, z);
+        }
+      }
+    }
   }
-  return verts.size();
-}
+  int get(MElement *ele, int j, int k, std::vector<MVertex *> &verts) const
+  {
+    int n = ele->getNumVertices();
+    for(int l = 0; l < 2; l++) {
+      for(int p = 0; p < n; p++) {
+        MVertex *v = ele->getVertex(p);
+        auto it = _row.find(v);
+        MVertex *tmp = (it == _row.end()) ?
+                         nullptr :
+                         _vertices[it->second * _numPositions + _offset[j] +
+                                   k + l];
+        if(!tmp) {
+          double x = v->x(), y = v->y(), z = v->z();
+          _ep->Extrude(j, k + l, x, y, z);
+          Msg::Error("Could not find extruded vertex (%.16g, %.16g, %.16g)", x,
+                     y, z);
+        }
+        else
+          verts.push_back(tmp);
+      }
+    }
+    return verts.size();
+  }
+};
 
 static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
 {
@@ -203,14 +250,15 @@ static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
   }
 #endif
 
-  // create elements (note that it would be faster to access the *interior*
-  // nodes by direct indexing, but it's just simpler to query everything by
-  // position)
+  // create elements (the extruded nodes are searched for by position once,
+  // then accessed by source node and layer)
+  extrudedVertices ext;
+  ext.build(from, ep, pos);
   for(std::size_t i = 0; i < from->triangles.size(); i++) {
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> verts;
-        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, verts) == 6) {
+        if(ext.get(from->triangles[i], j, k, verts) == 6) {
           createPriPyrTet(verts, to, from->triangles[i]);
         }
       }
@@ -225,8 +273,7 @@ static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
       for(int j = 0; j < ep->mesh.NbLayer; j++) {
         for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
           std::vector<MVertex *> verts;
-          if(getExtrudedVertices(from->quadrangles[i], ep, j, k, pos, verts) ==
-             8)
+          if(ext.get(from->quadrangles[i], j, k, verts) == 8)
             createHexPri(verts, to, from->quadrangles[i]);
         }
       }
@@ -255,22 +302,22 @@ static void insertAllVertices(GRegion *gr, MVertexRTree &pos)
   }
 }
 
-void meshGRegionExtruded::operator()(GRegion *gr)
+static bool isExtrudedVolume(GRegion *gr)
 {
-  gr->model()->setCurrentMeshEntity(gr);
-
-  if(gr->geomType() == GEntity::DiscreteVolume) return;
-
+  if(gr->geomType() == GEntity::DiscreteVolume) return false;
   ExtrudeParams *ep = gr->meshAttributes.extrude;
+  return ep && ep->mesh.ExtrudeMesh && ep->geo.Mode == EXTRUDED_ENTITY;
+}
 
-  if(!ep || !ep->mesh.ExtrudeMesh || ep->geo.Mode != EXTRUDED_ENTITY) return;
+// mesh the (already demeshed) extruded volume; this only creates nodes and
+// elements in gr, and can thus be performed concurrently for volumes with
+// different extrusion parameters
+static void meshExtrudedVolume(GRegion *gr)
+{
+  ExtrudeParams *ep = gr->meshAttributes.extrude;
 
   Msg::Info("Meshing volume %d (Extruded)", gr->tag());
 
-  // destroy the mesh if it exists
-  deMeshGRegion dem;
-  dem(gr);
-
   // build an rtree with all the vertices on the boundary of gr
   MVertexRTree pos(CTX::instance()->geom.tolerance * CTX::instance()->lc);
   insertAllVertices(gr, pos);
@@ -283,17 +330,96 @@ void meshGRegionExtruded::operator()(GRegion *gr)
   }
 
   extrudeMesh(from, gr, pos);
+}
 
+static void carveExtrudedVolume(GRegion *gr)
+{
   // carve holes if any (only do it now if the mesh is final, i.e., if
   // the mesh is recombined)
+  ExtrudeParams *ep = gr->meshAttributes.extrude;
   if(ep->mesh.Holes.size() && ep->mesh.Recombine) {
     for(auto it = ep->mesh.Holes.begin(); it != ep->mesh.Holes.end(); it++)
       carveHole(gr, it->first, it->second.first, it->second.second);
   }
 }
 
+void meshGRegionExtruded::operator()(GRegion *gr)
+{
+  gr->model()->setCurrentMeshEntity(gr);
+
+  if(!isExtrudedVolume(gr)) return;
+
+  // destroy the mesh if it exists
+  deMeshGRegion dem;
+  dem(gr);
+
+  meshExtrudedVolume(gr);
+  carveExtrudedVolume(gr);
+}
+
+void MeshExtrudedVolumes(GModel *m, int nthreads)
+{
+  std::vector<GRegion *> regions;
+  std::map<ExtrudeParams *, int> numRegions;
+  bool quadToTri = false;
+  for(auto it = m->firstRegion(); it != m->lastRegion(); it++) {
+    if(!isExtrudedVolume(*it)) continue;
+    ExtrudeParams *ep = (*it)->meshAttributes.extrude;
+    regions.push_back(*it);
+    numRegions[ep]++;
+    if(ep->mesh.QuadToTri && ep->mesh.Recombine) quadToTri = true;
+  }
+
+  // QuadToTri meshes depend on the meshes of the neighboring volumes: keep the
+  // original order
+  if(quadToTri || nthreads < 2) {
+    std::for_each(regions.begin(), regions.end(), meshGRegionExtruded());
+    return;
+  }
+
+  // destroying the meshes invalidates the model mesh caches: do it serially
+  deMeshGRegion dem;
+  for(std::size_t i = 0; i < regions.size(); i++) dem(regions[i]);
+
+  // ExtrudeParams::Extrude() temporarily modifies the extrusion parameters (for
+  // rotations): volumes sharing their parameters are meshed serially
+  std::vector<GRegion *> concurrent, serial;
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    if(numRegions[regions[i]->meshAttributes.extrude] > 1)
+      serial.push_back(regions[i]);
+    else
+      concurrent.push_back(regions[i]);
+  }
+
+  bool exceptions = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < concurrent.size(); i++) {
+    bool skip;
+#pragma omp atomic read
+    skip = exceptions;
+    if(skip) continue;
+    try { // OpenMP forbids leaving block via exception
+      m->setCurrentMeshEntity(concurrent[i]);
+      meshExtrudedVolume(concurrent[i]);
+    } catch(...) {
+#pragma omp atomic write
+      exceptions = true;
+    }
+  }
+  if(exceptions) throw std::runtime_error(Msg::GetLastError());
+
+  for(std::size_t i = 0; i < serial.size(); i++) {
+    m->setCurrentMeshEntity(serial[i]);
+    meshExtrudedVolume(serial[i]);
+  }
+
+  // carving modifies the mesh of the carving surfaces
+  for(std::size_t i = 0; i < regions.size(); i++)
+    carveExtrudedVolume(regions[i]);
+}
+
 static int edgeExists(MVertex *v1, MVertex *v2,
-                      std::set<std::pair<MVertex *, MVertex *> > &edges)
+                      const std::set<std::pair<MVertex *, MVertex *> > &edges)
 {
   std::pair<MVertex *, MVertex *> p(std::min(v1, v2), std::max(v1, v2));
   return edges.count(p);
@@ -314,7 +440,7 @@ static void deleteEdge(MVertex *v1, MVertex *v2,
 }
 
 // subdivide the 3 lateral faces of each prism
-static void phase1(GRegion *gr, MVertexRTree &pos,
+static void phase1(GRegion *gr, const extrudedVertices &ext,
                    std::set<std::pair<MVertex *, MVertex *> > &edges, int ntry)
 {
   ExtrudeParams *ep = gr->meshAttributes.extrude;
@@ -325,7 +451,7 @@ static void phase1(GRegion *gr, MVertexRTree &pos,
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> v;
-        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, v) == 6) {
+        if(ext.get(from->triangles[i], j, k, v) == 6) {
           if(ntry == 1) {
             if(!edgeExists(v[0], v[4], edges)) createEdge(v[1], v[3], edges);
             if(!edgeExists(v[4], v[2], edges)) createEdge(v[1], v[5], edges);
@@ -352,7 +478,7 @@ static void phase1(GRegion *gr, MVertexRTree &pos,
 }
 
 // modify lateral edges to make them "tet-compatible"
-static void phase2(GRegion *gr, MVertexRTree &pos,
+static void phase2(GRegion *gr, const extrudedVertices &ext,
                    std::set<std::pair<MVertex *, MVertex *> > &edges,
                    std::set<std::pair<MVertex *, MVertex *> > &edges_swap,
                    int &swap)
@@ -365,7 +491,7 @@ static void phase2(GRegion *gr, MVertexRTree &pos,
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> v;
-        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, v) == 6) {
+        if(ext.get(from->triangles[i], j, k, v) == 6) {
           if(edgeExists(v[3], v[1], edges) && edgeExists(v[4], v[2], edges) &&
              edgeExists(v[0], v[5], edges)) {
             swap++;
@@ -418,8 +544,8 @@ static void phase2(GRegion *gr, MVertexRTree &pos,
 }
 
 // create tets
-static void phase3(GRegion *gr, MVertexRTree &pos,
-                   std::set<std::pair<MVertex *, MVertex *> > &edges)
+static void phase3(GRegion *gr, const extrudedVertices &ext,
+                   const std::set<std::pair<MVertex *, MVertex *> > &edges)
 {
   ExtrudeParams *ep = gr->meshAttributes.extrude;
   GFace *from = gr->model()->getFaceByTag(std::abs(ep->geo.Source));
@@ -430,7 +556,7 @@ static void phase3(GRegion *gr, MVertexRTree &pos,
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> v;
-        if(getExtrudedVertices(tri, ep, j, k, pos, v) == 6) {
+        if(ext.get(tri, j, k, v) == 6) {
           if(edgeExists(v[3], v[1], edges) && edgeExists(v[4], v[2], edges) &&
              edgeExists(v[3], v[2], edges)) {
             createTet(v[0], v[1], v[2], v[3], gr, tri);
@@ -509,19 +635,48 @@ int SubdivideExtrudedMesh(GModel *m)
 
   Msg::Info("Subdividing extruded mesh");
 
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // look up the extruded nodes of each region once; regions sharing their
+  // extrusion parameters are handled serially, as ExtrudeParams::Extrude()
+  // temporarily modifies them
+  std::vector<extrudedVertices> ext(regions.size());
+  std::vector<GFace *> from(regions.size(), nullptr);
+  std::vector<char> shared(regions.size(), 0);
+  std::map<ExtrudeParams *, int> numRegions;
+  for(std::size_t i = 0; i < regions.size(); i++)
+    numRegions[regions[i]->meshAttributes.extrude]++;
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    ExtrudeParams *ep = regions[i]->meshAttributes.extrude;
+    from[i] = m->getFaceByTag(std::abs(ep->geo.Source));
+    shared[i] = (numRegions[ep] > 1);
+  }
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    if(from[i] && !shared[i])
+      ext[i].build(from[i], regions[i]->meshAttributes.extrude, pos);
+  }
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    if(from[i] && shared[i])
+      ext[i].build(from[i], regions[i]->meshAttributes.extrude, pos);
+  }
+
   std::set<std::pair<MVertex *, MVertex *> > edges;
 
+  // the creation and the swapping of the lateral edges depend on the edges
+  // created in the neighboring regions: phases 1 and 2 are serial
   for(int ntry = 1; ntry <= 2; ntry++) {
     // create edges on lateral sides of "prisms"
     for(std::size_t i = 0; i < regions.size(); i++)
-      phase1(regions[i], pos, edges, ntry);
+      phase1(regions[i], ext[i], edges, ntry);
     // swap lateral edges to make them "tet-compatible"
     int j = 0, swap;
     std::set<std::pair<MVertex *, MVertex *> > edges_swap;
     do {
       swap = 0;
       for(std::size_t i = 0; i < regions.size(); i++)
-        phase2(regions[i], pos, edges, edges_swap, swap);
+        phase2(regions[i], ext[i], edges, edges_swap, swap);
       Msg::Info("Swapping %d", swap);
       if(j && j == swap) {
         if(ntry == 1) {
@@ -554,8 +709,11 @@ int SubdivideExtrudedMesh(GModel *m)
     gr->prisms.clear();
     for(std::size_t i = 0; i < gr->pyramids.size(); i++) delete gr->pyramids[i];
     gr->pyramids.clear();
-    phase3(gr, pos, edges);
   }
+  // the tetrahedra of each region only depend on the (now fixed) edges
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < regions.size(); i++)
+    phase3(regions[i], ext[i], edges);
 
   // remesh bounding surfaces, to make them compatible with the volume mesh
   std::set<GFace *> faces;
@@ -8,6 +8,7 @@
 //   Michael Ermakov (ermakov@ipmnet.ru)
 //
 
+#include <algorithm>
 #include <map>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
@@ -18,6 +19,7 @@
 #include "MTetrahedron.h"
 #include "MHexahedron.h"
 #include "MPrism.h"
+#include "SPoint3.h"
 #include "Context.h"
 
 #if defined(HAVE_QUADTRI)
@@ -146,14 +148,13 @@ static double transfiniteHex(double f1, double f2, double f3, double f4,
          (1 - u) * v * w * s8;
 }
 
-static MVertex *
-transfiniteHex(GRegion *gr, MVertex *f1, MVertex *f2, MVertex *f3, MVertex *f4,
-               MVertex *f5, MVertex *f6, MVertex *c1, MVertex *c2, MVertex *c3,
-               MVertex *c4, MVertex *c5, MVertex *c6, MVertex *c7, MVertex *c8,
-               MVertex *c9, MVertex *c10, MVertex *c11, MVertex *c12,
-               MVertex *s1, MVertex *s2, MVertex *s3, MVertex *s4, MVertex *s5,
-               MVertex *s6, MVertex *s7, MVertex *s8, double u, double v,
-               double w)
+static SPoint3
+transfiniteHex(MVertex *f1, MVertex *f2, MVertex *f3, MVertex *f4, MVertex *f5,
+               MVertex *f6, MVertex *c1, MVertex *c2, MVertex *c3, MVertex *c4,
+               MVertex *c5, MVertex *c6, MVertex *c7, MVertex *c8, MVertex *c9,
+               MVertex *c10, MVertex *c11, MVertex *c12, MVertex *s1,
+               MVertex *s2, MVertex *s3, MVertex *s4, MVertex *s5, MVertex *s6,
+               MVertex *s7, MVertex *s8, double u, double v, double w)
 {
   double x = transfiniteHex(
     f1->x(), f2->x(), f3->x(), f4->x(), f5->x(), f6->x(), c1->x(), c2->x(),
@@ -170,7 +171,7 @@ transfiniteHex(GRegion *gr, MVertex *f1, MVertex *f2, MVertex *f3, MVertex *f4,
     c3->z(), c4->z(), c5->z(), c6->z(), c7->z(), c8->z(), c9->z(), c10->z(),
     c11->z(), c12->z(), s1->z(), s2->z(), s3->z(), s4->z(), s5->z(), s6->z(),
     s7->z(), s8->z(), u, v, w);
-  return new MVertex(x, y, z, gr);
+  return SPoint3(x, y, z);
 }
 
 class GOrientedTransfiniteFace {
@@ -340,7 +341,7 @@ void findTransfiniteCorners(GRegion *gr, std::vector<MVertex *> &corners)
   }
 }
 
-int MeshTransfiniteVolume(GRegion *gr)
+int MeshTransfiniteVolume(GRegion *gr, int nthreads)
 {
   if(gr->meshAttributes.method != MESH_TRANSFINITE) return 0;
 
@@ -439,10 +440,19 @@ int MeshTransfiniteVolume(GRegion *gr)
     for(int j = 0; j < N_j; j++) { tab[i][j].resize(N_k); }
   }
 
-  for(int i = 0; i < N_i; i++) {
+  // the interior nodes only depend on the boundary nodes: compute their
+  // coordinates concurrently into a preallocated array, and create the nodes
+  // afterwards in the same (i, j, k) order as before, so that the numbering
+  // does not depend on the number of threads
+  int n_i = std::max(N_i - 2, 0), n_j = std::max(N_j - 2, 0),
+      n_k = std::max(N_k - 2, 0);
+  std::vector<SPoint3> xyz((std::size_t)n_i * n_j * n_k);
+
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+  for(int i = 1; i < N_i - 1; i++) {
     double u = lengths_i[i] / L_i;
 
-    for(int j = 0; j < N_j; j++) {
+    for(int j = 1; j < N_j - 1; j++) {
       double v = lengths_j[j] / L_j;
 
       MVertex *c0 = orientedFaces[4].getVertex(i, 0);
@@ -458,7 +468,7 @@ int MeshTransfiniteVolume(GRegion *gr)
       MVertex *f4 = orientedFaces[4].getVertex(i, j);
       MVertex *f5 = orientedFaces[5].getVertex(i, j);
 
-      for(int k = 0; k < N_k; k++) {
+      for(int k = 1; k < N_k - 1; k++) {
         double w = lengths_k[k] / L_k;
 
         MVertex *c8 = orientedFaces[0].getVertex(0, k);
@@ -475,30 +485,45 @@ int MeshTransfiniteVolume(GRegion *gr)
         else
           f3 = c8;
 
+        xyz[((std::size_t)(i - 1) * n_j + (j - 1)) * n_k + (k - 1)] =
+          transfiniteHex(f0, f1, f2, f3, f4, f5, c0, c1, c2, c3, c4, c5, c6,
+                         c7, c8, c9, c10, c11, s0, s1, s2, s3, s4, s5, s6, s7,
+                         u, v, w);
+      }
+    }
+  }
+
+  gr->mesh_vertices.reserve(gr->mesh_vertices.size() + xyz.size());
+  for(int i = 0; i < N_i; i++) {
+    for(int j = 0; j < N_j; j++) {
+      for(int k = 0; k < N_k; k++) {
         if(i && j && k && i != N_i - 1 && j != N_j - 1 && k != N_k - 1) {
-          MVertex *newv = transfiniteHex(
-            gr, f0, f1, f2, f3, f4, f5, c0, c1, c2, c3, c4, c5, c6, c7, c8, c9,
-            c10, c11, s0, s1, s2, s3, s4, s5, s6, s7, u, v, w);
+          const SPoint3 &p =
+            xyz[((std::size_t)(i - 1) * n_j + (j - 1)) * n_k + (k - 1)];
+          MVertex *newv = new MVertex(p.x(), p.y(), p.z(), gr);
           gr->mesh_vertices.push_back(newv);
           tab[i][j][k] = newv;
         }
         else if(!i) {
-          tab[i][j][k] = f3;
+          if(corners.size() == 8)
+            tab[i][j][k] = orientedFaces[3].getVertex(j, k);
+          else
+            tab[i][j][k] = orientedFaces[0].getVertex(0, k);
         }
         else if(!j) {
-          tab[i][j][k] = f0;
+          tab[i][j][k] = orientedFaces[0].getVertex(i, k);
         }
         else if(!k) {
-          tab[i][j][k] = f4;
+          tab[i][j][k] = orientedFaces[4].getVertex(i, j);
         }
         else if(i == N_i - 1) {
-          tab[i][j][k] = f1;
+          tab[i][j][k] = orientedFaces[1].getVertex(j, k);
         }
         else if(j == N_j - 1) {
-          tab[i][j][k] = f2;
+          tab[i][j][k] = orientedFaces[2].getVertex(i, k);
         }
         else if(k == N_k - 1) {
-          tab[i][j][k] = f5;
+          tab[i][j][k] = orientedFaces[5].getVertex(i, j);
         }
       }
     }
@@ -520,6 +545,21 @@ int MeshTransfiniteVolume(GRegion *gr)
   // create elements
 
   if(faces.size() == 6) {
+    // preallocate the element arrays in the all-hexahedra and
+    // all-tetrahedra cases
+    std::size_t numCells = (std::size_t)(N_i - 1) * (N_j - 1) * (N_k - 1);
+    bool allRecombined = true, noneRecombined = true;
+    for(int f = 0; f < 6; f++) {
+      if(orientedFaces[f].recombined())
+        noneRecombined = false;
+      else
+        allRecombined = false;
+    }
+    if(allRecombined)
+      gr->hexahedra.reserve(gr->hexahedra.size() + numCells);
+    else if(noneRecombined)
+      gr->tetrahedra.reserve(gr->tetrahedra.size() + 6 * numCells);
+
     for(int i = 0; i < N_i - 1; i++) {
       for(int j = 0; j < N_j - 1; j++) {
         for(int k = 0; k < N_k - 1; k++) {
@@ -13,6 +13,7 @@
 #include <limits>
 #include <stack>
 #include <cstdlib>
+#include <cstdint>
 #include <map>
 #include <unordered_map>
 #include "GmshConfig.h"
@@ -55,8 +56,6 @@ typedef std::set<std::pair<int, GEntity *>, OriGEntityPtrFullLessThan>
                      std::vector<std::pair<MElement *, std::vector<int> > >,   \
                      MVertexPtrHash, MVertexPtrEqual>
 
-#if defined(HAVE_METIS)
-
 #include "OS.h"
 #include "Context.h"
 #include "partitionRegion.h"
@@ -77,10 +76,21 @@ typedef std::set<std::pair<int, GEntity *>, OriGEntityPtrFullLessThan>
 #include "MTrihedron.h"
 #include "MElementCut.h"
 #include "MPoint.h"
+#include "HilbertCurve.h"
 
+#if defined(HAVE_METIS)
 extern "C" {
 #include <metis.h>
 }
+#else
+// same integer type as in METIS (see contrib/metis/include/metis.h), so that
+// the graph can be built and partitioned along a Hilbert curve without METIS
+#if defined(HAVE_64BIT_SIZE_T)
+typedef int64_t idx_t;
+#else
+typedef int32_t idx_t;
+#endif
+#endif
 
 // Graph of the mesh for partitioning purposes.
 class Graph {
@@ -208,15 +218,24 @@ public:
   {
     std::vector<std::set<MElement *, MElementPtrLessThan> > elements(
       (size ? size : _nparts), std::set<MElement *, MElementPtrLessThan>());
+    // detect the elements on partition boundaries concurrently, then insert
+    // them in the (ordered) sets
+    std::vector<char> onBoundary(_ne, 0);
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic, 1000) num_threads(nthreads)
     for(std::size_t i = 0; i < _ne; i++) {
+      if(_element[i]->getDim() != _dim) continue;
       for(idx_t j = _xadj[i]; j < _xadj[i + 1]; j++) {
         if(_partition[i] != _partition[_adjncy[j]]) {
-          if(_element[i]->getDim() == _dim) {
-            elements[_partition[i]].insert(_element[i]);
-          }
+          onBoundary[i] = 1;
+          break;
         }
       }
     }
+    for(std::size_t i = 0; i < _ne; i++) {
+      if(onBoundary[i]) elements[_partition[i]].insert(_element[i]);
+    }
 
     return elements;
   }
@@ -590,135 +609,227 @@ static int makeGraph(GModel *model, Graph &graph, int selectDim)
   return 0;
 }
 
-// Partition a graph created by makeGraph using Metis library. Returns: 0 =
-// success, 1 = error, 2 = exception thrown.
-static int partitionGraph(Graph &graph, bool verbose)
+#if defined(HAVE_METIS)
+
+// Partition a graph created by makeGraph (with its dual graph and weights)
+// using Metis library. Returns: 0 = success, 1 = error.
+static int partitionGraphMetis(Graph &graph, std::vector<idx_t> &epart,
+                               idx_t &objval, bool verbose)
 {
-#ifdef HAVE_METIS
   std::stringstream opt;
-  try {
-    idx_t metisOptions[METIS_NOPTIONS];
-    METIS_SetDefaultOptions(metisOptions);
-
-    opt << "npart:" << graph.nparts();
-
-    opt << ", sizeof(idx_t):" << 8 * sizeof(idx_t);
-
-    opt << ", ptype:";
-    switch(CTX::instance()->mesh.metisAlgorithm) {
-    case 1: // Recursive
-      metisOptions[METIS_OPTION_PTYPE] = METIS_PTYPE_RB;
-      opt << "rb";
-      break;
-    case 2: // K-way
-      metisOptions[METIS_OPTION_PTYPE] = METIS_PTYPE_KWAY;
-      opt << "kway";
-      break;
-    default: opt << "default"; break;
-    }
+  idx_t metisOptions[METIS_NOPTIONS];
+  METIS_SetDefaultOptions(metisOptions);
 
-    opt << ", ufactor:";
-    if(CTX::instance()->mesh.metisMaxLoadImbalance >= 0) {
-      metisOptions[METIS_OPTION_UFACTOR] =
-        CTX::instance()->mesh.metisMaxLoadImbalance;
-      opt << CTX::instance()->mesh.metisMaxLoadImbalance;
-    }
-    else {
-      opt << "default";
-    }
+  opt << "npart:" << graph.nparts();
 
-    opt << ", ctype:";
-    switch(CTX::instance()->mesh.metisEdgeMatching) {
-    case 1: // Random matching
-      metisOptions[METIS_OPTION_CTYPE] = METIS_CTYPE_RM;
-      opt << "rm";
-      break;
-    case 2: // Sorted heavy-edge matching
-      metisOptions[METIS_OPTION_CTYPE] = METIS_CTYPE_SHEM;
-      opt << "shem";
-      break;
-    default: opt << "default"; break;
-    }
+  opt << ", sizeof(idx_t):" << 8 * sizeof(idx_t);
 
-    opt << ", rtype:";
-    switch(CTX::instance()->mesh.metisRefinementAlgorithm) {
-    case 1: // FM-based cut refinement
-      metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_FM;
-      opt << "fm";
-      break;
-    case 2: // Greedy boundary refinement
-      metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_GREEDY;
-      opt << "greedy";
-      break;
-    case 3: // Two-sided node FM refinement
-      metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_SEP2SIDED;
-      opt << "sep2sided";
-      break;
-    case 4: // One-sided node FM refinement
-      metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_SEP1SIDED;
-      opt << "sep1sided";
-      break;
-    default: opt << "default"; break;
-    }
+  opt << ", ptype:";
+  switch(CTX::instance()->mesh.metisAlgorithm) {
+  case 1: // Recursive
+    metisOptions[METIS_OPTION_PTYPE] = METIS_PTYPE_RB;
+    opt << "rb";
+    break;
+  case 2: // K-way
+    metisOptions[METIS_OPTION_PTYPE] = METIS_PTYPE_KWAY;
+    opt << "kway";
+    break;
+  default: opt << "default"; break;
+  }
 
-    opt << ", objtype:";
-    switch(CTX::instance()->mesh.metisObjective) {
-    case 1: // Min. cut
-      metisOptions[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_CUT;
-      opt << "cut";
-      break;
-    case 2: // Min. communication volume (slower)
-      metisOptions[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_VOL;
-      opt << "vol";
-      break;
-    default: opt << "default"; break;
-    }
+  opt << ", ufactor:";
+  if(CTX::instance()->mesh.metisMaxLoadImbalance >= 0) {
+    metisOptions[METIS_OPTION_UFACTOR] =
+      CTX::instance()->mesh.metisMaxLoadImbalance;
+    opt << CTX::instance()->mesh.metisMaxLoadImbalance;
+  }
+  else {
+    opt << "default";
+  }
+
+  opt << ", ctype:";
+  switch(CTX::instance()->mesh.metisEdgeMatching) {
+  case 1: // Random matching
+    metisOptions[METIS_OPTION_CTYPE] = METIS_CTYPE_RM;
+    opt << "rm";
+    break;
+  case 2: // Sorted heavy-edge matching
+    metisOptions[METIS_OPTION_CTYPE] = METIS_CTYPE_SHEM;
+    opt << "shem";
+    break;
+  default: opt << "default"; break;
+  }
+
+  opt << ", rtype:";
+  switch(CTX::instance()->mesh.metisRefinementAlgorithm) {
+  case 1: // FM-based cut refinement
+    metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_FM;
+    opt << "fm";
+    break;
+  case 2: // Greedy boundary refinement
+    metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_GREEDY;
+    opt << "greedy";
+    break;
+  case 3: // Two-sided node FM refinement
+    metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_SEP2SIDED;
+    opt << "sep2sided";
+    break;
+  case 4: // One-sided node FM refinement
+    metisOptions[METIS_OPTION_RTYPE] = METIS_RTYPE_SEP1SIDED;
+    opt << "sep1sided";
+    break;
+  default: opt << "default"; break;
+  }
+
+  opt << ", objtype:";
+  switch(CTX::instance()->mesh.metisObjective) {
+  case 1: // Min. cut
+    metisOptions[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_CUT;
+    opt << "cut";
+    break;
+  case 2: // Min. communication volume (slower)
+    metisOptions[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_VOL;
+    opt << "vol";
+    break;
+  default: opt << "default"; break;
+  }
+
+  opt << ", minconn:";
+  switch(CTX::instance()->mesh.metisMinConn) {
+  case 0:
+    metisOptions[METIS_OPTION_MINCONN] = 0;
+    opt << 0;
+    break;
+  case 1:
+    metisOptions[METIS_OPTION_MINCONN] = 1;
+    opt << 1;
+    break;
+  default: opt << "default"; break;
+  }
+
+  if(verbose) Msg::Info("Running METIS with %s", opt.str().c_str());
+
+  // C numbering
+  metisOptions[METIS_OPTION_NUMBERING] = 0;
+
+  idx_t ne = graph.ne();
+  idx_t numPart = graph.nparts();
+  idx_t ncon = 1;
+
+  int metisError = 0;
+  if(metisOptions[METIS_OPTION_PTYPE] == METIS_PTYPE_KWAY) {
+    metisError = METIS_PartGraphKway(
+      &ne, &ncon, graph.xadj(), graph.adjncy(), graph.vwgt(), nullptr,
+      nullptr, &numPart, nullptr, nullptr, metisOptions, &objval, &epart[0]);
+  }
+  else {
+    metisError = METIS_PartGraphRecursive(
+      &ne, &ncon, graph.xadj(), graph.adjncy(), graph.vwgt(), nullptr,
+      nullptr, &numPart, nullptr, nullptr, metisOptions, &objval, &epart[0]);
+  }
 
-    opt << ", minconn:";
-    switch(CTX::instance()->mesh.metisMinConn) {
-    case 0:
-      metisOptions[METIS_OPTION_MINCONN] = 0;
-      opt << 0;
-      break;
-    case 1:
-      metisOptions[METIS_OPTION_MINCONN] = 1;
-      opt << 1;
-      break;
-    default: opt << "default"; break;
-    }
+  switch(metisError) {
+  case METIS_OK: break;
+  case METIS_ERROR_INPUT: Msg::Error("METIS input error"); return 1;
+  case METIS_ERROR_MEMORY: Msg::Error("METIS memory error"); return 1;
+  case METIS_ERROR:
+  default: Msg::Error("METIS error"); return 1;
+  }
+  return 0;
+}
 
-    if(verbose) Msg::Info("Running METIS with %s", opt.str().c_str());
+#endif
 
-    // C numbering
-    metisOptions[METIS_OPTION_NUMBERING] = 0;
+// Partition a graph created by makeGraph (with its dual graph and weights) by
+// sorting the elements along a Hilbert curve and splitting the sorted list
+// into chunks of equal weight
+static void partitionGraphHilbert(Graph &graph, std::vector<idx_t> &epart,
+                                  idx_t &objval)
+{
+  std::size_t ne = graph.ne();
+  idx_t numPart = graph.nparts();
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  double min[3] = {std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max()};
+  double max[3] = {-std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max()};
+  std::vector<SPoint3> bary(ne);
+#pragma omp parallel num_threads(nthreads)
+  {
+    double tmin[3] = {min[0], min[1], min[2]};
+    double tmax[3] = {max[0], max[1], max[2]};
+#pragma omp for
+    for(std::size_t i = 0; i < ne; i++) {
+      if(!graph.element(i)) continue;
+      bary[i] = graph.element(i)->barycenter();
+      for(int j = 0; j < 3; j++) {
+        tmin[j] = std::min(tmin[j], bary[i][j]);
+        tmax[j] = std::max(tmax[j], bary[i][j]);
+      }
+    }
+#pragma omp critical
+    for(int j = 0; j < 3; j++) {
+      min[j] = std::min(min[j], tmin[j]);
+      max[j] = std::max(max[j], tmax[j]);
+    }
+  }
+
+  std::vector<std::pair<uint64_t, std::size_t> > keys(ne);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < ne; i++)
+    keys[i] = std::make_pair(
+      HilbertIndex(bary[i].x(), bary[i].y(), bary[i].z(), min, max), i);
+  bary.clear();
+  std::sort(keys.begin(), keys.end());
+
+  // assign each element to the chunk containing the middle of its weight
+  uint64_t total = 0, w = 0;
+  for(std::size_t i = 0; i < ne; i++)
+    total += graph.vwgt() ? graph.vwgt()[i] : 1;
+  if(!total) total = 1;
+  for(std::size_t k = 0; k < ne; k++) {
+    std::size_t i = keys[k].second;
+    uint64_t wi = graph.vwgt() ? graph.vwgt()[i] : 1;
+    epart[i] = std::min((idx_t)((2 * w + wi) * numPart / (2 * total)),
+                        numPart - 1);
+    w += wi;
+  }
+
+  objval = 0;
+#pragma omp parallel for reduction(+ : objval) num_threads(nthreads)
+  for(std::size_t i = 0; i < ne; i++)
+    for(idx_t j = graph.xadj(i); j < graph.xadj(i + 1); j++)
+      if(epart[i] != epart[graph.adjncy(j)]) objval++;
+  objval /= 2;
+}
 
-    idx_t objval;
+// Partition a graph created by makeGraph. Returns: 0 = success, 1 = error, 2 =
+// exception thrown.
+static int partitionGraph(Graph &graph, bool verbose)
+{
+  try {
+    idx_t objval = 0;
     std::vector<idx_t> epart(graph.ne());
-    idx_t ne = graph.ne();
     idx_t numPart = graph.nparts();
-    idx_t ncon = 1;
     graph.fillDefaultWeights();
-
-    int metisError = 0;
     graph.createDualGraph(false);
 
-    if(metisOptions[METIS_OPTION_PTYPE] == METIS_PTYPE_KWAY) {
-      metisError = METIS_PartGraphKway(
-        &ne, &ncon, graph.xadj(), graph.adjncy(), graph.vwgt(), nullptr,
-        nullptr, &numPart, nullptr, nullptr, metisOptions, &objval, &epart[0]);
+    if(CTX::instance()->mesh.partitionAlgorithm == 1) {
+      if(verbose) Msg::Info("Partitioning along a Hilbert curve");
+      partitionGraphHilbert(graph, epart, objval);
     }
     else {
-      metisError = METIS_PartGraphRecursive(
-        &ne, &ncon, graph.xadj(), graph.adjncy(), graph.vwgt(), nullptr,
-        nullptr, &numPart, nullptr, nullptr, metisOptions, &objval, &epart[0]);
-    }
-
-    switch(metisError) {
-    case METIS_OK: break;
-    case METIS_ERROR_INPUT: Msg::Error("METIS input error"); return 1;
-    case METIS_ERROR_MEMORY: Msg::Error("METIS memory error"); return 1;
-    case METIS_ERROR:
-    default: Msg::Error("METIS error"); return 1;
+#if defined(HAVE_METIS)
+      if(partitionGraphMetis(graph, epart, objval, verbose)) return 1;
+#else
+      Msg::Warning("Gmsh must be compiled with METIS support to partition "
+                   "meshes with METIS: partitioning along a Hilbert curve");
+      partitionGraphHilbert(graph, epart, objval);
+#endif
     }
 
     // Check and correct the topology
@@ -743,7 +854,6 @@ static int partitionGraph(Graph &graph, bool verbose)
     Msg::Error("METIS exception");
     return 2;
   }
-#endif
 
   return 0;
 }
@@ -2180,6 +2290,8 @@ static void assignPhysicals(GModel *model)
   }
 }
 
+#if defined(HAVE_METIS)
+
 bool cmp_hedges(const std::pair<MEdge, size_t> &he0,
                 const std::pair<MEdge, size_t> &he1)
 {
@@ -2264,6 +2376,16 @@ int PartitionFaceMinEdgeLength(GFace *gf, int np, double tol)
   return 0;
 }
 
+#else
+
+int PartitionFaceMinEdgeLength(GFace *gf, int np, double tol)
+{
+  Msg::Error("Gmsh must be compiled with METIS support to partition meshes");
+  return 0;
+}
+
+#endif
+
 // Partition a mesh into n parts. Returns: 0 = success, 1 = error
 
 int PartitionMesh(GModel *model, int numPart)
@@ -2526,6 +2648,28 @@ int UnpartitionMesh(GModel *model)
   return 0;
 }
 
+// Compute the partition of the mesh into numPart parts, without creating the
+// partition entities. Returns: 0 = success, 1 = no elements found/invalid data.
+int ComputeMeshPartition(GModel *model, int numPart,
+                         std::vector<std::pair<MElement *, int> > &elmToPart)
+{
+  if(numPart <= 0) return 1;
+
+  Graph graph(model);
+  if(makeGraph(model, graph, -1)) return 1;
+  graph.nparts(numPart);
+  if(partitionGraph(graph, true)) return 1;
+
+  elmToPart.clear();
+  elmToPart.reserve(graph.ne());
+  for(std::size_t i = 0; i < graph.ne(); i++) {
+    if(graph.element(i))
+      elmToPart.push_back(std::make_pair(
+        graph.element(i), graph.nparts() > 1 ? graph.partition(i) + 1 : 1));
+  }
+  return 0;
+}
+
 // Create the partition according to the element split given by elmToPartition
 // Returns: 0 = success, 1 = no elements found/invalid data.
 int PartitionUsingThisSplit(GModel *model,
@@ -2657,30 +2801,3 @@ int ConvertOldPartitioningToNewOne(GModel *model)
 
   return PartitionUsingThisSplit(model, elmToPartition);
 }
-
-#else
-
-int PartitionMesh(GModel *model, int numPart)
-{
-  Msg::Error("Gmsh must be compiled with METIS support to partition meshes");
-  return 0;
-}
-
-int UnpartitionMesh(GModel *model) { return 0; }
-
-int ConvertOldPartitioningToNewOne(GModel *model) { return 0; }
-
-int PartitionUsingThisSplit(
-  GModel *model, std::vector<std::pair<MElement *, int> > &elmToPartition)
-{
-  Msg::Error("Gmsh must be compiled with METIS support to partition meshes");
-  return 0;
-}
-
-int PartitionFaceMinEdgeLength(GFace *gf, int np, double tol)
-{
-  Msg::Error("Gmsh must be compiled with METIS support to partition meshes");
-  return 0;
-}
-
-#endif
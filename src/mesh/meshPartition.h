@@ -16,6 +16,8 @@ int UnpartitionMesh(GModel *model);
 int PartitionUsingThisSplit(GModel *model,
   std::vector<std::pair<MElement *, int> > &elmToPartition);
 int ConvertOldPartitioningToNewOne(GModel *model);
+int ComputeMeshPartition(GModel *model, int numPart,
+  std::vector<std::pair<MElement *, int> > &elmToPartition);
 
 int PartitionFaceMinEdgeLength(GFace *gf, int np, double tol = 1.02);
 
@@ -7,9 +7,14 @@
 #include "GModel.h"
 #include "GmshMessage.h"
 #include "GmshConfig.h"
+#include "Context.h"
 #include "HilbertCurve.h"
+#include <algorithm>
+#include <limits>
 #include <queue>
 #include <cmath>
+#include <unordered_map>
+#include <unordered_set>
 
 #if defined(HAVE_METIS)
 #include "metis.h"
@@ -134,13 +139,12 @@ template <typename T>
 static void
 createVertexToVertexGraph(GModel *gm,
                           const std::vector<std::size_t> &elementTags,
-                          std::map<MVertex *, std::size_t> &initial_numbering,
-                          std::map<std::size_t, MVertex *> &invert_numbering,
+                          std::vector<MVertex *> &vertices,
                           std::vector<T> &ai, std::vector<T> &aj)
 {
   ai.clear();
   aj.clear();
-  initial_numbering.clear();
+  vertices.clear();
 
   std::vector<MElement *> elements;
   if(elementTags.empty()) {
@@ -156,67 +160,111 @@ createVertexToVertexGraph(GModel *gm,
     for(auto n : elementTags) elements.push_back(gm->getMeshElementByTag(n));
   }
 
-  std::size_t count = 0;
-  std::vector<std::pair<T, T>> coords;
-  std::size_t numbers[1000];
-  for(auto e : elements) {
-    for(std::size_t i = 0; i < e->getNumVertices(); i++) {
-      MVertex *v = e->getVertex(i);
-      auto it = initial_numbering.find(v);
-      if(it == initial_numbering.end()) {
-        numbers[i] = count;
-        invert_numbering[count] = v;
-        initial_numbering[v] = count++;
-      }
-      else
-        numbers[i] = it->second;
-    }
-    for(std::size_t i = 0; i < e->getNumVertices(); i++) {
-      for(std::size_t j = 0; j < e->getNumVertices(); j++) {
-        if(i != j) coords.push_back(std::make_pair(numbers[i], numbers[j]));
-      }
+  // number the nodes in the order in which they are first encountered, and
+  // store the element-to-node connectivity with these numbers
+  std::unordered_map<MVertex *, std::size_t> numbering;
+  numbering.reserve(elements.size());
+  std::vector<std::size_t> eptr(elements.size() + 1, 0), econn;
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    MElement *e = elements[i];
+    for(std::size_t j = 0; j < e->getNumVertices(); j++) {
+      MVertex *v = e->getVertex(j);
+      auto it = numbering.insert(std::make_pair(v, vertices.size()));
+      if(it.second) vertices.push_back(v);
+      econn.push_back(it.first->second);
     }
+    eptr[i + 1] = econn.size();
   }
-  std::sort(coords.begin(), coords.end());
+  numbering.clear();
 
-  auto last = std::unique(coords.begin(), coords.end());
-  coords.erase(last, coords.end());
+  // node-to-element connectivity
+  std::size_t nv = vertices.size();
+  std::vector<std::size_t> nptr(nv + 1, 0), nconn(econn.size());
+  for(auto n : econn) nptr[n + 1]++;
+  for(std::size_t i = 0; i < nv; i++) nptr[i + 1] += nptr[i];
+  {
+    std::vector<std::size_t> pos(nptr.begin(), nptr.end() - 1);
+    for(std::size_t i = 0; i < elements.size(); i++)
+      for(std::size_t j = eptr[i]; j < eptr[i + 1]; j++)
+        nconn[pos[econn[j]]++] = i;
+  }
 
-  ai.push_back(0);
-  T line = coords[0].first;
-  for(auto c : coords) {
-    if(c.first != line) {
-      ai.push_back((T)aj.size());
-      line = c.first;
+  // the (sorted) neighbors of each node are independent: count them in a first
+  // pass, then fill the compressed rows in a second pass
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  ai.resize(nv + 1, 0);
+  for(int pass = 0; pass < 2; pass++) {
+#pragma omp parallel num_threads(nthreads)
+    {
+      std::vector<T> adj;
+#pragma omp for schedule(dynamic, 1024)
+      for(std::size_t i = 0; i < nv; i++) {
+        adj.clear();
+        for(std::size_t k = nptr[i]; k < nptr[i + 1]; k++) {
+          std::size_t e = nconn[k];
+          for(std::size_t j = eptr[e]; j < eptr[e + 1]; j++)
+            if(econn[j] != i) adj.push_back((T)econn[j]);
+        }
+        std::sort(adj.begin(), adj.end());
+        adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+        if(!pass)
+          ai[i + 1] = (T)adj.size();
+        else
+          std::copy(adj.begin(), adj.end(), aj.begin() + ai[i]);
+      }
+    }
+    if(!pass) {
+      for(std::size_t i = 0; i < nv; i++) ai[i + 1] += ai[i];
+      aj.resize(ai[nv]);
     }
-    aj.push_back(c.second);
   }
-  ai.push_back((T)aj.size());
+}
+
+// return the (old tag, new tag) pairs sorted by old tag
+static void sortByOldTags(const std::vector<MVertex *> &vertices,
+                          const std::vector<std::size_t> &newNum,
+                          std::vector<std::size_t> &oldTags,
+                          std::vector<std::size_t> &newTags)
+{
+  std::vector<std::pair<std::size_t, std::size_t> > p(vertices.size());
+  for(std::size_t i = 0; i < vertices.size(); i++)
+    p[i] = std::make_pair(vertices[i]->getNum(), newNum[i]);
+  std::sort(p.begin(), p.end());
+  oldTags.resize(p.size());
+  newTags.resize(p.size());
+  for(std::size_t i = 0; i < p.size(); i++) {
+    oldTags[i] = p[i].first;
+    newTags[i] = p[i].second;
+  }
 }
 
 int meshRenumber_Vertices_RCMK(const std::vector<std::size_t> &elementTags,
-                               std::map<std::size_t, std::size_t> &permutations)
+                               std::vector<std::size_t> &oldTags,
+                               std::vector<std::size_t> &newTags)
 {
   GModel *gm = GModel ::current();
-  permutations.clear();
+  oldTags.clear();
+  newTags.clear();
 
   Msg::Info("RCMK renumbering...");
 
-  std::map<MVertex *, std::size_t> initial_numbering;
-  std::map<std::size_t, MVertex *> inverse_numbering;
+  std::vector<MVertex *> vertices;
   std::vector<std::size_t> ai, aj;
-  createVertexToVertexGraph(gm, elementTags, initial_numbering,
-                            inverse_numbering, ai, aj);
+  createVertexToVertexGraph(gm, elementTags, vertices, ai, aj);
+  if(vertices.empty()) return 0;
 
-  std::vector<std::size_t> sorted(initial_numbering.size());
+  std::vector<std::size_t> sorted(vertices.size());
 
-  if(RCM(sorted, ai, aj)) return 1;
+  if(aj.empty()) { // no connections: keep the initial order
+    for(std::size_t i = 0; i < sorted.size(); i++) sorted[i] = i + 1;
+  }
+  else if(RCM(sorted, ai, aj))
+    return 1;
 
   int after = bandwidth(ai, aj, &sorted[0]);
 
-  for(auto it : initial_numbering) {
-    permutations[it.first->getNum()] = sorted[it.second];
-  }
+  sortByOldTags(vertices, sorted, oldTags, newTags);
 
   Msg::Info("Done RCMK renumbering (bandwidth is now %d)",
             after);
@@ -224,83 +272,113 @@ int meshRenumber_Vertices_RCMK(const std::vector<std::size_t> &elementTags,
   return 0;
 }
 
-int meshRenumber_Vertices_Hilbert(
-  const std::vector<std::size_t> &elementTags,
-  std::map<std::size_t, std::size_t> &permutations)
+int meshRenumber_Vertices_Hilbert(const std::vector<std::size_t> &elementTags,
+                                  std::vector<std::size_t> &oldTags,
+                                  std::vector<std::size_t> &newTags)
 {
   GModel *gm = GModel ::current();
-  permutations.clear();
+  oldTags.clear();
+  newTags.clear();
 
   Msg::Info("Hilbert renumbering...");
 
-  std::set<MVertex *> allv;
+  std::vector<MVertex *> v;
   if(elementTags.empty()) {
     std::vector<GEntity *> entities;
     gm->getEntities(entities);
-    for(auto ge : entities) {
-      for(std::size_t k = 0; k < ge->getNumMeshVertices(); k++) {
-        allv.insert(ge->getMeshVertex(k));
-      }
-    }
+    for(auto ge : entities)
+      v.insert(v.end(), ge->mesh_vertices.begin(), ge->mesh_vertices.end());
   }
   else {
+    std::unordered_set<MVertex *> allv;
     for(auto n : elementTags) {
       MElement *e = gm->getMeshElementByTag(n);
       for(std::size_t k = 0; k < e->getNumVertices(); k++) {
-        allv.insert(e->getVertex(k));
+        if(allv.insert(e->getVertex(k)).second) v.push_back(e->getVertex(k));
+      }
+    }
+  }
+  if(v.empty()) return 0;
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  double min[3] = {std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::max()};
+  double max[3] = {-std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max(),
+                   -std::numeric_limits<double>::max()};
+#pragma omp parallel num_threads(nthreads)
+  {
+    double tmin[3] = {min[0], min[1], min[2]};
+    double tmax[3] = {max[0], max[1], max[2]};
+#pragma omp for
+    for(std::size_t i = 0; i < v.size(); i++) {
+      for(int j = 0; j < 3; j++) {
+        tmin[j] = std::min(tmin[j], v[i]->point()[j]);
+        tmax[j] = std::max(tmax[j], v[i]->point()[j]);
       }
     }
+#pragma omp critical
+    for(int j = 0; j < 3; j++) {
+      min[j] = std::min(min[j], tmin[j]);
+      max[j] = std::max(max[j], tmax[j]);
+    }
   }
 
-  std::vector<MVertex *> v(allv.begin(), allv.end());
+  // sort the nodes by Hilbert index (ties are broken by the initial order, so
+  // that the result does not depend on the number of threads)
+  std::vector<std::pair<uint64_t, std::size_t> > keys(v.size());
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < v.size(); i++)
+    keys[i] = std::make_pair(
+      HilbertIndex(v[i]->x(), v[i]->y(), v[i]->z(), min, max), i);
+  std::sort(keys.begin(), keys.end());
 
-  SortHilbert_Without_Brio(v);
+  std::vector<std::size_t> num(v.size());
+  for(std::size_t i = 0; i < keys.size(); i++) num[keys[i].second] = i + 1;
 
-  for(std::size_t i = 0; i < v.size(); i++) {
-    permutations[v[i]->getNum()] = i + 1;
-  }
+  sortByOldTags(v, num, oldTags, newTags);
 
   Msg::Info("Done Hilbert renumbering");
 
   return 0;
 }
 
-int meshRenumber_Vertices_Metis(
-  const std::vector<std::size_t> &elementTags,
-  std::map<std::size_t, std::size_t> &permutations)
+int meshRenumber_Vertices_Metis(const std::vector<std::size_t> &elementTags,
+                                std::vector<std::size_t> &oldTags,
+                                std::vector<std::size_t> &newTags)
 {
-  permutations.clear();
+  oldTags.clear();
+  newTags.clear();
 
 #if defined(HAVE_METIS)
 
   Msg::Info("METIS renumbering (nested dissection)...");
 
   GModel *gm = GModel ::current();
-  std::map<MVertex *, std::size_t> initial_numbering;
-  std::map<std::size_t, MVertex *> invert_numbering;
+  std::vector<MVertex *> vertices;
   std::vector<idx_t> ai, aj;
-  createVertexToVertexGraph(gm, elementTags, initial_numbering,
-                            invert_numbering, ai, aj);
+  createVertexToVertexGraph(gm, elementTags, vertices, ai, aj);
+  if(vertices.empty()) return 0;
 
-  idx_t n = (idx_t)initial_numbering.size();
+  idx_t n = (idx_t)vertices.size();
   idx_t *xadj = &ai[0];
-  idx_t *adjncy = &aj[0];
-  idx_t *perm = new idx_t[n];
-  idx_t *iperm = new idx_t[n];
-  int result = METIS_NodeND(&n, xadj, adjncy, nullptr, nullptr, perm, iperm);
+  idx_t *adjncy = aj.empty() ? nullptr : &aj[0];
+  std::vector<idx_t> perm(n), iperm(n);
+  int result = METIS_NodeND(&n, xadj, adjncy, nullptr, nullptr, &perm[0],
+                            &iperm[0]);
 
   if(result != METIS_OK) {
-    delete[] perm;
-    delete[] iperm;
     Msg::Warning("Renumbering with METIS failed");
     return -1;
   }
 
-  for(auto it : initial_numbering) {
-    permutations[it.first->getNum()] = iperm[it.second] + 1;
-  }
-  delete[] perm;
-  delete[] iperm;
+  std::vector<std::size_t> num(vertices.size());
+  for(std::size_t i = 0; i < vertices.size(); i++) num[i] = iperm[i] + 1;
+
+  sortByOldTags(vertices, num, oldTags, newTags);
 
   Msg::Info("Done METIS renumbering");
 
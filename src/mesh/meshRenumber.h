@@ -6,16 +6,22 @@
 #ifndef _MESH_RENUMBER_
 #define _MESH_RENUMBER_
 
-#include <map>
+#include <cstddef>
 #include <vector>
 
-int meshRenumber_Vertices_RCMK(const std::vector<std::size_t> &elements,
-                               std::map<std::size_t, std::size_t> &permutations);
+// Compute a renumbering of the nodes of the given elements (of all the
+// elements in the current model if elementTags is empty): the node with tag
+// oldTags[i] should be renumbered newTags[i]; oldTags is sorted
+int meshRenumber_Vertices_RCMK(const std::vector<std::size_t> &elementTags,
+                               std::vector<std::size_t> &oldTags,
+                               std::vector<std::size_t> &newTags);
 
-int meshRenumber_Vertices_Hilbert(const std::vector<std::size_t> &elements,
-                                  std::map<std::size_t, std::size_t> &permutations);
+int meshRenumber_Vertices_Hilbert(const std::vector<std::size_t> &elementTags,
+                                  std::vector<std::size_t> &oldTags,
+                                  std::vector<std::size_t> &newTags);
 
 int meshRenumber_Vertices_Metis(const std::vector<std::size_t> &elementTags,
-                                std::map<std::size_t, std::size_t> &permutations);
+                                std::vector<std::size_t> &oldTags,
+                                std::vector<std::size_t> &newTags);
 
 #endif
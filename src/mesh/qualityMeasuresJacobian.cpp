@@ -4,12 +4,15 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <limits>
+#include <map>
+#include <algorithm>
 #include "qualityMeasuresJacobian.h"
 #include "FuncSpaceData.h"
 #include "MElement.h"
 #include "BasisFactory.h"
 #include "bezierBasis.h"
 #include "JacobianBasis.h"
+#include "CondNumBasis.h"
 #include "Numeric.h"
 #include "fullMatrix.h"
 
@@ -178,6 +181,15 @@ static void _computeICN(const fullVector<double> &det,
   }
 }
 
+static bool _jacobianBoundsOk(double minL, double maxL, double minB,
+                              double maxB)
+{
+  double tol = std::max(std::abs(minL), std::abs(maxL)) * 1e-3;
+  return (minL <= 0 || minB > 0) && (maxL >= 0 || maxB < 0) &&
+         minL - minB < tol && maxB - maxL < tol;
+  // NB: First condition implies minL and minB both positive or both negative
+}
+
 static bool _getQualityFunctionSpace(MElement *el, FuncSpaceData &fsGrad,
                                      FuncSpaceData &fsDet,
                                      int orderSamplingPoints = 0)
@@ -237,6 +249,71 @@ static bool _getQualityFunctionSpace(MElement *el, FuncSpaceData &fsGrad,
   return true;
 }
 
+// Group the elements by type (and number of nodes), as indices into
+// 'elements'
+static void _groupElementsByType(const std::vector<MElement *> &elements,
+                                 std::vector<std::vector<std::size_t> > &groups)
+{
+  std::map<std::pair<int, std::size_t>, std::size_t> types;
+  for(std::size_t i = 0; i < elements.size(); ++i) {
+    std::pair<int, std::size_t> key(elements[i]->getTypeForMSH(),
+                                    elements[i]->getNumVertices());
+    auto it = types.find(key);
+    if(it == types.end()) {
+      types[key] = groups.size();
+      groups.push_back(std::vector<std::size_t>(1, i));
+    }
+    else
+      groups[it->second].push_back(i);
+  }
+}
+
+static void _prepareBezierBasis(const FuncSpaceData &fs)
+{
+  BasisFactory::getBezierBasis(fs);
+  // Bezier expansion on prisms relies on the triangle basis
+  if(fs.getType() == TYPE_PRI)
+    BasisFactory::getBezierBasis(TYPE_TRI, fs.getSpaceOrder());
+}
+
+// Create all the bases needed to compute the Jacobian determinant (and the
+// quality measures if 'measures' is set) of elements of the same type as
+// 'el', so that they can then be accessed concurrently; returns false if the
+// bases cannot be prepared (the elements must then be treated sequentially)
+static bool _prepareBases(MElement *el, bool measures)
+{
+  const JacobianBasis *jfs = el->getJacobianFuncSpace();
+  if(!jfs || jfs->getFuncSpaceData().getSerendipity()) return false;
+  _prepareBezierBasis(jfs->getFuncSpaceData());
+  if(!measures) return true;
+
+  FuncSpaceData jacMatSpace, jacDetSpace;
+  if(!_getQualityFunctionSpace(el, jacMatSpace, jacDetSpace)) return false;
+  const int tag = el->getTypeForMSH();
+  BasisFactory::getGradientBasis(tag, jacMatSpace);
+  BasisFactory::getJacobianBasis(tag, jacDetSpace);
+  _prepareBezierBasis(jacMatSpace);
+  _prepareBezierBasis(jacDetSpace);
+  BasisFactory::getBezierBasis(jacMatSpace)->getRaiser();
+  BasisFactory::getBezierBasis(jacDetSpace)->getRaiser();
+  return true;
+}
+
+// Update the progress with the number of treated elements, from the master
+// thread only
+static void _updateProgress(MsgProgressStatus *progress, int &done, int num)
+{
+  if(!progress) return;
+#pragma omp atomic
+  done += num;
+  if(Msg::GetThreadNum() == 0) {
+    int d;
+#pragma omp atomic read
+    d = done;
+    progress->setProgress(d);
+  }
+}
+
 namespace jacobianBasedQuality {
 
   void minMaxJacobianDeterminant(MElement *el, double &min, double &max,
@@ -478,6 +555,375 @@ namespace jacobianBasedQuality {
     _computeICN(determinant, gradients, icn, el->getDim());
   }
 
+  void minMaxJacobianDeterminant(const std::vector<MElement *> &elements,
+                                 std::vector<double> &min,
+                                 std::vector<double> &max,
+                                 const fullMatrix<double> *normals,
+                                 int nthreads, MsgProgressStatus *progress)
+  {
+    const std::size_t blockSize = 256;
+    int done = 0;
+
+    min.assign(elements.size(), 99);
+    max.assign(elements.size(), -99);
+
+    std::vector<std::vector<std::size_t> > groups;
+    _groupElementsByType(elements, groups);
+
+    // Elements for which the Bezier coefficients of the whole element do not
+    // provide sharp enough bounds, and which need to be subdivided
+    std::vector<std::size_t> toRefine;
+
+    for(std::size_t g = 0; g < groups.size(); ++g) {
+      const std::vector<std::size_t> &group = groups[g];
+      MElement *first = elements[group[0]];
+      const JacobianBasis *jfs = first->getJacobianFuncSpace();
+      if(!jfs) {
+        Msg::Warning("Jacobian function space not implemented for %s",
+                     first->getName().c_str());
+        _updateProgress(progress, done, (int)group.size());
+        continue;
+      }
+      const FuncSpaceData fsData = jfs->getFuncSpaceData();
+      if(fsData.getSerendipity()) {
+        // let the element-wise computation report the error, sequentially as
+        // it creates the bases it needs
+        for(std::size_t i = 0; i < group.size(); ++i) {
+          const std::size_t k = group[i];
+          minMaxJacobianDeterminant(elements[k], min[k], max[k], normals);
+        }
+        bezierCoeff::releasePools();
+        _updateProgress(progress, done, (int)group.size());
+        continue;
+      }
+      _prepareBases(first, false);
+
+      const int numNodes = first->getNumVertices();
+      const int numSamplingPnts = jfs->getNumSamplingPnts();
+      const int numBlocks = (group.size() + blockSize - 1) / blockSize;
+      std::vector<char> refine(group.size(), 0);
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+      for(int b = 0; b < numBlocks; ++b) {
+        const std::size_t start = b * blockSize;
+        const int numEl = std::min(blockSize, group.size() - start);
+
+        // Sample the Jacobian determinant of all the elements of the block
+        fullMatrix<double> nodesX(numNodes, numEl);
+        fullMatrix<double> nodesY(numNodes, numEl);
+        fullMatrix<double> nodesZ(numNodes, numEl);
+        for(int j = 0; j < numEl; ++j) {
+          MElement *el = elements[group[start + j]];
+          for(int i = 0; i < numNodes; ++i) {
+            const MVertex *v = el->getShapeFunctionNode(i);
+            nodesX(i, j) = v->x();
+            nodesY(i, j) = v->y();
+            nodesZ(i, j) = v->z();
+          }
+        }
+        fullMatrix<double> coeffLag(numSamplingPnts, numEl);
+        jfs->getSignedJacobian(nodesX, nodesY, nodesZ, coeffLag, normals);
+
+        // Convert all the columns into Bezier coefficients at once (without
+        // using the memory pools)
+        bezierCoeff bez(fsData, coeffLag, -1);
+        const double *coeffs = bez.getDataPtr();
+        for(int j = 0; j < numEl; ++j) {
+          double minL = bez.getCornerCoeff(0, j), maxL = minL;
+          for(int i = 1; i < bez.getNumCornerCoeff(); ++i) {
+            minL = std::min(minL, bez.getCornerCoeff(i, j));
+            maxL = std::max(maxL, bez.getCornerCoeff(i, j));
+          }
+          const double *c = coeffs + j * numSamplingPnts;
+          double minB = c[0], maxB = c[0];
+          for(int i = 1; i < numSamplingPnts; ++i) {
+            minB = std::min(minB, c[i]);
+            maxB = std::max(maxB, c[i]);
+          }
+          if(_jacobianBoundsOk(minL, maxL, minB, maxB)) {
+            min[group[start + j]] = minB;
+            max[group[start + j]] = maxB;
+          }
+          else
+            refine[start + j] = 1;
+        }
+        int numDone = 0;
+        for(int j = 0; j < numEl; ++j)
+          if(!refine[start + j]) numDone++;
+        _updateProgress(progress, done, numDone);
+      }
+
+      for(std::size_t i = 0; i < group.size(); ++i)
+        if(refine[i]) toRefine.push_back(group[i]);
+    }
+
+    if(toRefine.empty()) return;
+
+    // The memory pools used for the subdivision are thread-local
+#pragma omp parallel num_threads(nthreads)
+    {
+#pragma omp for schedule(dynamic)
+      for(std::size_t i = 0; i < toRefine.size(); ++i) {
+        const std::size_t k = toRefine[i];
+        minMaxJacobianDeterminant(elements[k], min[k], max[k], normals);
+        _updateProgress(progress, done, 1);
+      }
+      bezierCoeff::releasePools();
+    }
+  }
+
+  static void _minMeasure(const std::vector<MElement *> &elements,
+                          std::vector<double> &measure, bool knownValid,
+                          bool reversedOk, const fullMatrix<double> *normals,
+                          int nthreads, bool icn, MsgProgressStatus *progress)
+  {
+    measure.assign(elements.size(), 0);
+
+    // Computation of the measure should never be performed to invalid
+    // elements (for which the measure is 0).
+    std::vector<char> valid(elements.size(), 1);
+    if(!knownValid) {
+      std::vector<double> jmin, jmax;
+      minMaxJacobianDeterminant(elements, jmin, jmax, normals, nthreads);
+      for(std::size_t i = 0; i < elements.size(); ++i) {
+        if((jmin[i] <= 0 && jmax[i] >= 0) || (jmax[i] < 0 && !reversedOk))
+          valid[i] = 0;
+      }
+    }
+
+    // the elements whose bases cannot be prepared are treated sequentially
+    std::vector<std::vector<std::size_t> > groups;
+    _groupElementsByType(elements, groups);
+    std::vector<char> parallel(elements.size(), 1);
+    for(std::size_t g = 0; g < groups.size(); ++g) {
+      if(_prepareBases(elements[groups[g][0]], true)) continue;
+      for(std::size_t i = 0; i < groups[g].size(); ++i)
+        parallel[groups[g][i]] = 0;
+    }
+
+    int done = 0;
+    for(std::size_t i = 0; i < elements.size(); ++i) {
+      if(parallel[i]) continue;
+      if(valid[i]) {
+        if(icn)
+          measure[i] = minICNMeasure(elements[i], true, reversedOk, normals);
+        else
+          measure[i] = minIGEMeasure(elements[i], true, reversedOk, normals);
+      }
+      _updateProgress(progress, done, 1);
+    }
+
+#pragma omp parallel num_threads(nthreads)
+    {
+#pragma omp for schedule(dynamic)
+      for(std::size_t i = 0; i < elements.size(); ++i) {
+        if(!parallel[i]) continue;
+        if(valid[i]) {
+          if(icn)
+            measure[i] = minICNMeasure(elements[i], true, reversedOk, normals);
+          else
+            measure[i] = minIGEMeasure(elements[i], true, reversedOk, normals);
+        }
+        _updateProgress(progress, done, 1);
+      }
+      bezierCoeff::releasePools();
+    }
+  }
+
+  void minIGEMeasure(const std::vector<MElement *> &elements,
+                     std::vector<double> &ige, bool knownValid,
+                     bool reversedOk, const fullMatrix<double> *normals,
+                     int nthreads, MsgProgressStatus *progress)
+  {
+    _minMeasure(elements, ige, knownValid, reversedOk, normals, nthreads,
+                false, progress);
+  }
+
+  void minICNMeasure(const std::vector<MElement *> &elements,
+                     std::vector<double> &icn, bool knownValid,
+                     bool reversedOk, const fullMatrix<double> *normals,
+                     int nthreads, MsgProgressStatus *progress)
+  {
+    _minMeasure(elements, icn, knownValid, reversedOk, normals, nthreads,
+                true, progress);
+  }
+
+  enum _sampledMeasure { _sampledSICN, _sampledSIGE, _sampledDisto };
+
+  static double _minSampledMeasure(MElement *el, _sampledMeasure which)
+  {
+    switch(which) {
+    case _sampledSICN: return el->minSICNShapeMeasure();
+    case _sampledSIGE: return el->minSIGEShapeMeasure();
+    default: return el->distoShapeMeasure();
+    }
+  }
+
+  static void _minSampledMeasure(const std::vector<MElement *> &elements,
+                                 std::vector<double> &measure,
+                                 _sampledMeasure which, int nthreads)
+  {
+    const std::size_t blockSize = 256;
+
+    measure.assign(elements.size(), 0.);
+
+    std::vector<std::vector<std::size_t> > groups;
+    _groupElementsByType(elements, groups);
+
+    for(std::size_t g = 0; g < groups.size(); ++g) {
+      const std::vector<std::size_t> &group = groups[g];
+      MElement *first = elements[group[0]];
+      const int tag = first->getTypeForMSH();
+      const int type = first->getType();
+      const int dim = first->getDim();
+      const bool standard = type == TYPE_PNT || type == TYPE_LIN ||
+                            type == TYPE_TRI || type == TYPE_QUA ||
+                            type == TYPE_TET || type == TYPE_PRI ||
+                            type == TYPE_HEX || type == TYPE_PYR;
+
+      // Create the bases sequentially, so that they can then be accessed
+      // concurrently; the elements for which they are not available are
+      // treated one by one
+      const CondNumBasis *cnb = nullptr;
+      const GradientBasis *gradBasis = nullptr;
+      const JacobianBasis *jfs = nullptr;
+      bool batch = standard;
+      switch(which) {
+      case _sampledSICN:
+        batch = standard || type == TYPE_TRIH;
+        if(batch) cnb = BasisFactory::getCondNumBasis(tag);
+        break;
+      case _sampledSIGE: {
+        FuncSpaceData jacMatSpace, jacDetSpace;
+        batch = standard && dim > 1 &&
+                _getQualityFunctionSpace(first, jacMatSpace, jacDetSpace,
+                                         first->getPolynomialOrder());
+        if(batch) {
+          gradBasis = BasisFactory::getGradientBasis(tag, jacMatSpace);
+          jfs = BasisFactory::getJacobianBasis(tag, jacDetSpace);
+        }
+      } break;
+      case _sampledDisto:
+        if(batch) jfs = first->getJacobianFuncSpace();
+        batch = jfs && !jfs->getFuncSpaceData().getSerendipity();
+        if(batch) _prepareBezierBasis(jfs->getFuncSpaceData());
+        break;
+      }
+      if(!batch) {
+        for(std::size_t i = 0; i < group.size(); ++i)
+          measure[group[i]] = _minSampledMeasure(elements[group[i]], which);
+        continue;
+      }
+
+      const int numNodes = first->getNumVertices();
+      const int numBlocks = (group.size() + blockSize - 1) / blockSize;
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+      for(int b = 0; b < numBlocks; ++b) {
+        const std::size_t start = b * blockSize;
+        const int numEl = std::min(blockSize, group.size() - start);
+
+        fullMatrix<double> nodesX(numNodes, numEl);
+        fullMatrix<double> nodesY(numNodes, numEl);
+        fullMatrix<double> nodesZ(numNodes, numEl);
+        for(int j = 0; j < numEl; ++j) {
+          MElement *el = elements[group[start + j]];
+          for(int i = 0; i < numNodes; ++i) {
+            const MVertex *v = el->getShapeFunctionNode(i);
+            nodesX(i, j) = v->x();
+            nodesY(i, j) = v->y();
+            nodesZ(i, j) = v->z();
+          }
+        }
+
+        switch(which) {
+        case _sampledSICN: {
+          fullMatrix<double> normals(numEl, 3);
+          if(dim == 2) {
+            for(int j = 0; j < numEl; ++j) {
+              SVector3 n = elements[group[start + j]]->getFace(0).normal();
+              normals(j, 0) = n[0];
+              normals(j, 1) = n[1];
+              normals(j, 2) = n[2];
+            }
+          }
+          const int numCNNodes = cnb->getNumCondNumNodes();
+          fullMatrix<double> invCondNum(numCNNodes, numEl);
+          cnb->getSignedInvCondNum(nodesX, nodesY, nodesZ, normals, invCondNum);
+          for(int j = 0; j < numEl; ++j) {
+            double min = invCondNum(0, j);
+            for(int i = 1; i < numCNNodes; ++i)
+              min = std::min(min, invCondNum(i, j));
+            measure[group[start + j]] = min;
+          }
+        } break;
+        case _sampledSIGE: {
+          // Sample the Jacobian determinant and the gradients of the mapping
+          // (derivative d of coordinate c in grad[3 * d + c]) of all the
+          // elements of the block, then compute the measure element-wise
+          const int numDet = jfs->getNumSamplingPnts();
+          const int numGrad = gradBasis->getNumSamplingPoints();
+          fullMatrix<double> det(numDet, numEl);
+          jfs->getSignedJacobian(nodesX, nodesY, nodesZ, det);
+          const fullMatrix<double> *dShape[3] = {&gradBasis->dShapeMat_dX,
+                                                 &gradBasis->dShapeMat_dY,
+                                                 &gradBasis->dShapeMat_dZ};
+          const fullMatrix<double> *nodes[3] = {&nodesX, &nodesY, &nodesZ};
+          std::vector<fullMatrix<double> > grad(3 * dim);
+          for(int d = 0; d < dim; ++d) {
+            for(int c = 0; c < 3; ++c) {
+              grad[3 * d + c].resize(numGrad, numEl);
+              dShape[d]->mult(*nodes[c], grad[3 * d + c]);
+            }
+          }
+          fullMatrix<double> gradients(numGrad, 3 * dim), v;
+          fullVector<double> determinant(numDet), ige;
+          for(int j = 0; j < numEl; ++j) {
+            for(int k = 0; k < 3 * dim; ++k)
+              for(int i = 0; i < numGrad; ++i) gradients(i, k) = grad[k](i, j);
+            for(int i = 0; i < numDet; ++i) determinant(i) = det(i, j);
+            _computeCoeffLengthVectors(gradients, v, type);
+            _computeIGE(determinant, v, ige, type);
+            double min = std::numeric_limits<double>::max();
+            for(int i = 0; i < ige.size(); ++i) min = std::min(min, ige(i));
+            measure[group[start + j]] = min;
+          }
+        } break;
+        case _sampledDisto: {
+          // The minimum is taken over the Bezier coefficients of the scaled
+          // Jacobian (converted without using the memory pools)
+          fullMatrix<double> jac(jfs->getNumSamplingPnts(), numEl);
+          jfs->getScaledJacobian(nodesX, nodesY, nodesZ, jac);
+          bezierCoeff bez(jfs->getFuncSpaceData(), jac, -1);
+          const int numCoeff = bez.getNumCoeff();
+          for(int j = 0; j < numEl; ++j) {
+            const double *c = bez.getDataPtr() + j * numCoeff;
+            measure[group[start + j]] = *std::min_element(c, c + numCoeff);
+          }
+        } break;
+        }
+      }
+    }
+  }
+
+  void minSICNShapeMeasure(const std::vector<MElement *> &elements,
+                           std::vector<double> &sicn, int nthreads)
+  {
+    _minSampledMeasure(elements, sicn, _sampledSICN, nthreads);
+  }
+
+  void minSIGEShapeMeasure(const std::vector<MElement *> &elements,
+                           std::vector<double> &sige, int nthreads)
+  {
+    _minSampledMeasure(elements, sige, _sampledSIGE, nthreads);
+  }
+
+  void distoShapeMeasure(const std::vector<MElement *> &elements,
+                         std::vector<double> &disto, int nthreads)
+  {
+    _minSampledMeasure(elements, disto, _sampledDisto, nthreads);
+  }
+
   // Virtual class _coeffData
   bool _lessMinB::operator()(_coeffData *cd1, _coeffData *cd2) const
   {
@@ -509,10 +955,7 @@ namespace jacobianBasedQuality {
 
   bool _coeffDataJac::boundsOk(double minL, double maxL) const
   {
-    double tol = std::max(std::abs(minL), std::abs(maxL)) * 1e-3;
-    return (minL <= 0 || _minB > 0) && (maxL >= 0 || _maxB < 0) &&
-           minL - _minB < tol && _maxB - maxL < tol;
-    // NB: First condition implies minL and minB both positive or both negative
+    return _jacobianBoundsOk(minL, maxL, _minB, _maxB);
   }
 
   void _coeffDataJac::getSubCoeff(std::vector<_coeffData *> &v) const
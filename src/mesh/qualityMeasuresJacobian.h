@@ -11,6 +11,7 @@
 
 class bezierCoeff;
 class MElement;
+class MsgProgressStatus;
 template <class scalar> class fullVector;
 template <class scalar> class fullMatrix;
 
@@ -38,6 +39,39 @@ namespace jacobianBasedQuality {
   void sampleIGEMeasure(MElement *el, int order, fullVector<double> &ige);
   void sampleICNMeasure(MElement *el, int order, fullVector<double> &icn);
 
+  // Batched versions of the above, for many elements at once. Elements of
+  // the same type are sampled together through matrix-matrix products, in
+  // blocks distributed over 'nthreads' threads; the Bezier subdivision is
+  // only performed for the elements whose bounds are not sharp enough. If
+  // 'progress' is given, it is updated with the number of treated elements.
+  void minMaxJacobianDeterminant(const std::vector<MElement *> &elements,
+                                 std::vector<double> &min,
+                                 std::vector<double> &max,
+                                 const fullMatrix<double> *normals = nullptr,
+                                 int nthreads = 1,
+                                 MsgProgressStatus *progress = nullptr);
+  void minIGEMeasure(const std::vector<MElement *> &elements,
+                     std::vector<double> &ige, bool knownValid = false,
+                     bool reversedOk = false,
+                     const fullMatrix<double> *normals = nullptr,
+                     int nthreads = 1, MsgProgressStatus *progress = nullptr);
+  void minICNMeasure(const std::vector<MElement *> &elements,
+                     std::vector<double> &icn, bool knownValid = false,
+                     bool reversedOk = false,
+                     const fullMatrix<double> *normals = nullptr,
+                     int nthreads = 1, MsgProgressStatus *progress = nullptr);
+
+  // Batched versions of MElement::minSICNShapeMeasure(),
+  // MElement::minSIGEShapeMeasure() and MElement::distoShapeMeasure(): the
+  // measures are sampled for blocks of elements of the same type at once,
+  // distributed over 'nthreads' threads
+  void minSICNShapeMeasure(const std::vector<MElement *> &elements,
+                           std::vector<double> &sicn, int nthreads = 1);
+  void minSIGEShapeMeasure(const std::vector<MElement *> &elements,
+                           std::vector<double> &sige, int nthreads = 1);
+  void distoShapeMeasure(const std::vector<MElement *> &elements,
+                         std::vector<double> &disto, int nthreads = 1);
+
   // For regression tests:
   void testAllMeasuresAllElements();
   void testAllMeasures(MElement *el,
@@ -1600,7 +1600,14 @@ void tetgenmesh::initializepools()
     printf("  tetrahedron per block: %d.\n", b->tetrahedraperblock);
   }
 
+  // the tables are static and thus shared by all the meshes: in a parallel
+  // region they have been initialized by the caller (this file is also
+  // compiled in hxt, without the Gmsh messaging layer)
+#if defined(_OPENMP)
+  if(!omp_in_parallel()) inittables();
+#else
   inittables();
+#endif
 
   // There are three input point lists available, which are in, addin,
   //   and bgm->in. These point lists may have different number of
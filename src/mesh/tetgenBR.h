@@ -852,7 +852,7 @@ public:
   static int sorgpivot[6], sdestpivot[6], sapexpivot[6];
   static int snextpivot[6];
 
-  void inittables();
+  static void inittables();
 
   // Primitives for tetrahedra.
   inline tetrahedron encode(triface &t);
@@ -1536,7 +1536,9 @@ public:
   }
 };
 
-static selfint_event sevent;
+// one event per thread, as the boundary of independent volumes can be
+// recovered concurrently
+static thread_local selfint_event sevent;
 
 inline void terminatetetgen(tetgenmesh *m, int x)
 {
@@ -13,68 +13,153 @@
 #include "JacobianBasis.h"
 #include <map>
 #include <cstddef>
+#include <atomic>
+#include <thread>
+#include <algorithm>
 
-std::map<int, nodalBasis *> BasisFactory::fs;
-std::map<int, CondNumBasis *> BasisFactory::cs;
-std::map<FuncSpaceData, JacobianBasis *> BasisFactory::js;
-std::map<FuncSpaceData, bezierBasis *> BasisFactory::bs;
-std::map<FuncSpaceData, GradientBasis *> BasisFactory::gs;
+namespace {
 
-const nodalBasis *BasisFactory::getNodalBasis(int tag)
-{
-  // If the Basis has already been built, return it.
-  auto it = fs.find(tag);
-  if(it != fs.end()) { return it->second; }
-
-  // Get the parent type to see which kind of basis we want to create
-  nodalBasis *F = nullptr;
-  if(tag == MSH_TRI_MINI)
-    F = new miniBasisTri();
-  else if(tag == MSH_TET_MINI)
-    F = new miniBasisTet();
-  else {
-    int parentType = ElementType::getParentType(tag);
-    switch(parentType) {
-    case(TYPE_PNT):
-    case(TYPE_LIN):
-    case(TYPE_TRI):
-    case(TYPE_QUA):
-    case(TYPE_PRI):
-    case(TYPE_TET):
-    case(TYPE_HEX): F = new polynomialBasis(tag); break;
-    case(TYPE_PYR): F = new pyramidalBasis(tag); break;
-    default:
-      Msg::Error("Unknown type of element %d (in BasisFactory)", tag);
-      return nullptr;
-    }
+  // Index of a basis in the table of a registry, or -1 if it is not tabulated
+  long registryIndex(int tag)
+  {
+    if(tag < 0 || tag > MSH_MAX_NUM) return -1;
+    return tag;
   }
 
-  std::pair<std::map<int, nodalBasis *>::const_iterator, bool> inserted;
-#pragma omp critical(getNodalBasis)
+  long registryIndex(const FuncSpaceData &data)
   {
-    inserted = fs.insert(std::make_pair(tag, F));
-    if(!inserted.second) delete F;
+    const int n = BasisFactory::maxTabulatedOrder;
+    const int type = data.getType(), nij = data.getNij(), nk = data.getNk();
+    const bool pyr = data.getPyramidalSpace();
+    if(type < 0 || type > TYPE_HEX || nij < 0 || nij >= n || nk < 0 || nk >= n)
+      return -1;
+    // the space order is redundant for all the spaces built by FuncSpaceData
+    // constructors; other spaces are not tabulated
+    if(data.getSpaceOrder() != (pyr ? nij + nk : std::max(nij, nk))) return -1;
+    return ((type * 2 + (pyr ? 1 : 0)) * n + nij) * n + nk;
   }
 
-  return inserted.first->second;
-}
+  // Bases of a given kind, created at most once per key: the first thread
+  // requesting a missing basis creates it, while the other threads requesting
+  // the same basis wait for it to be published. If the creation fails, the
+  // key is released so that the next request tries again.
+  template <class Key, class Basis, long N> class basisRegistry {
+  private:
+    std::atomic<Basis *> _table[N];
+    std::atomic<char> _creating[N];
+    std::map<Key, Basis *> _others; // nullptr while being created
+
+  public:
+    basisRegistry()
+    {
+      for(long i = 0; i < N; i++) {
+        _table[i].store(nullptr);
+        _creating[i].store(0);
+      }
+    }
+    template <class Create> Basis *get(const Key &key, Create create)
+    {
+      const long index = registryIndex(key);
+      if(index >= 0) {
+        while(true) {
+          Basis *basis = _table[index].load(std::memory_order_acquire);
+          if(basis) return basis;
+          char creating = 0;
+          if(_creating[index].compare_exchange_strong(creating, 1)) break;
+          std::this_thread::yield();
+        }
+        // the flag stays set once the basis is published
+        Basis *created = create();
+        if(created)
+          _table[index].store(created, std::memory_order_release);
+        else
+          _creating[index].store(0);
+        return created;
+      }
+
+      Basis *basis = nullptr;
+      while(true) {
+        bool mine = false;
+#pragma omp critical(basisRegistry)
+        {
+          auto it = _others.find(key);
+          if(it == _others.end()) {
+            _others[key] = nullptr;
+            mine = true;
+          }
+          else
+            basis = it->second;
+        }
+        if(basis) return basis;
+        if(mine) break;
+        std::this_thread::yield();
+      }
+      basis = create();
+#pragma omp critical(basisRegistry)
+      {
+        if(basis)
+          _others[key] = basis;
+        else
+          _others.erase(key);
+      }
+      return basis;
+    }
+    void clear()
+    {
+      for(long i = 0; i < N; i++) {
+        delete _table[i].load();
+        _table[i].store(nullptr);
+        _creating[i].store(0);
+      }
+      for(auto it = _others.begin(); it != _others.end(); it++)
+        delete it->second;
+      _others.clear();
+    }
+  };
 
-const JacobianBasis *BasisFactory::getJacobianBasis(int tag, FuncSpaceData fsd)
-{
-  FuncSpaceData data = fsd.getForNonSerendipitySpace();
+  const long numTabulatedTags = MSH_MAX_NUM + 1;
+  const long numTabulatedSpaces = (TYPE_HEX + 1) * 2 *
+                                  BasisFactory::maxTabulatedOrder *
+                                  BasisFactory::maxTabulatedOrder;
 
-  auto it = js.find(data);
-  if(it != js.end()) return it->second;
+  basisRegistry<int, nodalBasis, numTabulatedTags> fs;
+  basisRegistry<int, CondNumBasis, numTabulatedTags> cs;
+  basisRegistry<FuncSpaceData, JacobianBasis, numTabulatedSpaces> js;
+  basisRegistry<FuncSpaceData, bezierBasis, numTabulatedSpaces> bs;
+  basisRegistry<FuncSpaceData, GradientBasis, numTabulatedSpaces> gs;
 
-  JacobianBasis *J = new JacobianBasis(tag, data);
+} // namespace
 
-  std::pair<std::map<FuncSpaceData, JacobianBasis *>::const_iterator, bool> inserted;
-#pragma omp critical(getJacobianBasis)
-  {
-    inserted = js.insert(std::make_pair(data, J));
-    if(!inserted.second) delete J;
+static nodalBasis *createNodalBasis(int tag)
+{
+  // Get the parent type to see which kind of basis we want to create
+  if(tag == MSH_TRI_MINI) return new miniBasisTri();
+  if(tag == MSH_TET_MINI) return new miniBasisTet();
+  int parentType = ElementType::getParentType(tag);
+  switch(parentType) {
+  case(TYPE_PNT):
+  case(TYPE_LIN):
+  case(TYPE_TRI):
+  case(TYPE_QUA):
+  case(TYPE_PRI):
+  case(TYPE_TET):
+  case(TYPE_HEX): return new polynomialBasis(tag);
+  case(TYPE_PYR): return new pyramidalBasis(tag);
+  default:
+    Msg::Error("Unknown type of element %d (in BasisFactory)", tag);
+    return nullptr;
   }
-  return inserted.first->second;
+}
+
+const nodalBasis *BasisFactory::getNodalBasis(int tag)
+{
+  return fs.get(tag, [tag]() { return createNodalBasis(tag); });
+}
+
+const JacobianBasis *BasisFactory::getJacobianBasis(int tag, FuncSpaceData fsd)
+{
+  FuncSpaceData data = fsd.getForNonSerendipitySpace();
+  return js.get(data, [tag, &data]() { return new JacobianBasis(tag, data); });
 }
 
 const JacobianBasis *BasisFactory::getJacobianBasis(int tag, int order)
@@ -100,36 +185,14 @@ const JacobianBasis *BasisFactory::getJacobianBasis(int tag)
 
 const CondNumBasis *BasisFactory::getCondNumBasis(int tag, int cnOrder)
 {
-  auto it = cs.find(tag);
-  if(it != cs.end()) return it->second;
-
-  CondNumBasis *M = new CondNumBasis(tag, cnOrder);
-
-  std::pair<std::map<int, CondNumBasis *>::const_iterator, bool> inserted;
-#pragma omp critical(getCondNumBasis)
-  {
-    inserted = cs.insert(std::make_pair(tag, M));
-    if(!inserted.second) delete M;
-  }
-  return inserted.first->second;
+  return cs.get(tag,
+                [tag, cnOrder]() { return new CondNumBasis(tag, cnOrder); });
 }
 
 const GradientBasis *BasisFactory::getGradientBasis(int tag, FuncSpaceData fsd)
 {
   FuncSpaceData data = fsd.getForNonSerendipitySpace();
-
-  auto it = gs.find(data);
-  if(it != gs.end()) return it->second;
-
-  GradientBasis *G = new GradientBasis(tag, data);
-
-  std::pair<std::map<FuncSpaceData, GradientBasis *>::const_iterator, bool> inserted;
-#pragma omp critical(getGradientBasis)
-  {
-    inserted = gs.insert(std::make_pair(data, G));
-    if(!inserted.second) delete G;
-  }
-  return inserted.first->second;
+  return gs.get(data, [tag, &data]() { return new GradientBasis(tag, data); });
 }
 
 const GradientBasis *BasisFactory::getGradientBasis(int tag, int order)
@@ -146,19 +209,7 @@ const GradientBasis *BasisFactory::getGradientBasis(int tag)
 const bezierBasis *BasisFactory::getBezierBasis(FuncSpaceData fsd)
 {
   FuncSpaceData data = fsd.getForNonSerendipitySpace();
-
-  auto it = bs.find(data);
-  if(it != bs.end()) return it->second;
-
-  bezierBasis *B = new bezierBasis(data);
-
-  std::pair<std::map<FuncSpaceData, bezierBasis *>::const_iterator, bool> inserted;
-#pragma omp critical(getBezierBasis)
-  {
-    inserted = bs.insert(std::make_pair(data, B));
-    if(!inserted.second) delete B;
-  }
-  return inserted.first->second;
+  return bs.get(data, [&data]() { return new bezierBasis(data); });
 }
 
 const bezierBasis *BasisFactory::getBezierBasis(int parentType, int order)
@@ -173,38 +224,9 @@ const bezierBasis *BasisFactory::getBezierBasis(int tag)
 
 void BasisFactory::clearAll()
 {
-  auto itF = fs.begin();
-  while(itF != fs.end()) {
-    delete itF->second;
-    itF++;
-  }
   fs.clear();
-
-  auto itJ = js.begin();
-  while(itJ != js.end()) {
-    delete itJ->second;
-    itJ++;
-  }
   js.clear();
-
-  auto itC = cs.begin();
-  while(itC != cs.end()) {
-    delete itC->second;
-    itC++;
-  }
   cs.clear();
-
-  auto itG = gs.begin();
-  while(itG != gs.end()) {
-    delete itG->second;
-    itG++;
-  }
   gs.clear();
-
-  auto itB = bs.begin();
-  while(itB != bs.end()) {
-    delete itB->second;
-    itB++;
-  }
   bs.clear();
 }
@@ -15,14 +15,18 @@ class JacobianBasis;
 class FuncSpaceData;
 
 class BasisFactory {
-private:
-  static std::map<int, nodalBasis *> fs;
-  static std::map<int, CondNumBasis *> cs;
-  static std::map<FuncSpaceData, JacobianBasis *> js;
-  static std::map<FuncSpaceData, bezierBasis *> bs;
-  static std::map<FuncSpaceData, GradientBasis *> gs;
-
 public:
+  // Bases are created on first request and never move afterwards. Lookups are
+  // lock-free (a direct access into a table of atomic pointers) for all the
+  // element types and for function spaces of order < maxTabulatedOrder; other
+  // function spaces are stored in a map protected by a lock, and are thus
+  // still supported, only with slower lookups. The bound is fixed since the
+  // tables are allocated statically: for each kind of basis defined on
+  // function spaces, (TYPE_HEX + 1) x 2 x 32 x 32 = 18432 entries of 9 bytes
+  // (a pointer and a flag), i.e. about 166 kB. It covers the orders for which
+  // the bases can be computed accurately.
+  static const int maxTabulatedOrder = 32;
+
   // Caution: the returned pointer can be NULL
 
   // Nodal
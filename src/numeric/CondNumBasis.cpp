@@ -507,6 +507,85 @@ void CondNumBasis::getSignedInvCondNumGeneral(
                              nodesXYZ, normals, invCond);
 }
 
+// Calculate the signed inverse condition number in Frobenius norm for several
+// elements, with one matrix product per coordinate and derivative
+void CondNumBasis::getSignedInvCondNum(const fullMatrix<double> &nodesX,
+                                       const fullMatrix<double> &nodesY,
+                                       const fullMatrix<double> &nodesZ,
+                                       const fullMatrix<double> &normals,
+                                       fullMatrix<double> &invCond) const
+{
+  const int numEl = nodesX.size2();
+  switch(_dim) {
+  case 0: {
+    invCond.setAll(1.);
+    break;
+  }
+
+  case 1: {
+    Msg::Warning("Inverse condition number not implemented in 1D");
+    invCond.setAll(0.);
+    break;
+  }
+
+  case 2: {
+    const fullMatrix<double> &dSMat_dX = _gradBasis->dShapeIdealMat_dX;
+    const fullMatrix<double> &dSMat_dY = _gradBasis->dShapeIdealMat_dY;
+    fullMatrix<double> dxdX(_nCondNumNodes, numEl), dydX(_nCondNumNodes, numEl),
+      dzdX(_nCondNumNodes, numEl);
+    fullMatrix<double> dxdY(_nCondNumNodes, numEl), dydY(_nCondNumNodes, numEl),
+      dzdY(_nCondNumNodes, numEl);
+    dSMat_dX.mult(nodesX, dxdX);
+    dSMat_dX.mult(nodesY, dydX);
+    dSMat_dX.mult(nodesZ, dzdX);
+    dSMat_dY.mult(nodesX, dxdY);
+    dSMat_dY.mult(nodesY, dydY);
+    dSMat_dY.mult(nodesZ, dzdY);
+    for(int iEl = 0; iEl < numEl; iEl++) {
+      const double &nx = normals(iEl, 0), &ny = normals(iEl, 1),
+                   &nz = normals(iEl, 2);
+      for(int i = 0; i < _nCondNumNodes; i++)
+        invCond(i, iEl) = calcInvCondNum2D<true>(
+          dxdX(i, iEl), dxdY(i, iEl), dydX(i, iEl), dydY(i, iEl), dzdX(i, iEl),
+          dzdY(i, iEl), nx, ny, nz);
+    }
+    break;
+  }
+
+  case 3: {
+    if(ElementType::getParentType(_tag) == TYPE_TRIH) {
+      invCond.setAll(1.);
+      break;
+    }
+    const fullMatrix<double> &dSMat_dX = _gradBasis->dShapeIdealMat_dX;
+    const fullMatrix<double> &dSMat_dY = _gradBasis->dShapeIdealMat_dY;
+    const fullMatrix<double> &dSMat_dZ = _gradBasis->dShapeIdealMat_dZ;
+    fullMatrix<double> dxdX(_nCondNumNodes, numEl), dydX(_nCondNumNodes, numEl),
+      dzdX(_nCondNumNodes, numEl);
+    fullMatrix<double> dxdY(_nCondNumNodes, numEl), dydY(_nCondNumNodes, numEl),
+      dzdY(_nCondNumNodes, numEl);
+    fullMatrix<double> dxdZ(_nCondNumNodes, numEl), dydZ(_nCondNumNodes, numEl),
+      dzdZ(_nCondNumNodes, numEl);
+    dSMat_dX.mult(nodesX, dxdX);
+    dSMat_dX.mult(nodesY, dydX);
+    dSMat_dX.mult(nodesZ, dzdX);
+    dSMat_dY.mult(nodesX, dxdY);
+    dSMat_dY.mult(nodesY, dydY);
+    dSMat_dY.mult(nodesZ, dzdY);
+    dSMat_dZ.mult(nodesX, dxdZ);
+    dSMat_dZ.mult(nodesY, dydZ);
+    dSMat_dZ.mult(nodesZ, dzdZ);
+    for(int iEl = 0; iEl < numEl; iEl++) {
+      for(int i = 0; i < _nCondNumNodes; i++)
+        invCond(i, iEl) = calcInvCondNum3D<true>(
+          dxdX(i, iEl), dxdY(i, iEl), dxdZ(i, iEl), dydX(i, iEl), dydY(i, iEl),
+          dydZ(i, iEl), dzdX(i, iEl), dzdY(i, iEl), dzdZ(i, iEl));
+    }
+    break;
+  }
+  }
+}
+
 // Calculate the inverse condition number in Frobenius norm and its gradients
 // w.r.t. node position, with normal vectors to straight element  for
 // regularization. Evaluation points depend on the given matrices for shape
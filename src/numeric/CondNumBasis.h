@@ -52,6 +52,15 @@ public:
                                _gradBasis->dShapeIdealMat_dZ, nodesXYZ, normals,
                                invCond);
   }
+  // Same as above for several elements of the same type at once: column j of
+  // nodesX, nodesY and nodesZ holds the node coordinates of element j, row j
+  // of normals its normal (for 2D elements) and column j of invCond its
+  // measure
+  void getSignedInvCondNum(const fullMatrix<double> &nodesX,
+                           const fullMatrix<double> &nodesY,
+                           const fullMatrix<double> &nodesZ,
+                           const fullMatrix<double> &normals,
+                           fullMatrix<double> &invCond) const;
   inline void getInvCondNumAndGradients(const fullMatrix<double> &nodesXYZ,
                                         fullMatrix<double> &IDI) const
   {
@@ -3,8 +3,10 @@
 // See the LICENSE.txt file in the Gmsh root directory for license information.
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
+#include <algorithm>
 #include "SBoundingBox3d.h"
 #include "MVertex.h"
+#include "HilbertCurve.h"
 
 struct HilbertSort {
   // The code for generating table transgc
@@ -273,3 +275,46 @@ void SortHilbert_Without_Brio(std::vector<MVertex *> &v){
   HilbertSort h(1000);
   h.Apply(v,v.size()+1);
 }
+
+uint64_t HilbertIndex(double x, double y, double z, const double min[3],
+                      const double max[3])
+{
+  // J. Skilling, "Programming the Hilbert curve", AIP Conference Proceedings
+  // 707, 2004: transform the integer coordinates into the "transposed" Hilbert
+  // index, whose bits are then interleaved
+  const int bits = 21;
+  const uint32_t M = 1u << (bits - 1);
+  double p[3] = {x, y, z};
+  uint32_t X[3];
+  for(int i = 0; i < 3; i++) {
+    double l = max[i] - min[i];
+    double t = (l > 0.) ? (p[i] - min[i]) / l : 0.;
+    t = std::min(std::max(t, 0.), 1.);
+    X[i] = std::min((uint32_t)(t * (1u << bits)), (1u << bits) - 1);
+  }
+
+  // inverse undo
+  for(uint32_t Q = M; Q > 1; Q >>= 1) {
+    uint32_t P = Q - 1;
+    for(int i = 0; i < 3; i++) {
+      if(X[i] & Q) { X[0] ^= P; }
+      else {
+        uint32_t t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for(int i = 1; i < 3; i++) X[i] ^= X[i - 1];
+  uint32_t t = 0;
+  for(uint32_t Q = M; Q > 1; Q >>= 1)
+    if(X[2] & Q) t ^= Q - 1;
+  for(int i = 0; i < 3; i++) X[i] ^= t;
+
+  uint64_t index = 0;
+  for(int b = bits - 1; b >= 0; b--)
+    for(int i = 0; i < 3; i++) index = (index << 1) | ((X[i] >> b) & 1);
+  return index;
+}
@@ -6,7 +6,14 @@
 #ifndef HILBERT_CURVE
 #define HILBERT_CURVE
 
+#include <cstdint>
+
 void SortHilbert(std::vector<MVertex *> &);
 void SortHilbert_Without_Brio(std::vector<MVertex *> &v);
 
+// index of the point (x, y, z) along the 3D Hilbert curve filling the box
+// [min, max], discretized with 2^21 cells in each direction
+uint64_t HilbertIndex(double x, double y, double z, const double min[3],
+                      const double max[3]);
+
 #endif
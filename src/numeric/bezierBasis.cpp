@@ -609,9 +609,9 @@ void bezierBasisRaiser::computeCoeff(const fullVector<double> &coeffA,
       "or A != B == C");
 }
 
-bezierCoeffMemoryPool *bezierCoeff::_pool0 = nullptr;
-bezierCoeffMemoryPool *bezierCoeff::_pool1 = nullptr;
-fullMatrix<double> bezierCoeff::_sub = fullMatrix<double>();
+thread_local bezierCoeffMemoryPool *bezierCoeff::_pool0 = nullptr;
+thread_local bezierCoeffMemoryPool *bezierCoeff::_pool1 = nullptr;
+thread_local fullMatrix<double> bezierCoeff::_sub = fullMatrix<double>();
 
 bezierCoeff::bezierCoeff(const FuncSpaceData fsData,
                          const fullMatrix<double> &orderedLagCoeff, int num)
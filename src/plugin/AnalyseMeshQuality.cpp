@@ -297,19 +297,22 @@ void GMSH_AnalyseMeshQualityPlugin::_computeMinMaxJandValidity(int dim)
     default: break;
     }
 
-    MsgProgressStatus progress(num);
+    std::vector<MElement *> elements(num);
+    for(unsigned i = 0; i < num; ++i) elements[i] = entity->getMeshElement(i);
+    std::vector<double> min, max;
+    {
+      MsgProgressStatus progress(num);
+      jacobianBasedQuality::minMaxJacobianDeterminant(
+        elements, min, max, normals, _getNumThreads(), &progress);
+    }
 
     _data.reserve(_data.size() + num);
     for(unsigned i = 0; i < num; ++i) {
-      MElement *el = entity->getMeshElement(i);
-      double min, max;
-      jacobianBasedQuality::minMaxJacobianDeterminant(el, min, max, normals);
-      _data.push_back(data_elementMinMax(el, min, max));
-      if(min < 0 && max < 0) ++cntInverted;
-      progress.next();
+      _data.push_back(data_elementMinMax(elements[i], min[i], max[i]));
+      if(min[i] < 0 && max[i] < 0) ++cntInverted;
 
 #if defined(HAVE_VISUDEV)
-      _computePointwiseQuantities(el, normals);
+      _computePointwiseQuantities(elements[i], normals);
 #endif
     }
     if(normals) delete normals;
@@ -322,21 +325,42 @@ void GMSH_AnalyseMeshQualityPlugin::_computeMinMaxJandValidity(int dim)
   bezierCoeff::releasePools();
 }
 
-void GMSH_AnalyseMeshQualityPlugin::_computeMinIGE(int dim)
+int GMSH_AnalyseMeshQualityPlugin::_getNumThreads()
 {
-  if(_computedIGE[dim - 1]) return;
-
-  MsgProgressStatus progress(_data.size());
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  return nthreads;
+}
 
+void GMSH_AnalyseMeshQualityPlugin::_getValidElements(
+  int dim, std::vector<MElement *> &elements, std::vector<std::size_t> &indices)
+{
   for(std::size_t i = 0; i < _data.size(); ++i) {
     MElement *const el = _data[i].element();
     if(el->getDim() != dim) continue;
-    if(_data[i].minJ() <= 0 && _data[i].maxJ() >= 0) { _data[i].setMinS(0); }
-    else {
-      _data[i].setMinS(jacobianBasedQuality::minIGEMeasure(el, true));
-    }
-    progress.next();
+    if(_data[i].minJ() <= 0 && _data[i].maxJ() >= 0) continue;
+    elements.push_back(el);
+    indices.push_back(i);
   }
+}
+
+void GMSH_AnalyseMeshQualityPlugin::_computeMinIGE(int dim)
+{
+  if(_computedIGE[dim - 1]) return;
+
+  for(std::size_t i = 0; i < _data.size(); ++i) {
+    if(_data[i].element()->getDim() == dim) _data[i].setMinS(0);
+  }
+
+  std::vector<MElement *> elements;
+  std::vector<std::size_t> indices;
+  _getValidElements(dim, elements, indices);
+  std::vector<double> ige;
+  MsgProgressStatus progress(elements.size());
+  jacobianBasedQuality::minIGEMeasure(elements, ige, true, false, nullptr,
+                                      _getNumThreads(), &progress);
+  for(std::size_t i = 0; i < indices.size(); ++i)
+    _data[indices[i]].setMinS(ige[i]);
 
   _computedIGE[dim - 1] = true;
 }
@@ -345,18 +369,20 @@ void GMSH_AnalyseMeshQualityPlugin::_computeMinICN(int dim)
 {
   if(_computedICN[dim - 1]) return;
 
-  MsgProgressStatus progress(_data.size());
-
   for(std::size_t i = 0; i < _data.size(); ++i) {
-    MElement *const el = _data[i].element();
-    if(el->getDim() != dim) continue;
-    if(_data[i].minJ() <= 0 && _data[i].maxJ() >= 0) { _data[i].setMinI(0); }
-    else {
-      _data[i].setMinI(jacobianBasedQuality::minICNMeasure(el, true));
-    }
-    progress.next();
+    if(_data[i].element()->getDim() == dim) _data[i].setMinI(0);
   }
 
+  std::vector<MElement *> elements;
+  std::vector<std::size_t> indices;
+  _getValidElements(dim, elements, indices);
+  std::vector<double> icn;
+  MsgProgressStatus progress(elements.size());
+  jacobianBasedQuality::minICNMeasure(elements, icn, true, false, nullptr,
+                                      _getNumThreads(), &progress);
+  for(std::size_t i = 0; i < indices.size(); ++i)
+    _data[indices[i]].setMinI(icn[i]);
+
   _computedICN[dim - 1] = true;
 }
 
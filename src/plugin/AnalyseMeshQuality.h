@@ -83,6 +83,9 @@ private:
   void _computeMinMaxJandValidity(int dim);
   void _computeMinIGE(int dim);
   void _computeMinICN(int dim);
+  int _getNumThreads();
+  void _getValidElements(int dim, std::vector<MElement *> &elements,
+                         std::vector<std::size_t> &indices);
   int _hideWithThreshold(int askedDim, int whichMeasure, double threshold,
                          bool greater);
   void _printStatJacobian();
@@ -7,6 +7,7 @@
 #include "OctreePost.h"
 #include "CutGrid.h"
 #include "Context.h"
+#include "GmshMessage.h"
 
 #if defined(HAVE_OPENGL)
 #include "drawContext.h"
@@ -333,26 +334,38 @@ PView *GMSH_CutGridPlugin::GenerateView(PView *v1, int connect)
     }
   }
 
+  // the grid points are searched concurrently: the search trees are either
+  // built by the OctreePost constructor or created on demand thread-safely
+  int nbU = getNbU(), nbV = getNbV();
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
   if(nbs) {
-    for(int i = 0; i < getNbU(); i++)
-      for(int j = 0; j < getNbV(); j++)
-        o.searchScalar(pnts[i][j][0], pnts[i][j][1], pnts[i][j][2], vals[i][j]);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int n = 0; n < nbU * nbV; n++) {
+      int i = n / nbV, j = n % nbV;
+      o.searchScalar(pnts[i][j][0], pnts[i][j][1], pnts[i][j][2], vals[i][j]);
+    }
     addInView(numsteps, connect, 1, pnts, vals, data2->SP, &data2->NbSP,
               data2->SL, &data2->NbSL, data2->SQ, &data2->NbSQ);
   }
 
   if(nbv) {
-    for(int i = 0; i < getNbU(); i++)
-      for(int j = 0; j < getNbV(); j++)
-        o.searchVector(pnts[i][j][0], pnts[i][j][1], pnts[i][j][2], vals[i][j]);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int n = 0; n < nbU * nbV; n++) {
+      int i = n / nbV, j = n % nbV;
+      o.searchVector(pnts[i][j][0], pnts[i][j][1], pnts[i][j][2], vals[i][j]);
+    }
     addInView(numsteps, connect, 3, pnts, vals, data2->VP, &data2->NbVP,
               data2->VL, &data2->NbVL, data2->VQ, &data2->NbVQ);
   }
 
   if(nbt) {
-    for(int i = 0; i < getNbU(); i++)
-      for(int j = 0; j < getNbV(); j++)
-        o.searchTensor(pnts[i][j][0], pnts[i][j][1], pnts[i][j][2], vals[i][j]);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int n = 0; n < nbU * nbV; n++) {
+      int i = n / nbV, j = n % nbV;
+      o.searchTensor(pnts[i][j][0], pnts[i][j][1], pnts[i][j][2], vals[i][j]);
+    }
     addInView(numsteps, connect, 9, pnts, vals, data2->TP, &data2->NbTP,
               data2->TL, &data2->NbTL, data2->TQ, &data2->NbTQ);
   }
@@ -48,17 +48,17 @@ PView *GMSH_GradientPlugin::execute(PView *v)
   PViewDataList *data2 = getDataList(v2);
   int firstNonEmptyStep = data1->getFirstNonEmptyTimeStep();
 
-  for(int ent = 0; ent < data1->getNumEntities(firstNonEmptyStep); ent++) {
-    for(int ele = 0; ele < data1->getNumElements(firstNonEmptyStep, ent);
-        ele++) {
-      if(data1->skipElement(firstNonEmptyStep, ent, ele)) continue;
+  forEachElement(
+    data1, firstNonEmptyStep, data2,
+    [&](int ent, int ele, PViewDataList *blockData) {
+      if(data1->skipElement(firstNonEmptyStep, ent, ele)) return;
       int numComp = data1->getNumComponents(firstNonEmptyStep, ent, ele);
-      if(numComp != 1 && numComp != 3) continue;
+      if(numComp != 1 && numComp != 3) return;
       int type = data1->getType(firstNonEmptyStep, ent, ele);
       int numNodes = data1->getNumNodes(firstNonEmptyStep, ent, ele);
       std::vector<double> *out =
-        data2->incrementList((numComp == 1) ? 3 : 9, type, numNodes);
-      if(!out) continue;
+        blockData->incrementList((numComp == 1) ? 3 : 9, type, numNodes);
+      if(!out) return;
       double x[8], y[8], z[8], val[8 * 3];
       for(int nod = 0; nod < numNodes; nod++)
         data1->getNode(firstNonEmptyStep, ent, ele, nod, x[nod], y[nod],
@@ -66,7 +66,7 @@ PView *GMSH_GradientPlugin::execute(PView *v)
       int dim = data1->getDimension(firstNonEmptyStep, ent, ele);
       elementFactory factory;
       element *element = factory.create(numNodes, dim, x, y, z);
-      if(!element) continue;
+      if(!element) return;
       for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
       for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
       for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
@@ -88,8 +88,7 @@ PView *GMSH_GradientPlugin::execute(PView *v)
         }
       }
       delete element;
-    }
-  }
+    });
 
   for(int i = 0; i < data1->getNumTimeSteps(); i++) {
     if(!data1->hasTimeStep(i)) continue;
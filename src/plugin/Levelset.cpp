@@ -223,7 +223,6 @@ static void reorderPrism(int numComp, double xp[12], double yp[12],
 
 GMSH_LevelsetPlugin::GMSH_LevelsetPlugin()
 {
-  _invert = 0.;
   _ref[0] = _ref[1] = _ref[2] = 0.;
   _valueIndependent = 0; // "moving" levelset
   _valueView = -1; // use same view for levelset and field data
@@ -387,6 +386,7 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
   int numEdges = vdata->getNumEdges(stepmin, ent, ele);
   int numComp = wdata->getNumComponents(otherstep, ent, ele);
   int type = vdata->getType(stepmin, ent, ele);
+  double invert = 0.;
 
   // decompose the element into simplices
   for(int simplex = 0; simplex < numSimplexDec(type); simplex++) {
@@ -470,19 +470,19 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
           switch(_orientation) {
           case MAP:
             gradSimplex(x, y, z, scalarValues, gr);
-            _invert = prosca(gr, normal);
+            invert = prosca(gr, normal);
             break;
-          case PLANE: _invert = prosca(normal, _ref); break;
+          case PLANE: invert = prosca(normal, _ref); break;
           case SPHERE:
             gr[0] = xp[0] - _ref[0];
             gr[1] = yp[0] - _ref[1];
             gr[2] = zp[0] - _ref[2];
-            _invert = prosca(gr, normal);
+            invert = prosca(gr, normal);
           case NONE:
           default: break;
           }
         }
-        if(_invert > 0.) {
+        if(invert > 0.) {
           double xpi[12], ypi[12], zpi[12], valpi[12][9];
           int epi[12];
           for(int k = 0; k < np; k++)
@@ -580,19 +580,18 @@ PView *GMSH_LevelsetPlugin::execute(PView *v)
   // Force creation of one view per time step if we have multi meshes
   if(vdata->hasMultipleMeshes()) _valueIndependent = 0;
 
-  double x[8], y[8], z[8], levels[8];
-  double scalarValues[8] = {0., 0., 0., 0., 0., 0., 0., 0.};
-
   PView *v2 = nullptr;
   if(_valueIndependent) {
     // create a single output view containing the (possibly multi-step) levelset
     int firstNonEmptyStep = vdata->getFirstNonEmptyTimeStep();
     v2 = new PView();
     PViewDataList *out = getDataList(v2);
-    for(int ent = 0; ent < vdata->getNumEntities(firstNonEmptyStep); ent++) {
-      for(int ele = 0; ele < vdata->getNumElements(firstNonEmptyStep, ent);
-          ele++) {
-        if(vdata->skipElement(firstNonEmptyStep, ent, ele)) continue;
+    forEachElement(
+      vdata, firstNonEmptyStep, out,
+      [&](int ent, int ele, PViewDataList *blockOut) {
+        if(vdata->skipElement(firstNonEmptyStep, ent, ele)) return;
+        double x[8], y[8], z[8], levels[8];
+        double scalarValues[8] = {0., 0., 0., 0., 0., 0., 0., 0.};
         for(int nod = 0; nod < vdata->getNumNodes(firstNonEmptyStep, ent, ele);
             nod++) {
           vdata->getNode(firstNonEmptyStep, ent, ele, nod, x[nod], y[nod],
@@ -600,9 +599,8 @@ PView *GMSH_LevelsetPlugin::execute(PView *v)
           levels[nod] = levelset(x[nod], y[nod], z[nod], 0.);
         }
         _cutAndAddElements(vdata, wdata, ent, ele, -1, _valueTimeStep, x, y, z,
-                           levels, scalarValues, out);
-      }
-    }
+                           levels, scalarValues, blockOut);
+      });
     out->setName(vdata->getName() + "_Levelset");
     out->setFileName(vdata->getFileName() + "_Levelset.pos");
     out->finalize();
@@ -613,9 +611,11 @@ PView *GMSH_LevelsetPlugin::execute(PView *v)
       if(!vdata->hasTimeStep(step)) continue;
       v2 = new PView();
       PViewDataList *out = getDataList(v2);
-      for(int ent = 0; ent < vdata->getNumEntities(step); ent++) {
-        for(int ele = 0; ele < vdata->getNumElements(step, ent); ele++) {
-          if(vdata->skipElement(step, ent, ele)) continue;
+      forEachElement(
+        vdata, step, out, [&](int ent, int ele, PViewDataList *blockOut) {
+          if(vdata->skipElement(step, ent, ele)) return;
+          double x[8], y[8], z[8], levels[8];
+          double scalarValues[8] = {0., 0., 0., 0., 0., 0., 0., 0.};
           for(int nod = 0; nod < vdata->getNumNodes(step, ent, ele); nod++) {
             vdata->getNode(step, ent, ele, nod, x[nod], y[nod], z[nod]);
             vdata->getScalarValue(step, ent, ele, nod, scalarValues[nod]);
@@ -623,9 +623,8 @@ PView *GMSH_LevelsetPlugin::execute(PView *v)
           }
           int wstep = (_valueTimeStep < 0) ? step : _valueTimeStep;
           _cutAndAddElements(vdata, wdata, ent, ele, step, wstep, x, y, z,
-                             levels, scalarValues, out);
-        }
-      }
+                             levels, scalarValues, blockOut);
+        });
       char tmp[246];
       sprintf(tmp, "_Levelset_%d", step);
       out->setName(vdata->getName() + tmp);
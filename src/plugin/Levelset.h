@@ -10,7 +10,6 @@
 
 class GMSH_LevelsetPlugin : public GMSH_PostPlugin {
 private:
-  double _invert;
   void _addElement(int np, int numEdges, int numComp, double xp[12],
                    double yp[12], double zp[12], double valp[12][9],
                    PViewDataList *out, bool firstStep);
@@ -248,28 +248,34 @@ PView *GMSH_ParticlesPlugin::execute(PView *v)
   double c4 =
     DT * DT * (beta + (0.5 + gamma - 2 * beta) + (0.5 - gamma + beta));
 
-  for(int i = 0; i < getNbU(); ++i) {
-    for(int j = 0; j < getNbV(); ++j) {
-      double XINIT[3], X0[3], X1[3];
-      getPoint(i, j, XINIT);
-      getPoint(i, j, X0);
-      getPoint(i, j, X1);
-      data2->NbVP++;
-      data2->VP.push_back(XINIT[0]);
-      data2->VP.push_back(XINIT[1]);
-      data2->VP.push_back(XINIT[2]);
-      for(int iter = 0; iter < maxIter; iter++) {
-        double F[3], X[3];
-        o1.searchVector(X1[0], X1[1], X1[2], F, timeStep);
-        for(int k = 0; k < 3; k++)
-          X[k] = (c2 * X1[k] + c3 * X0[k] + c4 * F[k]) / c1;
-        data2->VP.push_back(X[0] - XINIT[0]);
-        data2->VP.push_back(X[1] - XINIT[1]);
-        data2->VP.push_back(X[2] - XINIT[2]);
-        for(int k = 0; k < 3; k++) {
-          X0[k] = X1[k];
-          X1[k] = X[k];
-        }
+  // the particles are independent: integrate them concurrently, each one
+  // writing its (fixed size) trajectory at its own offset in the output list
+  int nbU = getNbU(), nbV = getNbV();
+  std::size_t stride = 3 * (1 + maxIter);
+  std::size_t offset = data2->VP.size();
+  data2->VP.resize(offset + stride * nbU * nbV);
+  data2->NbVP += nbU * nbV;
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(int n = 0; n < nbU * nbV; n++) {
+    int i = n / nbV, j = n % nbV;
+    double *VP = &data2->VP[offset + stride * n];
+    double XINIT[3], X0[3], X1[3];
+    getPoint(i, j, XINIT);
+    getPoint(i, j, X0);
+    getPoint(i, j, X1);
+    for(int k = 0; k < 3; k++) *VP++ = XINIT[k];
+    for(int iter = 0; iter < maxIter; iter++) {
+      double F[3], X[3];
+      o1.searchVector(X1[0], X1[1], X1[2], F, timeStep);
+      for(int k = 0; k < 3; k++)
+        X[k] = (c2 * X1[k] + c3 * X0[k] + c4 * F[k]) / c1;
+      for(int k = 0; k < 3; k++) *VP++ = X[k] - XINIT[k];
+      for(int k = 0; k < 3; k++) {
+        X0[k] = X1[k];
+        X1[k] = X[k];
       }
     }
   }
@@ -4,6 +4,8 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <sstream>
+#include <array>
+#include <algorithm>
 #include <stdio.h>
 #include <string.h>
 #include "GmshConfig.h"
@@ -104,6 +106,46 @@ PViewData *GMSH_PostPlugin::getPossiblyAdaptiveData(PView *view)
   return view->getData(true);
 }
 
+void GMSH_PostPlugin::forEachElement(
+  PViewData *data, int step, PViewDataList *out,
+  const std::function<void(int, int, PViewDataList *)> &kernel)
+{
+  // blocks of consecutive elements (entity, first element, last element)
+  const int blockSize = 512;
+  std::vector<std::array<int, 3> > blocks;
+  for(int ent = 0; ent < data->getNumEntities(step); ent++) {
+    int numEle = data->getNumElements(step, ent);
+    for(int ele = 0; ele < numEle; ele += blockSize)
+      blocks.push_back({ent, ele, std::min(ele + blockSize, numEle)});
+  }
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  if(nthreads == 1 || blocks.size() < 2) {
+    for(auto &b : blocks)
+      for(int ele = b[1]; ele < b[2]; ele++) kernel(b[0], ele, out);
+    return;
+  }
+
+  // process the blocks by rounds, to bound the memory used by the outputs of
+  // the blocks before they are appended to out
+  std::size_t roundSize = 8 * nthreads;
+  std::vector<PViewDataList *> outs(roundSize, nullptr);
+  for(std::size_t r = 0; r < blocks.size(); r += roundSize) {
+    int n = std::min(roundSize, blocks.size() - r);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int i = 0; i < n; i++) {
+      std::array<int, 3> &b = blocks[r + i];
+      outs[i] = new PViewDataList();
+      for(int ele = b[1]; ele < b[2]; ele++) kernel(b[0], ele, outs[i]);
+    }
+    for(int i = 0; i < n; i++) {
+      out->appendLists(*outs[i]);
+      delete outs[i];
+    }
+  }
+}
+
 PViewDataList *GMSH_PostPlugin::getDataList(PView *view, bool showError)
 {
   if(!view) return nullptr;
@@ -14,6 +14,7 @@
 //  in the executable. I think that it's a good way to start.
 
 #include <string>
+#include <functional>
 #include "Options.h"
 #include "GmshMessage.h"
 #include "PView.h"
@@ -108,6 +109,14 @@ public:
   // get the the adapted data (i.e. linear, on refined mesh) if
   // available, otherwise get the original data
   virtual PViewData *getPossiblyAdaptiveData(PView *view);
+  // apply kernel(ent, ele, out) to all the elements of data at time step
+  // step. The elements are processed concurrently by blocks, each block
+  // adding its output to its own list-based data; the outputs of the blocks
+  // are then appended to out in the order of the elements, so that the
+  // result is the same as with a serial loop, whatever the number of threads
+  void forEachElement(
+    PViewData *data, int step, PViewDataList *out,
+    const std::function<void(int ent, int ele, PViewDataList *out)> &kernel);
   virtual void assignSpecificVisibility() const {}
   virtual bool geometricalFilter(fullMatrix<double> *) const { return true; }
 };
@@ -231,31 +231,50 @@ PView *GMSH_StreamLinesPlugin::execute(PView *v)
   }
 
   OctreePost o1(v1);
-  double *val2 = nullptr;
-  OctreePost *o2 = nullptr;
-  if(data2) {
-    val2 = new double[data2->getNumTimeSteps()];
-    o2 = new OctreePost(v2);
-  }
+  OctreePost *o2 = data2 ? new OctreePost(v2) : nullptr;
+  int numSteps2 = data2 ? data2->getNumTimeSteps() : 0;
 
   PView *v3 = new PView();
   PViewDataList *data3 = getDataList(v3);
 
   const double b1 = 1. / 3., b2 = 2. / 3., b3 = 1. / 3., b4 = 1. / 6.;
   const double a1 = 0.5, a2 = 0.5, a3 = 1., a4 = 1.;
-  double XINIT[3], X[3], DX[3], X1[3], X2[3], X3[3], X4[3];
 
-  for(int i = 0; i < getNbU(); ++i) {
-    for(int j = 0; j < getNbV(); ++j) {
+  // the stream lines are independent: integrate them concurrently, each one
+  // writing its (fixed size) output at its own offset in the output lists
+  int nbU = getNbU(), nbV = getNbV();
+  std::vector<double> &out = data2 ? data3->SL : data3->VP;
+  std::size_t stride =
+    data2 ? maxIter * (6 + 2 * numSteps2) : 3 * (1 + maxIter);
+  std::size_t offset = out.size();
+  out.resize(offset + stride * nbU * nbV);
+  if(data2)
+    data3->NbSL += nbU * nbV * maxIter;
+  else
+    data3->NbVP += nbU * nbV;
+  if(timeStep < 0) {
+    double T0 = data1->getTime(0);
+    for(int n = 0; n < nbU * nbV; n++)
+      for(int iter = 0; iter < maxIter; iter++)
+        data3->Time.push_back(T0 + DT * iter);
+  }
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel num_threads(nthreads)
+  {
+    std::vector<double> val2(numSteps2);
+#pragma omp for schedule(dynamic)
+    for(int n = 0; n < nbU * nbV; n++) {
+      int i = n / nbV, j = n % nbV;
+      double *o = &out[offset + stride * n];
+      double XINIT[3], X[3], DX[3], X1[3], X2[3], X3[3], X4[3];
       getPoint(i, j, XINIT);
       getPoint(i, j, X);
 
-      if(data2) { o2->searchScalar(X[0], X[1], X[2], val2, -1); }
+      if(data2) { o2->searchScalar(X[0], X[1], X[2], val2.data(), -1); }
       else {
-        data3->NbVP++;
-        data3->VP.push_back(X[0]);
-        data3->VP.push_back(X[1]);
-        data3->VP.push_back(X[2]);
+        for(int k = 0; k < 3; k++) *o++ = X[k];
       }
 
       int currentTimeStep = 0;
@@ -266,7 +285,6 @@ PView *GMSH_StreamLinesPlugin::execute(PView *v)
         if(timeStep < 0) {
           double T0 = data1->getTime(0);
           double currentT = T0 + DT * iter;
-          data3->Time.push_back(currentT);
           for(; currentTimeStep < data1->getNumTimeSteps() - 1 &&
                 currentT > 0.5 * (data1->getTime(currentTimeStep) +
                                   data1->getTime(currentTimeStep + 1));
@@ -299,32 +317,22 @@ PView *GMSH_StreamLinesPlugin::execute(PView *v)
         for(int k = 0; k < 3; k++) DX[k] = X[k] - XINIT[k];
 
         if(data2) {
-          data3->NbSL++;
-          data3->SL.push_back(XPREV[0]);
-          data3->SL.push_back(X[0]);
-          data3->SL.push_back(XPREV[1]);
-          data3->SL.push_back(X[1]);
-          data3->SL.push_back(XPREV[2]);
-          data3->SL.push_back(X[2]);
-          for(int k = 0; k < data2->getNumTimeSteps(); k++)
-            data3->SL.push_back(val2[k]);
-          o2->searchScalar(X[0], X[1], X[2], val2, -1);
-          for(int k = 0; k < data2->getNumTimeSteps(); k++)
-            data3->SL.push_back(val2[k]);
+          for(int k = 0; k < 3; k++) {
+            *o++ = XPREV[k];
+            *o++ = X[k];
+          }
+          for(int k = 0; k < numSteps2; k++) *o++ = val2[k];
+          o2->searchScalar(X[0], X[1], X[2], val2.data(), -1);
+          for(int k = 0; k < numSteps2; k++) *o++ = val2[k];
         }
         else {
-          data3->VP.push_back(DX[0]);
-          data3->VP.push_back(DX[1]);
-          data3->VP.push_back(DX[2]);
+          for(int k = 0; k < 3; k++) *o++ = DX[k];
         }
       }
     }
   }
 
-  if(data2) {
-    delete[] val2;
-    delete o2;
-  }
+  if(o2) { delete o2; }
   else {
     v3->getOptions()->vectorType = PViewOptions::Displacement;
   }
@@ -312,109 +312,54 @@ void OctreePost::_create(PViewData *data)
                       bbmax.z() - bbmin.z()};
     const int maxElePerBucket = 100; // memory vs. speed trade-off
 
-    _sp =
-      Octree_Create(maxElePerBucket, min, size, pntBB, pntCentroid, pntInEle);
-    addListOfStuff(_sp, l->SP, 3 + 1 * l->getNumTimeSteps());
-    Octree_Arrange(_sp);
-    _vp =
-      Octree_Create(maxElePerBucket, min, size, pntBB, pntCentroid, pntInEle);
-    addListOfStuff(_vp, l->VP, 3 + 3 * l->getNumTimeSteps());
-    Octree_Arrange(_vp);
-    _tp =
-      Octree_Create(maxElePerBucket, min, size, pntBB, pntCentroid, pntInEle);
-    addListOfStuff(_tp, l->TP, 3 + 9 * l->getNumTimeSteps());
-    Octree_Arrange(_tp);
-
-    _sl =
-      Octree_Create(maxElePerBucket, min, size, linBB, linCentroid, linInEle);
-    addListOfStuff(_sl, l->SL, 6 + 2 * l->getNumTimeSteps());
-    Octree_Arrange(_sl);
-    _vl =
-      Octree_Create(maxElePerBucket, min, size, linBB, linCentroid, linInEle);
-    addListOfStuff(_vl, l->VL, 6 + 6 * l->getNumTimeSteps());
-    Octree_Arrange(_vl);
-    _tl =
-      Octree_Create(maxElePerBucket, min, size, linBB, linCentroid, linInEle);
-    addListOfStuff(_tl, l->TL, 6 + 18 * l->getNumTimeSteps());
-    Octree_Arrange(_tl);
-
-    _st =
-      Octree_Create(maxElePerBucket, min, size, triBB, triCentroid, triInEle);
-    addListOfStuff(_st, l->ST, 9 + 3 * l->getNumTimeSteps());
-    Octree_Arrange(_st);
-    _vt =
-      Octree_Create(maxElePerBucket, min, size, triBB, triCentroid, triInEle);
-    addListOfStuff(_vt, l->VT, 9 + 9 * l->getNumTimeSteps());
-    Octree_Arrange(_vt);
-    _tt =
-      Octree_Create(maxElePerBucket, min, size, triBB, triCentroid, triInEle);
-    addListOfStuff(_tt, l->TT, 9 + 27 * l->getNumTimeSteps());
-    Octree_Arrange(_tt);
-
-    _sq =
-      Octree_Create(maxElePerBucket, min, size, quaBB, quaCentroid, quaInEle);
-    addListOfStuff(_sq, l->SQ, 12 + 4 * l->getNumTimeSteps());
-    Octree_Arrange(_sq);
-    _vq =
-      Octree_Create(maxElePerBucket, min, size, quaBB, quaCentroid, quaInEle);
-    addListOfStuff(_vq, l->VQ, 12 + 12 * l->getNumTimeSteps());
-    Octree_Arrange(_vq);
-    _tq =
-      Octree_Create(maxElePerBucket, min, size, quaBB, quaCentroid, quaInEle);
-    addListOfStuff(_tq, l->TQ, 12 + 36 * l->getNumTimeSteps());
-    Octree_Arrange(_tq);
-
-    _ss =
-      Octree_Create(maxElePerBucket, min, size, tetBB, tetCentroid, tetInEle);
-    addListOfStuff(_ss, l->SS, 12 + 4 * l->getNumTimeSteps());
-    Octree_Arrange(_ss);
-    _vs =
-      Octree_Create(maxElePerBucket, min, size, tetBB, tetCentroid, tetInEle);
-    addListOfStuff(_vs, l->VS, 12 + 12 * l->getNumTimeSteps());
-    Octree_Arrange(_vs);
-    _ts =
-      Octree_Create(maxElePerBucket, min, size, tetBB, tetCentroid, tetInEle);
-    addListOfStuff(_ts, l->TS, 12 + 36 * l->getNumTimeSteps());
-    Octree_Arrange(_ts);
-
-    _sh =
-      Octree_Create(maxElePerBucket, min, size, hexBB, hexCentroid, hexInEle);
-    addListOfStuff(_sh, l->SH, 24 + 8 * l->getNumTimeSteps());
-    Octree_Arrange(_sh);
-    _vh =
-      Octree_Create(maxElePerBucket, min, size, hexBB, hexCentroid, hexInEle);
-    addListOfStuff(_vh, l->VH, 24 + 24 * l->getNumTimeSteps());
-    Octree_Arrange(_vh);
-    _th =
-      Octree_Create(maxElePerBucket, min, size, hexBB, hexCentroid, hexInEle);
-    addListOfStuff(_th, l->TH, 24 + 72 * l->getNumTimeSteps());
-    Octree_Arrange(_th);
-
-    _si =
-      Octree_Create(maxElePerBucket, min, size, priBB, priCentroid, priInEle);
-    addListOfStuff(_si, l->SI, 18 + 6 * l->getNumTimeSteps());
-    Octree_Arrange(_si);
-    _vi =
-      Octree_Create(maxElePerBucket, min, size, priBB, priCentroid, priInEle);
-    addListOfStuff(_vi, l->VI, 18 + 18 * l->getNumTimeSteps());
-    Octree_Arrange(_vi);
-    _ti =
-      Octree_Create(maxElePerBucket, min, size, priBB, priCentroid, priInEle);
-    addListOfStuff(_ti, l->TI, 18 + 54 * l->getNumTimeSteps());
-    Octree_Arrange(_ti);
-
-    _sy =
-      Octree_Create(maxElePerBucket, min, size, pyrBB, pyrCentroid, pyrInEle);
-    addListOfStuff(_sy, l->SY, 15 + 5 * l->getNumTimeSteps());
-    Octree_Arrange(_sy);
-    _vy =
-      Octree_Create(maxElePerBucket, min, size, pyrBB, pyrCentroid, pyrInEle);
-    addListOfStuff(_vy, l->VY, 15 + 15 * l->getNumTimeSteps());
-    Octree_Arrange(_vy);
-    _ty =
-      Octree_Create(maxElePerBucket, min, size, pyrBB, pyrCentroid, pyrInEle);
-    addListOfStuff(_ty, l->TY, 15 + 45 * l->getNumTimeSteps());
-    Octree_Arrange(_ty);
+    // the octrees are independent, and are thus built concurrently
+    struct octreeDef {
+      Octree **octree;
+      std::vector<double> *list;
+      int nbNod, nbComp;
+      BBFunction bb;
+      CentroidFunction centroid;
+      InEleFunction inEle;
+    };
+    octreeDef defs[] = {
+      {&_sp, &l->SP, 1, 1, pntBB, pntCentroid, pntInEle},
+      {&_vp, &l->VP, 1, 3, pntBB, pntCentroid, pntInEle},
+      {&_tp, &l->TP, 1, 9, pntBB, pntCentroid, pntInEle},
+      {&_sl, &l->SL, 2, 1, linBB, linCentroid, linInEle},
+      {&_vl, &l->VL, 2, 3, linBB, linCentroid, linInEle},
+      {&_tl, &l->TL, 2, 9, linBB, linCentroid, linInEle},
+      {&_st, &l->ST, 3, 1, triBB, triCentroid, triInEle},
+      {&_vt, &l->VT, 3, 3, triBB, triCentroid, triInEle},
+      {&_tt, &l->TT, 3, 9, triBB, triCentroid, triInEle},
+      {&_sq, &l->SQ, 4, 1, quaBB, quaCentroid, quaInEle},
+      {&_vq, &l->VQ, 4, 3, quaBB, quaCentroid, quaInEle},
+      {&_tq, &l->TQ, 4, 9, quaBB, quaCentroid, quaInEle},
+      {&_ss, &l->SS, 4, 1, tetBB, tetCentroid, tetInEle},
+      {&_vs, &l->VS, 4, 3, tetBB, tetCentroid, tetInEle},
+      {&_ts, &l->TS, 4, 9, tetBB, tetCentroid, tetInEle},
+      {&_sh, &l->SH, 8, 1, hexBB, hexCentroid, hexInEle},
+      {&_vh, &l->VH, 8, 3, hexBB, hexCentroid, hexInEle},
+      {&_th, &l->TH, 8, 9, hexBB, hexCentroid, hexInEle},
+      {&_si, &l->SI, 6, 1, priBB, priCentroid, priInEle},
+      {&_vi, &l->VI, 6, 3, priBB, priCentroid, priInEle},
+      {&_ti, &l->TI, 6, 9, priBB, priCentroid, priInEle},
+      {&_sy, &l->SY, 5, 1, pyrBB, pyrCentroid, pyrInEle},
+      {&_vy, &l->VY, 5, 3, pyrBB, pyrCentroid, pyrInEle},
+      {&_ty, &l->TY, 5, 9, pyrBB, pyrCentroid, pyrInEle}};
+    const int numDefs = sizeof(defs) / sizeof(defs[0]);
+    const int numSteps = l->getNumTimeSteps();
+
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int i = 0; i < numDefs; i++) {
+      const octreeDef &d = defs[i];
+      *d.octree = Octree_Create(maxElePerBucket, min, size, d.bb, d.centroid,
+                                d.inEle);
+      addListOfStuff(*d.octree, *d.list,
+                     3 * d.nbNod + d.nbNod * d.nbComp * numSteps);
+      Octree_Arrange(*d.octree);
+    }
   }
 }
 
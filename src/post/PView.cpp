@@ -30,9 +30,12 @@ void PView::_init(int tag)
   }
 
   _changed = true;
+  _onlyStepChanged = false;
   _aliasOf = -1;
   _eye = SPoint3(0., 0., 0.);
   va_points = va_lines = va_triangles = va_vectors = va_ellipses = nullptr;
+  _numTaggedElements = 0;
+  _numTaggedNodes = 0;
   normals = nullptr;
 
   for(std::size_t i = 0; i < list.size(); i++) {
@@ -219,6 +222,8 @@ void PView::deleteVertexArrays()
   va_vectors = nullptr;
   if(va_ellipses) delete va_ellipses;
   va_ellipses = nullptr;
+  _numTaggedElements = 0;
+  _numTaggedNodes = 0;
 }
 
 void PView::setOptions(PViewOptions *val)
@@ -241,11 +246,19 @@ PViewData *PView::getData(bool useAdaptiveIfAvailable)
 void PView::setChanged(bool val)
 {
   _changed = val;
+  _onlyStepChanged = false;
   // reset the eye position everytime we change the view so that the
   // arrays get resorted for transparency
   if(_changed) _eye = SPoint3(0., 0., 0.);
 }
 
+void PView::setStepChanged()
+{
+  // the geometry is unchanged, so that there is no need to resort the arrays
+  if(!_changed) _onlyStepChanged = true;
+  _changed = true;
+}
+
 void PView::combine(bool time, int how, bool remove, bool copyOptions)
 {
   // time == true: combine the timesteps (oherwise combine the elements)
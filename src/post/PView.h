@@ -33,10 +33,17 @@ private:
   int _index;
   // flag to mark that the view has changed1
   bool _changed;
+  // flag to mark that only the time step has changed since the vertex arrays
+  // were filled
+  bool _onlyStepChanged;
   // tag of the source view if this view is an alias, -1 otherwise
   int _aliasOf;
   // eye position (for transparency sorting)
   SPoint3 _eye;
+  // number of elements with data (and of their nodes) when the vertex arrays
+  // were filled, if their vertices are tagged with the data they are created
+  // from (0 otherwise)
+  std::size_t _numTaggedElements, _numTaggedNodes;
   // the options
   PViewOptions *_options;
   // the data
@@ -96,6 +103,11 @@ public:
   bool &getChanged() { return _changed; }
   void setChanged(bool val);
 
+  // mark the view as changed because its time step has changed (if nothing
+  // else changed, the vertex arrays can then be updated incrementally)
+  void setStepChanged();
+  bool getOnlyStepChanged() { return _changed && _onlyStepChanged; }
+
   // check if the view is an alias ("light copy") of another view
   int getAliasOf() { return _aliasOf; }
 
@@ -156,6 +168,15 @@ public:
 
   // vertex arrays to draw the elements efficiently
   VertexArray *va_points, *va_lines, *va_triangles, *va_vectors, *va_ellipses;
+  // tagged vertex arrays allow to only update their colors when the time step
+  // changes
+  std::size_t getNumTaggedElements() { return _numTaggedElements; }
+  std::size_t getNumTaggedNodes() { return _numTaggedNodes; }
+  void setNumTagged(std::size_t numElements, std::size_t numNodes)
+  {
+    _numTaggedElements = numElements;
+    _numTaggedNodes = numNodes;
+  }
 
   // fill the vertex arrays, given the current option and data
   bool fillVertexArrays();
@@ -9,6 +9,7 @@
 #include "GmshMessage.h"
 #include "OctreePost.h"
 #include "fullMatrix.h"
+#include "Context.h"
 
 std::map<std::string, interpolationMatrices> PViewData::_interpolationSchemes;
 
@@ -23,8 +24,8 @@ PViewData::~PViewData()
   if(_adaptive) delete _adaptive;
   for(auto it = _interpolation.begin(); it != _interpolation.end(); it++)
     for(std::size_t i = 0; i < it->second.size(); i++) delete it->second[i];
-  if(_octree) delete _octree;
-  if(_kdtree) delete _kdtree;
+  if(_octree) delete _octree.load();
+  if(_kdtree) delete _kdtree.load();
 }
 
 bool PViewData::finalize(bool computeMinMax,
@@ -245,6 +246,53 @@ bool PViewData::combineSpace(nameData &nd)
   return false;
 }
 
+OctreePost *PViewData::_getOctree()
+{
+  OctreePost *octree = _octree.load(std::memory_order_acquire);
+  if(octree) return octree;
+#pragma omp critical(PViewDataSearchTree)
+  {
+    octree = _octree.load(std::memory_order_relaxed);
+    if(!octree) {
+      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
+      octree = new OctreePost(this);
+      _octree.store(octree, std::memory_order_release);
+    }
+  }
+  return octree;
+}
+
+SPoint3KDTree *PViewData::_getKDTree(int step)
+{
+  SPoint3KDTree *kdtree = _kdtree.load(std::memory_order_acquire);
+  if(kdtree) return kdtree;
+#pragma omp critical(PViewDataSearchTree)
+  {
+    kdtree = _kdtree.load(std::memory_order_relaxed);
+    if(!kdtree) {
+      Msg::Debug("Rebuilding kdtree for view data '%s'", _name.c_str());
+      _pc.pts.clear();
+      // FIXME: should directly iterate on mesh nodes for model-based views
+      if(step < 0) step = getFirstNonEmptyTimeStep();
+      for(int ent = 0; ent < getNumEntities(step); ent++) {
+        for(int ele = 0; ele < getNumElements(step, ent); ele++) {
+          int numNodes = getNumNodes(step, ent, ele);
+          for(int nod = 0; nod < numNodes; nod++) {
+            double xx, yy, zz;
+            getNode(step, ent, ele, nod, xx, yy, zz);
+            _pc.pts.push_back(SPoint3(xx, yy, zz));
+          }
+        }
+      }
+      kdtree = new SPoint3KDTree(3, _pc2kdtree,
+                                 nanoflann::KDTreeSingleIndexAdaptorParams(10));
+      kdtree->buildIndex();
+      _kdtree.store(kdtree, std::memory_order_release);
+    }
+  }
+  return kdtree;
+}
+
 double PViewData::findClosestNode(double &xn, double &yn, double &zn, int step)
 {
   double x = xn, y = yn, z = zn;
@@ -279,33 +327,13 @@ double PViewData::findClosestNode(double &xn, double &yn, double &zn, int step)
 
 #else
 
-#pragma omp critical(PViewDataFindClosestNode)
-  if(!_kdtree) {
-    Msg::Debug("Rebuilding kdtree for view data '%s'", _name.c_str());
-    _pc.pts.clear();
-    // FIXME: should directly iterate on mesh nodes for model-based views
-    if(step < 0) step = getFirstNonEmptyTimeStep();
-    for(int ent = 0; ent < getNumEntities(step); ent++) {
-      for(int ele = 0; ele < getNumElements(step, ent); ele++) {
-        int numNodes = getNumNodes(step, ent, ele);
-        for(int nod = 0; nod < numNodes; nod++) {
-          double xx, yy, zz;
-          getNode(step, ent, ele, nod, xx, yy, zz);
-          _pc.pts.push_back(SPoint3(xx, yy, zz));
-        }
-      }
-    }
-    _kdtree = new SPoint3KDTree(3, _pc2kdtree,
-                                nanoflann::KDTreeSingleIndexAdaptorParams(10));
-    _kdtree->buildIndex();
-  }
-
+  SPoint3KDTree *kdtree = _getKDTree(step);
   double query_pt[3] = {x, y, z};
   std::size_t idx;
   double squ_dist = 0.;
   nanoflann::KNNResultSet<double> resultSet(1);
   resultSet.init(&idx, &squ_dist);
-  _kdtree->findNeighbors(resultSet, &query_pt[0], nanoflann::SearchParams(10));
+  kdtree->findNeighbors(resultSet, &query_pt[0], nanoflann::SearchParams(10));
   if(idx < _pc.pts.size()) {
     xn = _pc.pts[idx].x();
     yn = _pc.pts[idx].y();
@@ -323,15 +351,7 @@ bool PViewData::searchScalar(double x, double y, double z, double *values,
                              int step, double *size, int qn, double *qx,
                              double *qy, double *qz, bool grad, int dim)
 {
-  if(!_octree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
-      _octree = new OctreePost(this);
-    }
-  }
-  return _octree->searchScalar(x, y, z, values, step, size, qn, qx, qy, qz,
+  return _getOctree()->searchScalar(x, y, z, values, step, size, qn, qx, qy, qz,
                                grad, dim);
 }
 
@@ -363,15 +383,7 @@ bool PViewData::searchVector(double x, double y, double z, double *values,
                              int step, double *size, int qn, double *qx,
                              double *qy, double *qz, bool grad, int dim)
 {
-  if(!_octree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
-      _octree = new OctreePost(this);
-    }
-  }
-  return _octree->searchVector(x, y, z, values, step, size, qn, qx, qy, qz,
+  return _getOctree()->searchVector(x, y, z, values, step, size, qn, qx, qy, qz,
                                grad, dim);
 }
 
@@ -403,15 +415,7 @@ bool PViewData::searchTensor(double x, double y, double z, double *values,
                              int step, double *size, int qn, double *qx,
                              double *qy, double *qz, bool grad, int dim)
 {
-  if(!_octree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
-      _octree = new OctreePost(this);
-    }
-  }
-  return _octree->searchTensor(x, y, z, values, step, size, qn, qx, qy, qz,
+  return _getOctree()->searchTensor(x, y, z, values, step, size, qn, qx, qy, qz,
                                grad, dim);
 }
 
@@ -438,3 +442,51 @@ bool PViewData::searchTensorClosest(double x, double y, double z,
   }
   return ret;
 }
+
+void PViewData::searchClosest(const std::vector<double> &xyz, int numComp,
+                              std::vector<double> &values,
+                              std::vector<double> &distances, int step,
+                              bool grad, double distanceMax, int dim)
+{
+  int numSteps = (step < 0) ? getNumTimeSteps() : 1;
+  std::size_t numVal = numComp * (grad ? 3 : 1) * numSteps;
+  std::size_t numPoints = xyz.size() / 3;
+  values.assign(numPoints * numVal, 0.);
+  distances.assign(numPoints, -1.);
+  if(!numPoints) return;
+
+  // create the search trees before searching concurrently
+  _getOctree();
+  if(distanceMax) _getKDTree(step);
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel num_threads(nthreads)
+  {
+    // the search functions use the values of all the time steps as workspace
+    std::vector<double> val(9 * 3 * getNumTimeSteps());
+#pragma omp for schedule(dynamic, 100)
+    for(std::size_t i = 0; i < numPoints; i++) {
+      double x = xyz[3 * i], y = xyz[3 * i + 1], z = xyz[3 * i + 2];
+      double distance = distanceMax;
+      bool found = false;
+      switch(numComp) {
+      case 1:
+        found = searchScalarClosest(x, y, z, distance, &val[0], step, nullptr,
+                                    0, nullptr, nullptr, nullptr, grad, dim);
+        break;
+      case 3:
+        found = searchVectorClosest(x, y, z, distance, &val[0], step, nullptr,
+                                    0, nullptr, nullptr, nullptr, grad, dim);
+        break;
+      case 9:
+        found = searchTensorClosest(x, y, z, distance, &val[0], step, nullptr,
+                                    0, nullptr, nullptr, nullptr, grad, dim);
+        break;
+      }
+      distances[i] = found ? distance : -1.;
+      if(found)
+        for(std::size_t j = 0; j < numVal; j++) values[numVal * i + j] = val[j];
+    }
+  }
+}
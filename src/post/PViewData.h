@@ -10,6 +10,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <atomic>
 #include "SBoundingBox3d.h"
 #include "SPoint3KDTree.h"
 
@@ -38,11 +39,15 @@ private:
   // index of the view in the file
   int _fileIndex;
   // octree for rapid search
-  OctreePost *_octree;
+  std::atomic<OctreePost *> _octree;
   // kdtree for rapid search of neighrest neighbor
   SPoint3Cloud _pc;
   SPoint3CloudAdaptor<SPoint3Cloud> _pc2kdtree;
-  SPoint3KDTree *_kdtree;
+  std::atomic<SPoint3KDTree *> _kdtree;
+  // get the search trees, creating them if necessary (the creation is
+  // thread-safe, so that searches can be performed concurrently)
+  OctreePost *_getOctree();
+  SPoint3KDTree *_getKDTree(int step);
 
 protected:
   // adaptive visualization data
@@ -296,8 +301,7 @@ public:
   // get MElement (if view supports it)
   virtual MElement *getElement(int step, int entity, int element);
 
-  // find coordinates of closest node to point (xn, yn, zn); currently performs
-  // a simple linear search - we might want to use a kdtree instead
+  // find coordinates of closest node to point (xn, yn, zn), using a kdtree
   double findClosestNode(double &xn, double &yn, double &zn, int step);
 
   // search for the value of the View at point x, y, z. Values are interpolated
@@ -338,6 +342,18 @@ public:
                            double *qy = nullptr, double *qz = nullptr,
                            bool grad = false, int dim = -1);
 
+  // search for the values with numComp components (1, 3 or 9) at the points
+  // xyz (given by their x, y and z coordinates), concurrently. The values at
+  // each point are stored contiguously in values (numComp * (grad ? 3 : 1) *
+  // (step < 0 ? getNumTimeSteps() : 1) per point, set to 0 if no match was
+  // found); distances contains the distance of the match for each point, as
+  // returned by the search*Closest functions with distance == distanceMax
+  void searchClosest(const std::vector<double> &xyz, int numComp,
+                     std::vector<double> &values,
+                     std::vector<double> &distances, int step = -1,
+                     bool grad = false, double distanceMax = 0.,
+                     int dim = -1);
+
   // I/O routines
   virtual bool writeSTL(const std::string &fileName);
   virtual bool writeTXT(const std::string &fileName);
@@ -17,6 +17,50 @@
 #include "Numeric.h"
 #include "GmshMessage.h"
 #include "pyramidalBasis.h"
+#include "Context.h"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+std::atomic<unsigned long> pagedStepData::_clock(0);
+
+// the steps whose values are currently loaded and can be released
+static std::set<pagedStepData *> loadedSteps;
+
+void pagedStepData::_pagedIn()
+{
+  _lastUse.store(_clock.fetch_add(1) + 1);
+  loadedSteps.insert(this);
+
+  // other threads might be reading the values of loaded steps without lock:
+  // memory is only released outside of parallel regions
+#if defined(_OPENMP)
+  if(omp_in_parallel()) return;
+#endif
+
+  double limit = CTX::instance()->post.outOfCoreMemoryLimit;
+  if(limit <= 0.) return;
+  std::size_t maxBytes = (std::size_t)(limit * 1024. * 1024.);
+  std::size_t bytes = 0;
+  std::vector<std::pair<unsigned long, pagedStepData *> > candidates;
+  for(auto s : loadedSteps) {
+    bytes += s->getMemoryInBytes();
+    if(s != this) candidates.push_back(std::make_pair(s->_lastUse.load(), s));
+  }
+  if(bytes <= maxBytes) return;
+  std::sort(candidates.begin(), candidates.end());
+  for(std::size_t i = 0; i < candidates.size() && bytes > maxBytes; i++) {
+    pagedStepData *s = candidates[i].second;
+    bytes -= std::min(bytes, s->getMemoryInBytes());
+    s->pageOut();
+    loadedSteps.erase(s);
+  }
+  Msg::Debug("Out-of-core post-processing data: %zu steps loaded (%g Mb)",
+             loadedSteps.size(), (double)bytes / 1024. / 1024.);
+}
+
+void pagedStepData::_unregister() { loadedSteps.erase(this); }
 
 PViewDataGModel::PViewDataGModel(DataType type)
   : PViewData(), _min(VAL_INF), _max(-VAL_INF), _type(type)
@@ -254,11 +298,8 @@ bool PViewDataGModel::finalize(bool computeMinMax,
 
 MElement *PViewDataGModel::_getElement(int step, int ent, int ele)
 {
-  static int lastStep = -1, lastEnt = -1, lastEle = -1;
-  static MElement *curr = nullptr;
-  if(step != lastStep || ent != lastEnt || ele != lastEle)
-    curr = _steps[step]->getEntity(ent)->getMeshElement(ele);
-  return curr;
+  // no (static) cache here, so that the data can be accessed concurrently
+  return _steps[step]->getEntity(ent)->getMeshElement(ele);
 }
 
 std::string PViewDataGModel::getFileName(int step)
@@ -668,6 +709,7 @@ void PViewDataGModel::setValue(int step, int ent, int ele, int nod, int comp,
                                double val)
 {
   MElement *e = _getElement(step, ent, ele);
+  _steps[step]->pinData();
   switch(_type) {
   case NodeData: {
     int num = _getNode(e, nod)->getNum();
@@ -9,8 +9,59 @@
 #include "PViewData.h"
 #include "GModel.h"
 #include "SBoundingBox3d.h"
+#include <atomic>
+#include <functional>
 
-template <class Real> class stepData {
+// Out-of-core storage of time steps: the values of a step that were read from
+// one or more blocks in files can be released from memory when the total size
+// of the loaded steps exceeds PostProcessing.OutOfCoreMemoryLimit (the least
+// recently used steps being released first), and are transparently read again
+// when they are accessed. Inside OpenMP parallel regions, steps can be read
+// concurrently without locking: values are then never released before the end
+// of the region.
+class pagedStepData {
+public:
+  // the location of a block of values in a file
+  struct dataBlock {
+    std::string fileName;
+    long long offset;
+    bool binary, swap, withMult;
+    int numEnt;
+  };
+  virtual ~pagedStepData() {}
+  // release the values from memory (they will be read again on demand)
+  virtual void pageOut() = 0;
+  virtual std::size_t getMemoryInBytes() = 0;
+  // read the 'numEnt' records of a block of values with 'numComp' components,
+  // either from the current position in 'fp' or, if 'fp' is null, from the
+  // location given in 'b'; 'fn' is called with the index, the multiplicity
+  // and the values of each record
+  static bool readDataBlock(FILE *fp, const dataBlock &b, int numComp,
+                            const std::function<void(int, int, const double *)>
+                              &fn);
+  // the current position in a file, to be stored in a dataBlock
+  static long long tell(FILE *fp);
+
+protected:
+  // the value of the usage clock when the step was last accessed
+  std::atomic<unsigned long> _lastUse;
+  pagedStepData() : _lastUse(0) {}
+  // the following are called inside "omp critical(stepDataPaging)":
+  // register the step as loaded and, outside of parallel regions, release the
+  // least recently used other steps if the memory limit is exceeded
+  void _pagedIn();
+  // unregister the step (when its data is destroyed)
+  void _unregister();
+  static std::atomic<unsigned long> _clock;
+  inline void _touch()
+  {
+    unsigned long c = _clock.load(std::memory_order_relaxed);
+    if(_lastUse.load(std::memory_order_relaxed) != c)
+      _lastUse.store(c, std::memory_order_relaxed);
+  }
+};
+
+template <class Real> class stepData : public pagedStepData {
 private:
   // a pointer to the underlying model
   GModel *_model;
@@ -27,18 +78,17 @@ private:
   // the number of components in the data (one stepData contains only
   // a single field type)
   int _numComp;
-  // the values, indexed by MVertex or MElement id numbers (If the
-  // numbering is sparse, or if we only have data for high-id
-  // entities, the vector has zero entries and is thus not
-  // optimal. This is the price to pay if we want 1) rapid access to
-  // the data and 2) not to store any additional info in MVertex or
-  // MElement)
-  //
-  // FIXME: we should change this design and store a vector<int> of tags, and do
-  // indirect addressing, even if it's a bit slower...
-  std::vector<Real *> *_data;
+  // the values, indexed by MVertex or MElement id numbers: the values
+  // associated with index i are stored contiguously in _values, starting at
+  // _offsets[i] (or _offsets[i] == _noData if there is no data for index
+  // i). If the numbering is sparse, the offset table has unused entries; this
+  // is the price to pay if we want 1) rapid access to the data and 2) not to
+  // store any additional info in MVertex or MElement.
+  std::vector<std::size_t> _offsets;
+  std::vector<Real> _values;
+  static const std::size_t _noData = (std::size_t)-1;
   // a vector containing the multiplying factor allowing to compute
-  // the number of values stored in _data for each index (number of
+  // the number of values stored for each index (number of
   // values = getMult() * getNumComponents()). If _mult is empty, a
   // default value of "1" is assumed
   std::vector<int> _mult;
@@ -47,17 +97,69 @@ private:
   std::vector<std::vector<double> > _gaussPoints;
   // a set of all "partitions" encountered in the data
   std::set<int> _partitions;
+  // the blocks in files the values were read from: if not empty, the values
+  // can be released from memory and read again on demand
+  std::vector<dataBlock> _blocks;
+  // are the values currently released from memory?
+  std::atomic<bool> _pagedOut;
+  // were the values modified in memory (they cannot be released anymore)?
+  bool _pinned;
+  inline void _ensureLoaded()
+  {
+    if(_blocks.empty()) return;
+    if(_pagedOut.load(std::memory_order_acquire))
+      _pageIn();
+    else
+      _touch();
+  }
+  void _pageIn()
+  {
+#pragma omp critical(stepDataPaging)
+    {
+      if(_pagedOut.load(std::memory_order_relaxed)) {
+        for(auto &b : _blocks) {
+          if(!readDataBlock(nullptr, b, _numComp,
+                            [this](int num, int mult, const double *val) {
+                              Real *d = _allocData(num, mult);
+                              for(int j = 0; j < _numComp * mult; j++)
+                                d[j] = (Real)val[j];
+                            }))
+            Msg::Error("Could not read data of step at time %g from '%s'",
+                       _time, b.fileName.c_str());
+        }
+        _pagedOut.store(false, std::memory_order_release);
+        _pagedIn();
+      }
+    }
+  }
+  Real *_allocData(int index, int mult)
+  {
+    if(index >= (int)_offsets.size()) resizeData(index + 100); // optimize this
+    if(_offsets[index] == _noData) {
+      _offsets[index] = _values.size();
+      _values.resize(_values.size() + _numComp * mult, 0.);
+    }
+    if(mult > 1) {
+      if(index >= (int)_mult.size())
+        _mult.resize(index + 100, 1); // optimize this
+      _mult[index] = mult;
+    }
+    return &_values[_offsets[index]];
+  }
 
 public:
   stepData(GModel *model, int numComp, const std::string &fileName = "",
            int fileIndex = -1, double time = 0., double min = VAL_INF,
            double max = -VAL_INF)
     : _model(model), _fileName(fileName), _fileIndex(fileIndex), _time(time),
-      _min(min), _max(max), _numComp(numComp), _data(0)
+      _min(min), _max(max), _numComp(numComp), _pagedOut(false),
+      _pinned(false)
   {
   }
-  stepData(stepData<Real> &other) : _data(0)
+  // the copy is always stored in memory
+  stepData(stepData<Real> &other) : _pagedOut(false), _pinned(true)
   {
+    other._ensureLoaded();
     _model = other._model;
     _entities = other._entities;
     _bbox = other._bbox;
@@ -67,18 +169,8 @@ public:
     _min = other._min;
     _max = other._max;
     _numComp = other._numComp;
-    if(other._data) {
-      std::size_t n = other.getNumData();
-      _data = new std::vector<Real *>(n, (Real *)0);
-      for(std::size_t i = 0; i < n; i++) {
-        Real *d = other.getData(i);
-        if(d) {
-          int m = other.getMult(i) * _numComp;
-          (*_data)[i] = new Real[m];
-          for(int j = 0; j < m; j++) (*_data)[i][j] = d[j];
-        }
-      }
-    }
+    _offsets = other._offsets;
+    _values = other._values;
     _mult = other._mult;
     _gaussPoints = other._gaussPoints;
     _partitions = other._partitions;
@@ -108,56 +200,113 @@ public:
   void setMax(double max) { _max = max; }
   std::size_t getNumData()
   {
-    if(!_data) return 0;
-    return _data->size();
+    _ensureLoaded();
+    return _offsets.size();
   }
   void resizeData(int n)
   {
-    if(!_data) _data = new std::vector<Real *>(n, (Real *)0);
-    if(n > (int)_data->size()) _data->resize(n, (Real *)0);
+    if(n > (int)_offsets.size()) _offsets.resize(n, _noData);
+  }
+  // reserve storage for n additional values (e.g. before reading a block of
+  // data), to avoid repeated reallocations of the value storage
+  void reserveValues(std::size_t n)
+  {
+    std::size_t needed = _values.size() + n;
+    if(needed > _values.capacity())
+      _values.reserve(std::max(needed, 2 * _values.capacity()));
   }
+  // pointer to the values associated with index; the pointer is invalidated
+  // by the next call with allocIfNeeded set and, outside of parallel regions,
+  // by the access to another step (which can release this one)
   Real *getData(int index, bool allocIfNeeded = false, int mult = 1)
   {
     if(index < 0) return 0;
+    _ensureLoaded();
     if(allocIfNeeded) {
-      if(index >= (int)getNumData()) resizeData(index + 100); // optimize this
-      if(!(*_data)[index]) {
-        (*_data)[index] = new Real[_numComp * mult];
-        for(int i = 0; i < _numComp * mult; i++) (*_data)[index][i] = 0.;
-      }
-      if(mult > 1) {
-        if(index >= (int)_mult.size())
-          _mult.resize(index + 100, 1); // optimize this
-        _mult[index] = mult;
-      }
+      pinData();
+      return _allocData(index, mult);
+    }
+    if(index >= (int)_offsets.size() || _offsets[index] == _noData) return 0;
+    return &_values[_offsets[index]];
+  }
+  // read a block of values from a file (see pagedStepData::readDataBlock),
+  // and remember its location so that the values can be released from memory
+  // and read again on demand; 'fn' is called with the index, the
+  // multiplicity and the stored values of each record
+  bool readBlock(FILE *fp, const dataBlock &b,
+                 const std::function<void(int, int, Real *)> &fn)
+  {
+    _ensureLoaded();
+    // only steps whose values all come from files can be released
+    if(_blocks.empty() && !_values.empty()) pinData();
+    bool ok = readDataBlock(fp, b, _numComp,
+                            [this, &fn](int num, int mult, const double *val) {
+                              Real *d = _allocData(num, mult);
+                              for(int j = 0; j < _numComp * mult; j++)
+                                d[j] = (Real)val[j];
+                              if(fn) fn(num, mult, d);
+                            });
+    if(!ok) pinData();
+    if(_pinned) return ok;
+#pragma omp critical(stepDataPaging)
+    {
+      _blocks.push_back(b);
+      _pagedIn();
     }
-    else {
-      if(index >= (int)getNumData()) return 0;
+    return ok;
+  }
+  // the values are (or will be) modified in memory: they cannot be released
+  // anymore
+  void pinData()
+  {
+    if(_pinned) return;
+    _pinned = true;
+    if(_blocks.empty()) return;
+    _ensureLoaded();
+#pragma omp critical(stepDataPaging)
+    {
+      _unregister();
+      _blocks.clear();
     }
-    return (*_data)[index];
+  }
+  void pageOut()
+  {
+    _pagedOut.store(true, std::memory_order_release);
+    std::vector<std::size_t>().swap(_offsets);
+    std::vector<Real>().swap(_values);
+  }
+  std::size_t getMemoryInBytes()
+  {
+    return _values.size() * sizeof(Real) + _offsets.size() * sizeof(std::size_t);
   }
   void destroyData()
   {
-    if(_data) {
-      for(unsigned int i = 0; i < _data->size(); i++)
-        if((*_data)[i]) delete[](*_data)[i];
-      delete _data;
-      _data = 0;
+    if(!_blocks.empty()) {
+#pragma omp critical(stepDataPaging)
+      {
+        _unregister();
+        _blocks.clear();
+      }
     }
+    _pagedOut.store(false, std::memory_order_release);
+    _pinned = false;
+    std::vector<std::size_t>().swap(_offsets);
+    std::vector<Real>().swap(_values);
   }
   void renumberData(const std::map<std::size_t, std::size_t> &mapping)
   {
-    if(!_data) return;
+    pinData();
+    if(_offsets.empty()) return;
     std::size_t imax = 0, imin = 0;
     for(auto m : mapping) {
       imax = std::max(imax, m.second);
       imin = std::min(imin, m.second);
     }
-    std::vector<Real *> data2(imax + 1, nullptr);
+    std::vector<std::size_t> offsets2(imax + 1, _noData);
     std::vector<int> mult2(imax + 1, 1);
     for(auto m : mapping) {
-      if(m.first < _data->size()) {
-        data2[m.second] = (*_data)[m.first];
+      if(m.first < _offsets.size()) {
+        offsets2[m.second] = _offsets[m.first];
       }
       else {
         Msg::Warning("Wrong source index %zu in step data renumbering", m.first);
@@ -166,7 +315,7 @@ public:
       if(m.first < _mult.size())
         mult2[m.second] = _mult[m.first];
     }
-    *_data = data2;
+    _offsets.swap(offsets2);
     _mult = mult2;
   }
   std::vector<double> &getGaussPoints(int msh)
@@ -177,12 +326,12 @@ public:
   std::set<int> &getPartitions() { return _partitions; }
   double getMemoryInMb()
   {
-    double b = 0.;
-    for(std::size_t i = 0; i < getNumData(); i++) b += getMult(i);
-    return b * getNumComponents() * sizeof(Real) / 1024. / 1024.;
+    return (double)getMemoryInBytes() / 1024. / 1024.;
   }
 };
 
+template <class Real> const std::size_t stepData<Real>::_noData;
+
 // The data container using elements from one or more GModel(s).
 class PViewDataGModel : public PViewData {
 public:
@@ -195,13 +344,14 @@ public:
   };
 
 private:
-  // the data, indexed by time step
+  // the data, indexed by time step (always stored in double precision, as
+  // the readers, the plugins and the API access the values through double
+  // pointers)
   std::vector<stepData<double> *> _steps;
   // the global min/max of the view
   double _min, _max;
   // the type of the dataset
   DataType _type;
-  // cache last element to speed up loops
   MElement *_getElement(int step, int ent, int ele);
   MVertex *_getNode(MElement *e, int nod);
 
@@ -36,6 +36,11 @@ bool PViewDataGModel::addData(GModel *model,
                                      model->getNumMeshElements();
   _steps[step]->resizeData(numEnt);
 
+  std::size_t numValues = 0;
+  for(auto it = data.begin(); it != data.end(); it++)
+    numValues += it->second.size();
+  _steps[step]->reserveValues(numValues);
+
   for(auto it = data.begin(); it != data.end(); it++) {
     int mult = it->second.size() / numComp;
     double *d = _steps[step]->getData(it->first, true, mult);
@@ -74,6 +79,10 @@ bool PViewDataGModel::addData(GModel *model,
                                      model->getNumMeshElements();
   _steps[step]->resizeData(numEnt);
 
+  std::size_t numValues = 0;
+  for(std::size_t i = 0; i < data.size(); i++) numValues += data[i].size();
+  _steps[step]->reserveValues(numValues);
+
   for(std::size_t i = 0; i < data.size(); i++) {
     int mult = data[i].size() / numComp;
     double *d = _steps[step]->getData(tags[i], true, mult);
@@ -112,6 +121,7 @@ bool PViewDataGModel::addData(GModel *model,
   int numEnt = (_type == NodeData) ? model->getNumMeshVertices() :
                                      model->getNumMeshElements();
   _steps[step]->resizeData(numEnt);
+  _steps[step]->reserveValues(data.size());
 
   int mult = stride / numComp;
   for(std::size_t i = 0; i < tags.size(); i++) {
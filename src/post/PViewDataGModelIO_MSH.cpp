@@ -11,6 +11,77 @@
 #include "StringUtils.h"
 #include "OS.h"
 
+long long pagedStepData::tell(FILE *fp)
+{
+#if defined(_MSC_VER)
+  return _ftelli64(fp);
+#else
+  return ftello(fp);
+#endif
+}
+
+static bool readBlockRecords(FILE *fp, const pagedStepData::dataBlock &b,
+                             int numComp,
+                             const std::function<void(int, int, const double *)>
+                               &fn)
+{
+  std::vector<double> d;
+  for(int i = 0; i < b.numEnt; i++) {
+    int num;
+    if(b.binary) {
+      if(fread(&num, sizeof(int), 1, fp) != 1) return false;
+      if(b.swap) SwapBytes((char *)&num, sizeof(int), 1);
+    }
+    else {
+      if(fscanf(fp, "%d", &num) != 1) return false;
+    }
+    if(num < 0) return false;
+    int mult = 1;
+    if(b.withMult) {
+      if(b.binary) {
+        if(fread(&mult, sizeof(int), 1, fp) != 1) return false;
+        if(b.swap) SwapBytes((char *)&mult, sizeof(int), 1);
+      }
+      else {
+        if(fscanf(fp, "%d", &mult) != 1) return false;
+      }
+    }
+    int n = numComp * mult;
+    if((int)d.size() < n) d.resize(n);
+    if(b.binary) {
+      if((int)fread(&d[0], sizeof(double), n, fp) != n) return false;
+      if(b.swap) SwapBytes((char *)&d[0], sizeof(double), n);
+    }
+    else {
+      for(int j = 0; j < n; j++)
+        if(fscanf(fp, "%lf", &d[j]) != 1) return false;
+    }
+    fn(num, mult, &d[0]);
+  }
+  return true;
+}
+
+bool pagedStepData::readDataBlock(
+  FILE *fp, const dataBlock &b, int numComp,
+  const std::function<void(int, int, const double *)> &fn)
+{
+  if(fp) return readBlockRecords(fp, b, numComp, fn);
+
+  FILE *f = Fopen(b.fileName.c_str(), "rb");
+  if(!f) {
+    Msg::Error("Unable to open file '%s'", b.fileName.c_str());
+    return false;
+  }
+#if defined(_MSC_VER)
+  bool ok = !_fseeki64(f, b.offset, SEEK_SET);
+#else
+  bool ok = !fseeko(f, b.offset, SEEK_SET);
+#endif
+  if(ok) ok = readBlockRecords(f, b, numComp, fn);
+  fclose(f);
+  return ok;
+}
+
 bool PViewDataGModel::readMSH(const std::string &viewName,
                               const std::string &fileName, int fileIndex,
                               FILE *fp, bool binary, bool swap, int step,
@@ -38,52 +109,38 @@ bool PViewDataGModel::readMSH(const std::string &viewName,
   */
 
   _steps[step]->resizeData(numEnt);
+  _steps[step]->reserveValues((std::size_t)numEnt * numComp);
+
+  pagedStepData::dataBlock block;
+  block.fileName = fileName;
+  block.offset = pagedStepData::tell(fp);
+  block.binary = binary;
+  block.swap = swap;
+  block.withMult = (_type == ElementNodeData || _type == GaussPointData);
+  block.numEnt = numEnt;
 
   Msg::StartProgressMeter(numEnt);
-  for(int i = 0; i < numEnt; i++) {
-    int num;
-    if(binary) {
-      if(fread(&num, sizeof(int), 1, fp) != 1) return false;
-      if(swap) SwapBytes((char *)&num, sizeof(int), 1);
-    }
-    else {
-      if(fscanf(fp, "%d", &num) != 1) return false;
-    }
-    if(num < 0) return false;
-    int mult = 1;
-    if(_type == ElementNodeData || _type == GaussPointData) {
-      if(binary) {
-        if(fread(&mult, sizeof(int), 1, fp) != 1) return false;
-        if(swap) SwapBytes((char *)&mult, sizeof(int), 1);
-      }
-      else {
-        if(fscanf(fp, "%d", &mult) != 1) return false;
+  int i = 0;
+  bool ok = _steps[step]->readBlock(
+    fp, block, [&](int num, int mult, double *d) {
+      // compute min/max here to avoid calling finalize(true) later: this
+      // would be very slow for large multi-step, multi-partition datasets
+      // (since we would recompute the min/max for all the previously loaded
+      // steps/partitions, and thus loop over all the elements many times);
+      // this also allows to keep the min/max of steps whose values are
+      // released from memory
+      for(int j = 0; j < mult; j++) {
+        double val = ComputeScalarRep(numComp, &d[numComp * j]);
+        _steps[step]->setMin(std::min(_steps[step]->getMin(), val));
+        _steps[step]->setMax(std::max(_steps[step]->getMax(), val));
+        _min = std::min(_min, val);
+        _max = std::max(_max, val);
       }
-    }
-    double *d = _steps[step]->getData(num, true, mult);
-
-    if(binary) {
-      if((int)fread(d, sizeof(double), numComp * mult, fp) != numComp * mult)
-        return false;
-      if(swap) SwapBytes((char *)d, sizeof(double), numComp * mult);
-    }
-    else {
-      for(int j = 0; j < numComp * mult; j++)
-        if(fscanf(fp, "%lf", &d[j]) != 1) return false;
-    }
-    // compute min/max here to avoid calling finalize(true) later:
-    // this would be very slow for large multi-step, multi-partition
-    // datasets (since we would recompute the min/max for all the
-    // previously loaded steps/partitions, and thus loop over all the
-    // elements many times)
-    for(int j = 0; j < mult; j++) {
-      double val = ComputeScalarRep(numComp, &d[numComp * j]);
-      _steps[step]->setMin(std::min(_steps[step]->getMin(), val));
-      _steps[step]->setMax(std::max(_steps[step]->getMax(), val));
-      _min = std::min(_min, val);
-      _max = std::max(_max, val);
-    }
-    if(numEnt > 100000) Msg::ProgressMeter(i + 1, true, "Reading data");
+      if(numEnt > 100000) Msg::ProgressMeter(++i, true, "Reading data");
+    });
+  if(!ok) {
+    Msg::StopProgressMeter();
+    return false;
   }
   Msg::StopProgressMeter();
   if(partition >= 0) _steps[step]->getPartitions().insert(partition);
@@ -4,6 +4,7 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <algorithm>
+#include <atomic>
 #include "PView.h"
 #include "PViewDataList.h"
 #include "GmshMessage.h"
@@ -14,15 +15,19 @@
 #include "Context.h"
 #include "polynomialBasis.h"
 
+thread_local PViewDataList::lastElement PViewDataList::_last = {
+  0, -1, -1, -1, -1, -1, -1, -1, nullptr, nullptr};
+
+// unique identifiers of the data, used to tag the cached elements
+static std::atomic<std::size_t> _lastId(0);
+
 PViewDataList::PViewDataList(bool isAdapted)
   : PViewData(), NbTimeStep(0), Min(VAL_INF), Max(-VAL_INF), NbSP(0), NbVP(0),
     NbTP(0), NbSL(0), NbVL(0), NbTL(0), NbST(0), NbVT(0), NbTT(0), NbSQ(0),
     NbVQ(0), NbTQ(0), NbSG(0), NbVG(0), NbTG(0), NbSS(0), NbVS(0), NbTS(0),
     NbSH(0), NbVH(0), NbTH(0), NbSI(0), NbVI(0), NbTI(0), NbSY(0), NbVY(0),
     NbTY(0), NbSR(0), NbVR(0), NbTR(0), NbSD(0), NbVD(0), NbTD(0), NbT2(0),
-    NbT3(0), _lastElement(-1), _lastDimension(-1), _lastNumNodes(-1),
-    _lastNumComponents(-1), _lastNumValues(-1), _lastNumEdges(-1),
-    _lastType(-1), _lastXYZ(nullptr), _lastVal(nullptr), _isAdapted(isAdapted)
+    NbT3(0), _id(++_lastId), _isAdapted(isAdapted)
 {
   for(int i = 0; i < 33; i++) _index[i] = 0;
   polyTotNumNodes[0] = 0.;
@@ -144,6 +149,9 @@ bool PViewDataList::finalize(bool computeMinMax,
     for(int j = 0; j <= i; j++) _index[i] += nb[j];
   }
 
+  // invalidate the cached elements
+  _id = ++_lastId;
+
   if(CTX::instance()->post.smooth) smooth();
 
   return PViewData::finalize();
@@ -320,11 +328,11 @@ void PViewDataList::_setLast(int ele, int dim, int nbnod, int nbcomp, int nbedg,
     if(getInterpolationMatrices(type, im) == 4) nbnod = im[2]->size1();
   }
 
-  _lastDimension = dim;
-  _lastNumNodes = nbnod;
-  _lastNumComponents = nbcomp;
-  _lastNumEdges = nbedg;
-  _lastType = type;
+  _last.dimension = dim;
+  _last.numNodes = nbnod;
+  _last.numComponents = nbcomp;
+  _last.numEdges = nbedg;
+  _last.type = type;
   int nb = list.size() / nblist; // number of coords and values for the element
   int nbAg =
     ele * nb; // number of coords and values before the ones of the element
@@ -333,14 +341,15 @@ void PViewDataList::_setLast(int ele, int dim, int nbnod, int nbcomp, int nbedg,
     nb = list.size() / polyTotNumNodes[t] * nbnod;
     nbAg = polyAgNumNodes[t][ele] * nb / nbnod;
   }
-  _lastNumValues = (nb - 3 * nbnod) / NbTimeStep;
-  _lastXYZ = &list[nbAg];
-  _lastVal = &list[nbAg + 3 * _lastNumNodes];
+  _last.numValues = (nb - 3 * nbnod) / NbTimeStep;
+  _last.xyz = &list[nbAg];
+  _last.val = &list[nbAg + 3 * _last.numNodes];
 }
 
 void PViewDataList::_setLast(int ele)
 {
-  _lastElement = ele;
+  _last.id = _id;
+  _last.ele = ele;
   if(ele < _index[2]) { // points
     if(ele < _index[0])
       _setLast(ele, 0, 1, 1, 0, TYPE_PNT, SP, NbSP);
@@ -435,23 +444,21 @@ void PViewDataList::_setLast(int ele)
 
 int PViewDataList::getDimension(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastDimension;
+  return _getLast(ele).dimension;
 }
 
 int PViewDataList::getNumNodes(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumNodes;
+  return _getLast(ele).numNodes;
 }
 
 int PViewDataList::getNode(int step, int ent, int ele, int nod, double &x,
                            double &y, double &z)
 {
-  if(ele != _lastElement) _setLast(ele);
-  x = _lastXYZ[nod];
-  y = _lastXYZ[_lastNumNodes + nod];
-  z = _lastXYZ[2 * _lastNumNodes + nod];
+  lastElement &l = _getLast(ele);
+  x = l.xyz[nod];
+  y = l.xyz[l.numNodes + nod];
+  z = l.xyz[2 * l.numNodes + nod];
   return 0;
 }
 
@@ -459,59 +466,55 @@ void PViewDataList::setNode(int step, int ent, int ele, int nod, double x,
                             double y, double z)
 {
   if(step) return;
-  if(ele != _lastElement) _setLast(ele);
-  _lastXYZ[nod] = x;
-  _lastXYZ[_lastNumNodes + nod] = y;
-  _lastXYZ[2 * _lastNumNodes + nod] = z;
+  lastElement &l = _getLast(ele);
+  l.xyz[nod] = x;
+  l.xyz[l.numNodes + nod] = y;
+  l.xyz[2 * l.numNodes + nod] = z;
 }
 
 int PViewDataList::getNumComponents(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumComponents;
+  return _getLast(ele).numComponents;
 }
 
 int PViewDataList::getNumValues(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumValues;
+  return _getLast(ele).numValues;
 }
 
 void PViewDataList::getValue(int step, int ent, int ele, int idx, double &val)
 {
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
   if(step >= NbTimeStep) step = 0;
-  val = _lastVal[step * _lastNumValues + idx];
+  val = l.val[step * l.numValues + idx];
 }
 
 void PViewDataList::getValue(int step, int ent, int ele, int nod, int comp,
                              double &val)
 {
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
   if(step >= NbTimeStep) step = 0;
-  val = _lastVal[step * _lastNumNodes * _lastNumComponents +
-                 nod * _lastNumComponents + comp];
+  val = l.val[step * l.numNodes * l.numComponents + nod * l.numComponents +
+              comp];
 }
 
 void PViewDataList::setValue(int step, int ent, int ele, int nod, int comp,
                              double val)
 {
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
   if(step >= NbTimeStep) step = 0;
-  _lastVal[step * _lastNumNodes * _lastNumComponents +
-           nod * _lastNumComponents + comp] = val;
+  l.val[step * l.numNodes * l.numComponents + nod * l.numComponents + comp] =
+    val;
 }
 
 int PViewDataList::getNumEdges(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastNumEdges;
+  return _getLast(ele).numEdges;
 }
 
 int PViewDataList::getType(int step, int ent, int ele)
 {
-  if(ele != _lastElement) _setLast(ele);
-  return _lastType;
+  return _getLast(ele).type;
 }
 
 void PViewDataList::_getString(int dim, int i, int step, std::string &str,
@@ -582,29 +585,28 @@ void PViewDataList::getString3D(int i, int step, std::string &str, double &x,
 void PViewDataList::reverseElement(int step, int ent, int ele)
 {
   if(step) return;
-  if(ele != _lastElement) _setLast(ele);
+  lastElement &l = _getLast(ele);
+  int nn = l.numNodes, nc = l.numComponents;
 
   // copy data
-  std::vector<double> XYZ(3 * _lastNumNodes);
-  for(std::size_t i = 0; i < XYZ.size(); i++) XYZ[i] = _lastXYZ[i];
+  std::vector<double> XYZ(3 * nn);
+  for(std::size_t i = 0; i < XYZ.size(); i++) XYZ[i] = l.xyz[i];
 
-  std::vector<double> V(_lastNumNodes * _lastNumComponents * getNumTimeSteps());
-  for(std::size_t i = 0; i < V.size(); i++) V[i] = _lastVal[i];
+  std::vector<double> V(nn * nc * getNumTimeSteps());
+  for(std::size_t i = 0; i < V.size(); i++) V[i] = l.val[i];
 
   // reverse node order
-  for(int i = 0; i < _lastNumNodes; i++) {
-    _lastXYZ[i] = XYZ[_lastNumNodes - i - 1];
-    _lastXYZ[_lastNumNodes + i] = XYZ[2 * _lastNumNodes - i - 1];
-    _lastXYZ[2 * _lastNumNodes + i] = XYZ[3 * _lastNumNodes - i - 1];
+  for(int i = 0; i < nn; i++) {
+    l.xyz[i] = XYZ[nn - i - 1];
+    l.xyz[nn + i] = XYZ[2 * nn - i - 1];
+    l.xyz[2 * nn + i] = XYZ[3 * nn - i - 1];
   }
 
   for(int step = 0; step < getNumTimeSteps(); step++)
-    for(int i = 0; i < _lastNumNodes; i++)
-      for(int k = 0; k < _lastNumComponents; k++)
-        _lastVal[_lastNumComponents * _lastNumNodes * step +
-                 _lastNumComponents * i + k] =
-          V[_lastNumComponents * _lastNumNodes * step +
-            _lastNumComponents * (_lastNumNodes - i - 1) + k];
+    for(int i = 0; i < nn; i++)
+      for(int k = 0; k < nc; k++)
+        l.val[nc * nn * step + nc * i + k] =
+          V[nc * nn * step + nc * (nn - i - 1) + k];
 }
 
 static void generateConnectivities(std::vector<double> &list, int nbList,
@@ -1410,3 +1412,64 @@ std::vector<double> *PViewDataList::incrementList(int numComp, int type,
   }
   return nullptr;
 }
+
+void PViewDataList::appendLists(PViewDataList &other)
+{
+  // elements (with a constant number of nodes)
+  for(int i = 0; i < 27; i++) {
+    std::vector<double> *l1 = nullptr, *l2 = nullptr;
+    int *ne1 = nullptr, *ne2 = nullptr, nc, nn;
+    _getRawData(i, &l1, &ne1, &nc, &nn);
+    other._getRawData(i, &l2, &ne2, &nc, &nn);
+    l1->insert(l1->end(), l2->begin(), l2->end());
+    *ne1 += *ne2;
+  }
+
+  // polygons and polyhedra
+  std::vector<double> *p1[6] = {&SG, &VG, &TG, &SD, &VD, &TD};
+  std::vector<double> *p2[6] = {&other.SG, &other.VG, &other.TG,
+                                &other.SD, &other.VD, &other.TD};
+  int *n1[6] = {&NbSG, &NbVG, &NbTG, &NbSD, &NbVD, &NbTD};
+  int n2[6] = {other.NbSG, other.NbVG, other.NbTG,
+               other.NbSD, other.NbVD, other.NbTD};
+  for(int i = 0; i < 6; i++) {
+    p1[i]->insert(p1[i]->end(), p2[i]->begin(), p2[i]->end());
+    *n1[i] += n2[i];
+  }
+  for(int t = 0; t < 2; t++) {
+    for(std::size_t i = 0; i < other.polyNumNodes[t].size(); i++) {
+      int n = other.polyNumNodes[t][i];
+      int nb = (polyAgNumNodes[t].size()) ? polyAgNumNodes[t].back() : 0;
+      polyNumNodes[t].push_back(n);
+      polyAgNumNodes[t].push_back(n + nb);
+    }
+    polyTotNumNodes[t] += other.polyTotNumNodes[t];
+  }
+
+  // strings
+  for(std::size_t i = 0; i < other.T2D.size(); i += 4) {
+    T2D.push_back(other.T2D[i]);
+    T2D.push_back(other.T2D[i + 1]);
+    T2D.push_back(other.T2D[i + 2]);
+    T2D.push_back(T2C.size());
+    int beg = (int)other.T2D[i + 3];
+    int end = (i + 4 < other.T2D.size()) ? (int)other.T2D[i + 3 + 4] :
+                                           (int)other.T2C.size();
+    T2C.insert(T2C.end(), other.T2C.begin() + beg, other.T2C.begin() + end);
+    NbT2++;
+  }
+  for(std::size_t i = 0; i < other.T3D.size(); i += 5) {
+    T3D.push_back(other.T3D[i]);
+    T3D.push_back(other.T3D[i + 1]);
+    T3D.push_back(other.T3D[i + 2]);
+    T3D.push_back(other.T3D[i + 3]);
+    T3D.push_back(T3C.size());
+    int beg = (int)other.T3D[i + 4];
+    int end = (i + 5 < other.T3D.size()) ? (int)other.T3D[i + 4 + 5] :
+                                           (int)other.T3C.size();
+    T3C.insert(T3C.end(), other.T3C.begin() + beg, other.T3C.begin() + end);
+    NbT3++;
+  }
+
+  if(Time.size() < other.Time.size()) Time = other.Time;
+}
@@ -54,14 +54,27 @@ public:
 
 private:
   int _index[33];
-  int _lastElement, _lastDimension;
-  int _lastNumNodes, _lastNumComponents, _lastNumValues, _lastNumEdges,
-    _lastType;
-  double *_lastXYZ, *_lastVal;
+  // the element accessed last is cached, so that its nodes and values can be
+  // accessed without locating it again in the lists. The cache is
+  // thread-local (and tagged with the unique identifier of the data, renewed
+  // each time the data is finalized), so that the data can be read
+  // concurrently
+  struct lastElement {
+    std::size_t id;
+    int ele, dimension, numNodes, numComponents, numValues, numEdges, type;
+    double *xyz, *val;
+  };
+  static thread_local lastElement _last;
+  std::size_t _id;
   bool _isAdapted;
   void _stat(std::vector<double> &D, std::vector<char> &C, int nb);
   void _stat(std::vector<double> &list, int nbcomp, int nbelm, int nbnod,
              int type);
+  lastElement &_getLast(int ele)
+  {
+    if(_last.id != _id || _last.ele != ele) _setLast(ele);
+    return _last;
+  }
   void _setLast(int ele);
   void _setLast(int ele, int dim, int nbnod, int nbcomp, int nbedg, int type,
                 std::vector<double> &list, int nblist);
@@ -135,6 +148,9 @@ public:
   // specific to list-based data sets
   void setOrder2(int type);
   std::vector<double> *incrementList(int numComp, int type, int numNodes = 0);
+  // append the elements and the strings of other to the lists, e.g. to merge
+  // outputs computed concurrently (finalize() must be called afterwards)
+  void appendLists(PViewDataList &other);
 
   // I/O routines
   bool readPOS(FILE *fp, double version, bool binary);
@@ -24,6 +24,57 @@
 #include "Options.h"
 #include "StringUtils.h"
 #include "fullMatrix.h"
+#include "PViewDataGModel.h"
+
+// the vertex arrays in which the elements are added: when the arrays are
+// filled in parallel, each thread adds its elements in its own set of arrays,
+// which are then merged in order (see addElementsInArrays)
+struct vertexArrays {
+  VertexArray *points, *lines, *triangles, *vectors, *ellipses;
+};
+static thread_local vertexArrays *va = nullptr;
+
+// the current boundary level (initialized with PViewOptions::boundary for each
+// element, and decremented when drawing the boundary of an element); stored
+// per thread for the same reason
+static thread_local int boundary = 0;
+
+// tags of the vertices in the vertex arrays: vertices whose color does not
+// depend on the data (e.g. element outlines), vertices whose color cannot be
+// updated incrementally (e.g. vertices created by cutting an element), and
+// vertices located on node 'nod' of element 'ele' in entity 'ent'
+static const uint64_t keepColorTag = ~(uint64_t)0;
+static const uint64_t noTag = keepColorTag - 1;
+
+// the element whose vertices are being tagged, if any (per thread)
+struct taggedElement {
+  int ent, ele;
+};
+static thread_local taggedElement *tagged = nullptr;
+
+static uint64_t getNodeTag(int ent, int ele, int nod)
+{
+  if(ent < 0 || ent >= (1 << 16) || ele < 0 || nod < 0 || nod >= (1 << 8))
+    return noTag;
+  return ((uint64_t)ent << 48) | ((uint64_t)ele << 8) | (uint64_t)nod;
+}
+
+// tag the untagged vertices of the array with 'tag'
+static void padTags(VertexArray *a, uint64_t tag)
+{
+  if(tagged) a->getTags().resize(a->getNumVertices(), tag);
+}
+
+// tag the last 'n' vertices added in the array with the nodes they are located
+// on
+static void tagLastVertices(VertexArray *a, int n, const int *nodes)
+{
+  if(!tagged) return;
+  std::vector<uint64_t> &tags = a->getTags();
+  tags.resize(a->getNumVertices() - n, noTag);
+  for(int j = 0; j < n; j++)
+    tags.push_back(getNodeTag(tagged->ent, tagged->ele, nodes[j]));
+}
 
 static void saturate(int nb, double **val, double vmin, double vmax, int i0 = 0,
                      int i1 = 1, int i2 = 2, int i3 = 3, int i4 = 4, int i5 = 5,
@@ -317,7 +368,7 @@ static void addOutlinePoint(PView *p, double **xyz, unsigned int color,
 {
   if(pre) return;
   SVector3 n = getPointNormal(p, 1.);
-  p->va_points->add(&xyz[i0][0], &xyz[i0][1], &xyz[i0][2], &n, &color, nullptr,
+  va->points->add(&xyz[i0][0], &xyz[i0][1], &xyz[i0][2], &n, &color, nullptr,
                     true);
 }
 
@@ -336,8 +387,9 @@ static void addScalarPoint(PView *p, double **xyz, double **val, bool pre,
       val[i0][0], vmin, vmax, false,
       (opt->intervalsType == PViewOptions::Discrete) ? opt->nbIso : -1);
     SVector3 n = getPointNormal(p, val[i0][0]);
-    p->va_points->add(&xyz[i0][0], &xyz[i0][1], &xyz[i0][2], &n, &col, nullptr,
+    va->points->add(&xyz[i0][0], &xyz[i0][1], &xyz[i0][2], &n, &col, nullptr,
                       unique);
+    tagLastVertices(va->points, 1, &i0);
   }
 }
 
@@ -357,7 +409,7 @@ static void addOutlineLine(PView *p, double **xyz, unsigned int color, bool pre,
   }
   SVector3 n[2];
   getLineNormal(p, x, y, z, nullptr, n, true);
-  p->va_lines->add(x, y, z, n, col, nullptr, true);
+  va->lines->add(x, y, z, n, col, nullptr, true);
 }
 
 static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
@@ -367,11 +419,11 @@ static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
 
   PViewOptions *opt = p->getOptions();
 
-  if(opt->boundary > 0) {
-    opt->boundary--;
+  if(boundary > 0) {
+    boundary--;
     addScalarPoint(p, xyz, val, pre, i0, true);
     addScalarPoint(p, xyz, val, pre, i1, true);
-    opt->boundary++;
+    boundary++;
     return;
   }
 
@@ -390,7 +442,9 @@ static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
        val[i1][0] <= vmax) {
       unsigned int col[2];
       for(int i = 0; i < 2; i++) col[i] = opt->getColor(v[i], vmin, vmax);
-      p->va_lines->add(x, y, z, n, col, nullptr, unique);
+      va->lines->add(x, y, z, n, col, nullptr, unique);
+      const int nodes[2] = {i0, i1};
+      tagLastVertices(va->lines, 2, nodes);
     }
     else {
       double x2[2], y2[2], z2[2], v2[2];
@@ -398,7 +452,7 @@ static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
       if(nb == 2) {
         unsigned int col[2];
         for(int i = 0; i < 2; i++) col[i] = opt->getColor(v2[i], vmin, vmax);
-        p->va_lines->add(x2, y2, z2, n, col, nullptr, unique);
+        va->lines->add(x2, y2, z2, n, col, nullptr, unique);
       }
     }
   }
@@ -415,7 +469,7 @@ static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
         unsigned int col[2] = {color, color};
         SVector3 n[2];
         getLineNormal(p, x2, y2, z2, v2, n, true);
-        p->va_lines->add(x2, y2, z2, n, col, nullptr, unique);
+        va->lines->add(x2, y2, z2, n, col, nullptr, unique);
       }
       if(vmin == vmax) break;
     }
@@ -430,7 +484,7 @@ static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
       if(nb == 1) {
         unsigned int color = opt->getColor(k, opt->nbIso);
         SVector3 n = getPointNormal(p, iso);
-        p->va_points->add(x2, y2, z2, &n, &color, nullptr, unique);
+        va->points->add(x2, y2, z2, &n, &color, nullptr, unique);
       }
       if(vmin == vmax) break;
     }
@@ -461,7 +515,7 @@ static void addOutlineTriangle(PView *p, double **xyz, unsigned int color,
       }
     }
     getLineNormal(p, x, y, z, nullptr, n, false);
-    if(!pre) p->va_lines->add(x, y, z, n, col, nullptr, true);
+    if(!pre) va->lines->add(x, y, z, n, col, nullptr, true);
   }
 }
 
@@ -473,11 +527,11 @@ static void addScalarTriangle(PView *p, double **xyz, double **val, bool pre,
 
   const int il[3][2] = {{i0, i1}, {i1, i2}, {i2, i0}};
 
-  if(opt->boundary > 0) {
-    opt->boundary--;
+  if(boundary > 0) {
+    boundary--;
     for(int i = 0; i < 3; i++)
       addScalarLine(p, xyz, val, pre, il[i][0], il[i][1], true);
-    opt->boundary++;
+    boundary++;
     return;
   }
 
@@ -505,7 +559,12 @@ static void addScalarTriangle(PView *p, double **xyz, double **val, bool pre,
         }
         col[i] = opt->getColor(v[i], vmin, vmax);
       }
-      if(!pre) p->va_triangles->add(x, y, z, n, col, nullptr, unique, skin);
+      if(!pre) {
+        va->triangles->add(x, y, z, n, col, nullptr, unique, skin);
+        // skin triangles are only added when the arrays are finalized
+        const int nodes[3] = {i0, i1, i2};
+        if(!skin) tagLastVertices(va->triangles, 3, nodes);
+      }
     }
     else {
       double x2[10], y2[10], z2[10], v2[10];
@@ -528,7 +587,7 @@ static void addScalarTriangle(PView *p, double **xyz, double **val, bool pre,
             col[i] = opt->getColor(v3[i], vmin, vmax);
           }
           if(!pre)
-            p->va_triangles->add(x3, y3, z3, n, col, nullptr, unique, skin);
+            va->triangles->add(x3, y3, z3, n, col, nullptr, unique, skin);
         }
       }
     }
@@ -558,7 +617,7 @@ static void addScalarTriangle(PView *p, double **xyz, double **val, bool pre,
             }
           }
           if(!pre)
-            p->va_triangles->add(x3, y3, z3, n, col, nullptr, unique, skin);
+            va->triangles->add(x3, y3, z3, n, col, nullptr, unique, skin);
         }
       }
       if(vmin == vmax) break;
@@ -585,7 +644,7 @@ static void addScalarTriangle(PView *p, double **xyz, double **val, bool pre,
         }
         double v[2] = {iso, iso};
         getLineNormal(p, x, y, z, v, n, false);
-        if(!pre) p->va_lines->add(x2, y2, z2, n, col, nullptr, unique);
+        if(!pre) va->lines->add(x2, y2, z2, n, col, nullptr, unique);
       }
       if(vmin == vmax) break;
     }
@@ -617,7 +676,7 @@ static void addOutlineQuadrangle(PView *p, double **xyz, unsigned int color,
       }
     }
     getLineNormal(p, x, y, z, nullptr, n, false);
-    if(!pre) p->va_lines->add(x, y, z, n, col, nullptr, true);
+    if(!pre) va->lines->add(x, y, z, n, col, nullptr, true);
   }
 }
 
@@ -625,16 +684,14 @@ static void addScalarQuadrangle(PView *p, double **xyz, double **val, bool pre,
                                 int i0 = 0, int i1 = 1, int i2 = 2, int i3 = 3,
                                 bool unique = false)
 {
-  PViewOptions *opt = p->getOptions();
-
   const int il[4][2] = {{i0, i1}, {i1, i2}, {i2, i3}, {i3, i0}};
   const int it[2][3] = {{i0, i1, i2}, {i0, i2, i3}};
 
-  if(opt->boundary > 0) {
-    opt->boundary--;
+  if(boundary > 0) {
+    boundary--;
     for(int i = 0; i < 4; i++)
       addScalarLine(p, xyz, val, pre, il[i][0], il[i][1], true);
-    opt->boundary++;
+    boundary++;
     return;
   }
 
@@ -652,9 +709,7 @@ static void addOutlinePolygon(PView *p, double **xyz, unsigned int color,
 static void addScalarPolygon(PView *p, double **xyz, double **val, bool pre,
                              int numNodes)
 {
-  PViewOptions *opt = p->getOptions();
-
-  if(opt->boundary > 0) {
+  if(boundary > 0) {
     const int il[3][2] = {{0, 1}, {1, 2}, {2, 0}};
     std::map<MEdge, int, MEdgeLessThan> edges;
     std::vector<MVertex *> verts;
@@ -674,7 +729,7 @@ static void addScalarPolygon(PView *p, double **xyz, double **val, bool pre,
       }
     }
 
-    opt->boundary--;
+    boundary--;
     for(auto ite = edges.begin(); ite != edges.end(); ite++) {
       int i = (int)(*ite).second / 100;
       int j = (*ite).second % 100;
@@ -682,7 +737,7 @@ static void addScalarPolygon(PView *p, double **xyz, double **val, bool pre,
         addScalarLine(p, xyz, val, pre, 3 * i + il[j][0], 3 * i + il[j][0],
                       true);
     }
-    opt->boundary++;
+    boundary++;
 
     for(int i = 0; i < numNodes; i++) delete verts[i];
     return;
@@ -707,14 +762,14 @@ static void addScalarTetrahedron(PView *p, double **xyz, double **val, bool pre,
 
   const int it[4][3] = {{i0, i2, i1}, {i0, i1, i3}, {i0, i3, i2}, {i3, i1, i2}};
 
-  if(opt->boundary > 0 || opt->intervalsType == PViewOptions::Continuous ||
+  if(boundary > 0 || opt->intervalsType == PViewOptions::Continuous ||
      opt->intervalsType == PViewOptions::Discrete) {
-    bool skin = (opt->boundary > 0) ? false : opt->drawSkinOnly;
-    opt->boundary--;
+    bool skin = (boundary > 0) ? false : opt->drawSkinOnly;
+    boundary--;
     for(int i = 0; i < 4; i++)
       addScalarTriangle(p, xyz, val, pre, it[i][0], it[i][1], it[i][2], true,
                         skin);
-    opt->boundary++;
+    boundary++;
     return;
   }
 
@@ -752,7 +807,7 @@ static void addScalarTetrahedron(PView *p, double **xyz, double **val, bool pre,
             }
           }
           if(!pre)
-            p->va_triangles->add(x3, y3, z3, n, col, nullptr, false, false);
+            va->triangles->add(x3, y3, z3, n, col, nullptr, false, false);
         }
       }
       if(vmin == vmax) break;
@@ -773,19 +828,17 @@ static void addOutlineHexahedron(PView *p, double **xyz, unsigned int color,
 
 static void addScalarHexahedron(PView *p, double **xyz, double **val, bool pre)
 {
-  PViewOptions *opt = p->getOptions();
-
   const int iq[6][4] = {{0, 3, 2, 1}, {0, 1, 5, 4}, {0, 4, 7, 3},
                         {1, 2, 6, 5}, {2, 3, 7, 6}, {4, 5, 6, 7}};
   const int is[6][4] = {{0, 1, 3, 7}, {0, 4, 1, 7}, {1, 4, 5, 7},
                         {1, 2, 3, 7}, {1, 6, 2, 7}, {1, 5, 6, 7}};
 
-  if(opt->boundary > 0) {
-    opt->boundary--;
+  if(boundary > 0) {
+    boundary--;
     for(int i = 0; i < 6; i++)
       addScalarQuadrangle(p, xyz, val, pre, iq[i][0], iq[i][1], iq[i][2],
                           iq[i][3], true);
-    opt->boundary++;
+    boundary++;
     return;
   }
 
@@ -809,19 +862,18 @@ static void addOutlinePrism(PView *p, double **xyz, unsigned int color,
 
 static void addScalarPrism(PView *p, double **xyz, double **val, bool pre)
 {
-  PViewOptions *opt = p->getOptions();
   const int iq[3][4] = {{0, 1, 4, 3}, {0, 3, 5, 2}, {1, 2, 5, 4}};
   const int it[2][3] = {{0, 2, 1}, {3, 4, 5}};
   const int is[3][4] = {{0, 1, 2, 4}, {0, 4, 2, 5}, {0, 3, 4, 5}};
 
-  if(opt->boundary > 0) {
-    opt->boundary--;
+  if(boundary > 0) {
+    boundary--;
     for(int i = 0; i < 3; i++)
       addScalarQuadrangle(p, xyz, val, pre, iq[i][0], iq[i][1], iq[i][2],
                           iq[i][3], true);
     for(int i = 0; i < 2; i++)
       addScalarTriangle(p, xyz, val, pre, it[i][0], it[i][1], it[i][2], true);
-    opt->boundary++;
+    boundary++;
     return;
   }
 
@@ -842,17 +894,15 @@ static void addOutlinePyramid(PView *p, double **xyz, unsigned int color,
 
 static void addScalarPyramid(PView *p, double **xyz, double **val, bool pre)
 {
-  PViewOptions *opt = p->getOptions();
-
   const int it[4][3] = {{0, 1, 4}, {3, 0, 4}, {1, 2, 4}, {2, 3, 4}};
   const int is[2][4] = {{0, 1, 3, 4}, {1, 2, 3, 4}};
 
-  if(opt->boundary > 0) {
-    opt->boundary--;
+  if(boundary > 0) {
+    boundary--;
     addScalarQuadrangle(p, xyz, val, pre, 0, 3, 2, 1, true);
     for(int i = 0; i < 4; i++)
       addScalarTriangle(p, xyz, val, pre, it[i][0], it[i][1], it[i][2], true);
-    opt->boundary++;
+    boundary++;
     return;
   }
 
@@ -910,9 +960,7 @@ static void addOutlinePolyhedron(PView *p, double **xyz, unsigned int color,
 static void addScalarPolyhedron(PView *p, double **xyz, double **val, bool pre,
                                 int numNodes)
 {
-  PViewOptions *opt = p->getOptions();
-
-  if(opt->boundary > 0) { return; }
+  if(boundary > 0) { return; }
 
   for(int i = 0; i < numNodes / 4; i++)
     addScalarTetrahedron(p, xyz, val, pre, 4 * i, 4 * i + 1, 4 * i + 2,
@@ -1019,7 +1067,7 @@ static void addVectorElement(PView *p, int ient, int iele, int numNodes,
         }
         SVector3 n[2];
         getLineNormal(p, dxyz[0], dxyz[1], dxyz[2], norm, n, true);
-        p->va_lines->add(dxyz[0], dxyz[1], dxyz[2], n, col, nullptr, false);
+        va->lines->add(dxyz[0], dxyz[1], dxyz[2], n, col, nullptr, false);
       }
     }
     for(int i = 0; i < numNodes; i++) delete[] val2[i];
@@ -1049,7 +1097,7 @@ static void addVectorElement(PView *p, int ient, int iele, int numNodes,
           dxyz[j][0] = xyz[i][j];
           dxyz[j][1] = val[i][j];
         }
-        p->va_vectors->add(dxyz[0], dxyz[1], dxyz[2], nullptr, col, nullptr,
+        va->vectors->add(dxyz[0], dxyz[1], dxyz[2], nullptr, col, nullptr,
                            false);
       }
     }
@@ -1087,7 +1135,7 @@ static void addVectorElement(PView *p, int ient, int iele, int numNodes,
         dxyz[i][0] = pc[i];
         dxyz[i][1] = d[i];
       }
-      p->va_vectors->add(dxyz[0], dxyz[1], dxyz[2], nullptr, col, nullptr,
+      va->vectors->add(dxyz[0], dxyz[1], dxyz[2], nullptr, col, nullptr,
                          false);
     }
   }
@@ -1113,14 +1161,14 @@ static void addTriangle(PView *p, PViewOptions *opt, double *x0, double *x1,
     double YY[3] = {x0[1], x1[1], x2[1]};
     double ZZ[3] = {x0[2], x1[2], x2[2]};
     SVector3 NN[3] = {N, N, N};
-    p->va_triangles->add(XX, YY, ZZ, NN, col, nullptr, false);
+    va->triangles->add(XX, YY, ZZ, NN, col, nullptr, false);
   }
   else {
     double XX[3] = {x1[0], x0[0], x2[0]};
     double YY[3] = {x1[1], x0[1], x2[1]};
     double ZZ[3] = {x1[2], x0[2], x2[2]};
     SVector3 NN[3] = {-N, -N, -N};
-    p->va_triangles->add(XX, YY, ZZ, NN, col, nullptr, false);
+    va->triangles->add(XX, YY, ZZ, NN, col, nullptr, false);
   }
 }
 
@@ -1254,7 +1302,7 @@ static void addTensorElement(PView *p, int iEnt, int iEle, int numNodes,
           det, opt->tmpMin, opt->tmpMax, false,
           (opt->intervalsType == PViewOptions::Discrete) ? opt->nbIso : -1);
         unsigned int col[4] = {color, color, color, color};
-        p->va_ellipses->add(vval[0], vval[1], vval[2], nullptr, col, nullptr,
+        va->ellipses->add(vval[0], vval[1], vval[2], nullptr, col, nullptr,
                             false);
       }
     }
@@ -1281,7 +1329,7 @@ static void addTensorElement(PView *p, int iEnt, int iEle, int numNodes,
         lmax, opt->tmpMin, opt->tmpMax, false,
         (opt->intervalsType == PViewOptions::Discrete) ? opt->nbIso : -1);
       unsigned int col[4] = {color, color, color, color};
-      p->va_ellipses->add(vval[0], vval[1], vval[2], nullptr, col, nullptr,
+      va->ellipses->add(vval[0], vval[1], vval[2], nullptr, col, nullptr,
                           false);
     }
   }
@@ -1325,143 +1373,407 @@ static void addTensorElement(PView *p, int iEnt, int iEle, int numNodes,
   }
 }
 
-static void addElementsInArrays(PView *p, bool preprocessNormalsOnly)
+// buffers for the coordinates and the values of the nodes of an element
+class elementBuffers {
+public:
+  int nmax;
+  double **xyz, **val;
+  elementBuffers() : nmax(0), xyz(nullptr), val(nullptr) { resize(PVIEW_NMAX); }
+  ~elementBuffers() { resize(0); }
+  void resize(int n)
+  {
+    for(int j = 0; j < nmax; j++) {
+      delete[] xyz[j];
+      delete[] val[j];
+    }
+    delete[] xyz;
+    delete[] val;
+    nmax = n;
+    xyz = n ? new double *[n] : nullptr;
+    val = n ? new double *[n] : nullptr;
+    for(int j = 0; j < n; j++) {
+      xyz[j] = new double[3];
+      val[j] = new double[9];
+    }
+  }
+};
+
+// add element 'i' of entity 'ent' in the vertex arrays, and tag the vertices
+// if 'tag' is set; returns false if the element has no data
+static bool addElementInArrays(PView *p, PViewData *data, int ent, int i,
+                               bool preprocessNormalsOnly, bool tag,
+                               elementBuffers &buf, SBoundingBox3d &bbox)
 {
   static int numNodesError = 0, numCompError = 0;
 
+  PViewOptions *opt = p->getOptions();
+  boundary = opt->boundary;
+
+  if(data->skipElement(opt->timeStep, ent, i, true, opt->sampling))
+    return false;
+  int type = data->getType(opt->timeStep, ent, i);
+  if(opt->skipElement(type)) return true;
+  int numComp = data->getNumComponents(opt->timeStep, ent, i);
+  int numNodes = data->getNumNodes(opt->timeStep, ent, i);
+  if(numNodes > PVIEW_NMAX) {
+    if(type == TYPE_POLYG || type == TYPE_POLYH) {
+      if(numNodes > buf.nmax) buf.resize(numNodes);
+    }
+    else {
+#pragma omp critical(addElementInArraysWarning)
+      if(numNodesError != numNodes) {
+        numNodesError = numNodes;
+        Msg::Warning("Fields with %d nodes per element cannot be displayed: "
+                     "either force the field type or select 'Adapt "
+                     "visualization grid' if the field is high-order",
+                     numNodes);
+      }
+      return true;
+    }
+  }
+  if((numComp > 9 && !opt->forceNumComponents) ||
+     opt->forceNumComponents > 9) {
+#pragma omp critical(addElementInArraysWarning)
+    if(numCompError != numComp) {
+      numCompError = numComp;
+      Msg::Warning("Fields with %d components cannot be displayed: "
+                   "either force the field type or select 'Adapt "
+                   "visualization grid' if the field is high-order",
+                   numComp);
+    }
+    return true;
+  }
+  double **xyz = buf.xyz, **val = buf.val;
+  for(int j = 0; j < numNodes; j++) {
+    data->getNode(opt->timeStep, ent, i, j, xyz[j][0], xyz[j][1], xyz[j][2]);
+    if(opt->forceNumComponents) {
+      for(int k = 0; k < opt->forceNumComponents; k++) {
+        int comp = opt->componentMap[k];
+        if(comp >= 0 && comp < numComp)
+          data->getValue(opt->timeStep, ent, i, j, comp, val[j][k]);
+        else
+          val[j][k] = 0.;
+      }
+    }
+    else
+      for(int k = 0; k < numComp; k++)
+        data->getValue(opt->timeStep, ent, i, j, k, val[j][k]);
+  }
+  if(opt->forceNumComponents) numComp = opt->forceNumComponents;
+
+  changeCoordinates(p, ent, i, numNodes, type, numComp, xyz, val);
+  int dim = data->getDimension(opt->timeStep, ent, i);
+  if(!isElementVisible(opt, dim, numNodes, xyz)) return true;
+
+  for(int j = 0; j < numNodes; j++)
+    bbox += SPoint3(xyz[j][0], xyz[j][1], xyz[j][2]);
+
+  taggedElement te = {ent, i};
+  if(tag) tagged = &te;
+
+  if(opt->showElement && !data->useGaussPoints())
+    addOutlineElement(p, type, xyz, preprocessNormalsOnly, numNodes);
+
+  padTags(va->points, keepColorTag);
+  padTags(va->lines, keepColorTag);
+  padTags(va->triangles, keepColorTag);
+
+  if(opt->intervalsType != PViewOptions::Numeric) {
+    if(data->useGaussPoints()) {
+      for(int j = 0; j < numNodes; j++) {
+        double *x2 = new double[3];
+        double **xyz2 = &x2;
+        double *v2 = new double[9];
+        double **val2 = &v2;
+        xyz2[0][0] = xyz[j][0];
+        xyz2[0][1] = xyz[j][1];
+        xyz2[0][2] = xyz[j][2];
+        for(int k = 0; k < numComp; k++) val2[0][k] = val[j][k];
+        if(numComp == 1 && opt->drawScalars)
+          addScalarElement(p, TYPE_PNT, xyz2, val2, preprocessNormalsOnly,
+                           numNodes);
+        else if(numComp == 3 && opt->drawVectors)
+          addVectorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
+                           preprocessNormalsOnly);
+        else if(numComp == 9 && opt->drawTensors)
+          addTensorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
+                           preprocessNormalsOnly);
+        delete[] x2;
+        delete[] v2;
+      }
+    }
+    else if(numComp == 1 && opt->drawScalars)
+      addScalarElement(p, type, xyz, val, preprocessNormalsOnly, numNodes);
+    else if(numComp == 3 && opt->drawVectors)
+      addVectorElement(p, ent, i, numNodes, type, xyz, val,
+                       preprocessNormalsOnly);
+    else if(numComp == 9 && opt->drawTensors)
+      addTensorElement(p, ent, i, numNodes, type, xyz, val,
+                       preprocessNormalsOnly);
+  }
+
+  padTags(va->points, noTag);
+  padTags(va->lines, noTag);
+  padTags(va->triangles, noTag);
+  tagged = nullptr;
+  return true;
+}
+
+// can the elements of the view be added in the vertex arrays in parallel?
+// This requires random access to the data without side effects (i.e.
+// model-based data, not list-based or adaptive data), and no per-element
+// modification of the options (as done for vectors, tensors and general
+// transformations)
+static bool canAddElementsInParallel(PView *p, bool preprocessNormalsOnly)
+{
+  PViewData *data = p->getData(true);
+  PViewOptions *opt = p->getOptions();
+  if(preprocessNormalsOnly || data != p->getData()) return false;
+  if(!dynamic_cast<PViewDataGModel *>(data) || data->useGaussPoints())
+    return false;
+  if(opt->useGenRaise || data->getNumVectors(opt->timeStep) ||
+     data->getNumTensors(opt->timeStep))
+    return false;
+  return true;
+}
+
+// can the colors of the vertex arrays be updated without recreating the
+// arrays when the time step changes? This requires the geometry of the arrays
+// to be independent of the values, and the elements to be added in the same
+// way as the parallel algorithm
+static bool canUpdateColorsOnly(PView *p)
+{
+  PViewOptions *opt = p->getOptions();
+  if(!CTX::instance()->post.incrementalStepUpdate) return false;
+  if(!canAddElementsInParallel(p, false)) return false;
+  if(opt->intervalsType != PViewOptions::Continuous) return false;
+  if(opt->rangeType == PViewOptions::Custom && !opt->saturateValues)
+    return false;
+  if(opt->pointType || opt->lineType || opt->drawSkinOnly) return false;
+  if(opt->raise[0] || opt->raise[1] || opt->raise[2] || opt->normalRaise)
+    return false;
+  if(opt->forceNumComponents) return false;
+  return true;
+}
+
+static void addElementsInArrays(PView *p, bool preprocessNormalsOnly,
+                                bool tag)
+{
   // use adaptive data if available
   PViewData *data = p->getData(true);
   PViewOptions *opt = p->getOptions();
 
   opt->tmpBBox.reset();
+  VertexArray::setBoundaryTolerance();
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  if(!canAddElementsInParallel(p, preprocessNormalsOnly)) nthreads = 1;
+
+  if(nthreads == 1) {
+    vertexArrays all = {p->va_points, p->va_lines, p->va_triangles,
+                        p->va_vectors, p->va_ellipses};
+    va = &all;
+    elementBuffers buf;
+    std::size_t num = 0, numNodes = 0;
+    for(int ent = 0; ent < data->getNumEntities(opt->timeStep); ent++) {
+      if(data->skipEntity(opt->timeStep, ent)) continue;
+      for(int i = 0; i < data->getNumElements(opt->timeStep, ent); i++) {
+        if(addElementInArrays(p, data, ent, i, preprocessNormalsOnly, tag, buf,
+                              opt->tmpBBox)) {
+          num++;
+          numNodes += data->getNumNodes(opt->timeStep, ent, i);
+        }
+      }
+    }
+    va = nullptr;
+    if(tag) p->setNumTagged(num, numNodes);
+    return;
+  }
 
-  int NMAX = PVIEW_NMAX;
-  double **xyz = new double *[NMAX];
-  double **val = new double *[NMAX];
-  for(int i = 0; i < NMAX; i++) {
-    xyz[i] = new double[3];
-    val[i] = new double[9];
+  // split the elements in chunks, each filling its own vertex arrays: merging
+  // the arrays in order leads to the same result as the sequential algorithm
+  struct chunk {
+    int ent, begin, end;
+    std::size_t num, numNodes;
+    vertexArrays arrays;
+    SBoundingBox3d bbox;
+  };
+  std::vector<chunk> chunks;
+  int numElements = 0;
+  for(int ent = 0; ent < data->getNumEntities(opt->timeStep); ent++) {
+    if(data->skipEntity(opt->timeStep, ent)) continue;
+    numElements += data->getNumElements(opt->timeStep, ent);
   }
+  int chunkSize = std::max(1000, numElements / (8 * nthreads));
   for(int ent = 0; ent < data->getNumEntities(opt->timeStep); ent++) {
     if(data->skipEntity(opt->timeStep, ent)) continue;
-    for(int i = 0; i < data->getNumElements(opt->timeStep, ent); i++) {
-      if(data->skipElement(opt->timeStep, ent, i, true, opt->sampling))
-        continue;
-      int type = data->getType(opt->timeStep, ent, i);
-      if(opt->skipElement(type)) continue;
-      int numComp = data->getNumComponents(opt->timeStep, ent, i);
-      int numNodes = data->getNumNodes(opt->timeStep, ent, i);
-      if(numNodes > PVIEW_NMAX) {
-        if(type == TYPE_POLYG || type == TYPE_POLYH) {
-          if(numNodes > NMAX) {
-            for(int j = 0; j < NMAX; j++) {
-              delete[] xyz[j];
-              delete[] val[j];
-            }
-            delete[] xyz;
-            delete[] val;
-            NMAX = numNodes;
-            xyz = new double *[NMAX];
-            val = new double *[NMAX];
-            for(int j = 0; j < NMAX; j++) {
-              xyz[j] = new double[3];
-              val[j] = new double[9];
-            }
-          }
-        }
-        else {
-          if(numNodesError != numNodes) {
-            numNodesError = numNodes;
-            Msg::Warning(
-              "Fields with %d nodes per element cannot be displayed: "
-              "either force the field type or select 'Adapt visualization "
-              "grid' if the field is high-order",
-              numNodes);
-          }
-          continue;
+    int n = data->getNumElements(opt->timeStep, ent);
+    for(int begin = 0; begin < n; begin += chunkSize) {
+      chunk c;
+      c.ent = ent;
+      c.begin = begin;
+      c.end = std::min(n, begin + chunkSize);
+      c.num = 0;
+      c.numNodes = 0;
+      chunks.push_back(c);
+    }
+  }
+
+  Msg::Debug("Filling vertex arrays of view %d using %d threads (%d chunks)",
+             p->getTag(), nthreads, (int)chunks.size());
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    elementBuffers buf;
+#pragma omp for schedule(dynamic)
+    for(std::size_t k = 0; k < chunks.size(); k++) {
+      chunk &c = chunks[k];
+      int n = c.end - c.begin;
+      c.arrays.points = new VertexArray(1, 0);
+      c.arrays.lines = new VertexArray(2, 0);
+      c.arrays.triangles = new VertexArray(3, n);
+      c.arrays.vectors = new VertexArray(2, 0);
+      c.arrays.ellipses = new VertexArray(4, 0);
+      va = &c.arrays;
+      for(int i = c.begin; i < c.end; i++) {
+        if(addElementInArrays(p, data, c.ent, i, preprocessNormalsOnly, tag,
+                              buf, c.bbox)) {
+          c.num++;
+          c.numNodes += data->getNumNodes(opt->timeStep, c.ent, i);
         }
       }
-      if((numComp > 9 && !opt->forceNumComponents) ||
-         opt->forceNumComponents > 9) {
-        if(numCompError != numComp) {
-          numCompError = numComp;
-          Msg::Warning(
-            "Fields with %d components cannot be displayed: "
-            "either force the field type or select 'Adapt visualization "
-            "grid' if the field is high-order",
-            numComp);
-        }
-        continue;
+      va = nullptr;
+    }
+  }
+
+  std::size_t num = 0, numNodes = 0;
+  for(auto &c : chunks) {
+    num += c.num;
+    numNodes += c.numNodes;
+    p->va_points->merge(c.arrays.points);
+    p->va_lines->merge(c.arrays.lines);
+    p->va_triangles->merge(c.arrays.triangles);
+    p->va_vectors->merge(c.arrays.vectors);
+    p->va_ellipses->merge(c.arrays.ellipses);
+    delete c.arrays.points;
+    delete c.arrays.lines;
+    delete c.arrays.triangles;
+    delete c.arrays.vectors;
+    delete c.arrays.ellipses;
+    if(!c.bbox.empty()) opt->tmpBBox += c.bbox;
+  }
+  if(tag) p->setNumTagged(num, numNodes);
+}
+
+static void setValueRange(PView *p)
+{
+  PViewData *data = p->getData(true);
+  PViewOptions *opt = p->getOptions();
+
+  if(opt->rangeType == PViewOptions::Custom) {
+    opt->tmpMin = opt->customMin;
+    opt->tmpMax = opt->customMax;
+  }
+  else if(opt->rangeType == PViewOptions::PerTimeStep) {
+    opt->tmpMin = data->getMin(opt->timeStep);
+    opt->tmpMax = data->getMax(opt->timeStep);
+  }
+  else {
+    // FIXME: this is not perfect for multi-step adaptive views, as
+    // we don't have the correct min/max info for the other steps
+    opt->tmpMin = data->getMin();
+    opt->tmpMax = data->getMax();
+  }
+}
+
+// update the colors of the vertex arrays for the current time step, using the
+// tags of the vertices; returns false (leaving the arrays in an undefined
+// state) if the arrays need to be recreated
+static bool updateColorsInArrays(PView *p)
+{
+  PViewData *data = p->getData(true);
+  PViewOptions *opt = p->getOptions();
+
+  if(!canUpdateColorsOnly(p)) return false;
+  VertexArray *arrays[3] = {p->va_points, p->va_lines, p->va_triangles};
+  for(int k = 0; k < 3; k++) {
+    if(!arrays[k] || arrays[k]->getTags().size() !=
+                       (std::size_t)arrays[k]->getNumVertices())
+      return false;
+  }
+  if(!p->va_vectors || p->va_vectors->getNumVertices() || !p->va_ellipses ||
+     p->va_ellipses->getNumVertices())
+    return false;
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // the elements with data in the new step must be the same: if the mesh has
+  // changed since the arrays were filled, the number of elements with data or
+  // of their nodes differ, and the arrays are recreated
+  std::size_t num = 0, numNodes = 0;
+  for(int ent = 0; ent < data->getNumEntities(opt->timeStep); ent++) {
+    if(data->skipEntity(opt->timeStep, ent)) continue;
+    int n = data->getNumElements(opt->timeStep, ent);
+#pragma omp parallel for schedule(dynamic, 1000) num_threads(nthreads) \
+  reduction(+ : num, numNodes)
+    for(int i = 0; i < n; i++) {
+      if(!data->skipElement(opt->timeStep, ent, i, true, opt->sampling)) {
+        num++;
+        numNodes += data->getNumNodes(opt->timeStep, ent, i);
       }
-      for(int j = 0; j < numNodes; j++) {
-        data->getNode(opt->timeStep, ent, i, j, xyz[j][0], xyz[j][1],
-                      xyz[j][2]);
-        if(opt->forceNumComponents) {
-          for(int k = 0; k < opt->forceNumComponents; k++) {
-            int comp = opt->componentMap[k];
-            if(comp >= 0 && comp < numComp)
-              data->getValue(opt->timeStep, ent, i, j, comp, val[j][k]);
-            else
-              val[j][k] = 0.;
-          }
+    }
+  }
+  if(num != p->getNumTaggedElements() || numNodes != p->getNumTaggedNodes())
+    return false;
+
+  setValueRange(p);
+  double vmin = opt->tmpMin, vmax = opt->tmpMax;
+
+  bool ok = true;
+  for(int k = 0; k < 3 && ok; k++) {
+    std::vector<uint64_t> &tags = arrays[k]->getTags();
+    int n = (int)tags.size();
+#pragma omp parallel num_threads(nthreads)
+    {
+      int lastEnt = -1, lastEle = -1;
+#pragma omp for schedule(static) reduction(&& : ok)
+      for(int m = 0; m < n; m++) {
+        if(!ok || tags[m] == keepColorTag) continue;
+        if(tags[m] == noTag) {
+          ok = false;
+          continue;
         }
-        else
-          for(int k = 0; k < numComp; k++)
-            data->getValue(opt->timeStep, ent, i, j, k, val[j][k]);
-      }
-      if(opt->forceNumComponents) numComp = opt->forceNumComponents;
-
-      changeCoordinates(p, ent, i, numNodes, type, numComp, xyz, val);
-      int dim = data->getDimension(opt->timeStep, ent, i);
-      if(!isElementVisible(opt, dim, numNodes, xyz)) continue;
-
-      for(int j = 0; j < numNodes; j++)
-        opt->tmpBBox += SPoint3(xyz[j][0], xyz[j][1], xyz[j][2]);
-
-      if(opt->showElement && !data->useGaussPoints())
-        addOutlineElement(p, type, xyz, preprocessNormalsOnly, numNodes);
-
-      if(opt->intervalsType != PViewOptions::Numeric) {
-        if(data->useGaussPoints()) {
-          for(int j = 0; j < numNodes; j++) {
-            double *x2 = new double[3];
-            double **xyz2 = &x2;
-            double *v2 = new double[9];
-            double **val2 = &v2;
-            xyz2[0][0] = xyz[j][0];
-            xyz2[0][1] = xyz[j][1];
-            xyz2[0][2] = xyz[j][2];
-            for(int k = 0; k < numComp; k++) val2[0][k] = val[j][k];
-            if(numComp == 1 && opt->drawScalars)
-              addScalarElement(p, TYPE_PNT, xyz2, val2, preprocessNormalsOnly,
-                               numNodes);
-            else if(numComp == 3 && opt->drawVectors)
-              addVectorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
-                               preprocessNormalsOnly);
-            else if(numComp == 9 && opt->drawTensors)
-              addTensorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
-                               preprocessNormalsOnly);
-            delete[] x2;
-            delete[] v2;
+        int ent = (int)(tags[m] >> 48);
+        int ele = (int)((tags[m] >> 8) & (((uint64_t)1 << 40) - 1));
+        int nod = (int)(tags[m] & 0xff);
+        if(ent != lastEnt || ele != lastEle) {
+          if(data->skipElement(opt->timeStep, ent, ele, true, opt->sampling)) {
+            ok = false;
+            continue;
           }
+          lastEnt = ent;
+          lastEle = ele;
         }
-        else if(numComp == 1 && opt->drawScalars)
-          addScalarElement(p, type, xyz, val, preprocessNormalsOnly, numNodes);
-        else if(numComp == 3 && opt->drawVectors)
-          addVectorElement(p, ent, i, numNodes, type, xyz, val,
-                           preprocessNormalsOnly);
-        else if(numComp == 9 && opt->drawTensors)
-          addTensorElement(p, ent, i, numNodes, type, xyz, val,
-                           preprocessNormalsOnly);
+        double v = 0.;
+        data->getValue(opt->timeStep, ent, ele, nod, 0, v);
+        if(opt->saturateValues) {
+          if(v > vmax)
+            v = vmax;
+          else if(v < vmin)
+            v = vmin;
+        }
+        arrays[k]->setColor(m, opt->getColor(v, vmin, vmax));
       }
     }
   }
-  for(int j = 0; j < NMAX; j++) {
-    delete[] xyz[j];
-    delete[] val[j];
-  }
-  delete[] xyz;
-  delete[] val;
+  if(!ok) return false;
+
+  Msg::Debug("Updated colors of %d vertices in vertex arrays",
+             p->va_points->getNumVertices() + p->va_lines->getNumVertices() +
+               p->va_triangles->getNumVertices());
+  return true;
 }
 
 class initPView {
@@ -1548,6 +1860,11 @@ public:
       return false;
     if(!opt->visible || opt->type != PViewOptions::Plot3D) return false;
 
+    if(p->getOnlyStepChanged() && updateColorsInArrays(p)) {
+      p->setChanged(false);
+      return true;
+    }
+
     p->deleteVertexArrays();
 
     if(data->isRemote()) {
@@ -1562,20 +1879,7 @@ public:
 
     if(opt->useGenRaise) opt->createGeneralRaise();
 
-    if(opt->rangeType == PViewOptions::Custom) {
-      opt->tmpMin = opt->customMin;
-      opt->tmpMax = opt->customMax;
-    }
-    else if(opt->rangeType == PViewOptions::PerTimeStep) {
-      opt->tmpMin = data->getMin(opt->timeStep);
-      opt->tmpMax = data->getMax(opt->timeStep);
-    }
-    else {
-      // FIXME: this is not perfect for multi-step adaptive views, as
-      // we don't have the correct min/max info for the other steps
-      opt->tmpMin = data->getMin();
-      opt->tmpMax = data->getMax();
-    }
+    setValueRange(p);
 
     p->va_points = new VertexArray(1, _estimateNumPoints(p));
     p->va_lines = new VertexArray(2, _estimateNumLines(p));
@@ -1587,8 +1891,8 @@ public:
 
     p->normals = new smooth_normals(opt->angleSmoothNormals);
 
-    if(opt->smoothNormals) addElementsInArrays(p, true);
-    addElementsInArrays(p, false);
+    if(opt->smoothNormals) addElementsInArrays(p, true, false);
+    addElementsInArrays(p, false, canUpdateColorsOnly(p));
 
     p->va_points->finalize();
     p->va_lines->finalize();
@@ -12,26 +12,28 @@
 #include "Plugin.h"
 #include "OS.h"
 #include "GmshDefines.h"
+#include "GmshMessage.h"
+#include "Context.h"
 
 //#define TIMER
 
-std::set<adaptiveVertex> adaptivePoint::allVertices;
-std::set<adaptiveVertex> adaptiveLine::allVertices;
-std::set<adaptiveVertex> adaptiveTriangle::allVertices;
-std::set<adaptiveVertex> adaptiveQuadrangle::allVertices;
-std::set<adaptiveVertex> adaptiveTetrahedron::allVertices;
-std::set<adaptiveVertex> adaptiveHexahedron::allVertices;
-std::set<adaptiveVertex> adaptivePrism::allVertices;
-std::set<adaptiveVertex> adaptivePyramid::allVertices;
-
-std::list<adaptivePoint *> adaptivePoint::all;
-std::list<adaptiveLine *> adaptiveLine::all;
-std::list<adaptiveTriangle *> adaptiveTriangle::all;
-std::list<adaptiveQuadrangle *> adaptiveQuadrangle::all;
-std::list<adaptiveTetrahedron *> adaptiveTetrahedron::all;
-std::list<adaptiveHexahedron *> adaptiveHexahedron::all;
-std::list<adaptivePrism *> adaptivePrism::all;
-std::list<adaptivePyramid *> adaptivePyramid::all;
+thread_local std::set<adaptiveVertex> adaptivePoint::allVertices;
+thread_local std::set<adaptiveVertex> adaptiveLine::allVertices;
+thread_local std::set<adaptiveVertex> adaptiveTriangle::allVertices;
+thread_local std::set<adaptiveVertex> adaptiveQuadrangle::allVertices;
+thread_local std::set<adaptiveVertex> adaptiveTetrahedron::allVertices;
+thread_local std::set<adaptiveVertex> adaptiveHexahedron::allVertices;
+thread_local std::set<adaptiveVertex> adaptivePrism::allVertices;
+thread_local std::set<adaptiveVertex> adaptivePyramid::allVertices;
+
+thread_local std::list<adaptivePoint *> adaptivePoint::all;
+thread_local std::list<adaptiveLine *> adaptiveLine::all;
+thread_local std::list<adaptiveTriangle *> adaptiveTriangle::all;
+thread_local std::list<adaptiveQuadrangle *> adaptiveQuadrangle::all;
+thread_local std::list<adaptiveTetrahedron *> adaptiveTetrahedron::all;
+thread_local std::list<adaptiveHexahedron *> adaptiveHexahedron::all;
+thread_local std::list<adaptivePrism *> adaptivePrism::all;
+thread_local std::list<adaptivePyramid *> adaptivePyramid::all;
 
 int adaptivePoint::numNodes = 1;
 int adaptiveLine::numNodes = 2;
@@ -56,11 +58,29 @@ std::vector<int> globalVTKData::vtkGlobalCellType;
 std::vector<PCoords> globalVTKData::vtkGlobalCoords;
 std::vector<PValues> globalVTKData::vtkGlobalValues;
 
+// refinement level of the refined reference element (T::all and
+// T::allVertices) of the calling thread, or -1 if it has not been created
+template <class T> static int &referenceLevel()
+{
+  static thread_local int level = -1;
+  return level;
+}
+
 template <class T> static void cleanElement()
 {
   for(auto it = T::all.begin(); it != T::all.end(); ++it) delete *it;
   T::all.clear();
   T::allVertices.clear();
+  referenceLevel<T>() = -1;
+}
+
+// create the refined reference element of the calling thread, if it does not
+// exist yet at the given level
+template <class T> static void createReferenceElement(int level)
+{
+  if(referenceLevel<T>() == level) return;
+  T::create(level);
+  referenceLevel<T>() = level;
 }
 
 static void computeShapeFunctions(fullMatrix<double> *coeffs,
@@ -1081,7 +1101,8 @@ void adaptivePyramid::recurError(adaptivePyramid *p, double AVG, double tol)
 template <class T>
 adaptiveElements<T>::adaptiveElements(std::vector<fullMatrix<double> *> &p)
   : _coeffsVal(nullptr), _eexpsVal(nullptr), _interpolVal(nullptr),
-    _coeffsGeom(nullptr), _eexpsGeom(nullptr), _interpolGeom(nullptr)
+    _coeffsGeom(nullptr), _eexpsGeom(nullptr), _interpolGeom(nullptr),
+    _level(-1)
 {
   if(p.size() >= 2) {
     _coeffsVal = p[0];
@@ -1106,7 +1127,8 @@ template <class T> void adaptiveElements<T>::init(int level)
   double t1 = TimeOfDay();
 #endif
 
-  T::create(level);
+  _level = level;
+  createReferenceElement<T>(level);
   int numVals = _coeffsVal ? _coeffsVal->size1() : T::numNodes;
   int numNodes = _coeffsGeom ? _coeffsGeom->size1() : T::numNodes;
 
@@ -1155,7 +1177,8 @@ template <> void adaptiveElements<adaptivePyramid>::init(int level)
   double t1 = TimeOfDay();
 #endif
 
-  adaptivePyramid::create(level);
+  _level = level;
+  createReferenceElement<adaptivePyramid>(level);
   int numVals = _coeffsVal ? _coeffsVal->size1() : adaptivePyramid::numNodes;
   int numNodes = _coeffsGeom ? _coeffsGeom->size1() : adaptivePyramid::numNodes;
 
@@ -1202,6 +1225,49 @@ template <> void adaptiveElements<adaptivePyramid>::init(int level)
 #endif
 }
 
+template <class T>
+void adaptiveElements<T>::_refine(double tol, int numComp,
+                                  const fullMatrix<double> &res,
+                                  const fullMatrix<double> &XYZ, int col,
+                                  double minVal, double maxVal,
+                                  GMSH_PostPlugin *plug)
+{
+  int i = 0;
+  for(auto it = T::allVertices.begin(); it != T::allVertices.end(); ++it) {
+    // ok because we know this will not change the set ordering
+    adaptiveVertex *p = (adaptiveVertex *)&(*it);
+    int j = numComp * col;
+    p->val = res(i, j);
+    if(numComp == 3 || numComp == 9) {
+      p->valy = res(i, j + 1);
+      p->valz = res(i, j + 2);
+      if(numComp == 9) {
+        p->valyx = res(i, j + 3);
+        p->valyy = res(i, j + 4);
+        p->valyz = res(i, j + 5);
+        p->valzx = res(i, j + 6);
+        p->valzy = res(i, j + 7);
+        p->valzz = res(i, j + 8);
+      }
+    }
+    p->X = XYZ(i, 3 * col);
+    p->Y = XYZ(i, 3 * col + 1);
+    p->Z = XYZ(i, 3 * col + 2);
+    i++;
+  }
+
+  for(auto it = T::all.begin(); it != T::all.end(); it++)
+    (*it)->visible = false;
+
+  if(!plug || tol != 0.) {
+    double avg = fabs(maxVal - minVal);
+    if(tol < 0) avg = 1.; // force visibility to the smallest subdivision
+    T::error(avg, tol);
+  }
+
+  if(plug) plug->assignSpecificVisibility();
+}
+
 template <class T>
 bool adaptiveElements<T>::adapt(double tol, int numComp,
                                 std::vector<PCoords> &coords,
@@ -1209,6 +1275,7 @@ bool adaptiveElements<T>::adapt(double tol, int numComp,
                                 double &maxVal, GMSH_PostPlugin *plug,
                                 bool onlyComputeMinMax)
 {
+  if(_level >= 0) createReferenceElement<T>(_level);
   int numVertices = T::allVertices.size();
 
   if(!numVertices) {
@@ -1228,18 +1295,18 @@ bool adaptiveElements<T>::adapt(double tol, int numComp,
   double t1 = TimeOfDay();
 #endif
 
-  fullVector<double> val(numVals), res(numVertices);
+  fullMatrix<double> val(numVals, 1), res(numVertices, 1);
   switch(numComp) {
   case 1: {
-    for(int i = 0; i < numVals; i++) val(i) = values[i].v[0];
+    for(int i = 0; i < numVals; i++) val(i, 0) = values[i].v[0];
     break;
   }
   case 3:
   case 9: {
     for(int i = 0; i < numVals; i++) {
-      val(i) = 0;
+      val(i, 0) = 0;
       for(int k = 0; k < numComp; k++)
-        val(i) += values[i].v[k] * values[i].v[k];
+        val(i, 0) += values[i].v[k] * values[i].v[k];
     }
     break;
   }
@@ -1254,26 +1321,24 @@ bool adaptiveElements<T>::adapt(double tol, int numComp,
   // minVal = VAL_INF;
   // maxVal = -VAL_INF;
   for(int i = 0; i < numVertices; i++) {
-    minVal = std::min(minVal, res(i));
-    maxVal = std::max(maxVal, res(i));
+    minVal = std::min(minVal, res(i, 0));
+    maxVal = std::max(maxVal, res(i, 0));
   }
   if(onlyComputeMinMax) return true;
 
-  fullMatrix<double> *resxyz = nullptr;
   if(numComp == 3 || numComp == 9) {
     fullMatrix<double> valxyz(numVals, numComp);
-    resxyz = new fullMatrix<double>(numVertices, numComp);
+    res.resize(numVertices, numComp);
     for(int i = 0; i < numVals; i++) {
       for(int k = 0; k < numComp; k++) { valxyz(i, k) = values[i].v[k]; }
     }
-    _interpolVal->mult(valxyz, *resxyz);
+    _interpolVal->mult(valxyz, res);
   }
 
   int numNodes = _coeffsGeom ? _coeffsGeom->size1() : T::numNodes;
   if(numNodes != (int)coords.size()) {
     Msg::Error("Wrong number of nodes in adaptation %d != %i", numNodes,
                coords.size());
-    if(resxyz) delete resxyz;
     return false;
   }
 
@@ -1290,42 +1355,7 @@ bool adaptiveElements<T>::adapt(double tol, int numComp,
   return true;
 #endif
 
-  int i = 0;
-  for(auto it = T::allVertices.begin(); it != T::allVertices.end(); ++it) {
-    // ok because we know this will not change the set ordering
-    adaptiveVertex *p = (adaptiveVertex *)&(*it);
-    p->val = res(i);
-    if(resxyz) {
-      p->val = (*resxyz)(i, 0);
-      p->valy = (*resxyz)(i, 1);
-      p->valz = (*resxyz)(i, 2);
-      if(numComp == 9) {
-        p->valyx = (*resxyz)(i, 3);
-        p->valyy = (*resxyz)(i, 4);
-        p->valyz = (*resxyz)(i, 5);
-        p->valzx = (*resxyz)(i, 6);
-        p->valzy = (*resxyz)(i, 7);
-        p->valzz = (*resxyz)(i, 8);
-      }
-    }
-    p->X = XYZ(i, 0);
-    p->Y = XYZ(i, 1);
-    p->Z = XYZ(i, 2);
-    i++;
-  }
-
-  if(resxyz) delete resxyz;
-
-  for(auto it = T::all.begin(); it != T::all.end(); it++)
-    (*it)->visible = false;
-
-  if(!plug || tol != 0.) {
-    double avg = fabs(maxVal - minVal);
-    if(tol < 0) avg = 1.; // force visibility to the smallest subdivision
-    T::error(avg, tol);
-  }
-
-  if(plug) plug->assignSpecificVisibility();
+  _refine(tol, numComp, res, XYZ, 0, minVal, maxVal, plug);
 
   coords.clear();
   values.clear();
@@ -1424,72 +1454,151 @@ void adaptiveElements<T>::addInView(double tol, int step, PViewData *in,
   outList->clear();
   *outNb = 0;
 
+  if(_level >= 0) createReferenceElement<T>(_level);
+  int numVertices = T::allVertices.size();
+  if(!numVertices) {
+    Msg::Warning("No adapted vertices to interpolate");
+    return;
+  }
+  int numVals = _coeffsVal ? _coeffsVal->size1() : T::numNodes;
+  int numNodes = _coeffsGeom ? _coeffsGeom->size1() : T::numNodes;
+
+  std::vector<std::pair<int, int> > elements;
   for(int ent = 0; ent < in->getNumEntities(step); ent++) {
     for(int ele = 0; ele < in->getNumElements(step, ent); ele++) {
       if(in->skipElement(step, ent, ele) ||
          in->getNumEdges(step, ent, ele) != T::numEdges)
         continue;
-      int numNodes = in->getNumNodes(step, ent, ele);
-      std::vector<PCoords> coords;
-      for(int i = 0; i < numNodes; i++) {
-        double x, y, z;
-        in->getNode(step, ent, ele, i, x, y, z);
-        coords.push_back(PCoords(x, y, z));
-      }
-      int numVal = in->getNumValues(step, ent, ele);
-      std::vector<PValues> values;
+      elements.push_back(std::make_pair(ent, ele));
+    }
+  }
 
-      switch(numComp) {
-      case 1:
-        for(int i = 0; i < numVal; i++) {
-          double val;
-          in->getValue(step, ent, ele, i, val);
-          values.push_back(PValues(val));
-        }
-        break;
-      case 3: {
-        for(int i = 0; i < numVal / 3; i++) {
-          double vx, vy, vz;
-          in->getValue(step, ent, ele, 3 * i + 0, vx);
-          in->getValue(step, ent, ele, 3 * i + 1, vy);
-          in->getValue(step, ent, ele, 3 * i + 2, vz);
-          values.push_back(PValues(vx, vy, vz));
-        }
-        break;
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  // the specific visibility assigned by plugins is not thread-safe
+  if(plug) nthreads = 1;
+
+  // The elements are processed by blocks, whose data is read sequentially. The
+  // refined values and coordinates are then computed concurrently by chunks of
+  // elements, using matrix-matrix products, each thread refining its own copy
+  // of the reference element. As in the element-by-element algorithm, the
+  // refinement criterion of an element uses the min/max of the values of the
+  // elements processed up to it, so that the result does not depend on the
+  // number of threads.
+  const int chunkSize = 64, blockSize = 64 * chunkSize;
+  for(std::size_t b0 = 0; b0 < elements.size(); b0 += blockSize) {
+    int n = std::min((int)(elements.size() - b0), blockSize);
+    int numChunks = (n + chunkSize - 1) / chunkSize;
+    bool lastBlock = (b0 + n == elements.size());
+
+    // 0: skipped, 1: refined, 2: only used for the min/max
+    std::vector<char> status(n, 1);
+    fullMatrix<double> val(numVals, n), xyz(numNodes, 3 * n);
+    fullMatrix<double> valxyz(numVals, (numComp > 1) ? numComp * n : 1);
+    for(int e = 0; e < n; e++) {
+      int ent = elements[b0 + e].first, ele = elements[b0 + e].second;
+      int numVal = in->getNumValues(step, ent, ele) / numComp;
+      if(numVal != numVals) {
+        Msg::Warning("Wrong number of values in adaptation %d != %i", numVals,
+                     numVal);
+        status[e] = 0;
+        continue;
       }
-      case 9: {
-        for(int i = 0; i < numVal / 9; i++) {
-          double vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
-          in->getValue(step, ent, ele, 9 * i + 0, vxx);
-          in->getValue(step, ent, ele, 9 * i + 1, vxy);
-          in->getValue(step, ent, ele, 9 * i + 2, vxz);
-          in->getValue(step, ent, ele, 9 * i + 3, vyx);
-          in->getValue(step, ent, ele, 9 * i + 4, vyy);
-          in->getValue(step, ent, ele, 9 * i + 5, vyz);
-          in->getValue(step, ent, ele, 9 * i + 6, vzx);
-          in->getValue(step, ent, ele, 9 * i + 7, vzy);
-          in->getValue(step, ent, ele, 9 * i + 8, vzz);
-          values.push_back(
-            PValues(vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz));
+      for(int i = 0; i < numVals; i++) {
+        for(int k = 0; k < numComp; k++) {
+          double v;
+          in->getValue(step, ent, ele, numComp * i + k, v);
+          if(numComp == 1)
+            val(i, e) = v;
+          else {
+            val(i, e) += v * v;
+            valxyz(i, numComp * e + k) = v;
+          }
         }
-        break;
       }
+      int nn = in->getNumNodes(step, ent, ele);
+      if(nn != numNodes) {
+        Msg::Error("Wrong number of nodes in adaptation %d != %i", numNodes,
+                   nn);
+        status[e] = 2;
+        continue;
       }
-      if(adapt(tol, numComp, coords, values, out->Min, out->Max, plug)) {
-        *outNb += coords.size() / T::numNodes;
-        for(std::size_t i = 0; i < coords.size() / T::numNodes; i++) {
-          for(int k = 0; k < T::numNodes; ++k)
-            outList->push_back(coords[T::numNodes * i + k].c[0]);
-          for(int k = 0; k < T::numNodes; ++k)
-            outList->push_back(coords[T::numNodes * i + k].c[1]);
-          for(int k = 0; k < T::numNodes; ++k)
-            outList->push_back(coords[T::numNodes * i + k].c[2]);
-          for(int k = 0; k < T::numNodes; ++k)
-            for(int l = 0; l < numComp; ++l)
-              outList->push_back(values[T::numNodes * i + k].v[l]);
+      for(int i = 0; i < numNodes; i++)
+        in->getNode(step, ent, ele, i, xyz(i, 3 * e), xyz(i, 3 * e + 1),
+                    xyz(i, 3 * e + 2));
+    }
+
+    std::vector<double> minVal(n, VAL_INF), maxVal(n, -VAL_INF);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int c = 0; c < numChunks; c++) {
+      int c0 = c * chunkSize, nc = std::min(chunkSize, n - c0);
+      fullMatrix<double> v(val, c0, nc), res(numVertices, nc);
+      _interpolVal->mult(v, res);
+      for(int e = c0; e < c0 + nc; e++) {
+        if(!status[e]) continue;
+        for(int i = 0; i < numVertices; i++) {
+          minVal[e] = std::min(minVal[e], res(i, e - c0));
+          maxVal[e] = std::max(maxVal[e], res(i, e - c0));
         }
       }
     }
+    for(int e = 0; e < n; e++) {
+      if(!status[e]) continue;
+      out->Min = std::min(out->Min, minVal[e]);
+      out->Max = std::max(out->Max, maxVal[e]);
+      minVal[e] = out->Min;
+      maxVal[e] = out->Max;
+    }
+
+    std::vector<std::vector<double> > outData(n);
+    std::vector<int> outNum(n, 0);
+#pragma omp parallel num_threads(nthreads)
+    {
+      createReferenceElement<T>(_level);
+#pragma omp for schedule(dynamic)
+      for(int c = 0; c < numChunks; c++) {
+        int c0 = c * chunkSize, nc = std::min(chunkSize, n - c0);
+        fullMatrix<double> x(xyz, 3 * c0, 3 * nc), X(numVertices, 3 * nc);
+        _interpolGeom->mult(x, X);
+        fullMatrix<double> v(numComp == 1 ? val : valxyz, numComp * c0,
+                             numComp * nc);
+        fullMatrix<double> res(numVertices, numComp * nc);
+        _interpolVal->mult(v, res);
+        for(int e = c0; e < c0 + nc; e++) {
+          if(status[e] != 1) continue;
+          _refine(tol, numComp, res, X, e - c0, minVal[e], maxVal[e], plug);
+          std::vector<double> &d = outData[e];
+          for(auto it = T::all.begin(); it != T::all.end(); it++) {
+            if(!(*it)->visible) continue;
+            adaptiveVertex **p = (*it)->p;
+            for(int k = 0; k < T::numNodes; ++k) d.push_back(p[k]->X);
+            for(int k = 0; k < T::numNodes; ++k) d.push_back(p[k]->Y);
+            for(int k = 0; k < T::numNodes; ++k) d.push_back(p[k]->Z);
+            for(int k = 0; k < T::numNodes; ++k) {
+              d.push_back(p[k]->val);
+              if(numComp == 1) continue;
+              d.push_back(p[k]->valy);
+              d.push_back(p[k]->valz);
+              if(numComp == 3) continue;
+              d.push_back(p[k]->valyx);
+              d.push_back(p[k]->valyy);
+              d.push_back(p[k]->valyz);
+              d.push_back(p[k]->valzx);
+              d.push_back(p[k]->valzy);
+              d.push_back(p[k]->valzz);
+            }
+            outNum[e]++;
+          }
+        }
+      }
+      // only keep the reference element of the calling thread
+      if(lastBlock && Msg::GetThreadNum()) cleanElement<T>();
+    }
+
+    for(int e = 0; e < n; e++) {
+      *outNb += outNum[e];
+      outList->insert(outList->end(), outData[e].begin(), outData[e].end());
+    }
   }
 }
 
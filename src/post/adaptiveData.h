@@ -75,13 +75,15 @@ public:
   int getSize() { return (int)mapping.size(); }
 };
 
+// The refined reference elements (all and allVertices) are stored per thread,
+// so that elements can be refined concurrently.
 class adaptivePoint {
 public:
   bool visible;
   adaptiveVertex *p[1];
   adaptivePoint *e[1];
-  static std::list<adaptivePoint *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptivePoint *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -106,8 +108,8 @@ public:
   bool visible;
   adaptiveVertex *p[2];
   adaptiveLine *e[2];
-  static std::list<adaptiveLine *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptiveLine *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -134,8 +136,8 @@ public:
   bool visible;
   adaptiveVertex *p[3];
   adaptiveTriangle *e[4];
-  static std::list<adaptiveTriangle *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptiveTriangle *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -165,8 +167,8 @@ public:
   bool visible;
   adaptiveVertex *p[4];
   adaptiveQuadrangle *e[4];
-  static std::list<adaptiveQuadrangle *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptiveQuadrangle *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -202,8 +204,8 @@ public:
   bool visible;
   adaptiveVertex *p[6];
   adaptivePrism *e[8];
-  static std::list<adaptivePrism *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptivePrism *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -246,8 +248,8 @@ public:
   bool visible;
   adaptiveVertex *p[4];
   adaptiveTetrahedron *e[8];
-  static std::list<adaptiveTetrahedron *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptiveTetrahedron *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -284,8 +286,8 @@ public:
   bool visible;
   adaptiveVertex *p[8];
   adaptiveHexahedron *e[8];
-  static std::list<adaptiveHexahedron *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptiveHexahedron *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -335,8 +337,8 @@ public:
   bool visible;
   adaptiveVertex *p[5];
   adaptivePyramid *e[10];
-  static std::list<adaptivePyramid *> all;
-  static std::set<adaptiveVertex> allVertices;
+  static thread_local std::list<adaptivePyramid *> all;
+  static thread_local std::set<adaptiveVertex> allVertices;
   static int numNodes, numEdges;
 
 public:
@@ -597,6 +599,15 @@ template <class T> class adaptiveElements {
 private:
   fullMatrix<double> *_coeffsVal, *_eexpsVal, *_interpolVal;
   fullMatrix<double> *_coeffsGeom, *_eexpsGeom, *_interpolGeom;
+  // the refinement level of the interpolation matrices
+  int _level;
+  // assign the interpolated values and coordinates of an element (column
+  // 'col' of XYZ, and columns numComp * col to numComp * (col + 1) - 1 of
+  // res) to the refined reference element of the calling thread, and compute
+  // the visibility of the refined elements
+  void _refine(double tol, int numComp, const fullMatrix<double> &res,
+               const fullMatrix<double> &XYZ, int col, double minVal,
+               double maxVal, GMSH_PostPlugin *plug);
 
 public:
   adaptiveElements(std::vector<fullMatrix<double> *> &interpolationMatrices);